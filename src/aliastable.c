@@ -0,0 +1,293 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "aliastable.h"
+
+/**
+ *	@brief	Comparison function for sorting floats in ascending order with `qsort()`.
+ *
+ *	@param	a	: Pointer to the first float.
+ *	@param	b	: Pointer to the second float.
+ *	@return		: Negative, zero, or positive if `a` is less than, equal to, or greater than `b`.
+ */
+static int
+compareFloats(const void *  a, const void *  b)
+{
+	float	x = *(const float *) a;
+	float	y = *(const float *) b;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ *	@brief	Comparison function for sorting outcomes in ascending order of value with `qsort()`.
+ *
+ *	@param	a	: Pointer to the first outcome.
+ *	@param	b	: Pointer to the second outcome.
+ *	@return		: Negative, zero, or positive if `a` is less than, equal to, or greater than `b`.
+ */
+static int
+compareOutcomes(const void *  a, const void *  b)
+{
+	return compareFloats(&((const AliasTableOutcome *) a)->value, &((const AliasTableOutcome *) b)->value);
+}
+
+CommonConstantReturnType
+aliasTableInit(AliasTable *  table, const float *  values, const double *  weights, size_t numberOfOutcomes)
+{
+	double			totalWeight = 0.0;
+	double			mean = 0.0;
+	double			variance = 0.0;
+	double			cumulativeWeight = 0.0;
+	AliasTableOutcome *	outcomes;
+	double *		scaledWeights;
+	uint32_t *		small;
+	uint32_t *		large;
+	size_t			numberOfSmall = 0;
+	size_t			numberOfLarge = 0;
+	size_t			outcome = 0;
+
+	if ((numberOfOutcomes == 0) || (numberOfOutcomes > UINT32_MAX))
+	{
+		fprintf(stderr, "Error: An alias table needs between 1 and %" PRIu32 " outcomes.\n", UINT32_MAX);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t i = 0; i < numberOfOutcomes; i++)
+	{
+		if (!(weights[i] >= 0.0))
+		{
+			fprintf(stderr, "Error: Alias table weights must be non-negative.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		totalWeight += weights[i];
+		mean += weights[i] * values[i];
+	}
+
+	if (!(totalWeight > 0.0))
+	{
+		fprintf(stderr, "Error: Alias table weights must have a positive sum.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	mean /= totalWeight;
+	for (size_t i = 0; i < numberOfOutcomes; i++)
+	{
+		variance += weights[i] * (values[i] - mean) * (values[i] - mean);
+	}
+
+	*table = (AliasTable) {
+		.numberOfOutcomes		= numberOfOutcomes,
+		.values				= (float *) checkedMalloc(numberOfOutcomes * sizeof(float), __FILE__, __LINE__),
+		.thresholds			= (float *) checkedMalloc(numberOfOutcomes * sizeof(float), __FILE__, __LINE__),
+		.aliases			= (uint32_t *) checkedMalloc(numberOfOutcomes * sizeof(uint32_t), __FILE__, __LINE__),
+		.cumulativeProbabilities	= (double *) checkedMalloc(numberOfOutcomes * sizeof(double), __FILE__, __LINE__),
+		.guideTable			= (uint32_t *) checkedMalloc(numberOfOutcomes * sizeof(uint32_t), __FILE__, __LINE__),
+		.mean				= mean,
+		.variance			= variance / totalWeight,
+	};
+
+	outcomes = (AliasTableOutcome *) checkedMalloc(numberOfOutcomes * sizeof(AliasTableOutcome), __FILE__, __LINE__);
+	scaledWeights = (double *) checkedMalloc(numberOfOutcomes * sizeof(double), __FILE__, __LINE__);
+	small = (uint32_t *) checkedMalloc(numberOfOutcomes * sizeof(uint32_t), __FILE__, __LINE__);
+	large = (uint32_t *) checkedMalloc(numberOfOutcomes * sizeof(uint32_t), __FILE__, __LINE__);
+
+	for (size_t i = 0; i < numberOfOutcomes; i++)
+	{
+		outcomes[i] = (AliasTableOutcome) {
+			.value	= values[i],
+			.weight	= weights[i],
+		};
+	}
+	qsort(outcomes, numberOfOutcomes, sizeof(AliasTableOutcome), compareOutcomes);
+
+	/*
+	 *	Vose's method: scale the weights so that they average to one, then repeatedly fill the
+	 *	column of an outcome with weight below one with the excess of an outcome above one.
+	 */
+	for (size_t i = 0; i < numberOfOutcomes; i++)
+	{
+		table->values[i] = outcomes[i].value;
+		table->aliases[i] = (uint32_t) i;
+		scaledWeights[i] = outcomes[i].weight * numberOfOutcomes / totalWeight;
+
+		if (scaledWeights[i] < 1.0)
+		{
+			small[numberOfSmall++] = (uint32_t) i;
+		}
+		else
+		{
+			large[numberOfLarge++] = (uint32_t) i;
+		}
+	}
+
+	while ((numberOfSmall > 0) && (numberOfLarge > 0))
+	{
+		uint32_t	lessThanOne = small[--numberOfSmall];
+		uint32_t	moreThanOne = large[numberOfLarge - 1];
+
+		table->thresholds[lessThanOne] = (float) scaledWeights[lessThanOne];
+		table->aliases[lessThanOne] = moreThanOne;
+		scaledWeights[moreThanOne] -= 1.0 - scaledWeights[lessThanOne];
+
+		if (scaledWeights[moreThanOne] < 1.0)
+		{
+			numberOfLarge--;
+			small[numberOfSmall++] = moreThanOne;
+		}
+	}
+
+	/*
+	 *	Whatever is left has weight one, up to rounding.
+	 */
+	while (numberOfLarge > 0)
+	{
+		table->thresholds[large[--numberOfLarge]] = 1.0f;
+	}
+	while (numberOfSmall > 0)
+	{
+		table->thresholds[small[--numberOfSmall]] = 1.0f;
+	}
+
+	/*
+	 *	Cumulative distribution function, and a guide table holding for every `g` the first
+	 *	outcome whose cumulative probability exceeds `g / numberOfOutcomes`.
+	 */
+	for (size_t i = 0; i < numberOfOutcomes; i++)
+	{
+		cumulativeWeight += outcomes[i].weight;
+		table->cumulativeProbabilities[i] = cumulativeWeight / totalWeight;
+	}
+	table->cumulativeProbabilities[numberOfOutcomes - 1] = 1.0;
+
+	for (size_t g = 0; g < numberOfOutcomes; g++)
+	{
+		while (table->cumulativeProbabilities[outcome] <= (double) g / numberOfOutcomes)
+		{
+			outcome++;
+		}
+
+		table->guideTable[g] = (uint32_t) outcome;
+	}
+
+	free(outcomes);
+	free(scaledWeights);
+	free(small);
+	free(large);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+aliasTableInitFromSamples(AliasTable *  table, const float *  samples, size_t numberOfSamples)
+{
+	float *				sortedSamples;
+	float *				uniqueValues;
+	double *			counts;
+	size_t				numberOfUniqueValues = 0;
+	CommonConstantReturnType	ret;
+
+	if (numberOfSamples == 0)
+	{
+		fprintf(stderr, "Error: An empirical distribution needs at least one sample.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	sortedSamples = (float *) checkedMalloc(numberOfSamples * sizeof(float), __FILE__, __LINE__);
+	uniqueValues = (float *) checkedMalloc(numberOfSamples * sizeof(float), __FILE__, __LINE__);
+	counts = (double *) checkedMalloc(numberOfSamples * sizeof(double), __FILE__, __LINE__);
+
+	memcpy(sortedSamples, samples, numberOfSamples * sizeof(float));
+	qsort(sortedSamples, numberOfSamples, sizeof(float), compareFloats);
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		if ((numberOfUniqueValues > 0) && (sortedSamples[i] == uniqueValues[numberOfUniqueValues - 1]))
+		{
+			counts[numberOfUniqueValues - 1] += 1.0;
+		}
+		else
+		{
+			uniqueValues[numberOfUniqueValues] = sortedSamples[i];
+			counts[numberOfUniqueValues] = 1.0;
+			numberOfUniqueValues++;
+		}
+	}
+
+	ret = aliasTableInit(table, uniqueValues, counts, numberOfUniqueValues);
+
+	free(sortedSamples);
+	free(uniqueValues);
+	free(counts);
+
+	return ret;
+}
+
+void
+aliasTableFree(AliasTable *  table)
+{
+	free(table->values);
+	free(table->thresholds);
+	free(table->aliases);
+	free(table->cumulativeProbabilities);
+	free(table->guideTable);
+	table->values = NULL;
+	table->thresholds = NULL;
+	table->aliases = NULL;
+	table->cumulativeProbabilities = NULL;
+	table->guideTable = NULL;
+	table->numberOfOutcomes = 0;
+
+	return;
+}
+
+void
+aliasTableDrawBatch(const AliasTable *  table, const double *  uniforms, float *  values, size_t numberOfDraws)
+{
+	const double	numberOfOutcomes = (double) table->numberOfOutcomes;
+	const size_t	lastColumn = table->numberOfOutcomes - 1;
+
+	/*
+	 *	Branch-free body (the selects compile to conditional moves/blends) so the loop vectorizes
+	 *	with gather instructions where available.
+	 */
+	#pragma omp simd
+	for (size_t i = 0; i < numberOfDraws; i++)
+	{
+		double	scaled = uniforms[i] * numberOfOutcomes;
+		size_t	column = (size_t) scaled;
+
+		column = (column > lastColumn) ? lastColumn : column;
+		values[i] = ((scaled - column) < table->thresholds[column]) ? table->values[column] : table->values[table->aliases[column]];
+	}
+
+	return;
+}
@@ -0,0 +1,149 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+
+typedef struct AliasTableOutcome
+{
+	float		value;
+	double		weight;
+} AliasTableOutcome;
+
+/*
+ *	Walker/Vose alias table of a discrete distribution over `numberOfOutcomes` values. A draw
+ *	picks a column uniformly and then either the column's own value or its alias, so it costs
+ *	constant time independent of the number of outcomes.
+ */
+typedef struct AliasTable
+{
+	size_t		numberOfOutcomes;
+	/*
+	 *	Value of each outcome, in ascending order.
+	 */
+	float *		values;
+	/*
+	 *	Probability of keeping the column's own value rather than its alias.
+	 */
+	float *		thresholds;
+	uint32_t *	aliases;
+	/*
+	 *	Cumulative distribution function at each value, and a guide table for inverting it.
+	 */
+	double *	cumulativeProbabilities;
+	uint32_t *	guideTable;
+	/*
+	 *	Moments of the distribution, computed when the table is built.
+	 */
+	double		mean;
+	double		variance;
+} AliasTable;
+
+/**
+ *	@brief	Build an alias table from values and their (not necessarily normalized) weights.
+ *
+ *	@param	table			: Pointer to the alias table to build.
+ *	@param	values			: The values.
+ *	@param	weights			: Non-negative weights of the values, with a positive sum.
+ *	@param	numberOfOutcomes	: Number of entries in `values` and `weights`.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	aliasTableInit(AliasTable *  table, const float *  values, const double *  weights, size_t numberOfOutcomes);
+
+/**
+ *	@brief	Build an alias table for the empirical distribution of samples. Repeated sample
+ *		values become a single outcome weighted by its count.
+ *
+ *	@param	table			: Pointer to the alias table to build.
+ *	@param	samples			: The samples.
+ *	@param	numberOfSamples		: Number of entries in `samples`.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	aliasTableInitFromSamples(AliasTable *  table, const float *  samples, size_t numberOfSamples);
+
+/**
+ *	@brief	Free the memory held by an alias table.
+ *
+ *	@param	table	: Pointer to the alias table.
+ */
+void				aliasTableFree(AliasTable *  table);
+
+/**
+ *	@brief	Draw from an alias table. The integer part of `u * numberOfOutcomes` selects the
+ *		column and its fractional part decides between the column's value and its alias.
+ *
+ *	@param	table	: Pointer to the alias table.
+ *	@param	u	: Uniform variate in (0, 1).
+ *	@return		: The drawn value.
+ */
+static inline float
+aliasTableDraw(const AliasTable *  table, double u)
+{
+	double	scaled = u * table->numberOfOutcomes;
+	size_t	column = (size_t) scaled;
+
+	if (column >= table->numberOfOutcomes)
+	{
+		column = table->numberOfOutcomes - 1;
+	}
+
+	return ((scaled - column) < table->thresholds[column]) ? table->values[column] : table->values[table->aliases[column]];
+}
+
+/**
+ *	@brief	Quantile (inverse cumulative distribution function) of the distribution of an alias
+ *		table. Unlike `aliasTableDraw()`, this is monotone in `u`, at the cost of a short scan
+ *		from the guide table (constant time on average).
+ *
+ *	@param	table	: Pointer to the alias table.
+ *	@param	u	: Probability in (0, 1).
+ *	@return		: The smallest value whose cumulative probability exceeds `u`.
+ */
+static inline float
+aliasTableQuantile(const AliasTable *  table, double u)
+{
+	size_t	guide = (size_t)(u * table->numberOfOutcomes);
+	size_t	outcome;
+
+	outcome = table->guideTable[(guide < table->numberOfOutcomes) ? guide : (table->numberOfOutcomes - 1)];
+	while ((outcome < table->numberOfOutcomes - 1) && (table->cumulativeProbabilities[outcome] <= u))
+	{
+		outcome++;
+	}
+
+	return table->values[outcome];
+}
+
+/**
+ *	@brief	Draw a batch of values from an alias table.
+ *
+ *	@param	table		: Pointer to the alias table.
+ *	@param	uniforms	: Uniform variates in (0, 1), one per draw.
+ *	@param	values		: Array to store the drawn values.
+ *	@param	numberOfDraws	: Number of draws.
+ */
+void				aliasTableDrawBatch(const AliasTable *  table, const double *  uniforms, float *  values, size_t numberOfDraws);
@@ -0,0 +1,99 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include "calibration.h"
+
+static const char *	kCalibrationSamplingNames[kCalibrationSamplingMax] =
+			{
+				"fixed",
+				"joint",
+				"independent",
+			};
+
+CommonConstantReturnType
+calibrationSamplingFromString(const char *  name, CalibrationSampling *  sampling)
+{
+	for (CalibrationSampling i = 0; i < kCalibrationSamplingMax; i++)
+	{
+		if (strcmp(name, kCalibrationSamplingNames[i]) == 0)
+		{
+			*sampling = i;
+
+			return kCommonConstantReturnTypeSuccess;
+		}
+	}
+
+	return kCommonConstantReturnTypeError;
+}
+
+const char *
+calibrationSamplingToString(CalibrationSampling sampling)
+{
+	return (sampling < kCalibrationSamplingMax) ? kCalibrationSamplingNames[sampling] : "unknown";
+}
+
+size_t
+calibrationSamplingNumberOfDimensions(const CalibrationTable *  table, CalibrationSampling sampling)
+{
+	switch (sampling)
+	{
+		case kCalibrationSamplingJoint:
+		{
+			return 1;
+		}
+
+		case kCalibrationSamplingIndependent:
+		{
+			return table->numberOfParameters;
+		}
+
+		default:
+		{
+			return 0;
+		}
+	}
+}
+
+void
+calibrationTableInit(CalibrationTable *  table, size_t numberOfDevices, size_t numberOfParameters)
+{
+	*table = (CalibrationTable) {
+		.numberOfDevices	= numberOfDevices,
+		.numberOfParameters	= numberOfParameters,
+		.rows			= (float *) checkedMalloc(numberOfDevices * numberOfParameters * sizeof(float), __FILE__, __LINE__),
+	};
+
+	return;
+}
+
+void
+calibrationTableFree(CalibrationTable *  table)
+{
+	free(table->rows);
+	table->rows = NULL;
+	table->numberOfDevices = 0;
+
+	return;
+}
@@ -0,0 +1,113 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+
+typedef enum
+{
+	kCalibrationSamplingFixed		= 0,
+	kCalibrationSamplingJoint,
+	kCalibrationSamplingIndependent,
+	kCalibrationSamplingMax
+} CalibrationSampling;
+
+/*
+ *	In-memory table of calibration parameters: one row of `numberOfParameters` values per device.
+ */
+typedef struct CalibrationTable
+{
+	size_t		numberOfDevices;
+	size_t		numberOfParameters;
+	float *		rows;
+} CalibrationTable;
+
+/**
+ *	@brief	Parse a calibration sampling name.
+ *
+ *	@param	name		: One of "fixed", "joint", or "independent".
+ *	@param	sampling	: Pointer to store the parsed calibration sampling.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	calibrationSamplingFromString(const char *  name, CalibrationSampling *  sampling);
+
+/**
+ *	@brief	Get the name of a calibration sampling.
+ *
+ *	@param	sampling	: The calibration sampling.
+ *	@return			: Name of the calibration sampling.
+ */
+const char *			calibrationSamplingToString(CalibrationSampling sampling);
+
+/**
+ *	@brief	Number of uniform variates that one draw of calibration parameters consumes.
+ *
+ *	@param	table		: Pointer to the calibration table.
+ *	@param	sampling	: The calibration sampling.
+ *	@return			: Zero for fixed, one for joint, and one per parameter for independent sampling.
+ */
+size_t				calibrationSamplingNumberOfDimensions(const CalibrationTable *  table, CalibrationSampling sampling);
+
+/**
+ *	@brief	Allocate a calibration table.
+ *
+ *	@param	table			: Pointer to the calibration table to initialize.
+ *	@param	numberOfDevices		: Number of rows.
+ *	@param	numberOfParameters	: Number of parameters per row.
+ */
+void				calibrationTableInit(CalibrationTable *  table, size_t numberOfDevices, size_t numberOfParameters);
+
+/**
+ *	@brief	Free the memory held by a calibration table.
+ *
+ *	@param	table	: Pointer to the calibration table.
+ */
+void				calibrationTableFree(CalibrationTable *  table);
+
+/**
+ *	@brief	Draw a vector of calibration parameters. Joint sampling copies the row of one device;
+ *		independent sampling picks the device of every parameter separately.
+ *
+ *	@param	table		: Pointer to the calibration table.
+ *	@param	sampling	: The calibration sampling (joint or independent).
+ *	@param	uniforms	: Uniform variates in (0, 1), as many as `calibrationSamplingNumberOfDimensions()`.
+ *	@param	parameters	: Array of `numberOfParameters` entries to store the drawn parameters.
+ */
+static inline void
+calibrationTableDraw(const CalibrationTable *  table, CalibrationSampling sampling, const double *  uniforms, float *  parameters)
+{
+	for (size_t i = 0; i < table->numberOfParameters; i++)
+	{
+		double	u = (sampling == kCalibrationSamplingIndependent) ? uniforms[i] : uniforms[0];
+		size_t	device = (size_t)(u * table->numberOfDevices);
+
+		device = (device < table->numberOfDevices) ? device : (table->numberOfDevices - 1);
+		parameters[i] = table->rows[device * table->numberOfParameters + i];
+	}
+
+	return;
+}
@@ -0,0 +1,411 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include "checkpoint.h"
+
+static const char	kCheckpointMagic[kCheckpointConstantMagicLength] = {'B', 'M', 'E', '6', '8', '0', 'C', 'K'};
+
+/**
+ *	@brief	Mix a value into a hash.
+ *
+ *	@param	hash	: The hash so far.
+ *	@param	value	: The value to mix in.
+ *	@return		: The new hash.
+ */
+static uint64_t
+hashCombine(uint64_t hash, uint64_t value)
+{
+	return samplingMix64(hash ^ (value + UINT64_C(0x9e3779b97f4a7c15) + (hash << 6) + (hash >> 2)));
+}
+
+static uint64_t
+hashCombineDouble(uint64_t hash, double value)
+{
+	uint64_t	bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+
+	return hashCombine(hash, bits);
+}
+
+/**
+ *	@brief	Merge the running statistics of a segment of samples into those of a checkpoint.
+ *
+ *	@param	statistics	: Pointer to the statistics to merge into.
+ *	@param	samples		: The samples of the segment.
+ *	@param	numberOfSamples	: Number of samples in the segment.
+ */
+static void
+mergeStatistics(CheckpointStatistics *  statistics, const float *  samples, size_t numberOfSamples)
+{
+	double	mean = 0.0;
+	double	sumOfSquaredDeviations = 0.0;
+	double	delta;
+	double	count;
+
+	if (numberOfSamples == 0)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		mean += samples[i];
+	}
+	mean /= numberOfSamples;
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		double	deviation = samples[i] - mean;
+
+		sumOfSquaredDeviations += deviation * deviation;
+	}
+
+	count = (double) statistics->count + (double) numberOfSamples;
+	delta = mean - statistics->mean;
+	statistics->mean += delta * numberOfSamples / count;
+	statistics->sumOfSquaredDeviations += sumOfSquaredDeviations + delta * delta * statistics->count * numberOfSamples / count;
+	statistics->count += numberOfSamples;
+
+	return;
+}
+
+/**
+ *	@brief	Write the header of a checkpoint and sync the file.
+ *
+ *	@param	checkpoint	: Pointer to the checkpoint.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+writeHeader(Checkpoint *  checkpoint)
+{
+	if ((fseeko(checkpoint->file, 0, SEEK_SET) != 0) ||
+		(fwrite(&checkpoint->header, sizeof(CheckpointHeader), 1, checkpoint->file) != 1) ||
+		(fflush(checkpoint->file) != 0) ||
+		(fsync(fileno(checkpoint->file)) != 0))
+	{
+		fprintf(stderr, "Error: Could not write the checkpoint header: %s.\n", strerror(errno));
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Load the samples of the completed iterations of a checkpoint.
+ *
+ *	@param	checkpoint	: Pointer to the checkpoint.
+ *	@param	outputSamples	: Array to load the outputs into.
+ *	@param	controlSamples	: Array to load the control-variate samples into, or `NULL`.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+loadSamples(Checkpoint *  checkpoint, float *  outputSamples, float *  controlSamples)
+{
+	size_t	valuesPerRecord = checkpoint->header.recordSize / sizeof(float);
+	size_t	numberOfRecords = checkpoint->header.numberOfCompletedIterations;
+	float *	buffer = (float *) checkedMalloc(kCheckpointConstantRecordsPerTransfer * checkpoint->header.recordSize, __FILE__, __LINE__);
+
+	if (fseeko(checkpoint->file, (off_t) sizeof(CheckpointHeader), SEEK_SET) != 0)
+	{
+		free(buffer);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t first = 0; first < numberOfRecords; first += kCheckpointConstantRecordsPerTransfer)
+	{
+		size_t	count = numberOfRecords - first;
+
+		count = (count < kCheckpointConstantRecordsPerTransfer) ? count : kCheckpointConstantRecordsPerTransfer;
+
+		if (fread(buffer, checkpoint->header.recordSize, count, checkpoint->file) != count)
+		{
+			free(buffer);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			outputSamples[first + i] = buffer[i * valuesPerRecord];
+
+			if (controlSamples != NULL)
+			{
+				controlSamples[first + i] = buffer[i * valuesPerRecord + 1];
+			}
+		}
+	}
+
+	free(buffer);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+uint64_t
+checkpointConfigurationHash(const ConversionModel *  model)
+{
+	const CommandLineArguments *	arguments = model->arguments;
+	uint64_t			hash = kCheckpointConstantVersion;
+
+	hash = hashCombine(hash, arguments->randomSeed);
+	hash = hashCombine(hash, arguments->samplingMethod);
+	hash = hashCombine(hash, arguments->common.outputSelect);
+	hash = hashCombine(hash, arguments->calibrationSampling);
+	hash = hashCombine(hash, arguments->inputCorrelation);
+	hash = hashCombine(hash, conversionModelNumberOfInputs(model));
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		hash = hashCombine(hash, model->inputDistributions[i].kind);
+		hash = hashCombineDouble(hash, inputDistributionMean(&model->inputDistributions[i]));
+		hash = hashCombineDouble(hash, inputDistributionVariance(&model->inputDistributions[i]));
+	}
+
+	for (size_t i = 0; i < kBME680ConstantsNumberOfTemperatureParameters; i++)
+	{
+		hash = hashCombineDouble(hash, model->temperatureParameters[i]);
+	}
+
+	for (size_t i = 0; i < kBME680ConstantsNumberOfPressureParameters; i++)
+	{
+		hash = hashCombineDouble(hash, model->pressureParameters[i]);
+	}
+
+	for (size_t i = 0; i < kBME680ConstantsNumberOfHumidityParameters; i++)
+	{
+		hash = hashCombineDouble(hash, model->humidityParameters[i]);
+	}
+
+	if (model->calibrationTable != NULL)
+	{
+		for (size_t i = 0; i < model->calibrationTable->numberOfDevices * model->calibrationTable->numberOfParameters; i++)
+		{
+			hash = hashCombineDouble(hash, model->calibrationTable->rows[i]);
+		}
+	}
+
+	return hash;
+}
+
+CommonConstantReturnType
+checkpointOpen(
+	Checkpoint *			checkpoint,
+	const CommandLineArguments *	arguments,
+	uint64_t			configurationHash,
+	float *				outputSamples,
+	float *				controlSamples,
+	size_t *			numberOfCompletedIterations)
+{
+	const char *	path = arguments->checkpointPath;
+	uint32_t	recordSize = (uint32_t)(((controlSamples != NULL) ? 2 : 1) * sizeof(float));
+	size_t		numberOfIterations = arguments->common.numberOfMonteCarloIterations;
+
+	*numberOfCompletedIterations = 0;
+	checkpoint->file = NULL;
+
+	if (arguments->resumeFromCheckpoint || arguments->extendCheckpoint)
+	{
+		checkpoint->file = fopen(path, "r+b");
+
+		/*
+		 *	Resuming a run whose first checkpoint was never written starts it afresh.
+		 */
+		if ((checkpoint->file == NULL) && ((errno != ENOENT) || arguments->extendCheckpoint))
+		{
+			fprintf(stderr, "Error: Could not open checkpoint \"%s\": %s.\n", path, strerror(errno));
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (checkpoint->file == NULL)
+	{
+		checkpoint->file = fopen(path, "w+b");
+
+		if (checkpoint->file == NULL)
+		{
+			fprintf(stderr, "Error: Could not create checkpoint \"%s\": %s.\n", path, strerror(errno));
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		checkpoint->header = (CheckpointHeader) {
+			.version		= kCheckpointConstantVersion,
+			.recordSize		= recordSize,
+			.configurationHash	= configurationHash,
+			.samplingMethod		= arguments->samplingMethod,
+			.numberOfIterations	= numberOfIterations,
+		};
+		memcpy(checkpoint->header.magic, kCheckpointMagic, kCheckpointConstantMagicLength);
+
+		return writeHeader(checkpoint);
+	}
+
+	if ((fread(&checkpoint->header, sizeof(CheckpointHeader), 1, checkpoint->file) != 1) ||
+		(memcmp(checkpoint->header.magic, kCheckpointMagic, kCheckpointConstantMagicLength) != 0) ||
+		(checkpoint->header.version != kCheckpointConstantVersion))
+	{
+		fprintf(stderr, "Error: \"%s\" is not a checkpoint of this application.\n", path);
+		checkpointClose(checkpoint);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((checkpoint->header.configurationHash != configurationHash) || (checkpoint->header.recordSize != recordSize))
+	{
+		fprintf(stderr, "Error: Checkpoint \"%s\" belongs to a run with different options or inputs.\n", path);
+		checkpointClose(checkpoint);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (checkpoint->header.numberOfIterations != numberOfIterations)
+	{
+		/*
+		 *	Latin hypercube and stratified samples depend on the number of iterations, so only
+		 *	the other sampling methods keep the samples of the checkpoint when `-M` grows.
+		 */
+		bool	isExtensible = (arguments->samplingMethod == kSamplingMethodPseudoRandom) || (arguments->samplingMethod == kSamplingMethodAntithetic);
+
+		if (!arguments->extendCheckpoint)
+		{
+			fprintf(stderr, "Error: Checkpoint \"%s\" is of a run with %" PRIu64 " iterations. Use `-X` to extend it.\n", path, checkpoint->header.numberOfIterations);
+			checkpointClose(checkpoint);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!isExtensible || (numberOfIterations < checkpoint->header.numberOfCompletedIterations))
+		{
+			fprintf(stderr, "Error: Only pseudorandom and antithetic runs can be extended, and only to at least the %" PRIu64 " completed iterations.\n", checkpoint->header.numberOfCompletedIterations);
+			checkpointClose(checkpoint);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		checkpoint->header.numberOfIterations = numberOfIterations;
+	}
+
+	if (loadSamples(checkpoint, outputSamples, controlSamples) != kCommonConstantReturnTypeSuccess)
+	{
+		fprintf(stderr, "Error: Checkpoint \"%s\" is truncated.\n", path);
+		checkpointClose(checkpoint);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	*numberOfCompletedIterations = checkpoint->header.numberOfCompletedIterations;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+checkpointSave(
+	Checkpoint *	checkpoint,
+	const float *	outputSamples,
+	const float *	controlSamples,
+	size_t		numberOfCompletedIterations)
+{
+	size_t	firstIteration = checkpoint->header.numberOfCompletedIterations;
+	size_t	valuesPerRecord = checkpoint->header.recordSize / sizeof(float);
+	float *	buffer;
+
+	if (numberOfCompletedIterations <= firstIteration)
+	{
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	if (fseeko(checkpoint->file, (off_t)(sizeof(CheckpointHeader) + firstIteration * checkpoint->header.recordSize), SEEK_SET) != 0)
+	{
+		fprintf(stderr, "Error: Could not write the checkpoint samples: %s.\n", strerror(errno));
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	buffer = (float *) checkedMalloc(kCheckpointConstantRecordsPerTransfer * checkpoint->header.recordSize, __FILE__, __LINE__);
+
+	for (size_t first = firstIteration; first < numberOfCompletedIterations; first += kCheckpointConstantRecordsPerTransfer)
+	{
+		size_t	count = numberOfCompletedIterations - first;
+
+		count = (count < kCheckpointConstantRecordsPerTransfer) ? count : kCheckpointConstantRecordsPerTransfer;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			buffer[i * valuesPerRecord] = outputSamples[first + i];
+
+			if (controlSamples != NULL)
+			{
+				buffer[i * valuesPerRecord + 1] = controlSamples[first + i];
+			}
+		}
+
+		if (fwrite(buffer, checkpoint->header.recordSize, count, checkpoint->file) != count)
+		{
+			fprintf(stderr, "Error: Could not write the checkpoint samples: %s.\n", strerror(errno));
+			free(buffer);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	free(buffer);
+
+	if ((fflush(checkpoint->file) != 0) || (fsync(fileno(checkpoint->file)) != 0))
+	{
+		fprintf(stderr, "Error: Could not sync the checkpoint samples: %s.\n", strerror(errno));
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	mergeStatistics(&checkpoint->header.outputStatistics, &outputSamples[firstIteration], numberOfCompletedIterations - firstIteration);
+
+	if (controlSamples != NULL)
+	{
+		mergeStatistics(&checkpoint->header.controlStatistics, &controlSamples[firstIteration], numberOfCompletedIterations - firstIteration);
+	}
+
+	checkpoint->header.numberOfCompletedIterations = numberOfCompletedIterations;
+
+	return writeHeader(checkpoint);
+}
+
+void
+checkpointClose(Checkpoint *  checkpoint)
+{
+	if (checkpoint->file != NULL)
+	{
+		fclose(checkpoint->file);
+		checkpoint->file = NULL;
+	}
+
+	return;
+}
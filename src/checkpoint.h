@@ -0,0 +1,142 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "model.h"
+
+typedef enum
+{
+	kCheckpointConstantVersion		= 1,
+	kCheckpointConstantMagicLength		= 8,
+	/*
+	 *	Number of records that one read or write of a checkpoint file moves.
+	 */
+	kCheckpointConstantRecordsPerTransfer	= 65536,
+} CheckpointConstant;
+
+/*
+ *	Running mean and sum of squared deviations of the samples saved so far, merged segment by
+ *	segment (Chan et al.), so a checkpoint can be summarized without reading its samples.
+ */
+typedef struct CheckpointStatistics
+{
+	uint64_t	count;
+	double		mean;
+	double		sumOfSquaredDeviations;
+} CheckpointStatistics;
+
+/*
+ *	Header at the start of a checkpoint file. The samples follow the header as records of the
+ *	selected output and, when the run uses the control variate, the temperature output. Since
+ *	every iteration draws its random numbers from counter-based streams by its index alone, the
+ *	number of completed iterations is the position of all random number streams.
+ */
+typedef struct CheckpointHeader
+{
+	char			magic[kCheckpointConstantMagicLength];
+	uint32_t		version;
+	uint32_t		recordSize;
+	/*
+	 *	Hash of everything that determines the samples of an iteration: seed, sampling method,
+	 *	selected output, inputs, and calibration parameters.
+	 */
+	uint64_t		configurationHash;
+	uint32_t		samplingMethod;
+	uint32_t		reserved;
+	/*
+	 *	Number of iterations of the run (`-M`), which Latin hypercube and stratified samples
+	 *	depend on.
+	 */
+	uint64_t		numberOfIterations;
+	uint64_t		numberOfCompletedIterations;
+	CheckpointStatistics	outputStatistics;
+	CheckpointStatistics	controlStatistics;
+} CheckpointHeader;
+
+typedef struct Checkpoint
+{
+	FILE *			file;
+	CheckpointHeader	header;
+} Checkpoint;
+
+/**
+ *	@brief	Hash the configuration of a native Monte Carlo run, to check that a checkpoint
+ *		belongs to the same run.
+ *
+ *	@param	model	: Pointer to the conversion model of the run.
+ *	@return		: The hash.
+ */
+uint64_t			checkpointConfigurationHash(const ConversionModel *  model);
+
+/**
+ *	@brief	Open the checkpoint file of a native Monte Carlo run. A new run creates the file.
+ *		Resuming loads the samples of the completed iterations, or creates the file if it does
+ *		not exist yet, so the same command line starts and restarts a run. Extending also
+ *		allows a larger `-M` than the checkpointed run, for sampling methods whose samples do
+ *		not depend on `-M`.
+ *
+ *	@param	checkpoint			: Pointer to the checkpoint to open.
+ *	@param	arguments			: Pointer to the command-line arguments struct.
+ *	@param	configurationHash		: Hash of the configuration of the run.
+ *	@param	outputSamples			: Array of `-M` entries to load the checkpointed outputs into.
+ *	@param	controlSamples			: Array of `-M` entries to load the checkpointed control-variate samples into, or `NULL`.
+ *	@param	numberOfCompletedIterations	: Pointer to store the number of iterations loaded.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	checkpointOpen(
+					Checkpoint *			checkpoint,
+					const CommandLineArguments *	arguments,
+					uint64_t			configurationHash,
+					float *				outputSamples,
+					float *				controlSamples,
+					size_t *			numberOfCompletedIterations);
+
+/**
+ *	@brief	Save the samples of newly-completed iterations to a checkpoint. The samples are
+ *		written and synced before the header that counts them, so a run that dies while
+ *		saving resumes from the previous checkpoint.
+ *
+ *	@param	checkpoint			: Pointer to the checkpoint.
+ *	@param	outputSamples			: The outputs of all iterations so far.
+ *	@param	controlSamples			: The control-variate samples of all iterations so far, or `NULL`.
+ *	@param	numberOfCompletedIterations	: Number of iterations completed so far.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	checkpointSave(
+					Checkpoint *	checkpoint,
+					const float *	outputSamples,
+					const float *	controlSamples,
+					size_t		numberOfCompletedIterations);
+
+/**
+ *	@brief	Close a checkpoint file.
+ *
+ *	@param	checkpoint	: Pointer to the checkpoint.
+ */
+void				checkpointClose(Checkpoint *  checkpoint);
@@ -3,5 +3,32 @@ SOURCES	=\
 	main.c\
 	utilities.c\
 	common.c\
+	sampling.c\
+	estimators.c\
+	distributions.c\
+	aliastable.c\
+	calibration.c\
+	model.c\
+	sensitivity.c\
+	uxstring.c\
+	correlation.c\
+	importance.c\
+	checkpoint.c\
+	shard.c\
+	placement.c\
+	samplestore.c\
+	reservoir.c\
+	precision.c\
+	delta.c\
+	unscented.c\
+	moments.c\
+	density.c\
+	interval.c\
+	dual.c\
+	gradient.c\
+	particle.c\
+	pce.c\
+	grid.c\
+	kernelcheck.c\
 
 CFLAGS += -IBME680-patched-driver/
@@ -0,0 +1,416 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "correlation.h"
+
+static const char *	kInputCorrelationNames[kInputCorrelationMax] =
+			{
+				"independent",
+				"cross",
+				"lagged",
+			};
+
+typedef struct RankedValue
+{
+	float		value;
+	size_t		index;
+} RankedValue;
+
+/**
+ *	@brief	Comparison function for sorting ranked values in ascending order with `qsort()`.
+ *
+ *	@param	a	: Pointer to the first ranked value.
+ *	@param	b	: Pointer to the second ranked value.
+ *	@return		: Negative, zero, or positive if `a` is less than, equal to, or greater than `b`.
+ */
+static int
+compareRankedValues(const void *  a, const void *  b)
+{
+	float	x = ((const RankedValue *) a)->value;
+	float	y = ((const RankedValue *) b)->value;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ *	@brief	Normal scores of a trace: the standard normal quantiles of the mid-ranks of its values,
+ *		so that tied values get the same score.
+ *
+ *	@param	trace		: The trace.
+ *	@param	traceLength	: Number of entries in the trace.
+ *	@param	scores		: Array to store the scores.
+ */
+static void
+calculateNormalScores(const float *  trace, size_t traceLength, double *  scores)
+{
+	RankedValue *	ranked = (RankedValue *) checkedMalloc(traceLength * sizeof(RankedValue), __FILE__, __LINE__);
+
+	for (size_t t = 0; t < traceLength; t++)
+	{
+		ranked[t] = (RankedValue) {
+			.value	= trace[t],
+			.index	= t,
+		};
+	}
+	qsort(ranked, traceLength, sizeof(RankedValue), compareRankedValues);
+
+	for (size_t first = 0; first < traceLength; )
+	{
+		size_t	last = first;
+		double	midRank;
+
+		while ((last + 1 < traceLength) && (ranked[last + 1].value == ranked[first].value))
+		{
+			last++;
+		}
+
+		midRank = 0.5 * (double)(first + last) + 0.5;
+		for (size_t t = first; t <= last; t++)
+		{
+			scores[ranked[t].index] = samplingNormalQuantile(midRank / traceLength);
+		}
+
+		first = last + 1;
+	}
+
+	free(ranked);
+
+	return;
+}
+
+/**
+ *	@brief	Lower Cholesky factor of a symmetric matrix.
+ *
+ *	@param	matrix			: The matrix.
+ *	@param	factor			: Matrix to store the factor.
+ *	@param	numberOfVariables	: Dimension of the matrices.
+ *	@return				: `true` if the matrix is positive definite, else `false`.
+ */
+static bool
+choleskyFactorize(
+	double		matrix[kCorrelationConstantMaxVariables][kCorrelationConstantMaxVariables],
+	double		factor[kCorrelationConstantMaxVariables][kCorrelationConstantMaxVariables],
+	size_t		numberOfVariables)
+{
+	memset(factor, 0, kCorrelationConstantMaxVariables * sizeof(factor[0]));
+
+	for (size_t i = 0; i < numberOfVariables; i++)
+	{
+		for (size_t j = 0; j <= i; j++)
+		{
+			double	sum = matrix[i][j];
+
+			for (size_t k = 0; k < j; k++)
+			{
+				sum -= factor[i][k] * factor[j][k];
+			}
+
+			if (i == j)
+			{
+				if (!(sum > 1e-12))
+				{
+					return false;
+				}
+
+				factor[i][i] = sqrt(sum);
+			}
+			else
+			{
+				factor[i][j] = sum / factor[j][j];
+			}
+		}
+	}
+
+	return true;
+}
+
+CommonConstantReturnType
+inputCorrelationFromString(const char *  name, InputCorrelation *  correlation)
+{
+	for (InputCorrelation i = 0; i < kInputCorrelationMax; i++)
+	{
+		if (strcmp(name, kInputCorrelationNames[i]) == 0)
+		{
+			*correlation = i;
+
+			return kCommonConstantReturnTypeSuccess;
+		}
+	}
+
+	return kCommonConstantReturnTypeError;
+}
+
+const char *
+inputCorrelationToString(InputCorrelation correlation)
+{
+	return (correlation < kInputCorrelationMax) ? kInputCorrelationNames[correlation] : "unknown";
+}
+
+CommonConstantReturnType
+correlatedSamplerInit(
+	CorrelatedSampler *	sampler,
+	InputCorrelation	correlation,
+	const float * const *	traces,
+	size_t			traceLength,
+	size_t			numberOfVariables)
+{
+	double *	scores[kCorrelationConstantMaxVariables] = {NULL};
+	double		standardDeviations[kCorrelationConstantMaxVariables];
+	double		lagCorrelation[kCorrelationConstantMaxVariables][kCorrelationConstantMaxVariables] = {{0}};
+	double		inverseTimesLagTransposed[kCorrelationConstantMaxVariables][kCorrelationConstantMaxVariables] = {{0}};
+	double		innovationCovariance[kCorrelationConstantMaxVariables][kCorrelationConstantMaxVariables];
+	double		shrinkage;
+
+	if ((numberOfVariables == 0) || (numberOfVariables > kCorrelationConstantMaxVariables) || (traceLength < 3))
+	{
+		fprintf(stderr, "Error: Correlated sampling needs 1 to %d traces of at least 3 samples.\n", kCorrelationConstantMaxVariables);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	*sampler = (CorrelatedSampler) {
+		.correlation		= correlation,
+		.numberOfVariables	= numberOfVariables,
+		.pathLength		= traceLength,
+	};
+
+	for (size_t i = 0; i < numberOfVariables; i++)
+	{
+		double	sumOfSquares = 0.0;
+
+		scores[i] = (double *) checkedMalloc(traceLength * sizeof(double), __FILE__, __LINE__);
+		calculateNormalScores(traces[i], traceLength, scores[i]);
+
+		/*
+		 *	Mid-rank normal scores are symmetric about zero, so they have zero mean.
+		 */
+		for (size_t t = 0; t < traceLength; t++)
+		{
+			sumOfSquares += scores[i][t] * scores[i][t];
+		}
+		standardDeviations[i] = sqrt(sumOfSquares / traceLength);
+	}
+
+	/*
+	 *	Correlations at lags 0 and 1. A constant trace has no scores to correlate, so it stays
+	 *	independent of the others.
+	 */
+	for (size_t i = 0; i < numberOfVariables; i++)
+	{
+		for (size_t j = 0; j < numberOfVariables; j++)
+		{
+			double	sum = 0.0;
+			double	lagSum = 0.0;
+
+			if ((standardDeviations[i] == 0.0) || (standardDeviations[j] == 0.0))
+			{
+				sampler->correlationMatrix[i][j] = (i == j) ? 1.0 : 0.0;
+
+				continue;
+			}
+
+			for (size_t t = 0; t < traceLength; t++)
+			{
+				sum += scores[i][t] * scores[j][t];
+			}
+
+			for (size_t t = 1; t < traceLength; t++)
+			{
+				lagSum += scores[i][t] * scores[j][t - 1];
+			}
+
+			sampler->correlationMatrix[i][j] = (i == j) ? 1.0 : (sum / traceLength / (standardDeviations[i] * standardDeviations[j]));
+			lagCorrelation[i][j] = lagSum / (traceLength - 1) / (standardDeviations[i] * standardDeviations[j]);
+		}
+	}
+
+	for (size_t i = 0; i < numberOfVariables; i++)
+	{
+		free(scores[i]);
+	}
+
+	/*
+	 *	Shrink the off-diagonal correlations until the correlation matrix is positive definite.
+	 */
+	while (!choleskyFactorize(sampler->correlationMatrix, sampler->stationaryFactor, numberOfVariables))
+	{
+		for (size_t i = 0; i < numberOfVariables; i++)
+		{
+			for (size_t j = 0; j < numberOfVariables; j++)
+			{
+				sampler->correlationMatrix[i][j] *= (i == j) ? 1.0 : 0.9;
+			}
+		}
+	}
+
+	if (correlation != kInputCorrelationLagged)
+	{
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	/*
+	 *	Transition matrix `A = G1 * R^-1` of the autoregression `y_t = A * y_(t-1) + e_t` with lag-1
+	 *	correlation `G1` and stationary correlation `R`. Columns of `R^-1 * G1^T` come from forward
+	 *	and back substitution with the Cholesky factor of `R`.
+	 */
+	for (size_t column = 0; column < numberOfVariables; column++)
+	{
+		double	forward[kCorrelationConstantMaxVariables];
+
+		for (size_t i = 0; i < numberOfVariables; i++)
+		{
+			double	sum = lagCorrelation[column][i];
+
+			for (size_t k = 0; k < i; k++)
+			{
+				sum -= sampler->stationaryFactor[i][k] * forward[k];
+			}
+			forward[i] = sum / sampler->stationaryFactor[i][i];
+		}
+
+		for (size_t i = numberOfVariables; i-- > 0; )
+		{
+			double	sum = forward[i];
+
+			for (size_t k = i + 1; k < numberOfVariables; k++)
+			{
+				sum -= sampler->stationaryFactor[k][i] * inverseTimesLagTransposed[k][column];
+			}
+			inverseTimesLagTransposed[i][column] = sum / sampler->stationaryFactor[i][i];
+		}
+	}
+
+	/*
+	 *	Innovation covariance `Q = R - A * R * A^T = R - G1 * R^-1 * G1^T`, with the transition
+	 *	matrix shrunk until `Q` is positive definite.
+	 */
+	shrinkage = 1.0;
+	do
+	{
+		for (size_t i = 0; i < numberOfVariables; i++)
+		{
+			for (size_t j = 0; j < numberOfVariables; j++)
+			{
+				double	sum = 0.0;
+
+				sampler->transitionMatrix[i][j] = shrinkage * inverseTimesLagTransposed[j][i];
+				for (size_t k = 0; k < numberOfVariables; k++)
+				{
+					sum += lagCorrelation[i][k] * inverseTimesLagTransposed[k][j];
+				}
+				innovationCovariance[i][j] = sampler->correlationMatrix[i][j] - shrinkage * shrinkage * sum;
+			}
+		}
+
+		shrinkage *= 0.9;
+	} while (!choleskyFactorize(innovationCovariance, sampler->innovationFactor, numberOfVariables));
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Transform one point of a path.
+ *
+ *	@param	sampler		: Pointer to the correlated sampler.
+ *	@param	point		: The point, transformed in place.
+ *	@param	state		: The state of the path, updated in place.
+ *	@param	isPathStart	: Whether the point is the first of its path.
+ */
+static void
+correlatedSamplerStep(const CorrelatedSampler *  sampler, double *  point, double *  state, bool isPathStart)
+{
+	double	normals[kCorrelationConstantMaxVariables];
+	double	correlated[kCorrelationConstantMaxVariables];
+
+	for (size_t i = 0; i < sampler->numberOfVariables; i++)
+	{
+		normals[i] = samplingNormalQuantile(point[i]);
+	}
+
+	for (size_t i = 0; i < sampler->numberOfVariables; i++)
+	{
+		correlated[i] = 0.0;
+
+		for (size_t k = 0; k <= i; k++)
+		{
+			correlated[i] += (isPathStart ? sampler->stationaryFactor[i][k] : sampler->innovationFactor[i][k]) * normals[k];
+		}
+
+		if (!isPathStart)
+		{
+			for (size_t k = 0; k < sampler->numberOfVariables; k++)
+			{
+				correlated[i] += sampler->transitionMatrix[i][k] * state[k];
+			}
+		}
+	}
+
+	for (size_t i = 0; i < sampler->numberOfVariables; i++)
+	{
+		state[i] = correlated[i];
+		point[i] = samplingNormalCdf(correlated[i]);
+	}
+
+	return;
+}
+
+void
+correlatedSamplerTransformPoint(
+	const CorrelatedSampler *	sampler,
+	const Sampler *			pointSampler,
+	uint64_t			sampleIndex,
+	double *			point,
+	double *			state,
+	bool *				isStateValid)
+{
+	bool	isLagged = (sampler->correlation == kInputCorrelationLagged);
+	bool	isPathStart = !isLagged || ((sampleIndex % sampler->pathLength) == 0);
+
+	if (sampler->correlation == kInputCorrelationIndependent)
+	{
+		return;
+	}
+
+	/*
+	 *	Regenerate the path up to the previous point.
+	 */
+	if (!isPathStart && !*isStateValid)
+	{
+		double		pathPoint[kSamplingConstantMaxDimensions];
+		uint64_t	pathStart = sampleIndex - (sampleIndex % sampler->pathLength);
+
+		for (uint64_t i = pathStart; i < sampleIndex; i++)
+		{
+			samplerGetPoint(pointSampler, i, pathPoint);
+			correlatedSamplerStep(sampler, pathPoint, state, i == pathStart);
+		}
+	}
+
+	correlatedSamplerStep(sampler, point, state, isPathStart);
+	*isStateValid = true;
+
+	return;
+}
@@ -0,0 +1,124 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "sampling.h"
+
+typedef enum
+{
+	kCorrelationConstantMaxVariables	= 4,
+} CorrelationConstant;
+
+typedef enum
+{
+	kInputCorrelationIndependent		= 0,
+	kInputCorrelationCross,
+	kInputCorrelationLagged,
+	kInputCorrelationMax
+} InputCorrelation;
+
+/*
+ *	Gaussian copula over the first `numberOfVariables` coordinates of the points of a sampler.
+ *	The coordinates map to standard normal variates, get correlated with Cholesky factors
+ *	estimated once from aligned traces, and map back to uniform variates. With lagged
+ *	correlation, consecutive points along paths of `pathLength` points additionally follow the
+ *	first-order vector autoregression of the traces.
+ */
+typedef struct CorrelatedSampler
+{
+	InputCorrelation	correlation;
+	size_t			numberOfVariables;
+	size_t			pathLength;
+	/*
+	 *	Correlation matrix of the normal scores of the traces and its lower Cholesky factor.
+	 */
+	double			correlationMatrix[kCorrelationConstantMaxVariables][kCorrelationConstantMaxVariables];
+	double			stationaryFactor[kCorrelationConstantMaxVariables][kCorrelationConstantMaxVariables];
+	/*
+	 *	Transition matrix of the autoregression and the lower Cholesky factor of the covariance
+	 *	of its innovations.
+	 */
+	double			transitionMatrix[kCorrelationConstantMaxVariables][kCorrelationConstantMaxVariables];
+	double			innovationFactor[kCorrelationConstantMaxVariables][kCorrelationConstantMaxVariables];
+} CorrelatedSampler;
+
+/**
+ *	@brief	Parse an input correlation name.
+ *
+ *	@param	name		: One of "independent", "cross", or "lagged".
+ *	@param	correlation	: Pointer to store the parsed input correlation.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	inputCorrelationFromString(const char *  name, InputCorrelation *  correlation);
+
+/**
+ *	@brief	Get the name of an input correlation.
+ *
+ *	@param	correlation	: The input correlation.
+ *	@return			: Name of the input correlation.
+ */
+const char *			inputCorrelationToString(InputCorrelation correlation);
+
+/**
+ *	@brief	Estimate a correlated sampler from aligned traces (entry `t` of every trace is from
+ *		the same time). Estimates that are not positive definite are shrunk until they are.
+ *
+ *	@param	sampler			: Pointer to the correlated sampler to initialize.
+ *	@param	correlation		: The input correlation to model.
+ *	@param	traces			: The traces, one per variable.
+ *	@param	traceLength		: Number of entries in every trace, which is also the path length.
+ *	@param	numberOfVariables	: Number of traces, at most `kCorrelationConstantMaxVariables`.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	correlatedSamplerInit(
+					CorrelatedSampler *	sampler,
+					InputCorrelation	correlation,
+					const float * const *	traces,
+					size_t			traceLength,
+					size_t			numberOfVariables);
+
+/**
+ *	@brief	Replace the first coordinates of a point of `pointSampler` by correlated uniform variates.
+ *		With lagged correlation, `state` carries the path from one point to the next: when
+ *		`*isStateValid` is false and the point is not the first of its path, the path is
+ *		regenerated from its first point, so points can be transformed in any order.
+ *
+ *	@param	sampler		: Pointer to the correlated sampler.
+ *	@param	pointSampler	: Pointer to the sampler that produced the point.
+ *	@param	sampleIndex	: Index of the point.
+ *	@param	point		: The point, transformed in place.
+ *	@param	state		: Array of `kCorrelationConstantMaxVariables` entries holding the state of the path.
+ *	@param	isStateValid	: Pointer to whether `state` is that of point `sampleIndex - 1`; set to true on return.
+ */
+void				correlatedSamplerTransformPoint(
+					const CorrelatedSampler *	sampler,
+					const Sampler *			pointSampler,
+					uint64_t			sampleIndex,
+					double *			point,
+					double *			state,
+					bool *				isStateValid);
@@ -0,0 +1,132 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include "delta.h"
+
+CommonConstantReturnType
+runDeltaMethod(const ConversionModel *  model, DeltaMethodResult *  result)
+{
+	const size_t	n = kConversionModelConstantMaxInputs;
+	double		mean[kConversionModelConstantMaxInputs];
+	double		covariance[kConversionModelConstantMaxInputs * kConversionModelConstantMaxInputs];
+	double		factor[kConversionModelConstantMaxInputs * kConversionModelConstantMaxInputs];
+	double		jacobian[kOutputDistributionIndexMax * kConversionModelConstantMaxInputs];
+
+	*result = (DeltaMethodResult) {
+		.numberOfEvaluations	= 1,
+	};
+
+	conversionModelInputMoments(model, mean, covariance);
+	conversionModelEvaluateWithJacobian(mean, result->mean, jacobian);
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		for (size_t p = 0; p < kOutputDistributionIndexMax; p++)
+		{
+			double	sum = 0.0;
+
+			for (size_t i = 0; i < n; i++)
+			{
+				for (size_t j = 0; j < n; j++)
+				{
+					sum += jacobian[o * n + i] * covariance[i * n + j] * jacobian[p * n + j];
+				}
+			}
+
+			result->covariance[o][p] = sum;
+		}
+
+		if (!isfinite(result->mean[o]) || !isfinite(result->covariance[o][o]))
+		{
+			fprintf(stderr, "Error: The conversion routines are not finite at the mean of the inputs.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	/*
+	 *	For every column `l` of the factor, `f(mu + l) + f(mu - l) - 2 f(mu)` is `l^T H l` up to
+	 *	fourth-order terms, and these sum to `tr(H Sigma)`.
+	 */
+	conversionModelCovarianceFactor(covariance, factor);
+
+	for (size_t j = 0; j < n; j++)
+	{
+		double	plus[kConversionModelConstantMaxInputs];
+		double	minus[kConversionModelConstantMaxInputs];
+		double	outputsPlus[kOutputDistributionIndexMax];
+		double	outputsMinus[kOutputDistributionIndexMax];
+
+		if (factor[j * n + j] == 0.0)
+		{
+			continue;
+		}
+
+		for (size_t i = 0; i < n; i++)
+		{
+			plus[i] = mean[i] + factor[i * n + j];
+			minus[i] = mean[i] - factor[i * n + j];
+		}
+
+		conversionModelEvaluateWithJacobian(plus, outputsPlus, NULL);
+		conversionModelEvaluateWithJacobian(minus, outputsMinus, NULL);
+		result->numberOfEvaluations += 2;
+
+		for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+		{
+			result->meanCorrection[o] += 0.5 * (outputsPlus[o] + outputsMinus[o] - 2.0 * result->mean[o]);
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+printDeltaMethodResult(const DeltaMethodResult *  result, const char *  outputNames[kOutputDistributionIndexMax])
+{
+	printf("Delta-method propagation (%zu model evaluations):\n", result->numberOfEvaluations);
+	printf("%-16s %14s %14s %14s %14s\n", "Output", "Mean", "Variance", "Mean shift", "Nonlinearity");
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		double	standardDeviation = sqrt(result->covariance[o][o]);
+
+		/*
+		 *	The second-order shift of the mean in units of the linearized standard deviation.
+		 */
+		printf("%-16s %14.6lf %14.6le %14.6le %14.6lf\n",
+			outputNames[o],
+			result->mean[o],
+			result->covariance[o][o],
+			result->meanCorrection[o],
+			(standardDeviation > 0.0) ? fabs(result->meanCorrection[o]) / standardDeviation : 0.0);
+	}
+
+	printf("\n");
+	printConversionModelOutputCovariance(result->covariance, outputNames);
+
+	return;
+}
@@ -0,0 +1,63 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "model.h"
+
+/*
+ *	First-order (delta-method) propagation of the means and covariance of the inputs of a
+ *	conversion model through its Jacobian at the input means: the outputs have mean `f(mu)` and
+ *	covariance `J Sigma J^T`. As an indicator of the linearization error, the second-order
+ *	correction of the means, `tr(H Sigma) / 2` for the Hessian `H` of every output, comes from
+ *	central differences along the columns of a Cholesky factor of `Sigma`.
+ */
+typedef struct DeltaMethodResult
+{
+	size_t	numberOfEvaluations;
+	double	mean[kOutputDistributionIndexMax];
+	double	covariance[kOutputDistributionIndexMax][kOutputDistributionIndexMax];
+	double	meanCorrection[kOutputDistributionIndexMax];
+} DeltaMethodResult;
+
+/**
+ *	@brief	Propagate the moments of the inputs of a conversion model to all of its outputs.
+ *
+ *	@param	model	: Pointer to the conversion model.
+ *	@param	result	: Pointer to store the result.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runDeltaMethod(const ConversionModel *  model, DeltaMethodResult *  result);
+
+/**
+ *	@brief	Print the result of the delta method.
+ *
+ *	@param	result		: Pointer to the result.
+ *	@param	outputNames	: Names of the outputs.
+ */
+void				printDeltaMethodResult(const DeltaMethodResult *  result, const char *  outputNames[kOutputDistributionIndexMax]);
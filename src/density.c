@@ -0,0 +1,537 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "density.h"
+
+typedef struct TemperatureAtom
+{
+	double		value;
+	double		weight;
+} TemperatureAtom;
+
+/**
+ *	@brief	Comparison function for sorting atoms in ascending order of value with `qsort()`.
+ *
+ *	@param	a	: Pointer to the first atom.
+ *	@param	b	: Pointer to the second atom.
+ *	@return		: Negative, zero, or positive as the first value is smaller, equal, or larger.
+ */
+static int
+compareAtoms(const void *  a, const void *  b)
+{
+	double	x = ((const TemperatureAtom *) a)->value;
+	double	y = ((const TemperatureAtom *) b)->value;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ *	@brief	`calc_temperature()` in double precision. With `a = (x - 16 par_t1) / 16384`, it is
+ *		`(par_t2 a + par_t3 a^2 / 4) / 5120`.
+ *
+ *	@param	parameters	: The parameters `par_t1`, `par_t2`, and `par_t3`.
+ *	@param	input		: The temperature ADC input.
+ *	@return			: The temperature.
+ */
+static double
+componentTemperature(const double *  parameters, double input)
+{
+	double	a = (input - 16.0 * parameters[0]) / 16384.0;
+
+	return (parameters[1] * a + parameters[2] * a * a / 4.0) / 5120.0;
+}
+
+/**
+ *	@brief	Real roots, in ascending order, of the temperature ADC inputs at which one component
+ *		reaches a temperature.
+ *
+ *	@param	parameters	: The parameters `par_t1`, `par_t2`, and `par_t3`.
+ *	@param	temperature	: The temperature.
+ *	@param	roots		: Array of two entries to store the inputs.
+ *	@return			: Number of roots.
+ */
+static size_t
+componentInputs(const double *  parameters, double temperature, double *  roots)
+{
+	double	quadratic = parameters[2] / 4.0;
+	double	linear = parameters[1];
+	double	constant = -5120.0 * temperature;
+	size_t	numberOfRoots = 0;
+
+	if (quadratic == 0.0)
+	{
+		if (linear == 0.0)
+		{
+			return 0;
+		}
+
+		roots[numberOfRoots++] = -constant / linear;
+	}
+	else
+	{
+		double	discriminant = linear * linear - 4.0 * quadratic * constant;
+		double	q;
+
+		if (discriminant < 0.0)
+		{
+			return 0;
+		}
+
+		/*
+		 *	Avoids the cancellation of the textbook formula for the root near zero.
+		 */
+		q = -0.5 * (linear + copysign(sqrt(discriminant), linear));
+		roots[numberOfRoots++] = q / quadratic;
+		roots[numberOfRoots++] = (q != 0.0) ? constant / q : 0.0;
+
+		if (roots[0] > roots[1])
+		{
+			double	swap = roots[0];
+
+			roots[0] = roots[1];
+			roots[1] = swap;
+		}
+	}
+
+	for (size_t i = 0; i < numberOfRoots; i++)
+	{
+		roots[i] = 16.0 * parameters[0] + 16384.0 * roots[i];
+	}
+
+	return numberOfRoots;
+}
+
+/**
+ *	@brief	Probability that a uniform temperature ADC input lies in an interval.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@param	lowerBound	: Lower bound of the interval.
+ *	@param	upperBound	: Upper bound of the interval.
+ *	@return			: The probability.
+ */
+static double
+inputProbability(const TemperatureDistribution *  distribution, double lowerBound, double upperBound)
+{
+	double	lower = fmax(lowerBound, distribution->inputLowerBound);
+	double	upper = fmin(upperBound, distribution->inputUpperBound);
+
+	return (upper > lower) ? (upper - lower) / (distribution->inputUpperBound - distribution->inputLowerBound) : 0.0;
+}
+
+/**
+ *	@brief	Cumulative probability of the atoms of a discrete temperature distribution.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@param	temperature	: The temperature.
+ *	@param	isInclusive	: Include an atom at `temperature`.
+ *	@return			: The probability of the atoms below (or at) `temperature`.
+ */
+static double
+atomProbability(const TemperatureDistribution *  distribution, double temperature, bool isInclusive)
+{
+	size_t	lower = 0;
+	size_t	upper = distribution->numberOfAtoms;
+
+	/*
+	 *	Binary search for the number of atoms below (or at) the temperature.
+	 */
+	while (lower < upper)
+	{
+		size_t	middle = lower + (upper - lower) / 2;
+		double	value = distribution->atomValues[middle];
+
+		if ((value < temperature) || (isInclusive && (value == temperature)))
+		{
+			lower = middle + 1;
+		}
+		else
+		{
+			upper = middle;
+		}
+	}
+
+	return (lower > 0) ? distribution->atomCumulativeProbabilities[lower - 1] : 0.0;
+}
+
+void
+temperatureDistributionInit(TemperatureDistribution *  distribution, const ConversionModel *  model)
+{
+	const CalibrationTable *	table = model->calibrationTable;
+	const InputDistribution *	input = &model->inputDistributions[kInputDistributionIndexForTemperatureRawADCValue];
+	size_t				numberOfDevices = (table != NULL) ? table->numberOfDevices : 1;
+	size_t				numberOfComponents = numberOfDevices;
+
+	if ((table != NULL) && (model->arguments->calibrationSampling == kCalibrationSamplingIndependent))
+	{
+		numberOfComponents = numberOfDevices * numberOfDevices * numberOfDevices;
+	}
+
+	*distribution = (TemperatureDistribution) {
+		.numberOfComponents	= numberOfComponents,
+		.parameters		= (double *) checkedMalloc(numberOfComponents * kBME680ConstantsNumberOfTemperatureParameters * sizeof(double), __FILE__, __LINE__),
+		.isContinuous		= (input->kind == kInputDistributionKindUniform) && (input->upperBound > input->lowerBound),
+		.inputLowerBound	= input->lowerBound,
+		.inputUpperBound	= input->upperBound,
+		.lowerBound		= INFINITY,
+		.upperBound		= -INFINITY,
+	};
+
+	for (size_t c = 0; c < numberOfComponents; c++)
+	{
+		double *	parameters = &distribution->parameters[c * kBME680ConstantsNumberOfTemperatureParameters];
+		size_t		digits = c;
+
+		for (size_t i = 0; i < kBME680ConstantsNumberOfTemperatureParameters; i++)
+		{
+			/*
+			 *	Independent sampling takes the device of parameter `i` from digit `i` of
+			 *	the component index in base `numberOfDevices`.
+			 */
+			size_t	device = (numberOfComponents == numberOfDevices) ? c : (digits % numberOfDevices);
+
+			digits /= numberOfDevices;
+			parameters[i] = (table != NULL) ? table->rows[device * table->numberOfParameters + i] : model->temperatureParameters[i];
+		}
+	}
+
+	if (distribution->isContinuous)
+	{
+		for (size_t c = 0; c < numberOfComponents; c++)
+		{
+			const double *	parameters = &distribution->parameters[c * kBME680ConstantsNumberOfTemperatureParameters];
+			double		ends[3] = {distribution->inputLowerBound, distribution->inputUpperBound, distribution->inputLowerBound};
+
+			/*
+			 *	The vertex of the parabola, if it lies within the support of the input.
+			 */
+			if (parameters[2] != 0.0)
+			{
+				double	vertex = 16.0 * parameters[0] - 16384.0 * 2.0 * parameters[1] / parameters[2];
+
+				ends[2] = fmin(fmax(vertex, distribution->inputLowerBound), distribution->inputUpperBound);
+			}
+
+			for (size_t i = 0; i < 3; i++)
+			{
+				distribution->lowerBound = fmin(distribution->lowerBound, componentTemperature(parameters, ends[i]));
+				distribution->upperBound = fmax(distribution->upperBound, componentTemperature(parameters, ends[i]));
+			}
+		}
+
+		return;
+	}
+
+	/*
+	 *	Discrete distribution: one atom per outcome of the input and component, sorted and
+	 *	with equal values merged.
+	 */
+	size_t			numberOfOutcomes = (input->kind == kInputDistributionKindEmpirical) ? input->aliasTable.numberOfOutcomes : 1;
+	TemperatureAtom *	atoms = (TemperatureAtom *) checkedMalloc(numberOfComponents * numberOfOutcomes * sizeof(TemperatureAtom), __FILE__, __LINE__);
+	size_t			numberOfAtoms = 0;
+	double			cumulativeProbability = 0.0;
+
+	for (size_t c = 0; c < numberOfComponents; c++)
+	{
+		for (size_t i = 0; i < numberOfOutcomes; i++)
+		{
+			double	value = input->value;
+			double	probability = 1.0;
+
+			if (input->kind == kInputDistributionKindEmpirical)
+			{
+				value = input->aliasTable.values[i];
+				probability = input->aliasTable.cumulativeProbabilities[i] - ((i > 0) ? input->aliasTable.cumulativeProbabilities[i - 1] : 0.0);
+			}
+			else if (input->kind == kInputDistributionKindUniform)
+			{
+				value = input->lowerBound;
+			}
+
+			atoms[c * numberOfOutcomes + i] = (TemperatureAtom) {
+				.value	= componentTemperature(&distribution->parameters[c * kBME680ConstantsNumberOfTemperatureParameters], value),
+				.weight	= probability / numberOfComponents,
+			};
+		}
+	}
+
+	qsort(atoms, numberOfComponents * numberOfOutcomes, sizeof(TemperatureAtom), compareAtoms);
+	distribution->atomValues = (double *) checkedMalloc(numberOfComponents * numberOfOutcomes * sizeof(double), __FILE__, __LINE__);
+	distribution->atomCumulativeProbabilities = (double *) checkedMalloc(numberOfComponents * numberOfOutcomes * sizeof(double), __FILE__, __LINE__);
+
+	for (size_t i = 0; i < numberOfComponents * numberOfOutcomes; i++)
+	{
+		cumulativeProbability += atoms[i].weight;
+
+		if ((numberOfAtoms == 0) || (atoms[i].value != distribution->atomValues[numberOfAtoms - 1]))
+		{
+			distribution->atomValues[numberOfAtoms++] = atoms[i].value;
+		}
+
+		distribution->atomCumulativeProbabilities[numberOfAtoms - 1] = cumulativeProbability;
+	}
+
+	distribution->atomCumulativeProbabilities[numberOfAtoms - 1] = 1.0;
+	distribution->numberOfAtoms = numberOfAtoms;
+	distribution->lowerBound = distribution->atomValues[0];
+	distribution->upperBound = distribution->atomValues[numberOfAtoms - 1];
+	free(atoms);
+
+	return;
+}
+
+void
+temperatureDistributionFree(TemperatureDistribution *  distribution)
+{
+	free(distribution->parameters);
+	free(distribution->atomValues);
+	free(distribution->atomCumulativeProbabilities);
+	distribution->parameters = NULL;
+	distribution->atomValues = NULL;
+	distribution->atomCumulativeProbabilities = NULL;
+
+	return;
+}
+
+double
+temperatureDistributionCdf(const TemperatureDistribution *  distribution, double temperature)
+{
+	double	probability = 0.0;
+
+	if (!distribution->isContinuous)
+	{
+		return atomProbability(distribution, temperature, true);
+	}
+
+	for (size_t c = 0; c < distribution->numberOfComponents; c++)
+	{
+		const double *	parameters = &distribution->parameters[c * kBME680ConstantsNumberOfTemperatureParameters];
+		double		roots[2];
+		size_t		numberOfRoots = componentInputs(parameters, temperature, roots);
+
+		/*
+		 *	The inputs with a temperature of at most `temperature` lie between the roots of
+		 *	an upward parabola, outside those of a downward one, and on one side of the root
+		 *	of a line.
+		 */
+		if (numberOfRoots == 2)
+		{
+			double	between = inputProbability(distribution, roots[0], roots[1]);
+
+			probability += (parameters[2] > 0.0) ? between : (1.0 - between);
+		}
+		else if (numberOfRoots == 1)
+		{
+			probability += (parameters[1] > 0.0) ? inputProbability(distribution, -INFINITY, roots[0]) : inputProbability(distribution, roots[0], INFINITY);
+		}
+		else
+		{
+			probability += (componentTemperature(parameters, distribution->inputLowerBound) <= temperature) ? 1.0 : 0.0;
+		}
+	}
+
+	return probability / distribution->numberOfComponents;
+}
+
+double
+temperatureDistributionPdf(const TemperatureDistribution *  distribution, double temperature)
+{
+	double	density = 0.0;
+
+	if (!distribution->isContinuous)
+	{
+		return 0.0;
+	}
+
+	for (size_t c = 0; c < distribution->numberOfComponents; c++)
+	{
+		const double *	parameters = &distribution->parameters[c * kBME680ConstantsNumberOfTemperatureParameters];
+		double		roots[2];
+		size_t		numberOfRoots = componentInputs(parameters, temperature, roots);
+
+		/*
+		 *	Change of variables: the input density over the slope of the temperature.
+		 */
+		for (size_t i = 0; i < numberOfRoots; i++)
+		{
+			double	a = (roots[i] - 16.0 * parameters[0]) / 16384.0;
+			double	slope = fabs(parameters[1] + parameters[2] * a / 2.0) / (5120.0 * 16384.0);
+
+			if ((roots[i] >= distribution->inputLowerBound) && (roots[i] <= distribution->inputUpperBound) && (slope > 0.0))
+			{
+				density += 1.0 / ((distribution->inputUpperBound - distribution->inputLowerBound) * slope);
+			}
+		}
+	}
+
+	return density / distribution->numberOfComponents;
+}
+
+double
+temperatureDistributionQuantile(const TemperatureDistribution *  distribution, double probability)
+{
+	double	lower = distribution->lowerBound;
+	double	upper = distribution->upperBound;
+
+	if (!distribution->isContinuous)
+	{
+		size_t	lowerIndex = 0;
+		size_t	upperIndex = distribution->numberOfAtoms - 1;
+
+		while (lowerIndex < upperIndex)
+		{
+			size_t	middle = lowerIndex + (upperIndex - lowerIndex) / 2;
+
+			if (distribution->atomCumulativeProbabilities[middle] < probability)
+			{
+				lowerIndex = middle + 1;
+			}
+			else
+			{
+				upperIndex = middle;
+			}
+		}
+
+		return distribution->atomValues[lowerIndex];
+	}
+
+	/*
+	 *	Newton steps on the distribution function, which has no closed-form inverse for a
+	 *	mixture, kept inside a bisection bracket.
+	 */
+	double	temperature = 0.5 * (lower + upper);
+
+	for (int iteration = 0; iteration < 200; iteration++)
+	{
+		double	cumulativeProbability = temperatureDistributionCdf(distribution, temperature);
+		double	density = temperatureDistributionPdf(distribution, temperature);
+		double	next;
+
+		if (cumulativeProbability < probability)
+		{
+			lower = temperature;
+		}
+		else
+		{
+			upper = temperature;
+		}
+
+		next = (density > 0.0) ? (temperature - (cumulativeProbability - probability) / density) : lower;
+
+		if (!((next > lower) && (next < upper)))
+		{
+			next = 0.5 * (lower + upper);
+		}
+
+		if (fabs(next - temperature) <= 1e-13 * fabs(temperature))
+		{
+			return next;
+		}
+
+		temperature = next;
+	}
+
+	return temperature;
+}
+
+CommonConstantReturnType
+runTemperatureDensity(const ConversionModel *  model, const DensityGrid *  grid, size_t numberOfQuantiles)
+{
+	TemperatureDistribution	distribution;
+	clock_t			start = clock();
+	float *			quantiles = (float *) checkedMalloc(numberOfQuantiles * sizeof(float), __FILE__, __LINE__);
+
+	temperatureDistributionInit(&distribution, model);
+
+	double	lowerBound = grid->hasRange ? grid->lowerBound : distribution.lowerBound;
+	double	upperBound = grid->hasRange ? grid->upperBound : distribution.upperBound;
+	size_t	numberOfPoints = grid->numberOfPoints;
+
+	printf("Exact temperature distribution (%s, %zu calibration component%s, support [%lf, %lf]):\n",
+		distribution.isContinuous ? "continuous" : "discrete",
+		distribution.numberOfComponents,
+		(distribution.numberOfComponents == 1) ? "" : "s",
+		distribution.lowerBound,
+		distribution.upperBound);
+
+	if (grid->isHistogram)
+	{
+		double	width = (upperBound - lowerBound) / numberOfPoints;
+
+		printf("%14s %14s %14s %14s\n", "Lower", "Upper", "Probability", "Density");
+
+		for (size_t i = 0; i < numberOfPoints; i++)
+		{
+			double	lower = lowerBound + i * width;
+			double	upper = (i + 1 == numberOfPoints) ? upperBound : (lower + width);
+			/*
+			 *	The first bin also holds an atom at its lower edge.
+			 */
+			double	below = ((i == 0) && !distribution.isContinuous) ? atomProbability(&distribution, lower, false) : temperatureDistributionCdf(&distribution, lower);
+			double	probability = temperatureDistributionCdf(&distribution, upper) - below;
+
+			printf("%14.6lf %14.6lf %14.6le %14.6le\n", lower, upper, probability, (upper > lower) ? probability / (upper - lower) : 0.0);
+		}
+	}
+	else
+	{
+		double	spacing = (numberOfPoints > 1) ? (upperBound - lowerBound) / (numberOfPoints - 1) : 0.0;
+
+		printf("%14s %14s %14s\n", "Temperature", "PDF", "CDF");
+
+		for (size_t i = 0; i < numberOfPoints; i++)
+		{
+			double	temperature = lowerBound + i * spacing;
+			double	density = temperatureDistributionPdf(&distribution, temperature);
+
+			/*
+			 *	A discrete distribution has no density, so print the probability of the
+			 *	cell around the grid point over its width instead.
+			 */
+			if (!distribution.isContinuous && (spacing > 0.0))
+			{
+				density = (temperatureDistributionCdf(&distribution, temperature + 0.5 * spacing) -
+						atomProbability(&distribution, temperature - 0.5 * spacing, true)) / spacing;
+			}
+
+			printf("%14.6lf %14.6le %14.6le\n", temperature, density, temperatureDistributionCdf(&distribution, temperature));
+		}
+	}
+
+	for (size_t i = 0; i < numberOfQuantiles; i++)
+	{
+		quantiles[i] = (float) temperatureDistributionQuantile(&distribution, (i + 0.5) / numberOfQuantiles);
+	}
+
+	saveMonteCarloFloatDataToDataDotOutFile(quantiles, (uint64_t)(((double)(clock() - start)) / CLOCKS_PER_SEC * 1000000), numberOfQuantiles);
+	printf("\nWrote %zu exact quantiles of the temperature to data.out.\n", numberOfQuantiles);
+
+	temperatureDistributionFree(&distribution);
+	free(quantiles);
+
+	return kCommonConstantReturnTypeSuccess;
+}
@@ -0,0 +1,118 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "model.h"
+
+/*
+ *	Exact distribution of the temperature output. `calc_temperature()` is a quadratic
+ *	polynomial of the temperature ADC input for every set of temperature calibration parameters,
+ *	so the distribution follows from the distribution of the input by a change of variables: a
+ *	uniform input gives a continuous distribution, and an empirical (or constant) input a
+ *	discrete one. Calibration parameters drawn from the calibration table make it a mixture
+ *	over the devices (joint) or over all combinations of the parameters of the devices
+ *	(independent).
+ */
+typedef struct TemperatureDistribution
+{
+	/*
+	 *	Temperature calibration parameters `par_t1`, `par_t2`, and `par_t3` of each equally
+	 *	likely component of the mixture.
+	 */
+	size_t		numberOfComponents;
+	double *	parameters;
+	/*
+	 *	Support of a uniform temperature ADC input.
+	 */
+	bool		isContinuous;
+	double		inputLowerBound;
+	double		inputUpperBound;
+	/*
+	 *	Values and cumulative probabilities of a discrete distribution, in ascending order.
+	 */
+	size_t		numberOfAtoms;
+	double *	atomValues;
+	double *	atomCumulativeProbabilities;
+	double		lowerBound;
+	double		upperBound;
+} TemperatureDistribution;
+
+/**
+ *	@brief	Derive the exact distribution of the temperature output of a conversion model.
+ *
+ *	@param	distribution	: Pointer to the distribution to initialize.
+ *	@param	model		: Pointer to the conversion model.
+ */
+void				temperatureDistributionInit(TemperatureDistribution *  distribution, const ConversionModel *  model);
+
+/**
+ *	@brief	Free the memory held by a temperature distribution.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ */
+void				temperatureDistributionFree(TemperatureDistribution *  distribution);
+
+/**
+ *	@brief	Cumulative distribution function of the temperature.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@param	temperature	: The temperature.
+ *	@return			: Probability that the temperature is at most `temperature`.
+ */
+double				temperatureDistributionCdf(const TemperatureDistribution *  distribution, double temperature);
+
+/**
+ *	@brief	Probability density function of a continuous temperature distribution.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@param	temperature	: The temperature.
+ *	@return			: The density, or zero for a discrete distribution.
+ */
+double				temperatureDistributionPdf(const TemperatureDistribution *  distribution, double temperature);
+
+/**
+ *	@brief	Quantile of the temperature.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@param	probability	: Probability in (0, 1).
+ *	@return			: The smallest temperature whose cumulative probability is at least `probability`.
+ */
+double				temperatureDistributionQuantile(const TemperatureDistribution *  distribution, double probability);
+
+/**
+ *	@brief	Print the exact density and distribution function of the temperature on a grid, or
+ *		its histogram, and write `numberOfQuantiles` quantiles at the probabilities
+ *		`(i + 1/2) / numberOfQuantiles` to "data.out" as a noise-free reference sample.
+ *
+ *	@param	model			: Pointer to the conversion model.
+ *	@param	grid			: Pointer to the grid.
+ *	@param	numberOfQuantiles	: Number of quantiles to write.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runTemperatureDensity(const ConversionModel *  model, const DensityGrid *  grid, size_t numberOfQuantiles);
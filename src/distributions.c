@@ -0,0 +1,203 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "distributions.h"
+
+void
+inputDistributionInitConstant(InputDistribution *  distribution, float value)
+{
+	*distribution = (InputDistribution) {
+		.kind	= kInputDistributionKindConstant,
+		.value	= value,
+	};
+
+	return;
+}
+
+void
+inputDistributionInitUniform(InputDistribution *  distribution, double lowerBound, double upperBound)
+{
+	*distribution = (InputDistribution) {
+		.kind		= kInputDistributionKindUniform,
+		.value		= (float)(0.5 * (lowerBound + upperBound)),
+		.lowerBound	= lowerBound,
+		.upperBound	= upperBound,
+	};
+
+	return;
+}
+
+CommonConstantReturnType
+inputDistributionInitEmpirical(InputDistribution *  distribution, const float *  samples, size_t numberOfSamples)
+{
+	*distribution = (InputDistribution) {
+		.kind	= kInputDistributionKindEmpirical,
+	};
+
+	if (aliasTableInitFromSamples(&distribution->aliasTable, samples, numberOfSamples) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	distribution->value = (float) distribution->aliasTable.mean;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+inputDistributionInitDiscrete(InputDistribution *  distribution, const float *  values, const double *  weights, size_t numberOfOutcomes)
+{
+	*distribution = (InputDistribution) {
+		.kind	= kInputDistributionKindEmpirical,
+	};
+
+	if (aliasTableInit(&distribution->aliasTable, values, weights, numberOfOutcomes) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	distribution->value = (float) distribution->aliasTable.mean;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+inputDistributionFree(InputDistribution *  distribution)
+{
+	if (distribution->kind == kInputDistributionKindEmpirical)
+	{
+		aliasTableFree(&distribution->aliasTable);
+	}
+
+	return;
+}
+
+void
+inputDistributionFromUniformBatch(const InputDistribution *  distribution, const double *  uniforms, float *  values, size_t numberOfDraws)
+{
+	switch (distribution->kind)
+	{
+		case kInputDistributionKindUniform:
+		{
+			const double	lowerBound = distribution->lowerBound;
+			const double	width = distribution->upperBound - distribution->lowerBound;
+
+			#pragma omp simd
+			for (size_t i = 0; i < numberOfDraws; i++)
+			{
+				values[i] = (float)(lowerBound + uniforms[i] * width);
+			}
+
+			break;
+		}
+
+		case kInputDistributionKindEmpirical:
+		{
+			aliasTableDrawBatch(&distribution->aliasTable, uniforms, values, numberOfDraws);
+
+			break;
+		}
+
+		default:
+		{
+			for (size_t i = 0; i < numberOfDraws; i++)
+			{
+				values[i] = distribution->value;
+			}
+
+			break;
+		}
+	}
+
+	return;
+}
+
+void
+inputDistributionQuantileBatch(const InputDistribution *  distribution, const double *  probabilities, float *  values, size_t numberOfValues)
+{
+	if (distribution->kind != kInputDistributionKindEmpirical)
+	{
+		inputDistributionFromUniformBatch(distribution, probabilities, values, numberOfValues);
+
+		return;
+	}
+
+	for (size_t i = 0; i < numberOfValues; i++)
+	{
+		values[i] = aliasTableQuantile(&distribution->aliasTable, probabilities[i]);
+	}
+
+	return;
+}
+
+double
+inputDistributionMean(const InputDistribution *  distribution)
+{
+	switch (distribution->kind)
+	{
+		case kInputDistributionKindUniform:
+		{
+			return 0.5 * (distribution->lowerBound + distribution->upperBound);
+		}
+
+		case kInputDistributionKindEmpirical:
+		{
+			return distribution->aliasTable.mean;
+		}
+
+		default:
+		{
+			return distribution->value;
+		}
+	}
+}
+
+double
+inputDistributionVariance(const InputDistribution *  distribution)
+{
+	switch (distribution->kind)
+	{
+		case kInputDistributionKindUniform:
+		{
+			double	width = distribution->upperBound - distribution->lowerBound;
+
+			return width * width / 12.0;
+		}
+
+		case kInputDistributionKindEmpirical:
+		{
+			/*
+			 *	Population variance: the samples are the distribution.
+			 */
+			return distribution->aliasTable.variance;
+		}
+
+		default:
+		{
+			return 0.0;
+		}
+	}
+}
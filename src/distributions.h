@@ -0,0 +1,195 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "aliastable.h"
+
+typedef enum
+{
+	kInputDistributionKindConstant		= 0,
+	kInputDistributionKindUniform,
+	kInputDistributionKindEmpirical,
+	kInputDistributionKindMax
+} InputDistributionKind;
+
+/*
+ *	Preloaded distribution of one input of the native Monte Carlo mode. Drawing from it maps a
+ *	uniform variate to the input in constant time. Constant and uniform distributions invert
+ *	their cumulative distribution function; empirical (and weighted discrete) distributions draw
+ *	from an alias table, whose columns are in ascending order of value, so stratification of the
+ *	uniform variates carries over to the alias-table columns.
+ */
+typedef struct InputDistribution
+{
+	InputDistributionKind	kind;
+	/*
+	 *	Value of a constant distribution.
+	 */
+	float			value;
+	/*
+	 *	Support of a uniform distribution.
+	 */
+	double			lowerBound;
+	double			upperBound;
+	/*
+	 *	Alias table of an empirical distribution.
+	 */
+	AliasTable		aliasTable;
+} InputDistribution;
+
+/**
+ *	@brief	Initialize a constant input distribution.
+ *
+ *	@param	distribution	: Pointer to the distribution to initialize.
+ *	@param	value		: The constant value.
+ */
+void				inputDistributionInitConstant(InputDistribution *  distribution, float value);
+
+/**
+ *	@brief	Initialize a uniform input distribution.
+ *
+ *	@param	distribution	: Pointer to the distribution to initialize.
+ *	@param	lowerBound	: Lower bound of the support.
+ *	@param	upperBound	: Upper bound of the support.
+ */
+void				inputDistributionInitUniform(InputDistribution *  distribution, double lowerBound, double upperBound);
+
+/**
+ *	@brief	Initialize an empirical input distribution from samples. Repeated sample values are
+ *		merged into a single weighted outcome of the distribution's alias table.
+ *
+ *	@param	distribution	: Pointer to the distribution to initialize.
+ *	@param	samples		: The samples.
+ *	@param	numberOfSamples	: Number of entries in `samples`.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	inputDistributionInitEmpirical(InputDistribution *  distribution, const float *  samples, size_t numberOfSamples);
+
+/**
+ *	@brief	Initialize a weighted discrete input distribution.
+ *
+ *	@param	distribution		: Pointer to the distribution to initialize.
+ *	@param	values			: The values.
+ *	@param	weights			: Non-negative weights of the values, with a positive sum.
+ *	@param	numberOfOutcomes	: Number of entries in `values` and `weights`.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	inputDistributionInitDiscrete(InputDistribution *  distribution, const float *  values, const double *  weights, size_t numberOfOutcomes);
+
+/**
+ *	@brief	Free the memory held by an input distribution.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ */
+void				inputDistributionFree(InputDistribution *  distribution);
+
+/**
+ *	@brief	Draw from an input distribution.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@param	u		: Uniform variate in (0, 1).
+ *	@return			: The drawn value.
+ */
+static inline float
+inputDistributionFromUniform(const InputDistribution *  distribution, double u)
+{
+	switch (distribution->kind)
+	{
+		case kInputDistributionKindUniform:
+		{
+			return (float)(distribution->lowerBound + u * (distribution->upperBound - distribution->lowerBound));
+		}
+
+		case kInputDistributionKindEmpirical:
+		{
+			return aliasTableDraw(&distribution->aliasTable, u);
+		}
+
+		default:
+		{
+			return distribution->value;
+		}
+	}
+}
+
+/**
+ *	@brief	Quantile (inverse cumulative distribution function) of an input distribution. Unlike
+ *		`inputDistributionFromUniform()`, this is monotone in `u` for every kind of distribution,
+ *		so dependence between uniform variates carries over to the inputs.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@param	u		: Probability in (0, 1).
+ *	@return			: The quantile.
+ */
+static inline float
+inputDistributionQuantile(const InputDistribution *  distribution, double u)
+{
+	if (distribution->kind == kInputDistributionKindEmpirical)
+	{
+		return aliasTableQuantile(&distribution->aliasTable, u);
+	}
+
+	return inputDistributionFromUniform(distribution, u);
+}
+
+/**
+ *	@brief	Quantiles of a batch of probabilities for an input distribution.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@param	probabilities	: Probabilities in (0, 1).
+ *	@param	values		: Array to store the quantiles.
+ *	@param	numberOfValues	: Number of probabilities.
+ */
+void				inputDistributionQuantileBatch(const InputDistribution *  distribution, const double *  probabilities, float *  values, size_t numberOfValues);
+
+/**
+ *	@brief	Draw a batch of values from an input distribution. The kind of the distribution is
+ *		resolved once per batch, so the inner loops vectorize.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@param	uniforms	: Uniform variates in (0, 1), one per draw.
+ *	@param	values		: Array to store the drawn values.
+ *	@param	numberOfDraws	: Number of draws.
+ */
+void				inputDistributionFromUniformBatch(const InputDistribution *  distribution, const double *  uniforms, float *  values, size_t numberOfDraws);
+
+/**
+ *	@brief	Mean of an input distribution.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@return			: The mean.
+ */
+double				inputDistributionMean(const InputDistribution *  distribution);
+
+/**
+ *	@brief	Variance of an input distribution.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@return			: The variance.
+ */
+double				inputDistributionVariance(const InputDistribution *  distribution);
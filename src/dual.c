@@ -0,0 +1,185 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <stdio.h>
+#include "dual.h"
+
+Dual
+dualConstant(double value)
+{
+	return (Dual) {.value = value};
+}
+
+Dual
+dualVariable(double value, size_t index)
+{
+	Dual	variable = {.value = value};
+
+	variable.gradient[index] = 1.0;
+
+	return variable;
+}
+
+Dual
+dualAdd(Dual a, Dual b)
+{
+	Dual	sum = {.value = a.value + b.value};
+
+	for (size_t i = 0; i < kConversionModelConstantMaxInputs; i++)
+	{
+		sum.gradient[i] = a.gradient[i] + b.gradient[i];
+	}
+
+	return sum;
+}
+
+Dual
+dualSubtract(Dual a, Dual b)
+{
+	Dual	difference = {.value = a.value - b.value};
+
+	for (size_t i = 0; i < kConversionModelConstantMaxInputs; i++)
+	{
+		difference.gradient[i] = a.gradient[i] - b.gradient[i];
+	}
+
+	return difference;
+}
+
+Dual
+dualMultiply(Dual a, Dual b)
+{
+	Dual	product = {.value = a.value * b.value};
+
+	for (size_t i = 0; i < kConversionModelConstantMaxInputs; i++)
+	{
+		product.gradient[i] = a.gradient[i] * b.value + a.value * b.gradient[i];
+	}
+
+	return product;
+}
+
+Dual
+dualDivide(Dual a, Dual b)
+{
+	Dual	quotient = {.value = a.value / b.value};
+
+	for (size_t i = 0; i < kConversionModelConstantMaxInputs; i++)
+	{
+		quotient.gradient[i] = (a.gradient[i] - quotient.value * b.gradient[i]) / b.value;
+	}
+
+	return quotient;
+}
+
+Dual
+dualScale(Dual a, double factor)
+{
+	Dual	scaled = {.value = factor * a.value};
+
+	for (size_t i = 0; i < kConversionModelConstantMaxInputs; i++)
+	{
+		scaled.gradient[i] = factor * a.gradient[i];
+	}
+
+	return scaled;
+}
+
+void
+dualConversionRoutines(const Dual *  inputs, Dual *  outputs)
+{
+	const Dual *	t = &inputs[kInputDistributionIndexMax];
+	const Dual *	p = &t[kBME680ConstantsNumberOfTemperatureParameters];
+	const Dual *	h = &p[kBME680ConstantsNumberOfPressureParameters];
+
+	/*
+	 *	Temperature, as `calc_temperature()`.
+	 */
+	Dual	a = dualSubtract(dualScale(inputs[kInputDistributionIndexForTemperatureRawADCValue], 1.0 / 16384.0), dualScale(t[0], 1.0 / 1024.0));
+	Dual	b = dualSubtract(dualScale(inputs[kInputDistributionIndexForTemperatureRawADCValue], 1.0 / 131072.0), dualScale(t[0], 1.0 / 8192.0));
+	Dual	temperature = dualScale(dualAdd(dualMultiply(a, t[1]), dualScale(dualMultiply(dualMultiply(b, b), t[2]), 16.0)), 1.0 / 5120.0);
+
+	/*
+	 *	Pressure, as `calc_pressure()` on `t_fine = 5120 * temperature`, in kPa.
+	 */
+	Dual	v1 = dualSubtract(dualScale(temperature, 2560.0), dualConstant(64000.0));
+	Dual	v1Squared = dualMultiply(v1, v1);
+	Dual	v2 = dualAdd(
+			dualScale(dualAdd(dualScale(dualMultiply(v1Squared, p[5]), 1.0 / 131072.0), dualScale(dualMultiply(v1, p[4]), 2.0)), 1.0 / 4.0),
+			dualScale(p[3], 65536.0));
+	Dual	u = dualScale(dualAdd(dualScale(dualMultiply(p[2], v1Squared), 1.0 / 16384.0), dualMultiply(p[1], v1)), 1.0 / 524288.0);
+	Dual	q = dualMultiply(dualAdd(dualConstant(1.0), dualScale(u, 1.0 / 32768.0)), p[0]);
+	Dual	pressure = dualConstant(0.0);
+
+	if ((int)q.value != 0)
+	{
+		Dual	c = dualDivide(
+				dualScale(
+					dualSubtract(
+						dualSubtract(dualConstant(1048576.0), inputs[kInputDistributionIndexForPressureRawADCValue]),
+						dualScale(v2, 1.0 / 4096.0)),
+					6250.0),
+				q);
+		Dual	c256 = dualScale(c, 1.0 / 256.0);
+		Dual	correction = dualAdd(
+					dualAdd(
+						dualScale(dualMultiply(p[8], dualMultiply(c, c)), 1.0 / 2147483648.0),
+						dualScale(dualMultiply(c, p[7]), 1.0 / 32768.0)),
+					dualAdd(
+						dualScale(dualMultiply(dualMultiply(dualMultiply(c256, c256), c256), p[9]), 1.0 / 131072.0),
+						dualScale(p[6], 128.0)));
+
+		pressure = dualScale(dualAdd(c, dualScale(correction, 1.0 / 16.0)), 1.0 / 1000.0);
+	}
+
+	/*
+	 *	Humidity, as `calc_humidity()`.
+	 */
+	Dual	v1Humidity = dualSubtract(
+				inputs[kInputDistributionIndexForHumidityRawADCValue],
+				dualAdd(dualScale(h[0], 16.0), dualMultiply(dualScale(h[2], 1.0 / 2.0), temperature)));
+	Dual	g = dualAdd(
+			dualConstant(1.0),
+			dualAdd(
+				dualMultiply(dualScale(h[3], 1.0 / 16384.0), temperature),
+				dualMultiply(dualScale(h[4], 1.0 / 1048576.0), dualMultiply(temperature, temperature))));
+	Dual	v2Humidity = dualMultiply(v1Humidity, dualMultiply(dualScale(h[1], 1.0 / 262144.0), g));
+	Dual	k = dualAdd(dualScale(h[5], 1.0 / 16384.0), dualMultiply(dualScale(h[6], 1.0 / 2097152.0), temperature));
+	Dual	humidity = dualAdd(v2Humidity, dualMultiply(k, dualMultiply(v2Humidity, v2Humidity)));
+
+	if (humidity.value <= 0.0)
+	{
+		humidity = dualConstant(0.0);
+	}
+	else if (humidity.value >= 100.0)
+	{
+		humidity = dualConstant(100.0);
+	}
+
+	outputs[kOutputDistributionIndexForTemperature] = temperature;
+	outputs[kOutputDistributionIndexForPressure] = pressure;
+	outputs[kOutputDistributionIndexForHumidity] = humidity;
+
+	return;
+}
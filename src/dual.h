@@ -0,0 +1,117 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "model.h"
+
+/*
+ *	Dual number for forward-mode automatic differentiation: a value and its partial derivatives
+ *	with respect to all raw ADC inputs and calibration parameters of the conversion routines.
+ *	Every operation applies the rules of differentiation to the gradients of its operands, so a
+ *	single evaluation of the conversion routines on dual numbers yields their exact Jacobian.
+ */
+typedef struct Dual
+{
+	double		value;
+	double		gradient[kConversionModelConstantMaxInputs];
+} Dual;
+
+/**
+ *	@brief	Dual number of a constant.
+ *
+ *	@param	value	: The constant.
+ *	@return		: The dual number with a zero gradient.
+ */
+Dual		dualConstant(double value);
+
+/**
+ *	@brief	Dual number of an independent variable.
+ *
+ *	@param	value	: Value of the variable.
+ *	@param	index	: Index of the variable in the gradient.
+ *	@return		: The dual number whose gradient is the unit vector of `index`.
+ */
+Dual		dualVariable(double value, size_t index);
+
+/**
+ *	@brief	Sum of two dual numbers.
+ *
+ *	@param	a	: The first operand.
+ *	@param	b	: The second operand.
+ *	@return		: a + b.
+ */
+Dual		dualAdd(Dual a, Dual b);
+
+/**
+ *	@brief	Difference of two dual numbers.
+ *
+ *	@param	a	: The first operand.
+ *	@param	b	: The second operand.
+ *	@return		: a - b.
+ */
+Dual		dualSubtract(Dual a, Dual b);
+
+/**
+ *	@brief	Product of two dual numbers.
+ *
+ *	@param	a	: The first operand.
+ *	@param	b	: The second operand.
+ *	@return		: a * b.
+ */
+Dual		dualMultiply(Dual a, Dual b);
+
+/**
+ *	@brief	Quotient of two dual numbers.
+ *
+ *	@param	a	: The dividend.
+ *	@param	b	: The nonzero divisor.
+ *	@return		: a / b.
+ */
+Dual		dualDivide(Dual a, Dual b);
+
+/**
+ *	@brief	Product of a dual number and a constant.
+ *
+ *	@param	a	: The dual number.
+ *	@param	factor	: The constant.
+ *	@return		: factor * a.
+ */
+Dual		dualScale(Dual a, double factor);
+
+/**
+ *	@brief	Evaluate the BME680 conversion routines on dual numbers of the raw ADC inputs and
+ *		calibration parameters. The formulas are those of the floating-point
+ *		`calc_temperature()`, `calc_pressure()` (in kPa), and `calc_humidity()`. Where
+ *		pressure is undefined it is zero, and where humidity is clamped it is constant.
+ *
+ *	@param	inputs	: Array of `kConversionModelConstantMaxInputs` dual numbers of the inputs.
+ *	@param	outputs	: Array of `kOutputDistributionIndexMax` entries to store the outputs.
+ */
+void		dualConversionRoutines(const Dual *  inputs, Dual *  outputs);
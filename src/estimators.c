@@ -0,0 +1,630 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "estimators.h"
+
+/*
+ *	Two-sided 95% quantile of the standard normal distribution.
+ */
+static const double	kEstimatorsNormalQuantile95 = 1.959963984540054;
+
+/*
+ *	Symbols of the comparisons of output events. Two-character symbols come first, so that
+ *	parsing matches "<=" before "<".
+ */
+static const char *	kOutputEventComparisonNames[kOutputEventComparisonMax] =
+			{
+				"<",
+				"<=",
+				">",
+				">=",
+			};
+static const OutputEventComparison	kOutputEventComparisonParseOrder[kOutputEventComparisonMax] =
+					{
+						kOutputEventComparisonLessOrEqual,
+						kOutputEventComparisonGreaterOrEqual,
+						kOutputEventComparisonLess,
+						kOutputEventComparisonGreater,
+					};
+
+/**
+ *	@brief	Value of a unit of the estimator: a single sample, or the mean of an antithetic pair.
+ *
+ *	@param	samples		: The samples.
+ *	@param	unitIndex	: Index of the unit.
+ *	@param	isAntithetic	: Whether consecutive samples form antithetic pairs.
+ *	@return			: Value of the unit.
+ */
+static inline double
+unitValue(const float *  samples, size_t unitIndex, bool isAntithetic)
+{
+	if (isAntithetic)
+	{
+		return 0.5 * ((double) samples[2 * unitIndex] + (double) samples[2 * unitIndex + 1]);
+	}
+
+	return samples[unitIndex];
+}
+
+/**
+ *	@brief	Select the `k`-th smallest entry of `values` (Hoare's selection). Reorders `values`
+ *		so that entry `k` is in its sorted position, with no larger entries before it and
+ *		no smaller entries after it.
+ *
+ *	@param	values		: The values.
+ *	@param	numberOfValues	: Number of entries in `values`.
+ *	@param	k		: Zero-based rank to select.
+ *	@return			: The `k`-th smallest entry.
+ */
+static float
+selectKthSmallest(float *  values, size_t numberOfValues, size_t k)
+{
+	ptrdiff_t	left = 0;
+	ptrdiff_t	right = (ptrdiff_t) numberOfValues - 1;
+	ptrdiff_t	rank = (ptrdiff_t) k;
+
+	while (left < right)
+	{
+		float		pivot = values[left + (right - left) / 2];
+		ptrdiff_t	i = left;
+		ptrdiff_t	j = right;
+
+		while (i <= j)
+		{
+			while (values[i] < pivot)
+			{
+				i++;
+			}
+			while (values[j] > pivot)
+			{
+				j--;
+			}
+			if (i <= j)
+			{
+				float	swap = values[i];
+
+				values[i] = values[j];
+				values[j] = swap;
+				i++;
+				j--;
+			}
+		}
+
+		if (rank <= j)
+		{
+			right = j;
+		}
+		else if (rank >= i)
+		{
+			left = i;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	return values[k];
+}
+
+CommonConstantReturnType
+outputEventFromString(const char *  string, OutputEvent *  event)
+{
+	for (size_t i = 0; i < kOutputEventComparisonMax; i++)
+	{
+		OutputEventComparison	comparison = kOutputEventComparisonParseOrder[i];
+		size_t			length = strlen(kOutputEventComparisonNames[comparison]);
+		float			threshold;
+
+		if (strncmp(string, kOutputEventComparisonNames[comparison], length) != 0)
+		{
+			continue;
+		}
+
+		if ((parseFloatChecked(&string[length], &threshold) != kCommonConstantReturnTypeSuccess) || !isfinite(threshold))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		*event = (OutputEvent) {
+			.comparison	= comparison,
+			.threshold	= threshold,
+		};
+
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	return kCommonConstantReturnTypeError;
+}
+
+const char *
+outputEventComparisonToString(const OutputEvent *  event)
+{
+	return (event->comparison < kOutputEventComparisonMax) ? kOutputEventComparisonNames[event->comparison] : "?";
+}
+
+double
+calculateTemperatureMean(
+	double		meanOfRawADCValue,
+	double		varianceOfRawADCValue,
+	const float *	temperatureParameters)
+{
+	double	parT1 = temperatureParameters[0];
+	double	parT2 = temperatureParameters[1];
+	double	parT3 = temperatureParameters[2];
+
+	/*
+	 *	Mirrors `calc_temperature()`: `var1` is linear and `var2` is the square of a linear
+	 *	function of the raw ADC value, so E[var2] = Var(x) / 131072^2 + (E[x] / 131072 - par_t1 / 8192)^2.
+	 *	The kernel evaluates in single precision, so the Monte Carlo mean differs from this
+	 *	value by the kernel's rounding error only.
+	 */
+	double	meanOfVar1 = ((meanOfRawADCValue / 16384.0) - (parT1 / 1024.0)) * parT2;
+	double	meanOfLinearTerm = (meanOfRawADCValue / 131072.0) - (parT1 / 8192.0);
+	double	meanOfSquare = (varianceOfRawADCValue / (131072.0 * 131072.0)) + (meanOfLinearTerm * meanOfLinearTerm);
+	double	meanOfVar2 = meanOfSquare * (parT3 * 16.0);
+
+	return (meanOfVar1 + meanOfVar2) / 5120.0;
+}
+
+MonteCarloEstimate
+estimateMonteCarloMean(
+	const float *	samples,
+	const float *	controlSamples,
+	double		controlMean,
+	size_t		numberOfSamples,
+	bool		isAntithetic)
+{
+	MonteCarloEstimate	estimate = {0};
+	size_t			numberOfUnits = isAntithetic ? (numberOfSamples / 2) : numberOfSamples;
+	double			sumOfSamples = 0.0;
+	double			sumOfUnits = 0.0;
+	double			sumOfControlUnits = 0.0;
+	double			sumOfSquaredSampleDeviations = 0.0;
+	double			sumOfSquaredUnitDeviations = 0.0;
+	double			sumOfSquaredControlDeviations = 0.0;
+	double			sumOfCrossDeviations = 0.0;
+	double			sampleMean;
+	double			unitMean;
+	double			controlUnitMean = 0.0;
+	double			unitVariance;
+	double			residualVariance;
+
+	if (numberOfUnits < 2)
+	{
+		fprintf(stderr, "Warning: Too few Monte Carlo samples to estimate the standard error.\n");
+		estimate.mean = (numberOfSamples > 0) ? samples[0] : NAN;
+		estimate.standardError = NAN;
+		estimate.sampleVariance = NAN;
+		estimate.effectiveSampleSize = numberOfSamples;
+
+		return estimate;
+	}
+
+	/*
+	 *	First pass: means.
+	 */
+	#pragma omp parallel for schedule(static) proc_bind(spread) reduction(+: sumOfSamples)
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		sumOfSamples += samples[i];
+	}
+
+	#pragma omp parallel for schedule(static) proc_bind(spread) reduction(+: sumOfUnits, sumOfControlUnits)
+	for (size_t i = 0; i < numberOfUnits; i++)
+	{
+		sumOfUnits += unitValue(samples, i, isAntithetic);
+
+		if (controlSamples != NULL)
+		{
+			sumOfControlUnits += unitValue(controlSamples, i, isAntithetic);
+		}
+	}
+
+	sampleMean = sumOfSamples / numberOfSamples;
+	unitMean = sumOfUnits / numberOfUnits;
+	if (controlSamples != NULL)
+	{
+		controlUnitMean = sumOfControlUnits / numberOfUnits;
+	}
+
+	/*
+	 *	Second pass: (co)variances about the means.
+	 */
+	#pragma omp parallel for schedule(static) proc_bind(spread) reduction(+: sumOfSquaredSampleDeviations)
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		double	deviation = samples[i] - sampleMean;
+
+		sumOfSquaredSampleDeviations += deviation * deviation;
+	}
+
+	#pragma omp parallel for schedule(static) proc_bind(spread) reduction(+: sumOfSquaredUnitDeviations, sumOfSquaredControlDeviations, sumOfCrossDeviations)
+	for (size_t i = 0; i < numberOfUnits; i++)
+	{
+		double	deviation = unitValue(samples, i, isAntithetic) - unitMean;
+
+		sumOfSquaredUnitDeviations += deviation * deviation;
+
+		if (controlSamples != NULL)
+		{
+			double	controlDeviation = unitValue(controlSamples, i, isAntithetic) - controlUnitMean;
+
+			sumOfSquaredControlDeviations += controlDeviation * controlDeviation;
+			sumOfCrossDeviations += deviation * controlDeviation;
+		}
+	}
+
+	estimate.sampleVariance = sumOfSquaredSampleDeviations / (numberOfSamples - 1);
+	unitVariance = sumOfSquaredUnitDeviations / (numberOfUnits - 1);
+	estimate.mean = unitMean;
+	residualVariance = unitVariance;
+
+	/*
+	 *	Control variate: subtract the regression of the output on the control variate. The
+	 *	variance left is the part of the output variance the control variate does not explain.
+	 */
+	if ((controlSamples != NULL) && (sumOfSquaredControlDeviations > 0.0))
+	{
+		double	beta = sumOfCrossDeviations / sumOfSquaredControlDeviations;
+
+		estimate.mean = unitMean - beta * (controlUnitMean - controlMean);
+		residualVariance = (sumOfSquaredUnitDeviations - beta * sumOfCrossDeviations) / (numberOfUnits - 1);
+		residualVariance = (residualVariance > 0.0) ? residualVariance : 0.0;
+	}
+
+	estimate.standardError = sqrt(residualVariance / numberOfUnits);
+	estimate.effectiveSampleSize = (residualVariance > 0.0)
+					? (estimate.sampleVariance * numberOfUnits / residualVariance)
+					: INFINITY;
+
+	return estimate;
+}
+
+/**
+ *	@brief	Merge the moments of new samples into the running statistics.
+ *
+ *	@param	statistics		: Pointer to the running statistics to update.
+ *	@param	samples			: The new samples.
+ *	@param	numberOfSamples		: Number of new samples.
+ */
+static void
+mergeSampleMoments(MonteCarloRunningStatistics *  statistics, const float *  samples, size_t numberOfSamples)
+{
+	double	na = (double) statistics->numberOfSamples;
+	double	nb = (double) numberOfSamples;
+	double	n = na + nb;
+	double	sum = 0.0;
+	double	mean;
+	double	secondCentralSum = 0.0;
+	double	thirdCentralSum = 0.0;
+	double	fourthCentralSum = 0.0;
+	double	delta;
+
+	if (numberOfSamples == 0)
+	{
+		return;
+	}
+
+	#pragma omp parallel for schedule(static) proc_bind(spread) reduction(+: sum)
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		sum += samples[i];
+	}
+	mean = sum / nb;
+
+	#pragma omp parallel for schedule(static) proc_bind(spread) reduction(+: secondCentralSum, thirdCentralSum, fourthCentralSum)
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		double	deviation = samples[i] - mean;
+		double	squaredDeviation = deviation * deviation;
+
+		secondCentralSum += squaredDeviation;
+		thirdCentralSum += squaredDeviation * deviation;
+		fourthCentralSum += squaredDeviation * squaredDeviation;
+	}
+
+	delta = mean - statistics->mean;
+	statistics->fourthCentralSum += fourthCentralSum
+					+ delta * delta * delta * delta * na * nb * (na * na - na * nb + nb * nb) / (n * n * n)
+					+ 6.0 * delta * delta * (na * na * secondCentralSum + nb * nb * statistics->secondCentralSum) / (n * n)
+					+ 4.0 * delta * (na * thirdCentralSum - nb * statistics->thirdCentralSum) / n;
+	statistics->thirdCentralSum += thirdCentralSum
+					+ delta * delta * delta * na * nb * (na - nb) / (n * n)
+					+ 3.0 * delta * (na * secondCentralSum - nb * statistics->secondCentralSum) / n;
+	statistics->secondCentralSum += secondCentralSum + delta * delta * na * nb / n;
+	statistics->mean += delta * nb / n;
+	statistics->numberOfSamples += numberOfSamples;
+}
+
+/**
+ *	@brief	Merge the (co)variances of new units into the running statistics.
+ *
+ *	@param	statistics		: Pointer to the running statistics to update.
+ *	@param	samples			: The samples of the new units.
+ *	@param	controlSamples		: The samples of the control variate of the new units, or `NULL`.
+ *	@param	numberOfUnits		: Number of new units.
+ *	@param	isAntithetic		: Whether consecutive samples form antithetic pairs.
+ */
+static void
+mergeUnits(
+	MonteCarloRunningStatistics *	statistics,
+	const float *			samples,
+	const float *			controlSamples,
+	size_t				numberOfUnits,
+	bool				isAntithetic)
+{
+	double	na = (double) statistics->numberOfUnits;
+	double	nb = (double) numberOfUnits;
+	double	n = na + nb;
+	double	sumOfUnits = 0.0;
+	double	sumOfControlUnits = 0.0;
+	double	unitMean;
+	double	controlUnitMean;
+	double	unitSquareSum = 0.0;
+	double	controlSquareSum = 0.0;
+	double	crossSum = 0.0;
+	double	delta;
+	double	controlDelta;
+
+	if (numberOfUnits == 0)
+	{
+		return;
+	}
+
+	#pragma omp parallel for schedule(static) proc_bind(spread) reduction(+: sumOfUnits, sumOfControlUnits)
+	for (size_t i = 0; i < numberOfUnits; i++)
+	{
+		sumOfUnits += unitValue(samples, i, isAntithetic);
+
+		if (controlSamples != NULL)
+		{
+			sumOfControlUnits += unitValue(controlSamples, i, isAntithetic);
+		}
+	}
+	unitMean = sumOfUnits / nb;
+	controlUnitMean = sumOfControlUnits / nb;
+
+	#pragma omp parallel for schedule(static) proc_bind(spread) reduction(+: unitSquareSum, controlSquareSum, crossSum)
+	for (size_t i = 0; i < numberOfUnits; i++)
+	{
+		double	deviation = unitValue(samples, i, isAntithetic) - unitMean;
+
+		unitSquareSum += deviation * deviation;
+
+		if (controlSamples != NULL)
+		{
+			double	controlDeviation = unitValue(controlSamples, i, isAntithetic) - controlUnitMean;
+
+			controlSquareSum += controlDeviation * controlDeviation;
+			crossSum += deviation * controlDeviation;
+		}
+	}
+
+	delta = unitMean - statistics->unitMean;
+	controlDelta = controlUnitMean - statistics->controlUnitMean;
+	statistics->unitSquareSum += unitSquareSum + delta * delta * na * nb / n;
+	statistics->controlSquareSum += controlSquareSum + controlDelta * controlDelta * na * nb / n;
+	statistics->crossSum += crossSum + delta * controlDelta * na * nb / n;
+	statistics->unitMean += delta * nb / n;
+	statistics->controlUnitMean += controlDelta * nb / n;
+	statistics->numberOfUnits += numberOfUnits;
+}
+
+void
+monteCarloRunningStatisticsAdd(
+	MonteCarloRunningStatistics *	statistics,
+	const float *			samples,
+	const float *			controlSamples,
+	size_t				numberOfSamples,
+	bool				isAntithetic)
+{
+	size_t	firstPairedSample = 0;
+
+	mergeSampleMoments(statistics, samples, numberOfSamples);
+
+	if (!isAntithetic)
+	{
+		mergeUnits(statistics, samples, controlSamples, numberOfSamples, false);
+
+		return;
+	}
+
+	/*
+	 *	The pair of the last sample of the earlier batches is the first sample of this one.
+	 */
+	if (statistics->hasUnpairedSample && (numberOfSamples > 0))
+	{
+		float	pair[2] = {statistics->unpairedSample, samples[0]};
+		float	controlPair[2] = {statistics->unpairedControlSample, (controlSamples != NULL) ? controlSamples[0] : 0.0f};
+
+		mergeUnits(statistics, pair, (controlSamples != NULL) ? controlPair : NULL, 1, true);
+		statistics->hasUnpairedSample = false;
+		firstPairedSample = 1;
+	}
+
+	mergeUnits(
+		statistics,
+		&samples[firstPairedSample],
+		(controlSamples != NULL) ? &controlSamples[firstPairedSample] : NULL,
+		(numberOfSamples - firstPairedSample) / 2,
+		true);
+
+	if (((numberOfSamples - firstPairedSample) % 2) != 0)
+	{
+		statistics->hasUnpairedSample = true;
+		statistics->unpairedSample = samples[numberOfSamples - 1];
+		statistics->unpairedControlSample = (controlSamples != NULL) ? controlSamples[numberOfSamples - 1] : 0.0f;
+	}
+}
+
+MonteCarloEstimate
+monteCarloRunningStatisticsEstimate(const MonteCarloRunningStatistics *  statistics, double controlMean)
+{
+	MonteCarloEstimate	estimate = {0};
+	double			numberOfUnits = (double) statistics->numberOfUnits;
+	double			residualVariance;
+
+	if (statistics->numberOfUnits < 2)
+	{
+		fprintf(stderr, "Warning: Too few Monte Carlo samples to estimate the standard error.\n");
+		estimate.mean = (statistics->numberOfSamples > 0) ? statistics->mean : NAN;
+		estimate.standardError = NAN;
+		estimate.sampleVariance = NAN;
+		estimate.effectiveSampleSize = statistics->numberOfSamples;
+
+		return estimate;
+	}
+
+	estimate.sampleVariance = statistics->secondCentralSum / (statistics->numberOfSamples - 1);
+	estimate.mean = statistics->unitMean;
+	residualVariance = statistics->unitSquareSum / (numberOfUnits - 1.0);
+
+	/*
+	 *	Only statistics with control-variate samples have a spread of them.
+	 */
+	if (statistics->controlSquareSum > 0.0)
+	{
+		double	beta = statistics->crossSum / statistics->controlSquareSum;
+
+		estimate.mean = statistics->unitMean - beta * (statistics->controlUnitMean - controlMean);
+		residualVariance = (statistics->unitSquareSum - beta * statistics->crossSum) / (numberOfUnits - 1.0);
+		residualVariance = (residualVariance > 0.0) ? residualVariance : 0.0;
+	}
+
+	estimate.standardError = sqrt(residualVariance / numberOfUnits);
+	estimate.effectiveSampleSize = (residualVariance > 0.0)
+					? (estimate.sampleVariance * numberOfUnits / residualVariance)
+					: INFINITY;
+
+	return estimate;
+}
+
+bool
+hasMonteCarloConverged(
+	const AdaptiveStoppingCriterion *	criterion,
+	MonteCarloRunningStatistics *		statistics,
+	const float *				samples,
+	const SampleCodeHistogram *		histogram,
+	float *					scratch,
+	double *				largestHalfWidth)
+{
+	size_t	numberOfSamples = statistics->numberOfSamples;
+	double	halfWidth;
+
+	*largestHalfWidth = 0.0;
+
+	if (numberOfSamples < 2)
+	{
+		*largestHalfWidth = INFINITY;
+
+		return false;
+	}
+
+	if (criterion->checkMean)
+	{
+		if (statistics->numberOfUnits < 2)
+		{
+			*largestHalfWidth = INFINITY;
+
+			return false;
+		}
+
+		halfWidth = kEstimatorsNormalQuantile95 * monteCarloRunningStatisticsEstimate(statistics, 0.0).standardError;
+		*largestHalfWidth = fmax(*largestHalfWidth, halfWidth);
+	}
+
+	if (criterion->checkVariance)
+	{
+		double	secondCentralMoment = statistics->secondCentralSum / numberOfSamples;
+		double	fourthCentralMoment = statistics->fourthCentralSum / numberOfSamples;
+
+		/*
+		 *	Asymptotically, Var(s^2) = (mu_4 - sigma^4) / n.
+		 */
+		halfWidth = kEstimatorsNormalQuantile95 * sqrt(fmax(fourthCentralMoment - secondCentralMoment * secondCentralMoment, 0.0) / numberOfSamples);
+		*largestHalfWidth = fmax(*largestHalfWidth, halfWidth);
+	}
+
+	if ((criterion->numberOfQuantiles > 0) && (numberOfSamples >= statistics->nextQuantileCheck))
+	{
+		statistics->quantileHalfWidth = 0.0;
+		statistics->nextQuantileCheck = numberOfSamples + (numberOfSamples + 3) / 4;
+
+		if (samples != NULL)
+		{
+			memcpy(scratch, samples, numberOfSamples * sizeof(float));
+		}
+
+		for (size_t q = 0; q < criterion->numberOfQuantiles; q++)
+		{
+			/*
+			 *	Distribution-free confidence interval of the quantile from the order statistics
+			 *	whose ranks lie `z * sqrt(n p (1 - p))` below and above `n p`.
+			 */
+			double	p = criterion->quantileLevels[q];
+			double	rankSpread = kEstimatorsNormalQuantile95 * sqrt(numberOfSamples * p * (1.0 - p));
+			double	lowerRank = floor(numberOfSamples * p - rankSpread);
+			double	upperRank = ceil(numberOfSamples * p + rankSpread);
+			float	lower;
+			float	upper;
+			float	unused;
+
+			if ((lowerRank < 0.0) || (upperRank > (double)(numberOfSamples - 1)))
+			{
+				statistics->quantileHalfWidth = INFINITY;
+
+				break;
+			}
+
+			if (samples != NULL)
+			{
+				lower = selectKthSmallest(scratch, numberOfSamples, (size_t) lowerRank);
+				upper = selectKthSmallest(scratch, numberOfSamples, (size_t) upperRank);
+			}
+			else
+			{
+				/*
+				 *	The codes only place each order statistic within the range of
+				 *	values of its code, so the interval spans the whole range.
+				 */
+				sampleCodeHistogramSelect(histogram, (size_t) lowerRank, &lower, &unused);
+				sampleCodeHistogramSelect(histogram, (size_t) upperRank, &unused, &upper);
+			}
+
+			halfWidth = 0.5 * ((double) upper - (double) lower);
+			statistics->quantileHalfWidth = fmax(statistics->quantileHalfWidth, halfWidth);
+		}
+	}
+
+	if (criterion->numberOfQuantiles > 0)
+	{
+		*largestHalfWidth = fmax(*largestHalfWidth, statistics->quantileHalfWidth);
+	}
+
+	return (*largestHalfWidth <= criterion->tolerance);
+}
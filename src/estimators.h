@@ -0,0 +1,270 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "precision.h"
+
+typedef enum
+{
+	kEstimatorsConstantMaxQuantiles		= 16,
+} EstimatorsConstant;
+
+typedef enum
+{
+	kOutputEventComparisonLess		= 0,
+	kOutputEventComparisonLessOrEqual,
+	kOutputEventComparisonGreater,
+	kOutputEventComparisonGreaterOrEqual,
+	kOutputEventComparisonMax
+} OutputEventComparison;
+
+/*
+ *	Event that the selected output compares to a threshold, e.g., `humidity >= 100`.
+ */
+typedef struct OutputEvent
+{
+	OutputEventComparison	comparison;
+	double			threshold;
+} OutputEvent;
+
+/*
+ *	Statistics whose 95% confidence intervals must be narrower than a tolerance for an adaptive
+ *	Monte Carlo run to stop.
+ */
+typedef struct AdaptiveStoppingCriterion
+{
+	/*
+	 *	Largest allowed half-width of the 95% confidence interval of each statistic.
+	 */
+	double	tolerance;
+	bool	checkMean;
+	bool	checkVariance;
+	size_t	numberOfQuantiles;
+	double	quantileLevels[kEstimatorsConstantMaxQuantiles];
+} AdaptiveStoppingCriterion;
+
+typedef struct MonteCarloEstimate
+{
+	/*
+	 *	Estimate of the mean of the output.
+	 */
+	double	mean;
+	/*
+	 *	Standard error of `mean`.
+	 */
+	double	standardError;
+	/*
+	 *	Sample variance of the individual output samples.
+	 */
+	double	sampleVariance;
+	/*
+	 *	Number of independent plain Monte Carlo samples that would give the same standard error.
+	 */
+	double	effectiveSampleSize;
+} MonteCarloEstimate;
+
+/*
+ *	Running statistics of the samples of a native Monte Carlo run. Every batch of new samples
+ *	merges into them in time proportional to the batch rather than to all samples so far, for
+ *	the convergence checks of adaptive Monte Carlo and for runs that store the samples as
+ *	16-bit codes. Zero-initialize before adding the first samples.
+ */
+typedef struct MonteCarloRunningStatistics
+{
+	/*
+	 *	Number of samples, their mean, and the sums of their second, third, and fourth powers
+	 *	of deviations from it.
+	 */
+	size_t	numberOfSamples;
+	double	mean;
+	double	secondCentralSum;
+	double	thirdCentralSum;
+	double	fourthCentralSum;
+	/*
+	 *	Number of units (samples, or antithetic pairs), the means of the units of the output and
+	 *	of the control variate, the sums of their squared deviations, and of the products of
+	 *	their deviations.
+	 */
+	size_t	numberOfUnits;
+	double	unitMean;
+	double	controlUnitMean;
+	double	unitSquareSum;
+	double	controlSquareSum;
+	double	crossSum;
+	/*
+	 *	Last sample (and control-variate sample) of antithetic samples of odd number, which
+	 *	forms a unit with the first sample of the next batch.
+	 */
+	bool	hasUnpairedSample;
+	float	unpairedSample;
+	float	unpairedControlSample;
+	/*
+	 *	Largest half-width of the confidence intervals of the quantiles at their last check, and
+	 *	the number of samples at which to check them next.
+	 */
+	double	quantileHalfWidth;
+	size_t	nextQuantileCheck;
+} MonteCarloRunningStatistics;
+
+/**
+ *	@brief	Parse an output event.
+ *
+ *	@param	string	: A comparison ("<", "<=", ">", or ">=") immediately followed by the threshold, e.g., ">=100".
+ *	@param	event	: Pointer to store the parsed event.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	outputEventFromString(const char *  string, OutputEvent *  event);
+
+/**
+ *	@brief	Get the symbol of the comparison of an output event.
+ *
+ *	@param	event	: Pointer to the event.
+ *	@return		: One of "<", "<=", ">", or ">=".
+ */
+const char *			outputEventComparisonToString(const OutputEvent *  event);
+
+/**
+ *	@brief	Check whether an output value lies in an output event.
+ *
+ *	@param	event	: Pointer to the event.
+ *	@param	output	: The output value.
+ *	@return		: `true` if the output satisfies the comparison of the event.
+ */
+static inline bool
+outputEventOccurs(const OutputEvent *  event, double output)
+{
+	switch (event->comparison)
+	{
+		case kOutputEventComparisonLess:
+		{
+			return output < event->threshold;
+		}
+
+		case kOutputEventComparisonLessOrEqual:
+		{
+			return output <= event->threshold;
+		}
+
+		case kOutputEventComparisonGreater:
+		{
+			return output > event->threshold;
+		}
+
+		default:
+		{
+			return output >= event->threshold;
+		}
+	}
+}
+
+/**
+ *	@brief	Mean of `calc_temperature()` over a raw ADC input with the given mean and variance.
+ *		The temperature is a quadratic of the raw ADC value, so its mean only depends on the
+ *		first two moments of the input.
+ *
+ *	@param	meanOfRawADCValue	: Mean of the raw temperature ADC value.
+ *	@param	varianceOfRawADCValue	: Variance of the raw temperature ADC value.
+ *	@param	temperatureParameters	: The temperature calibration parameters.
+ *	@return				: Mean of the calibrated temperature.
+ */
+double			calculateTemperatureMean(
+				double		meanOfRawADCValue,
+				double		varianceOfRawADCValue,
+				const float *	temperatureParameters);
+
+/**
+ *	@brief	Estimate the mean of Monte Carlo output samples, optionally using antithetic pairs
+ *		and a control variate with known mean.
+ *
+ *	@param	samples			: The output samples.
+ *	@param	controlSamples		: Samples of the control variate, or `NULL` to not use a control variate.
+ *	@param	controlMean		: Known mean of the control variate.
+ *	@param	numberOfSamples		: Number of entries in `samples` (and `controlSamples`).
+ *	@param	isAntithetic		: Whether consecutive samples form antithetic pairs.
+ *	@return				: The estimate with its standard error and effective sample size. The
+ *					  standard error treats units (samples, or antithetic pairs) as independent,
+ *					  so it is conservative for Latin hypercube and stratified samples.
+ */
+MonteCarloEstimate	estimateMonteCarloMean(
+				const float *	samples,
+				const float *	controlSamples,
+				double		controlMean,
+				size_t		numberOfSamples,
+				bool		isAntithetic);
+
+/**
+ *	@brief	Merge the next samples of a run into its running statistics, with the pairwise update
+ *		formulas of Chan et al. and Pébay.
+ *
+ *	@param	statistics		: Pointer to the running statistics of the samples before them.
+ *	@param	samples			: The new output samples.
+ *	@param	controlSamples		: The new samples of the control variate, or `NULL` to not use a control variate.
+ *	@param	numberOfSamples		: Number of entries in `samples` (and `controlSamples`).
+ *	@param	isAntithetic		: Whether consecutive samples of the run form antithetic pairs.
+ */
+void			monteCarloRunningStatisticsAdd(
+				MonteCarloRunningStatistics *	statistics,
+				const float *			samples,
+				const float *			controlSamples,
+				size_t				numberOfSamples,
+				bool				isAntithetic);
+
+/**
+ *	@brief	Estimate the mean of the samples of running statistics as `estimateMonteCarloMean()`.
+ *
+ *	@param	statistics		: Pointer to the running statistics.
+ *	@param	controlMean		: Known mean of the control variate, if the statistics include its samples.
+ *	@return				: The estimate with its standard error and effective sample size.
+ */
+MonteCarloEstimate	monteCarloRunningStatisticsEstimate(const MonteCarloRunningStatistics *  statistics, double controlMean);
+
+/**
+ *	@brief	Check whether the 95% confidence intervals of the statistics in `criterion` are
+ *		narrower than its tolerance. The confidence interval of the mean uses the same
+ *		estimator as `estimateMonteCarloMean()`, that of the variance the asymptotic
+ *		variance of the sample variance, and those of the quantiles order statistics.
+ *		Selecting the order statistics from the samples takes time proportional to all of
+ *		them, so the quantiles are only checked again once the number of samples has grown
+ *		by a quarter, and their last half-widths stand in between.
+ *
+ *	@param	criterion		: Pointer to the stopping criterion.
+ *	@param	statistics		: Pointer to the running statistics of all samples so far.
+ *	@param	samples			: All output samples so far, or `NULL` if `histogram` holds their codes.
+ *	@param	histogram		: Histogram of the codes of all output samples so far, if `samples` is `NULL`.
+ *	@param	scratch			: Array of at least as many entries as samples, used for quantile selection
+ *					  from `samples`.
+ *	@param	largestHalfWidth	: Pointer to store the largest confidence-interval half-width found.
+ *	@return				: `true` if all confidence intervals are narrower than the tolerance.
+ */
+bool			hasMonteCarloConverged(
+				const AdaptiveStoppingCriterion *	criterion,
+				MonteCarloRunningStatistics *		statistics,
+				const float *				samples,
+				const SampleCodeHistogram *		histogram,
+				float *					scratch,
+				double *				largestHalfWidth);
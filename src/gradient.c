@@ -0,0 +1,162 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include "gradient.h"
+#include "sampling.h"
+
+CommonConstantReturnType
+runGradientAnalysis(const ConversionModel *  model, size_t numberOfSamples, GradientAnalysisResult *  result)
+{
+	const size_t	n = kConversionModelConstantMaxInputs;
+	size_t		output = model->arguments->common.outputSelect;
+	Sampler		sampler;
+	double		inputMean[kConversionModelConstantMaxInputs];
+	double		inputCovariance[kConversionModelConstantMaxInputs * kConversionModelConstantMaxInputs];
+	double		shift = 0.0;
+	double		sum = 0.0;
+	double		sumOfSquares = 0.0;
+	size_t		numberOfBlocks = (numberOfSamples + kGradientConstantBlockSize - 1) / kGradientConstantBlockSize;
+	size_t		blockStride = 2 + 2 * kConversionModelConstantMaxInputs;
+	double *	blockSums;
+	double		samplePoint[kConversionModelConstantMaxInputs];
+	double		inputs[kConversionModelConstantMaxInputs];
+	double		outputs[kOutputDistributionIndexMax];
+
+	if (numberOfSamples < 2)
+	{
+		fprintf(stderr, "Error: Gradient analysis needs at least 2 samples.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (samplerInit(&sampler, model->arguments->samplingMethod, model->arguments->randomSeed, numberOfSamples, conversionModelNumberOfInputs(model)) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	*result = (GradientAnalysisResult) {.numberOfSamples = numberOfSamples};
+
+	/*
+	 *	Accumulate the output about its first sample, to keep the variance accurate.
+	 */
+	samplerGetPoint(&sampler, 0, samplePoint);
+	conversionModelInputValues(model, samplePoint, inputs);
+	conversionModelEvaluateWithJacobian(inputs, outputs, NULL);
+	shift = outputs[output];
+
+	/*
+	 *	Per block: the sums of the shifted output and its square, and of every derivative and
+	 *	its square, summed in block order so the result does not depend on the number of threads.
+	 */
+	blockSums = (double *) checkedMalloc(numberOfBlocks * blockStride * sizeof(double), __FILE__, __LINE__);
+
+	#pragma omp parallel for schedule(static) proc_bind(spread)
+	for (size_t block = 0; block < numberOfBlocks; block++)
+	{
+		size_t		blockEnd = (block + 1) * kGradientConstantBlockSize;
+		double *	sums = &blockSums[block * blockStride];
+
+		blockEnd = (blockEnd < numberOfSamples) ? blockEnd : numberOfSamples;
+
+		for (size_t k = 0; k < blockStride; k++)
+		{
+			sums[k] = 0.0;
+		}
+
+		for (size_t j = block * kGradientConstantBlockSize; j < blockEnd; j++)
+		{
+			double	blockSamplePoint[kConversionModelConstantMaxInputs];
+			double	blockInputs[kConversionModelConstantMaxInputs];
+			double	blockOutputs[kOutputDistributionIndexMax];
+			double	jacobian[kOutputDistributionIndexMax * kConversionModelConstantMaxInputs];
+
+			samplerGetPoint(&sampler, j, blockSamplePoint);
+			conversionModelInputValues(model, blockSamplePoint, blockInputs);
+			conversionModelEvaluateWithJacobian(blockInputs, blockOutputs, jacobian);
+
+			sums[0] += blockOutputs[output] - shift;
+			sums[1] += (blockOutputs[output] - shift) * (blockOutputs[output] - shift);
+
+			for (size_t i = 0; i < n; i++)
+			{
+				double	derivative = jacobian[output * n + i];
+
+				sums[2 + i] += derivative;
+				sums[2 + n + i] += derivative * derivative;
+			}
+		}
+	}
+
+	for (size_t block = 0; block < numberOfBlocks; block++)
+	{
+		const double *	sums = &blockSums[block * blockStride];
+
+		sum += sums[0];
+		sumOfSquares += sums[1];
+
+		for (size_t i = 0; i < n; i++)
+		{
+			result->meanDerivative[i] += sums[2 + i];
+			result->meanSquaredDerivative[i] += sums[2 + n + i];
+		}
+	}
+
+	free(blockSums);
+
+	result->mean = shift + sum / numberOfSamples;
+	result->variance = (sumOfSquares - sum * sum / numberOfSamples) / (numberOfSamples - 1);
+	conversionModelInputMoments(model, inputMean, inputCovariance);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		result->meanDerivative[i] /= numberOfSamples;
+		result->meanSquaredDerivative[i] /= numberOfSamples;
+		result->inputVariance[i] = inputCovariance[i * n + i];
+		result->scaledSensitivity[i] = (result->variance > 0.0) ? result->inputVariance[i] * result->meanSquaredDerivative[i] / result->variance : 0.0;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+printGradientAnalysisResult(const GradientAnalysisResult *  result, const char *  outputName)
+{
+	printf("Gradient of %s (%zu samples):\n", outputName, result->numberOfSamples);
+	printf("Mean: %lf, variance: %le\n\n", result->mean, result->variance);
+	printf("%-16s %15s %15s %15s %12s\n", "Input", "Mean d/dx", "RMS d/dx", "Input variance", "Scaled");
+
+	for (size_t i = 0; i < kConversionModelConstantMaxInputs; i++)
+	{
+		printf("%-16s %15.6le %15.6le %15.6le %12.6lf\n",
+			conversionModelVariableName(i),
+			result->meanDerivative[i],
+			sqrt(result->meanSquaredDerivative[i]),
+			result->inputVariance[i],
+			result->scaledSensitivity[i]);
+	}
+
+	return;
+}
@@ -0,0 +1,80 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "model.h"
+
+typedef enum
+{
+	/*
+	 *	Number of samples whose sums every thread accumulates together.
+	 */
+	kGradientConstantBlockSize	= 256,
+} GradientConstant;
+
+/*
+ *	Derivative-based sensitivities of the selected output of a conversion model: the exact
+ *	gradient of the output with respect to all raw ADC inputs and calibration parameters at
+ *	every sample, from one evaluation on dual numbers each, instead of finite differences.
+ */
+typedef struct GradientAnalysisResult
+{
+	size_t	numberOfSamples;
+	double	mean;
+	double	variance;
+	double	meanDerivative[kConversionModelConstantMaxInputs];
+	double	meanSquaredDerivative[kConversionModelConstantMaxInputs];
+	/*
+	 *	Variance of every input and parameter, and the share `Var(x_i) E[(df/dx_i)^2] / Var(f)`
+	 *	of the output variance, which for independent inputs equals the first-order Sobol index
+	 *	of a linear model and grows with the nonlinearity along the input.
+	 */
+	double	inputVariance[kConversionModelConstantMaxInputs];
+	double	scaledSensitivity[kConversionModelConstantMaxInputs];
+} GradientAnalysisResult;
+
+/**
+ *	@brief	Accumulate the gradients of the selected output of a conversion model over samples of
+ *		its inputs.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	numberOfSamples	: Number of samples.
+ *	@param	result		: Pointer to store the result.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runGradientAnalysis(const ConversionModel *  model, size_t numberOfSamples, GradientAnalysisResult *  result);
+
+/**
+ *	@brief	Print the result of a gradient analysis.
+ *
+ *	@param	result		: Pointer to the result.
+ *	@param	outputName	: Name of the selected output.
+ */
+void				printGradientAnalysisResult(const GradientAnalysisResult *  result, const char *  outputName);
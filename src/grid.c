@@ -0,0 +1,366 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "grid.h"
+#include "model.h"
+
+float
+responseGridAxisValue(const ResponseGridAxis *  axis, size_t index)
+{
+	if (axis->values != NULL)
+	{
+		return axis->values[index];
+	}
+
+	if (axis->numberOfValues == 1)
+	{
+		return axis->lowerBound;
+	}
+
+	return (float) (axis->lowerBound + ((double) axis->upperBound - axis->lowerBound) * index / (axis->numberOfValues - 1));
+}
+
+/**
+ *	@brief	Evaluate a block of consecutive grid points. The block steps through the grid like an
+ *		odometer from its first point, so that only the first point needs dividing out.
+ *
+ *	@param	arguments		: Pointer to command-line arguments struct that selects all outputs.
+ *	@param	grid			: Pointer to the grid.
+ *	@param	devices			: Device indices of the outer axis of the grid.
+ *	@param	deviceParameters	: Calibration parameters of each device of `devices`.
+ *	@param	firstPoint		: Index of the first grid point of the block.
+ *	@param	numberOfPoints		: Number of grid points of the block.
+ *	@param	records			: Array to store the record of each grid point of the block.
+ */
+static void
+evaluateResponseGridBlock(
+	CommandLineArguments *		arguments,
+	const ResponseGrid *		grid,
+	const size_t *			devices,
+	float * const *			deviceParameters,
+	size_t				firstPoint,
+	size_t				numberOfPoints,
+	ResponseGridRecord *		records)
+{
+	size_t	indices[kInputDistributionIndexMax];
+	size_t	device;
+	size_t	remainder = firstPoint;
+	float	inputVariables[kInputDistributionIndexMax];
+
+	for (size_t k = kInputDistributionIndexMax; k-- > 0;)
+	{
+		indices[k] = remainder % grid->axes[k].numberOfValues;
+		remainder /= grid->axes[k].numberOfValues;
+		inputVariables[k] = responseGridAxisValue(&grid->axes[k], indices[k]);
+	}
+
+	device = remainder;
+
+	for (size_t j = 0; j < numberOfPoints; j++)
+	{
+		float *	parameters = deviceParameters[device];
+
+		calculateBME680ConversionRoutines(arguments,
+				inputVariables,
+				records[j].outputs,
+				&parameters[0],
+				&parameters[kBME680ConstantsNumberOfTemperatureParameters],
+				&parameters[kBME680ConstantsNumberOfTemperatureParameters + kBME680ConstantsNumberOfPressureParameters]);
+
+		records[j].device = (uint32_t) devices[device];
+		memcpy(records[j].inputs, inputVariables, sizeof(inputVariables));
+
+		/*
+		 *	Advance to the next grid point, carrying into the slower axes.
+		 */
+		for (size_t k = kInputDistributionIndexMax; k-- > 0;)
+		{
+			if (++indices[k] < grid->axes[k].numberOfValues)
+			{
+				inputVariables[k] = responseGridAxisValue(&grid->axes[k], indices[k]);
+
+				break;
+			}
+
+			indices[k] = 0;
+			inputVariables[k] = responseGridAxisValue(&grid->axes[k], 0);
+
+			if (k == 0)
+			{
+				device++;
+			}
+		}
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Write the records of evaluated grid points to the grid file.
+ *
+ *	@param	file		: The grid file.
+ *	@param	format		: Format of the grid file.
+ *	@param	records		: The records.
+ *	@param	numberOfRecords	: Number of records.
+ *	@return			: `true` if all records were written, else `false`.
+ */
+static bool
+writeResponseGridRecords(FILE *  file, ResponseGridFormat format, const ResponseGridRecord *  records, size_t numberOfRecords)
+{
+	if (format == kResponseGridFormatBinary)
+	{
+		return (fwrite(records, sizeof(ResponseGridRecord), numberOfRecords, file) == numberOfRecords);
+	}
+
+	for (size_t i = 0; i < numberOfRecords; i++)
+	{
+		if (fprintf(file, "%" PRIu32 ",%.9g,%.9g,%.9g,%.9g,%.9g,%.9g\n",
+				records[i].device,
+				records[i].inputs[kInputDistributionIndexForTemperatureRawADCValue],
+				records[i].inputs[kInputDistributionIndexForPressureRawADCValue],
+				records[i].inputs[kInputDistributionIndexForHumidityRawADCValue],
+				records[i].outputs[kOutputDistributionIndexForTemperature],
+				records[i].outputs[kOutputDistributionIndexForPressure],
+				records[i].outputs[kOutputDistributionIndexForHumidity]) < 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ *	@brief	Evaluate every point of the response-surface grid and stream the records to its file.
+ *
+ *	@param	arguments		: Pointer to command-line arguments struct that selects all outputs.
+ *	@param	grid			: Pointer to the grid.
+ *	@param	devices			: Device indices of the outer axis of the grid.
+ *	@param	deviceParameters	: Calibration parameters of each device of `devices`.
+ *	@param	numberOfPoints		: Number of grid points.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+streamResponseGrid(
+	CommandLineArguments *		arguments,
+	const ResponseGrid *		grid,
+	const size_t *			devices,
+	float * const *			deviceParameters,
+	size_t				numberOfPoints)
+{
+	ResponseGridRecord *	records = malloc(kResponseGridConstantChunkSize * sizeof(ResponseGridRecord));
+	FILE *			file;
+	bool			isWritten = true;
+
+	if (records == NULL)
+	{
+		fprintf(stderr, "Error: Could not allocate the records of the response-surface grid.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	file = fopen(grid->outputPath, (grid->format == kResponseGridFormatBinary) ? "wb" : "w");
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not create response-surface grid file \"%s\": %s.\n", grid->outputPath, strerror(errno));
+		free(records);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (grid->format == kResponseGridFormatCsv)
+	{
+		isWritten = (fprintf(file, "device,temperature ADC,pressure ADC,humidity ADC,temperature,pressure,humidity\n") > 0);
+	}
+
+	/*
+	 *	Evaluate the grid in chunks, in parallel blocks within each chunk, and write every chunk
+	 *	before evaluating the next.
+	 */
+	for (size_t chunkStart = 0; isWritten && (chunkStart < numberOfPoints); chunkStart += kResponseGridConstantChunkSize)
+	{
+		size_t	chunkSize = numberOfPoints - chunkStart;
+		size_t	numberOfBlocks;
+
+		chunkSize = (chunkSize < kResponseGridConstantChunkSize) ? chunkSize : kResponseGridConstantChunkSize;
+		numberOfBlocks = (chunkSize + kResponseGridConstantBlockSize - 1) / kResponseGridConstantBlockSize;
+
+		#pragma omp parallel for schedule(static) proc_bind(spread)
+		for (size_t block = 0; block < numberOfBlocks; ++block)
+		{
+			size_t	blockStart = block * kResponseGridConstantBlockSize;
+			size_t	blockSize = chunkSize - blockStart;
+
+			blockSize = (blockSize < kResponseGridConstantBlockSize) ? blockSize : kResponseGridConstantBlockSize;
+
+			evaluateResponseGridBlock(
+				arguments,
+				grid,
+				devices,
+				deviceParameters,
+				chunkStart + blockStart,
+				blockSize,
+				&records[blockStart]);
+		}
+
+		isWritten = writeResponseGridRecords(file, grid->format, records, chunkSize);
+	}
+
+	free(records);
+
+	if ((fclose(file) != 0) || !isWritten)
+	{
+		fprintf(stderr, "Error: Could not write response-surface grid file \"%s\".\n", grid->outputPath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+runResponseSurfaceGrid(
+	CommandLineArguments *	arguments,
+	float *			temperatureParameters,
+	float *			pressureParameters,
+	float *			humidityParameters)
+{
+	const ResponseGrid *	grid = &arguments->responseGrid;
+	CommandLineArguments	allOutputsArguments = *arguments;
+	CalibrationTable	calibrationTable = {0};
+	float			fixedParameters[kBME680ConstantsNumberOfCalibrationParameters];
+	size_t			numberOfDevices = 1;
+	size_t *		devices;
+	float **		deviceParameters;
+	size_t			numberOfPoints;
+	CommonConstantReturnType	ret = kCommonConstantReturnTypeSuccess;
+
+	allOutputsArguments.common.outputSelect = kOutputDistributionIndexMax;
+
+	memcpy(&fixedParameters[0], temperatureParameters, kBME680ConstantsNumberOfTemperatureParameters * sizeof(float));
+	memcpy(&fixedParameters[kBME680ConstantsNumberOfTemperatureParameters], pressureParameters, kBME680ConstantsNumberOfPressureParameters * sizeof(float));
+	memcpy(&fixedParameters[kBME680ConstantsNumberOfTemperatureParameters + kBME680ConstantsNumberOfPressureParameters], humidityParameters, kBME680ConstantsNumberOfHumidityParameters * sizeof(float));
+
+	/*
+	 *	Devices of `-y` take their parameters from the calibration table, the device of `-n`
+	 *	from the parameters loaded already.
+	 */
+	if (grid->useAllDevices || (grid->deviceIndices != NULL))
+	{
+		if (loadCalibrationTable(arguments, &calibrationTable) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		numberOfDevices = grid->useAllDevices ? calibrationTable.numberOfDevices : grid->numberOfDevices;
+	}
+
+	devices = malloc(numberOfDevices * sizeof(size_t));
+	deviceParameters = malloc(numberOfDevices * sizeof(float *));
+
+	if ((devices == NULL) || (deviceParameters == NULL))
+	{
+		fprintf(stderr, "Error: Could not allocate the devices of the response-surface grid.\n");
+		ret = kCommonConstantReturnTypeError;
+	}
+
+	for (size_t i = 0; (ret == kCommonConstantReturnTypeSuccess) && (i < numberOfDevices); i++)
+	{
+		if (calibrationTable.rows == NULL)
+		{
+			devices[i] = arguments->indexForCalibrationParameters;
+			deviceParameters[i] = fixedParameters;
+
+			continue;
+		}
+
+		devices[i] = grid->useAllDevices ? i : grid->deviceIndices[i];
+
+		if (devices[i] >= calibrationTable.numberOfDevices)
+		{
+			fprintf(stderr, "Error: Device %zu of the grid is not in the calibration table of %zu devices.\n", devices[i], calibrationTable.numberOfDevices);
+			ret = kCommonConstantReturnTypeError;
+
+			break;
+		}
+
+		deviceParameters[i] = &calibrationTable.rows[devices[i] * kBME680ConstantsNumberOfCalibrationParameters];
+	}
+
+	numberOfPoints = numberOfDevices;
+
+	for (size_t k = 0; (ret == kCommonConstantReturnTypeSuccess) && (k < kInputDistributionIndexMax); k++)
+	{
+		if (numberOfPoints > SIZE_MAX / grid->axes[k].numberOfValues)
+		{
+			fprintf(stderr, "Error: The response-surface grid has too many points.\n");
+			ret = kCommonConstantReturnTypeError;
+
+			break;
+		}
+
+		numberOfPoints *= grid->axes[k].numberOfValues;
+	}
+
+	if (ret == kCommonConstantReturnTypeSuccess)
+	{
+		ret = streamResponseGrid(&allOutputsArguments, grid, devices, deviceParameters, numberOfPoints);
+	}
+
+	if (ret == kCommonConstantReturnTypeSuccess)
+	{
+		printf("Response-surface grid: %zu points (%zu devices x %zu temperature x %zu pressure x %zu humidity ADC values) written to \"%s\".\n",
+			numberOfPoints,
+			numberOfDevices,
+			grid->axes[kInputDistributionIndexForTemperatureRawADCValue].numberOfValues,
+			grid->axes[kInputDistributionIndexForPressureRawADCValue].numberOfValues,
+			grid->axes[kInputDistributionIndexForHumidityRawADCValue].numberOfValues,
+			grid->outputPath);
+	}
+
+	free(devices);
+	free(deviceParameters);
+	calibrationTableFree(&calibrationTable);
+
+	return ret;
+}
+
+void
+responseGridFree(ResponseGrid *  grid)
+{
+	for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+	{
+		free(grid->axes[k].values);
+		grid->axes[k].values = NULL;
+	}
+
+	free(grid->deviceIndices);
+	grid->deviceIndices = NULL;
+
+	return;
+}
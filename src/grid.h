@@ -0,0 +1,83 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "utilities.h"
+
+typedef enum
+{
+	/*
+	 *	Number of consecutive grid points that one thread evaluates together, and number of grid
+	 *	points evaluated before they are written out, which bounds the memory of any grid.
+	 */
+	kResponseGridConstantBlockSize		= 256,
+	kResponseGridConstantChunkSize		= 65536,
+} ResponseGridConstant;
+
+/*
+ *	One grid point and its outputs, as written to binary grid files (native byte order, no padding).
+ */
+typedef struct ResponseGridRecord
+{
+	uint32_t	device;
+	float		inputs[kInputDistributionIndexMax];
+	float		outputs[kOutputDistributionIndexMax];
+} ResponseGridRecord;
+
+/**
+ *	@brief	Value of a raw ADC input at a point of its axis of the response-surface grid.
+ *
+ *	@param	axis	: Pointer to the axis.
+ *	@param	index	: Index of the point, less than `axis->numberOfValues`.
+ *	@return		: Value of the input.
+ */
+float				responseGridAxisValue(const ResponseGridAxis *  axis, size_t index);
+
+/**
+ *	@brief	Evaluate all outputs on every point of the response-surface grid of `-g` and stream
+ *		them to its file. The grid is the Cartesian product of the devices and the values of
+ *		the temperature, pressure, and humidity ADC inputs, with the humidity varying fastest.
+ *
+ *	@param	arguments		: Pointer to command-line arguments struct.
+ *	@param	temperatureParameters	: The temperature calibration parameters of the device of `-n`.
+ *	@param	pressureParameters	: The pressure calibration parameters of the device of `-n`.
+ *	@param	humidityParameters	: The humidity calibration parameters of the device of `-n`.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runResponseSurfaceGrid(
+					CommandLineArguments *	arguments,
+					float *			temperatureParameters,
+					float *			pressureParameters,
+					float *			humidityParameters);
+
+/**
+ *	@brief	Free the value lists and device indices of a response-surface grid.
+ *
+ *	@param	grid	: Pointer to the grid.
+ */
+void				responseGridFree(ResponseGrid *  grid);
@@ -0,0 +1,401 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "importance.h"
+
+/*
+ *	Weight of the new estimate when a cross-entropy stage updates the proposal. Keeping part of
+ *	the previous proposal stops the standard deviations of discrete inputs from collapsing
+ *	once the elite all share one outcome.
+ */
+static const double	kImportanceSamplingSmoothing = 0.7;
+
+/*
+ *	Smallest standard deviation of the normal scores under the proposal.
+ */
+static const double	kImportanceSamplingMinStandardDeviation = 0.05;
+
+/**
+ *	@brief	Score of an output for the cross-entropy stages: larger scores are closer to the event.
+ *
+ *	@param	event	: Pointer to the event.
+ *	@param	output	: The output value.
+ *	@return		: The score. Outputs that are not a number get the lowest score.
+ */
+static double
+eventScore(const OutputEvent *  event, double output)
+{
+	if (isnan(output))
+	{
+		return -INFINITY;
+	}
+
+	return ((event->comparison == kOutputEventComparisonLess) || (event->comparison == kOutputEventComparisonLessOrEqual)) ? -output : output;
+}
+
+/**
+ *	@brief	Map a point of the unit hypercube to a point of the proposal.
+ *
+ *	@param	proposal	: Pointer to the proposal.
+ *	@param	uniforms	: Point in (0, 1)^numberOfInputs of the nominal distribution.
+ *	@param	normalScores	: Array to store the normal scores of the proposal point, or `NULL`.
+ *	@param	samplePoint	: Array to store the proposal point in (0, 1)^numberOfInputs.
+ *	@return			: Logarithm of the likelihood ratio of the proposal point.
+ */
+static double
+proposalPoint(const ImportanceSamplingProposal *  proposal, const double *  uniforms, double *  normalScores, double *  samplePoint)
+{
+	double	logLikelihoodRatio = 0.0;
+
+	for (size_t i = 0; i < proposal->numberOfInputs; i++)
+	{
+		double	standardScore = samplingNormalQuantile(uniforms[i]);
+		double	z = proposal->mean[i] + proposal->standardDeviation[i] * standardScore;
+		double	u = samplingNormalCdf(z);
+
+		/*
+		 *	Far in the tails, the cumulative distribution function rounds to 0 or 1.
+		 */
+		samplePoint[i] = fmin(fmax(u, 0x1.0p-53), 1.0 - 0x1.0p-53);
+		logLikelihoodRatio += log(proposal->standardDeviation[i]) + 0.5 * (standardScore * standardScore - z * z);
+
+		if (normalScores != NULL)
+		{
+			normalScores[i] = z;
+		}
+	}
+
+	return logLikelihoodRatio;
+}
+
+static int
+compareDoubles(const void *  a, const void *  b)
+{
+	double	x = *(const double *) a;
+	double	y = *(const double *) b;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ *	@brief	Run one cross-entropy stage: draw pilot samples from the current proposal, take the
+ *		samples with the highest scores as the elite, and move the proposal towards the mean
+ *		and standard deviation of their normal scores, weighted by their likelihood ratios.
+ *
+ *	@param	model			: Pointer to the conversion model.
+ *	@param	event			: Pointer to the event.
+ *	@param	stage			: Index of the stage, which selects its random numbers.
+ *	@param	numberOfPilotSamples	: Number of samples of the stage.
+ *	@param	proposal		: Pointer to the proposal to update.
+ *	@param	hasReachedEvent		: Pointer to store whether the elite lies in the event.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+runCrossEntropyStage(
+	const ConversionModel *		model,
+	const OutputEvent *		event,
+	size_t				stage,
+	size_t				numberOfPilotSamples,
+	ImportanceSamplingProposal *	proposal,
+	bool *				hasReachedEvent)
+{
+	size_t		numberOfInputs = proposal->numberOfInputs;
+	double *	scores = (double *) checkedMalloc(numberOfPilotSamples * sizeof(double), __FILE__, __LINE__);
+	double *	sortedScores = (double *) checkedMalloc(numberOfPilotSamples * sizeof(double), __FILE__, __LINE__);
+	double *	logLikelihoodRatios = (double *) checkedMalloc(numberOfPilotSamples * sizeof(double), __FILE__, __LINE__);
+	double *	normalScores = (double *) checkedMalloc(numberOfPilotSamples * numberOfInputs * sizeof(double), __FILE__, __LINE__);
+	double		target = eventScore(event, event->threshold);
+	double		level;
+	double		largestLogLikelihoodRatio = -INFINITY;
+	double		sumOfWeights = 0.0;
+	double		weightedSums[kImportanceSamplingConstantMaxInputs] = {0};
+	double		weightedSquareSums[kImportanceSamplingConstantMaxInputs] = {0};
+	Sampler		sampler;
+
+	if (samplerInit(
+			&sampler,
+			model->arguments->samplingMethod,
+			samplingRandomBits(model->arguments->randomSeed, kSamplingStreamMax, stage + 1),
+			numberOfPilotSamples,
+			numberOfInputs) != kCommonConstantReturnTypeSuccess)
+	{
+		free(scores);
+		free(sortedScores);
+		free(logLikelihoodRatios);
+		free(normalScores);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	#pragma omp parallel for schedule(static)
+	for (size_t j = 0; j < numberOfPilotSamples; j++)
+	{
+		double	uniforms[kImportanceSamplingConstantMaxInputs];
+		double	samplePoint[kImportanceSamplingConstantMaxInputs];
+		float	outputVariables[kOutputDistributionIndexMax];
+
+		samplerGetPoint(&sampler, j, uniforms);
+		logLikelihoodRatios[j] = proposalPoint(proposal, uniforms, &normalScores[j * numberOfInputs], samplePoint);
+		scores[j] = eventScore(event, conversionModelEvaluate(model, samplePoint, outputVariables));
+		sortedScores[j] = scores[j];
+	}
+
+	/*
+	 *	The elite are the samples at or above the level that the best one-in-ten samples reach,
+	 *	but never above the event itself.
+	 */
+	qsort(sortedScores, numberOfPilotSamples, sizeof(double), compareDoubles);
+	level = sortedScores[numberOfPilotSamples - 1 - numberOfPilotSamples / kImportanceSamplingConstantEliteFraction];
+	*hasReachedEvent = (level >= target);
+	level = (level < target) ? level : target;
+
+	for (size_t j = 0; j < numberOfPilotSamples; j++)
+	{
+		if ((scores[j] >= level) && (logLikelihoodRatios[j] > largestLogLikelihoodRatio))
+		{
+			largestLogLikelihoodRatio = logLikelihoodRatios[j];
+		}
+	}
+
+	for (size_t j = 0; j < numberOfPilotSamples; j++)
+	{
+		double	weight;
+
+		if (!(scores[j] >= level))
+		{
+			continue;
+		}
+
+		/*
+		 *	Likelihood ratios relative to the largest one, which cancels in the weighted mean.
+		 */
+		weight = exp(logLikelihoodRatios[j] - largestLogLikelihoodRatio);
+		sumOfWeights += weight;
+
+		for (size_t i = 0; i < numberOfInputs; i++)
+		{
+			double	z = normalScores[j * numberOfInputs + i];
+
+			weightedSums[i] += weight * z;
+			weightedSquareSums[i] += weight * z * z;
+		}
+	}
+
+	if (sumOfWeights > 0.0)
+	{
+		for (size_t i = 0; i < numberOfInputs; i++)
+		{
+			double	mean = weightedSums[i] / sumOfWeights;
+			double	variance = fmax(weightedSquareSums[i] / sumOfWeights - mean * mean, 0.0);
+			double	standardDeviation = kImportanceSamplingSmoothing * sqrt(variance) + (1.0 - kImportanceSamplingSmoothing) * proposal->standardDeviation[i];
+
+			proposal->mean[i] = kImportanceSamplingSmoothing * mean + (1.0 - kImportanceSamplingSmoothing) * proposal->mean[i];
+			proposal->standardDeviation[i] = fmax(standardDeviation, kImportanceSamplingMinStandardDeviation);
+		}
+	}
+
+	free(scores);
+	free(sortedScores);
+	free(logLikelihoodRatios);
+	free(normalScores);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+runImportanceSampling(
+	const ConversionModel *		model,
+	const OutputEvent *		event,
+	size_t				numberOfSamples,
+	ImportanceSamplingResult *	result)
+{
+	size_t		numberOfInputs = conversionModelNumberOfInputs(model);
+	size_t		numberOfPilotSamples = numberOfSamples / kImportanceSamplingConstantPilotFraction;
+	size_t		numberOfBlocks = (numberOfSamples + kImportanceSamplingConstantBlockSize - 1) / kImportanceSamplingConstantBlockSize;
+	double *	blockSums;
+	double		sumOfRatios = 0.0;
+	double		sumOfSquaredRatios = 0.0;
+	Sampler		sampler;
+
+	if ((numberOfSamples < 2) || (numberOfInputs > kImportanceSamplingConstantMaxInputs))
+	{
+		fprintf(stderr, "Error: Importance sampling needs at least 2 samples and at most %d inputs.\n", kImportanceSamplingConstantMaxInputs);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	*result = (ImportanceSamplingResult) {
+		.numberOfSamples	= numberOfSamples,
+		.proposal		= (ImportanceSamplingProposal) {
+						.numberOfInputs	= numberOfInputs,
+					},
+	};
+
+	/*
+	 *	Start from the nominal distribution.
+	 */
+	for (size_t i = 0; i < numberOfInputs; i++)
+	{
+		result->proposal.standardDeviation[i] = 1.0;
+	}
+
+	numberOfPilotSamples = (numberOfPilotSamples > kImportanceSamplingConstantMinPilotSamples) ? numberOfPilotSamples : kImportanceSamplingConstantMinPilotSamples;
+
+	for (size_t stage = 0; stage < kImportanceSamplingConstantMaxStages; stage++)
+	{
+		if (runCrossEntropyStage(model, event, stage, numberOfPilotSamples, &result->proposal, &result->hasReachedEvent) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		result->numberOfStages++;
+		result->numberOfPilotSamples += numberOfPilotSamples;
+
+		if (result->hasReachedEvent)
+		{
+			break;
+		}
+	}
+
+	if (samplerInit(&sampler, model->arguments->samplingMethod, model->arguments->randomSeed, numberOfSamples, numberOfInputs) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	Per block: the number of samples in the event and the sums of their likelihood ratios
+	 *	and squared likelihood ratios, summed in block order so the estimate does not depend on
+	 *	the number of threads.
+	 */
+	blockSums = (double *) checkedMalloc(3 * numberOfBlocks * sizeof(double), __FILE__, __LINE__);
+
+	#pragma omp parallel for schedule(static)
+	for (size_t block = 0; block < numberOfBlocks; block++)
+	{
+		size_t	blockEnd = (block + 1) * kImportanceSamplingConstantBlockSize;
+		double	numberOfEvents = 0.0;
+		double	sum = 0.0;
+		double	sumOfSquares = 0.0;
+
+		blockEnd = (blockEnd < numberOfSamples) ? blockEnd : numberOfSamples;
+
+		for (size_t j = block * kImportanceSamplingConstantBlockSize; j < blockEnd; j++)
+		{
+			double	uniforms[kImportanceSamplingConstantMaxInputs];
+			double	samplePoint[kImportanceSamplingConstantMaxInputs];
+			float	outputVariables[kOutputDistributionIndexMax];
+			double	logLikelihoodRatio;
+			double	likelihoodRatio;
+
+			samplerGetPoint(&sampler, j, uniforms);
+			logLikelihoodRatio = proposalPoint(&result->proposal, uniforms, NULL, samplePoint);
+
+			if (!outputEventOccurs(event, conversionModelEvaluate(model, samplePoint, outputVariables)))
+			{
+				continue;
+			}
+
+			likelihoodRatio = exp(logLikelihoodRatio);
+			numberOfEvents += 1.0;
+			sum += likelihoodRatio;
+			sumOfSquares += likelihoodRatio * likelihoodRatio;
+		}
+
+		blockSums[3 * block] = numberOfEvents;
+		blockSums[3 * block + 1] = sum;
+		blockSums[3 * block + 2] = sumOfSquares;
+	}
+
+	for (size_t block = 0; block < numberOfBlocks; block++)
+	{
+		result->numberOfEvents += (size_t) blockSums[3 * block];
+		sumOfRatios += blockSums[3 * block + 1];
+		sumOfSquaredRatios += blockSums[3 * block + 2];
+	}
+
+	free(blockSums);
+
+	/*
+	 *	The estimate is the mean of the indicator of the event times the likelihood ratio, over
+	 *	all samples. Its standard error treats the samples as independent.
+	 */
+	result->probability = sumOfRatios / numberOfSamples;
+	result->standardError = sqrt(fmax(sumOfSquaredRatios / numberOfSamples - result->probability * result->probability, 0.0) / (numberOfSamples - 1));
+	result->effectiveSampleSize = (sumOfSquaredRatios > 0.0) ? (sumOfRatios * sumOfRatios / sumOfSquaredRatios) : 0.0;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+printImportanceSamplingResult(
+	const ConversionModel *			model,
+	const OutputEvent *			event,
+	const ImportanceSamplingResult *	result,
+	const char *				outputName)
+{
+	printf("Importance sampling of P(%s %s %lf) (%zu samples, after %zu cross-entropy stages with %zu samples):\n",
+		outputName,
+		outputEventComparisonToString(event),
+		event->threshold,
+		result->numberOfSamples,
+		result->numberOfStages,
+		result->numberOfPilotSamples);
+	printf("Probability: %le, standard error: %le\n", result->probability, result->standardError);
+	printf("Samples in the event: %zu (effective: %.1lf)\n", result->numberOfEvents, result->effectiveSampleSize);
+
+	if (!result->hasReachedEvent)
+	{
+		fprintf(stderr, "Warning: The cross-entropy stages did not reach the event within %d stages, so the proposal may miss part of it and the estimate may be biased towards zero.\n", kImportanceSamplingConstantMaxStages);
+	}
+
+	/*
+	 *	With no sample in the event, the estimate and its standard error are both zero, which
+	 *	bounds nothing: the proposal may simply not sample the event.
+	 */
+	if (result->numberOfEvents == 0)
+	{
+		fprintf(stderr, "Warning: No importance sample is in the event, so the probability and standard error of 0 are not an estimate of the event probability.\n");
+	}
+
+	/*
+	 *	Plain Monte Carlo has standard error sqrt(p (1 - p) / N).
+	 */
+	if ((result->standardError > 0.0) && (result->probability < 1.0))
+	{
+		printf("Plain Monte Carlo iterations for the same standard error: %.3le\n",
+			result->probability * (1.0 - result->probability) / (result->standardError * result->standardError));
+	}
+
+	printf("\nProposal of the normal scores of the inputs:\n");
+	printf("%-16s %12s %12s\n", "Input", "Mean", "Std. dev.");
+
+	for (size_t i = 0; i < result->proposal.numberOfInputs; i++)
+	{
+		printf("%-16s %12.6lf %12.6lf\n", conversionModelInputName(model, i), result->proposal.mean[i], result->proposal.standardDeviation[i]);
+	}
+
+	return;
+}
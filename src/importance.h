@@ -0,0 +1,125 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "sampling.h"
+#include "estimators.h"
+#include "model.h"
+
+typedef enum
+{
+	kImportanceSamplingConstantMaxInputs		= kSamplingConstantMaxDimensions,
+	/*
+	 *	Number of samples per parallel work item.
+	 */
+	kImportanceSamplingConstantBlockSize		= 256,
+	/*
+	 *	Largest number of cross-entropy stages that tune the proposal before the final estimate.
+	 */
+	kImportanceSamplingConstantMaxStages		= 8,
+	/*
+	 *	Smallest number of samples per cross-entropy stage.
+	 */
+	kImportanceSamplingConstantMinPilotSamples	= 100,
+	/*
+	 *	Each cross-entropy stage uses one tenth as many samples as the final estimate.
+	 */
+	kImportanceSamplingConstantPilotFraction	= 10,
+	/*
+	 *	Each cross-entropy stage keeps the best one-in-ten samples as its elite.
+	 */
+	kImportanceSamplingConstantEliteFraction	= 10,
+} ImportanceSamplingConstant;
+
+/*
+ *	Importance sampling works on the normal scores `z = Phi^-1(u)` of the coordinates `u` of the
+ *	sample points of a conversion model, which are independent standard normal variates under
+ *	the nominal distribution. The proposal tilts them to independent normal variates with the
+ *	means and standard deviations below, and every sample carries the likelihood ratio of the
+ *	nominal distribution to the proposal.
+ */
+typedef struct ImportanceSamplingProposal
+{
+	size_t		numberOfInputs;
+	double		mean[kImportanceSamplingConstantMaxInputs];
+	double		standardDeviation[kImportanceSamplingConstantMaxInputs];
+} ImportanceSamplingProposal;
+
+typedef struct ImportanceSamplingResult
+{
+	size_t				numberOfSamples;
+	size_t				numberOfPilotSamples;
+	size_t				numberOfStages;
+	/*
+	 *	Whether the elite samples of the last cross-entropy stage lie in the event. If not, the
+	 *	proposal may miss part of the event and the estimate may be biased towards zero.
+	 */
+	bool				hasReachedEvent;
+	/*
+	 *	Number of samples, drawn from the proposal, that fall in the event.
+	 */
+	size_t				numberOfEvents;
+	double				probability;
+	double				standardError;
+	/*
+	 *	Effective number of samples in the event, from the spread of their likelihood ratios.
+	 */
+	double				effectiveSampleSize;
+	ImportanceSamplingProposal	proposal;
+} ImportanceSamplingResult;
+
+/**
+ *	@brief	Estimate the probability that the selected output of a conversion model lies in an
+ *		event. A few cross-entropy stages first move the proposal towards the event, and `numberOfSamples` fresh samples from the final proposal then give an
+ *		unbiased estimate of the probability.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	event		: Pointer to the event.
+ *	@param	numberOfSamples	: Number of samples of the final estimate.
+ *	@param	result		: Pointer to store the result.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runImportanceSampling(
+					const ConversionModel *		model,
+					const OutputEvent *		event,
+					size_t				numberOfSamples,
+					ImportanceSamplingResult *	result);
+
+/**
+ *	@brief	Print the result of importance sampling.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	event		: Pointer to the event.
+ *	@param	result		: Pointer to the result.
+ *	@param	outputName	: Name of the output that the event is about.
+ */
+void				printImportanceSamplingResult(
+					const ConversionModel *			model,
+					const OutputEvent *			event,
+					const ImportanceSamplingResult *	result,
+					const char *				outputName);
@@ -0,0 +1,611 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "interval.h"
+
+/**
+ *	@brief	Interval between two rounded bounds, widened by one unit in the last place on each
+ *		side. Round-to-nearest is within half a unit of the exact bound, so the widened
+ *		interval encloses the exact one. Undefined bounds, such as from 0 * infinity, give
+ *		the whole real line.
+ *
+ *	@param	lower	: Rounded lower bound.
+ *	@param	upper	: Rounded upper bound.
+ *	@return		: The outward-rounded interval.
+ */
+static Interval
+intervalOutward(double lower, double upper)
+{
+	if (isnan(lower) || isnan(upper))
+	{
+		return (Interval) {-INFINITY, INFINITY};
+	}
+
+	return (Interval) {nextafter(lower, -INFINITY), nextafter(upper, INFINITY)};
+}
+
+Interval
+intervalPoint(double value)
+{
+	return (Interval) {value, value};
+}
+
+Interval
+intervalAdd(Interval a, Interval b)
+{
+	return intervalOutward(a.lower + b.lower, a.upper + b.upper);
+}
+
+Interval
+intervalSubtract(Interval a, Interval b)
+{
+	return intervalOutward(a.lower - b.upper, a.upper - b.lower);
+}
+
+Interval
+intervalMultiply(Interval a, Interval b)
+{
+	double	products[4] = {a.lower * b.lower, a.lower * b.upper, a.upper * b.lower, a.upper * b.upper};
+	double	lower = products[0];
+	double	upper = products[0];
+
+	for (size_t i = 0; i < 4; i++)
+	{
+		if (isnan(products[i]))
+		{
+			return (Interval) {-INFINITY, INFINITY};
+		}
+
+		lower = fmin(lower, products[i]);
+		upper = fmax(upper, products[i]);
+	}
+
+	return intervalOutward(lower, upper);
+}
+
+Interval
+intervalDivide(Interval a, Interval b)
+{
+	if ((b.lower <= 0.0) && (b.upper >= 0.0))
+	{
+		return (Interval) {-INFINITY, INFINITY};
+	}
+
+	double	quotients[4] = {a.lower / b.lower, a.lower / b.upper, a.upper / b.lower, a.upper / b.upper};
+	double	lower = quotients[0];
+	double	upper = quotients[0];
+
+	for (size_t i = 0; i < 4; i++)
+	{
+		if (isnan(quotients[i]))
+		{
+			return (Interval) {-INFINITY, INFINITY};
+		}
+
+		lower = fmin(lower, quotients[i]);
+		upper = fmax(upper, quotients[i]);
+	}
+
+	return intervalOutward(lower, upper);
+}
+
+Interval
+intervalSquare(Interval a)
+{
+	double	lowerSquare = a.lower * a.lower;
+	double	upperSquare = a.upper * a.upper;
+
+	if ((a.lower <= 0.0) && (a.upper >= 0.0))
+	{
+		return (Interval) {0.0, nextafter(fmax(lowerSquare, upperSquare), INFINITY)};
+	}
+
+	return intervalOutward(fmin(lowerSquare, upperSquare), fmax(lowerSquare, upperSquare));
+}
+
+/**
+ *	@brief	Quotient of an interval by a constant.
+ *
+ *	@param	a		: The interval.
+ *	@param	divisor		: The nonzero constant.
+ *	@return			: An enclosure of a / divisor.
+ */
+static Interval
+intervalScale(Interval a, double divisor)
+{
+	return intervalDivide(a, intervalPoint(divisor));
+}
+
+/**
+ *	@brief	Smallest interval that contains two intervals.
+ *
+ *	@param	a	: The first interval.
+ *	@param	b	: The second interval.
+ *	@return		: The hull.
+ */
+static Interval
+intervalHull(Interval a, Interval b)
+{
+	return (Interval) {fmin(a.lower, b.lower), fmax(a.upper, b.upper)};
+}
+
+void
+intervalConversionRoutines(const Interval *  inputs, Interval *  outputs)
+{
+	const Interval *	t = &inputs[kInputDistributionIndexMax];
+	const Interval *	p = &t[kBME680ConstantsNumberOfTemperatureParameters];
+	const Interval *	h = &p[kBME680ConstantsNumberOfPressureParameters];
+
+	/*
+	 *	Temperature, as `calc_temperature()` with `var2` written in terms of `var1`'s factor
+	 *	`a`, since `b = a / 8`; the interval extension then has a single occurrence of `a`
+	 *	per term.
+	 */
+	Interval	a = intervalSubtract(intervalScale(inputs[kInputDistributionIndexForTemperatureRawADCValue], 16384.0), intervalScale(t[0], 1024.0));
+	Interval	temperature = intervalScale(
+					intervalAdd(
+						intervalMultiply(a, t[1]),
+						intervalScale(intervalMultiply(intervalSquare(a), t[2]), 4.0)),
+					5120.0);
+
+	/*
+	 *	Pressure, as `calc_pressure()` on `t_fine = 5120 * temperature`, in kPa.
+	 */
+	Interval	v1 = intervalSubtract(intervalMultiply(temperature, intervalPoint(2560.0)), intervalPoint(64000.0));
+	Interval	v1Squared = intervalSquare(v1);
+	Interval	v2 = intervalAdd(
+				intervalScale(
+					intervalAdd(
+						intervalScale(intervalMultiply(v1Squared, p[5]), 131072.0),
+						intervalMultiply(intervalMultiply(v1, p[4]), intervalPoint(2.0))),
+					4.0),
+				intervalMultiply(p[3], intervalPoint(65536.0)));
+	Interval	u = intervalScale(
+				intervalAdd(
+					intervalScale(intervalMultiply(p[2], v1Squared), 16384.0),
+					intervalMultiply(p[1], v1)),
+				524288.0);
+	Interval	q = intervalMultiply(intervalAdd(intervalPoint(1.0), intervalScale(u, 32768.0)), p[0]);
+	Interval	pressure = intervalPoint(0.0);
+
+	/*
+	 *	`calc_pressure()` returns zero where `(int)q` is zero, i.e., for -1 < q < 1.
+	 */
+	if ((q.lower <= -1.0) || (q.upper >= 1.0))
+	{
+		Interval	c = intervalDivide(
+					intervalMultiply(
+						intervalSubtract(
+							intervalSubtract(intervalPoint(1048576.0), inputs[kInputDistributionIndexForPressureRawADCValue]),
+							intervalScale(v2, 4096.0)),
+						intervalPoint(6250.0)),
+					q);
+		Interval	c256 = intervalScale(c, 256.0);
+		Interval	correction = intervalAdd(
+						intervalAdd(
+							intervalScale(intervalMultiply(p[8], intervalSquare(c)), 2147483648.0),
+							intervalMultiply(c, intervalScale(p[7], 32768.0))),
+						intervalAdd(
+							intervalMultiply(intervalMultiply(intervalSquare(c256), c256), intervalScale(p[9], 131072.0)),
+							intervalMultiply(p[6], intervalPoint(128.0))));
+		Interval	divisionBranch = intervalScale(intervalAdd(c, intervalScale(correction, 16.0)), 1000.0);
+
+		pressure = ((q.lower >= 1.0) || (q.upper <= -1.0)) ? divisionBranch : intervalHull(divisionBranch, pressure);
+	}
+
+	/*
+	 *	Humidity, as `calc_humidity()`, clamped to [0, 100] like it.
+	 */
+	Interval	v1Humidity = intervalSubtract(
+					inputs[kInputDistributionIndexForHumidityRawADCValue],
+					intervalAdd(intervalMultiply(h[0], intervalPoint(16.0)), intervalMultiply(intervalScale(h[2], 2.0), temperature)));
+	Interval	g = intervalAdd(
+				intervalPoint(1.0),
+				intervalAdd(
+					intervalMultiply(intervalScale(h[3], 16384.0), temperature),
+					intervalMultiply(intervalScale(h[4], 1048576.0), intervalSquare(temperature))));
+	Interval	v2Humidity = intervalMultiply(v1Humidity, intervalMultiply(intervalScale(h[1], 262144.0), g));
+	Interval	k = intervalAdd(intervalScale(h[5], 16384.0), intervalMultiply(intervalScale(h[6], 2097152.0), temperature));
+	Interval	humidity = intervalAdd(v2Humidity, intervalMultiply(k, intervalSquare(v2Humidity)));
+
+	outputs[kOutputDistributionIndexForTemperature] = temperature;
+	outputs[kOutputDistributionIndexForPressure] = pressure;
+	outputs[kOutputDistributionIndexForHumidity] = (Interval) {
+								fmin(fmax(humidity.lower, 0.0), 100.0),
+								fmin(fmax(humidity.upper, 0.0), 100.0),
+							};
+
+	return;
+}
+
+/*
+ *	Boxes of the inputs of a branch-and-bound search, kept in a binary heap by their bound of
+ *	one output: smallest lower bound first, or largest upper bound first.
+ */
+typedef struct IntervalBoxHeap
+{
+	size_t		numberOfBoxes;
+	size_t		capacity;
+	Interval *	boxes;
+	double *	keys;
+} IntervalBoxHeap;
+
+static void
+intervalBoxHeapSwap(IntervalBoxHeap *  heap, size_t i, size_t j)
+{
+	const size_t	n = kConversionModelConstantMaxInputs;
+	Interval	box[kConversionModelConstantMaxInputs];
+	double		key = heap->keys[i];
+
+	memcpy(box, &heap->boxes[i * n], sizeof(box));
+	memcpy(&heap->boxes[i * n], &heap->boxes[j * n], sizeof(box));
+	memcpy(&heap->boxes[j * n], box, sizeof(box));
+	heap->keys[i] = heap->keys[j];
+	heap->keys[j] = key;
+
+	return;
+}
+
+static void
+intervalBoxHeapPush(IntervalBoxHeap *  heap, const Interval *  box, double key)
+{
+	size_t	i = heap->numberOfBoxes++;
+
+	memcpy(&heap->boxes[i * kConversionModelConstantMaxInputs], box, kConversionModelConstantMaxInputs * sizeof(Interval));
+	heap->keys[i] = key;
+
+	while ((i > 0) && (heap->keys[(i - 1) / 2] > heap->keys[i]))
+	{
+		intervalBoxHeapSwap(heap, i, (i - 1) / 2);
+		i = (i - 1) / 2;
+	}
+
+	return;
+}
+
+static void
+intervalBoxHeapPop(IntervalBoxHeap *  heap, Interval *  box)
+{
+	size_t	i = 0;
+
+	memcpy(box, heap->boxes, kConversionModelConstantMaxInputs * sizeof(Interval));
+	heap->numberOfBoxes--;
+	intervalBoxHeapSwap(heap, 0, heap->numberOfBoxes);
+
+	for (;;)
+	{
+		size_t	smallest = i;
+
+		for (size_t child = 2 * i + 1; (child <= 2 * i + 2) && (child < heap->numberOfBoxes); child++)
+		{
+			if (heap->keys[child] < heap->keys[smallest])
+			{
+				smallest = child;
+			}
+		}
+
+		if (smallest == i)
+		{
+			break;
+		}
+
+		intervalBoxHeapSwap(heap, i, smallest);
+		i = smallest;
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Evaluate the conversion routines on a box and at its centre.
+ *
+ *	@param	box		: The box.
+ *	@param	enclosure	: Array of `kOutputDistributionIndexMax` entries to store the enclosures.
+ *	@param	result		: Pointer to the result, whose attained ranges grow by the values at the centre.
+ */
+static void
+evaluateBox(const Interval *  box, Interval *  enclosure, IntervalBoundsResult *  result)
+{
+	double	centre[kConversionModelConstantMaxInputs];
+	double	outputs[kOutputDistributionIndexMax];
+
+	intervalConversionRoutines(box, enclosure);
+
+	for (size_t i = 0; i < kConversionModelConstantMaxInputs; i++)
+	{
+		centre[i] = 0.5 * (box[i].lower + box[i].upper);
+	}
+
+	conversionModelEvaluateWithJacobian(centre, outputs, NULL);
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		result->attained[o].lower = fmin(result->attained[o].lower, outputs[o]);
+		result->attained[o].upper = fmax(result->attained[o].upper, outputs[o]);
+	}
+
+	result->numberOfEvaluations++;
+
+	return;
+}
+
+/**
+ *	@brief	Branch-and-bound search for one bound of one output.
+ *
+ *	@param	initialBoxes		: The boxes whose union is the domain of the inputs.
+ *	@param	numberOfInitialBoxes	: Number of boxes in `initialBoxes`.
+ *	@param	initialWidths		: Widths of the inputs over the domain.
+ *	@param	output			: Index of the output.
+ *	@param	isUpper			: Search for the upper rather than the lower bound.
+ *	@param	maxEvaluations		: Largest number of evaluations.
+ *	@param	result			: Pointer to the result.
+ *	@return				: The bound.
+ */
+static double
+searchBound(
+	const Interval *	initialBoxes,
+	size_t			numberOfInitialBoxes,
+	const double *		initialWidths,
+	size_t			output,
+	bool			isUpper,
+	size_t			maxEvaluations,
+	IntervalBoundsResult *	result)
+{
+	const size_t	n = kConversionModelConstantMaxInputs;
+	double		sign = isUpper ? -1.0 : 1.0;
+	size_t		numberOfEvaluations = 0;
+	double		bound;
+	IntervalBoxHeap	heap = {
+				.capacity	= numberOfInitialBoxes + maxEvaluations,
+			};
+
+	heap.boxes = (Interval *) checkedMalloc(heap.capacity * n * sizeof(Interval), __FILE__, __LINE__);
+	heap.keys = (double *) checkedMalloc(heap.capacity * sizeof(double), __FILE__, __LINE__);
+
+	for (size_t b = 0; b < numberOfInitialBoxes; b++)
+	{
+		Interval	enclosure[kOutputDistributionIndexMax];
+
+		evaluateBox(&initialBoxes[b * n], enclosure, result);
+		numberOfEvaluations++;
+		intervalBoxHeapPush(&heap, &initialBoxes[b * n], isUpper ? -enclosure[output].upper : enclosure[output].lower);
+	}
+
+	while (numberOfEvaluations + 2 <= maxEvaluations)
+	{
+		Interval	box[kConversionModelConstantMaxInputs];
+		double		attained = isUpper ? result->attained[output].upper : result->attained[output].lower;
+		size_t		split = n;
+		double		widest = 0.0;
+
+		/*
+		 *	Stop once the bound is as tight as the rounding allows.
+		 */
+		if (sign * attained - heap.keys[0] <= 1e-12 * fmax(1.0, fabs(attained)))
+		{
+			break;
+		}
+
+		intervalBoxHeapPop(&heap, box);
+
+		for (size_t i = 0; i < n; i++)
+		{
+			double	width = (initialWidths[i] > 0.0) ? (box[i].upper - box[i].lower) / initialWidths[i] : 0.0;
+
+			if (width > widest)
+			{
+				widest = width;
+				split = i;
+			}
+		}
+
+		if (split == n)
+		{
+			intervalBoxHeapPush(&heap, box, heap.keys[0]);
+
+			break;
+		}
+
+		/*
+		 *	Bisect the box along its relatively widest input and bound both halves.
+		 */
+		double		middle = 0.5 * (box[split].lower + box[split].upper);
+		Interval	halves[2] = {{box[split].lower, middle}, {middle, box[split].upper}};
+
+		for (size_t half = 0; half < 2; half++)
+		{
+			Interval	enclosure[kOutputDistributionIndexMax];
+
+			box[split] = halves[half];
+			evaluateBox(box, enclosure, result);
+			numberOfEvaluations++;
+			intervalBoxHeapPush(&heap, box, isUpper ? -enclosure[output].upper : enclosure[output].lower);
+		}
+	}
+
+	bound = sign * heap.keys[0];
+	free(heap.boxes);
+	free(heap.keys);
+
+	return bound;
+}
+
+CommonConstantReturnType
+runIntervalBounds(const ConversionModel *  model, size_t maxEvaluations, IntervalBoundsResult *  result)
+{
+	const size_t			n = kConversionModelConstantMaxInputs;
+	const CalibrationTable *	table = model->calibrationTable;
+	bool				isJoint = (table != NULL) && (model->arguments->calibrationSampling == kCalibrationSamplingJoint);
+	size_t				numberOfBoxes = isJoint ? table->numberOfDevices : 1;
+	Interval *			boxes = (Interval *) checkedMalloc(numberOfBoxes * n * sizeof(Interval), __FILE__, __LINE__);
+	double				initialWidths[kConversionModelConstantMaxInputs];
+	double				inputMean[kConversionModelConstantMaxInputs];
+	double				inputCovariance[kConversionModelConstantMaxInputs * kConversionModelConstantMaxInputs];
+
+	*result = (IntervalBoundsResult) {0};
+
+	if (maxEvaluations > kIntervalConstantMaxEvaluationsPerBound)
+	{
+		maxEvaluations = kIntervalConstantMaxEvaluationsPerBound;
+	}
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		result->initialEnclosure[o] = (Interval) {INFINITY, -INFINITY};
+		result->attained[o] = (Interval) {INFINITY, -INFINITY};
+	}
+
+	/*
+	 *	The domain: the supports of the raw ADC inputs and either the fixed calibration
+	 *	parameters, the range of every parameter across devices, or for joint sampling one box
+	 *	per device.
+	 */
+	conversionModelInputMoments(model, inputMean, inputCovariance);
+
+	for (size_t b = 0; b < numberOfBoxes; b++)
+	{
+		Interval *	box = &boxes[b * n];
+
+		for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+		{
+			const InputDistribution *	distribution = &model->inputDistributions[i];
+
+			switch (distribution->kind)
+			{
+				case kInputDistributionKindUniform:
+				{
+					box[i] = (Interval) {distribution->lowerBound, distribution->upperBound};
+
+					break;
+				}
+
+				case kInputDistributionKindEmpirical:
+				{
+					box[i] = (Interval) {INFINITY, -INFINITY};
+
+					for (size_t outcome = 0; outcome < distribution->aliasTable.numberOfOutcomes; outcome++)
+					{
+						box[i] = intervalHull(box[i], intervalPoint(distribution->aliasTable.values[outcome]));
+					}
+
+					break;
+				}
+
+				default:
+				{
+					box[i] = intervalPoint(distribution->value);
+
+					break;
+				}
+			}
+		}
+
+		for (size_t i = 0; i < kBME680ConstantsNumberOfCalibrationParameters; i++)
+		{
+			Interval *	parameter = &box[kInputDistributionIndexMax + i];
+
+			*parameter = intervalPoint(inputMean[kInputDistributionIndexMax + i]);
+
+			if (isJoint)
+			{
+				*parameter = intervalPoint(table->rows[b * table->numberOfParameters + i]);
+			}
+			else if (table != NULL)
+			{
+				*parameter = (Interval) {INFINITY, -INFINITY};
+
+				for (size_t device = 0; device < table->numberOfDevices; device++)
+				{
+					*parameter = intervalHull(*parameter, intervalPoint(table->rows[device * table->numberOfParameters + i]));
+				}
+			}
+		}
+	}
+
+	for (size_t i = 0; i < n; i++)
+	{
+		initialWidths[i] = 0.0;
+
+		for (size_t b = 0; b < numberOfBoxes; b++)
+		{
+			initialWidths[i] = fmax(initialWidths[i], boxes[b * n + i].upper - boxes[b * n + i].lower);
+		}
+	}
+
+	for (size_t b = 0; b < numberOfBoxes; b++)
+	{
+		Interval	enclosure[kOutputDistributionIndexMax];
+
+		evaluateBox(&boxes[b * n], enclosure, result);
+
+		for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+		{
+			result->initialEnclosure[o] = intervalHull(result->initialEnclosure[o], enclosure[o]);
+		}
+	}
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		result->enclosure[o].lower = searchBound(boxes, numberOfBoxes, initialWidths, o, false, maxEvaluations, result);
+		result->enclosure[o].upper = searchBound(boxes, numberOfBoxes, initialWidths, o, true, maxEvaluations, result);
+	}
+
+	free(boxes);
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		if (isnan(result->enclosure[o].lower) || isnan(result->enclosure[o].upper))
+		{
+			fprintf(stderr, "Error: The interval evaluation of the conversion routines failed.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+printIntervalBoundsResult(const IntervalBoundsResult *  result, const char *  outputNames[kOutputDistributionIndexMax])
+{
+	printf("Guaranteed bounds (%zu interval evaluations):\n", result->numberOfEvaluations);
+	printf("%-16s %29s %29s %29s\n", "Output", "Single evaluation", "Enclosure", "Attained");
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		printf("%-16s [%13.6lf, %13.6lf] [%13.6lf, %13.6lf] [%13.6lf, %13.6lf]\n",
+			outputNames[o],
+			result->initialEnclosure[o].lower,
+			result->initialEnclosure[o].upper,
+			result->enclosure[o].lower,
+			result->enclosure[o].upper,
+			result->attained[o].lower,
+			result->attained[o].upper);
+	}
+
+	return;
+}
@@ -0,0 +1,157 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "model.h"
+
+typedef enum
+{
+	/*
+	 *	Largest number of interval evaluations per bound of every output, whatever `-M`. Each
+	 *	evaluation takes about ten microseconds, and past this many the enclosures of the sensor
+	 *	outputs only tighten in their seventh significant digit.
+	 */
+	kIntervalConstantMaxEvaluationsPerBound	= 4096,
+} IntervalConstant;
+
+/*
+ *	Closed interval of real numbers. Every operation on intervals rounds its bounds outwards by
+ *	one unit in the last place, so the result encloses the exact result for all real numbers in
+ *	the operands despite the rounding of double-precision arithmetic.
+ */
+typedef struct Interval
+{
+	double		lower;
+	double		upper;
+} Interval;
+
+typedef struct IntervalBoundsResult
+{
+	/*
+	 *	Number of interval evaluations of the conversion routines.
+	 */
+	size_t		numberOfEvaluations;
+	/*
+	 *	Enclosures from a single evaluation over the whole input box (per calibration device
+	 *	for joint sampling), and after adaptive subdivision.
+	 */
+	Interval	initialEnclosure[kOutputDistributionIndexMax];
+	Interval	enclosure[kOutputDistributionIndexMax];
+	/*
+	 *	Range of the outputs at the centres of the evaluated boxes: the exact range of every
+	 *	output contains it, so its distance to the enclosure bounds how loose the enclosure is.
+	 */
+	Interval	attained[kOutputDistributionIndexMax];
+} IntervalBoundsResult;
+
+/**
+ *	@brief	Interval of a single number.
+ *
+ *	@param	value	: The number.
+ *	@return		: The interval [value, value].
+ */
+Interval			intervalPoint(double value);
+
+/**
+ *	@brief	Sum of two intervals.
+ *
+ *	@param	a	: The first interval.
+ *	@param	b	: The second interval.
+ *	@return		: An enclosure of a + b.
+ */
+Interval			intervalAdd(Interval a, Interval b);
+
+/**
+ *	@brief	Difference of two intervals.
+ *
+ *	@param	a	: The first interval.
+ *	@param	b	: The second interval.
+ *	@return		: An enclosure of a - b.
+ */
+Interval			intervalSubtract(Interval a, Interval b);
+
+/**
+ *	@brief	Product of two intervals.
+ *
+ *	@param	a	: The first interval.
+ *	@param	b	: The second interval.
+ *	@return		: An enclosure of a * b.
+ */
+Interval			intervalMultiply(Interval a, Interval b);
+
+/**
+ *	@brief	Quotient of two intervals.
+ *
+ *	@param	a	: The dividend.
+ *	@param	b	: The divisor.
+ *	@return		: An enclosure of a / b, or the whole real line if `b` contains zero.
+ */
+Interval			intervalDivide(Interval a, Interval b);
+
+/**
+ *	@brief	Square of an interval, which unlike `intervalMultiply(a, a)` is never negative.
+ *
+ *	@param	a	: The interval.
+ *	@return		: An enclosure of a^2.
+ */
+Interval			intervalSquare(Interval a);
+
+/**
+ *	@brief	Evaluate the BME680 conversion routines on intervals of the raw ADC inputs and
+ *		calibration parameters. The formulas are those of `conversionModelEvaluateWithJacobian()`;
+ *		where the pressure scale term may truncate to zero, the enclosure of pressure also
+ *		holds the zero that `calc_pressure()` returns there.
+ *
+ *	@param	inputs	: Array of `kConversionModelConstantMaxInputs` intervals of the inputs.
+ *	@param	outputs	: Array of `kOutputDistributionIndexMax` entries to store the enclosures of the outputs.
+ */
+void				intervalConversionRoutines(const Interval *  inputs, Interval *  outputs);
+
+/**
+ *	@brief	Enclose the range of all outputs of a conversion model over the supports of its
+ *		raw ADC inputs and the range of its calibration parameters. Starting from a single
+ *		interval evaluation, the box with the loosest bound of each output is bisected along
+ *		its relatively widest input, up to `maxEvaluations` evaluations per bound but no
+ *		more than `kIntervalConstantMaxEvaluationsPerBound`. The cost is therefore at most
+ *		two bounds times `kOutputDistributionIndexMax` outputs times that many evaluations.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	maxEvaluations	: Largest number of evaluations per bound of every output.
+ *	@param	result		: Pointer to store the result.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runIntervalBounds(const ConversionModel *  model, size_t maxEvaluations, IntervalBoundsResult *  result);
+
+/**
+ *	@brief	Print the result of interval bounds.
+ *
+ *	@param	result		: Pointer to the result.
+ *	@param	outputNames	: Names of the outputs.
+ */
+void				printIntervalBoundsResult(const IntervalBoundsResult *  result, const char *  outputNames[kOutputDistributionIndexMax]);
@@ -0,0 +1,213 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include "kernelcheck.h"
+#include "sampling.h"
+#include "dual.h"
+#include "interval.h"
+#include "particle.h"
+#include "moments.h"
+
+/*
+ *	Largest difference between a transcription and the driver, relative to the larger of one
+ *	and the magnitude of the output. The driver computes in single precision and the
+ *	transcriptions in double precision, so their difference is the rounding of the driver,
+ *	while a wrong constant or term in a transcription differs by far more.
+ */
+static const double	kKernelCheckRelativeTolerance = 1e-4;
+
+/**
+ *	@brief	Compare the outputs of a transcription of the conversion routines with those of the driver.
+ *
+ *	@param	name		: Name of the transcription, for the error message.
+ *	@param	outputs		: The outputs of the transcription.
+ *	@param	expected	: The outputs of the driver.
+ *	@param	outputNames	: Names of the outputs, for the error message.
+ *	@param	point		: Index of the point, for the error message.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if the outputs match, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+compareOutputs(const char *  name, const double *  outputs, const float *  expected, const char *  outputNames[kOutputDistributionIndexMax], size_t point)
+{
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		if (!(fabs(outputs[o] - expected[o]) <= kKernelCheckRelativeTolerance * fmax(1.0, fabs(expected[o]))))
+		{
+			fprintf(stderr, "Error: The %s transcription of the conversion routines gives %s = %le instead of %le at check point %zu.\n",
+				name,
+				outputNames[o],
+				outputs[o],
+				(double) expected[o],
+				point);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Evaluate the outputs from the polynomial coefficients of moment propagation, with the
+ *		humidity clamp that moment propagation applies separately.
+ *
+ *	@param	inputs		: The raw ADC inputs and calibration parameters.
+ *	@param	inputMean	: The means of the inputs, at which the polynomials are centred.
+ *	@param	outputs		: Array of `kOutputDistributionIndexMax` entries to store the outputs.
+ */
+static void
+evaluateMomentPolynomials(const double *  inputs, const double *  inputMean, double *  outputs)
+{
+	double	pressure[4];
+	double	humidity[3];
+	double	pressureOffset = inputs[kInputDistributionIndexForPressureRawADCValue] - inputMean[kInputDistributionIndexForPressureRawADCValue];
+	double	humidityOffset = inputs[kInputDistributionIndexForHumidityRawADCValue] - inputMean[kInputDistributionIndexForHumidityRawADCValue];
+
+	momentsConditionalPolynomials(
+		inputs[kInputDistributionIndexForTemperatureRawADCValue],
+		&inputs[kInputDistributionIndexMax],
+		inputMean[kInputDistributionIndexForPressureRawADCValue],
+		inputMean[kInputDistributionIndexForHumidityRawADCValue],
+		&outputs[kOutputDistributionIndexForTemperature],
+		pressure,
+		humidity);
+
+	outputs[kOutputDistributionIndexForPressure] = pressure[0] + pressureOffset * (pressure[1] + pressureOffset * (pressure[2] + pressureOffset * pressure[3]));
+	outputs[kOutputDistributionIndexForHumidity] = fmin(fmax(humidity[0] + humidityOffset * (humidity[1] + humidityOffset * humidity[2]), 0.0), 100.0);
+
+	return;
+}
+
+CommonConstantReturnType
+kernelCheckConversionRoutines(const ConversionModel *  model, const char *  outputNames[kOutputDistributionIndexMax])
+{
+	const size_t		n = kConversionModelConstantMaxInputs;
+	CommandLineArguments	allOutputs = *model->arguments;
+	Sampler			sampler;
+	double			inputMean[kConversionModelConstantMaxInputs];
+	double			inputCovariance[kConversionModelConstantMaxInputs * kConversionModelConstantMaxInputs];
+
+	/*
+	 *	The driver computes pressure and humidity only if they are selected.
+	 */
+	allOutputs.common.outputSelect = kOutputDistributionIndexMax;
+
+	if (samplerInit(&sampler, kSamplingMethodPseudoRandom, kKernelCheckConstantSeed, kKernelCheckConstantNumberOfPoints, conversionModelNumberOfInputs(model)) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	conversionModelInputMoments(model, inputMean, inputCovariance);
+
+	for (size_t point = 0; point < kKernelCheckConstantNumberOfPoints; point++)
+	{
+		double			samplePoint[kConversionModelConstantMaxInputs];
+		double			inputs[kConversionModelConstantMaxInputs];
+		float			inputVariables[kInputDistributionIndexMax];
+		float			parameters[kBME680ConstantsNumberOfCalibrationParameters];
+		float			expected[kOutputDistributionIndexMax];
+		double			outputs[kOutputDistributionIndexMax];
+		Dual			dualInputs[kConversionModelConstantMaxInputs];
+		Dual			dualOutputs[kOutputDistributionIndexMax];
+		Interval		intervalInputs[kConversionModelConstantMaxInputs];
+		Interval		intervalOutputs[kOutputDistributionIndexMax];
+		ParticleDistribution	particleInputs[kConversionModelConstantMaxInputs];
+		ParticleDistribution	particleOutputs[kOutputDistributionIndexMax];
+
+		samplerGetPoint(&sampler, point, samplePoint);
+		conversionModelInputValues(model, samplePoint, inputs);
+
+		for (size_t i = 0; i < n; i++)
+		{
+			if (i < kInputDistributionIndexMax)
+			{
+				inputVariables[i] = (float) inputs[i];
+			}
+			else
+			{
+				parameters[i - kInputDistributionIndexMax] = (float) inputs[i];
+			}
+
+			dualInputs[i] = dualConstant(inputs[i]);
+			intervalInputs[i] = intervalPoint(inputs[i]);
+			particleInputs[i] = particleConstant(inputs[i]);
+		}
+
+		calculateBME680ConversionRoutines(
+			&allOutputs,
+			inputVariables,
+			expected,
+			&parameters[0],
+			&parameters[kBME680ConstantsNumberOfTemperatureParameters],
+			&parameters[kBME680ConstantsNumberOfTemperatureParameters + kBME680ConstantsNumberOfPressureParameters]);
+
+		dualConversionRoutines(dualInputs, dualOutputs);
+
+		for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+		{
+			outputs[o] = dualOutputs[o].value;
+		}
+
+		if (compareOutputs("dual-number", outputs, expected, outputNames, point) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		intervalConversionRoutines(intervalInputs, intervalOutputs);
+
+		for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+		{
+			outputs[o] = 0.5 * (intervalOutputs[o].lower + intervalOutputs[o].upper);
+		}
+
+		if (compareOutputs("interval", outputs, expected, outputNames, point) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (particleConversionRoutines(particleInputs, particleOutputs) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+		{
+			outputs[o] = particleMean(&particleOutputs[o]);
+		}
+
+		if (compareOutputs("particle", outputs, expected, outputNames, point) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		evaluateMomentPolynomials(inputs, inputMean, outputs);
+
+		if (compareOutputs("moment-propagation", outputs, expected, outputNames, point) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
@@ -0,0 +1,55 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "model.h"
+
+typedef enum
+{
+	/*
+	 *	Number of random points of the inputs of a conversion model at which every
+	 *	transcription of the conversion routines is checked against the driver.
+	 */
+	kKernelCheckConstantNumberOfPoints	= 64,
+	/*
+	 *	Seed of the random points, fixed so that a failing check can be reproduced.
+	 */
+	kKernelCheckConstantSeed		= 1,
+} KernelCheckConstant;
+
+/**
+ *	@brief	Check that the transcriptions of the BME680 conversion routines that the analyses
+ *		run on their own number types (dual numbers, intervals, particle distributions, and
+ *		the polynomial coefficients of moment propagation) match
+ *		`calculateBME680ConversionRoutines()` at random points of the inputs of a conversion
+ *		model.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	outputNames	: Names of the outputs, for the error message.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if all transcriptions match, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	kernelCheckConversionRoutines(const ConversionModel *  model, const char *  outputNames[kOutputDistributionIndexMax]);
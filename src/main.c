@@ -33,99 +33,1038 @@
 #include "bme680.h"
 #include "utilities.h"
 #include "common.h"
+#include "estimators.h"
+#include "model.h"
+#include "sensitivity.h"
+#include "importance.h"
+#include "delta.h"
+#include "unscented.h"
+#include "moments.h"
+#include "density.h"
+#include "kernelcheck.h"
+#include "interval.h"
+#include "gradient.h"
+#include "particle.h"
+#include "pce.h"
+#include "grid.h"
+#include "checkpoint.h"
+#include "shard.h"
+#include "placement.h"
+#include "reservoir.h"
 
+typedef enum
+{
+	/*
+	 *	Number of native Monte Carlo iterations whose inputs are drawn together in one batch.
+	 *	It is also the block that `placementFirstTouchSamples()` gives to every thread.
+	 */
+	kMonteCarloConstantBlockSize	= kPlacementConstantBlockSize,
+	/*
+	 *	Largest number of iterations whose 32-bit samples a run with 16-bit codes (`-Q`) holds
+	 *	at a time.
+	 */
+	kMonteCarloConstantQuantizedSegmentSize	= 1024 * kMonteCarloConstantBlockSize,
+	/*
+	 *	Number of first iterations of a run with 16-bit codes from whose range the
+	 *	`quantized16` codes follow.
+	 */
+	kMonteCarloConstantQuantizedPilotSize	= 64 * kMonteCarloConstantBlockSize,
+} MonteCarloConstant;
+
+/*
+ *	Native Monte Carlo run that stores its samples as 16-bit codes (`-Q`). The iterations run in
+ *	segments into 32-bit buffers, the running statistics take the exact samples from them, and
+ *	then the codes of the samples go to the sample stores.
+ */
+typedef struct QuantizedRun
+{
+	SampleStore *			outputStore;
+	/*
+	 *	Store of the codes of the control-variate samples, which only the sample file of
+	 *	`-D file` needs, or `NULL`.
+	 */
+	SampleStore *			controlStore;
+	float *				outputBuffer;
+	float *				controlBuffer;
+	bool				hasQuantizers;
+	QuantizationError		error;
+	MonteCarloRunningStatistics	statistics;
+	/*
+	 *	Histogram of the codes of the outputs, for the quantiles of adaptive Monte Carlo (`-q`),
+	 *	or with `NULL` counts.
+	 */
+	SampleCodeHistogram		histogram;
+} QuantizedRun;
+
+/**
+ *	@brief	Set distributions for input variables via UxHw calls if they are not already set from command line.
+ *
+ *	@param	inputVariables	: The input variables.
+ */
+static void
+setInputVariables(CommandLineArguments *  arguments, float *  inputVariables)
+{
+	if (!arguments->isInputSetFromCommandLine[kInputDistributionIndexForTemperatureRawADCValue])
+	{
+		inputVariables[kInputDistributionIndexForTemperatureRawADCValue] = UxHwFloatUniformDist(
+											kBME680ConstantsTemperatureRawADCValueLowerBound,
+											kBME680ConstantsTemperatureRawADCValueUpperBound);
+	}
+
+	if (!arguments->isInputSetFromCommandLine[kInputDistributionIndexForPressureRawADCValue])
+	{
+		inputVariables[kInputDistributionIndexForPressureRawADCValue] = UxHwFloatUniformDist(
+											kBME680ConstantsPressureRawADCValueLowerBound,
+											kBME680ConstantsPressureRawADCValueUpperBound);
+	}
+
+	if (!arguments->isInputSetFromCommandLine[kInputDistributionIndexForHumidityRawADCValue])
+	{
+		inputVariables[kInputDistributionIndexForHumidityRawADCValue] = UxHwFloatUniformDist(
+											kBME680ConstantsHumidityRawADCValueLowerBound,
+											kBME680ConstantshumidityRawADCValueUpperBound);
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Run the native Monte Carlo iterations. Every iteration draws its inputs from `sampler` by
+ *		its index alone and maps them through the preloaded input distributions, so iterations
+ *		are independent and the loop runs in parallel when built with OpenMP. Iterations run in
+ *		blocks, and each block draws all of its values of one input with a single batched call.
+ *
+ *	@param	arguments		: Pointer to command-line arguments struct.
+ *	@param	sampler			: Pointer to the sampler for the raw ADC inputs.
+ *	@param	firstIteration		: Index of the first iteration to run.
+ *	@param	numberOfIterations	: Number of iterations to run.
+ *	@param	inputDistributions	: The distributions of the input variables.
+ *	@param	temperatureParameters	: The temperature calibration parameters.
+ *	@param	pressureParameters	: The pressure calibration parameters.
+ *	@param	humidityParameters	: The humidity calibration parameters.
+ *	@param	calibrationTable	: Calibration parameters of all devices to draw from in every iteration,
+ *					  or `NULL` to use the parameters above.
+ *	@param	correlatedSampler	: Copula that correlates the raw ADC inputs, or `NULL` for independent inputs.
+ *	@param	monteCarloOutputSamples	: Array to store the selected output of each iteration, from iteration `firstIteration` on.
+ *	@param	monteCarloControlSamples: Array to store the temperature output of each iteration, from iteration `firstIteration` on, or `NULL`.
+ */
+static void
+runMonteCarloIterations(
+	CommandLineArguments *	arguments,
+	const Sampler *		sampler,
+	size_t			firstIteration,
+	size_t			numberOfIterations,
+	const InputDistribution *	inputDistributions,
+	float *			temperatureParameters,
+	float *			pressureParameters,
+	float *			humidityParameters,
+	const CalibrationTable *	calibrationTable,
+	const CorrelatedSampler *	correlatedSampler,
+	float *			monteCarloOutputSamples,
+	float *			monteCarloControlSamples)
+{
+	size_t	numberOfBlocks = (numberOfIterations + kMonteCarloConstantBlockSize - 1) / kMonteCarloConstantBlockSize;
+
+	#pragma omp parallel for schedule(static) proc_bind(spread)
+	for (size_t block = 0; block < numberOfBlocks; ++block)
+	{
+		size_t	blockStart = firstIteration + block * kMonteCarloConstantBlockSize;
+		size_t	blockSize = firstIteration + numberOfIterations - blockStart;
+		double	samplePoint[kSamplingConstantMaxDimensions];
+		double	uniforms[kInputDistributionIndexMax][kMonteCarloConstantBlockSize];
+		float	inputSamples[kInputDistributionIndexMax][kMonteCarloConstantBlockSize];
+		float	calibrationSamples[kMonteCarloConstantBlockSize][kBME680ConstantsNumberOfCalibrationParameters];
+		double	correlationState[kCorrelationConstantMaxVariables];
+		bool	isCorrelationStateValid = false;
+
+		blockSize = (blockSize < kMonteCarloConstantBlockSize) ? blockSize : kMonteCarloConstantBlockSize;
+
+		for (size_t j = 0; j < blockSize; j++)
+		{
+			samplerGetPoint(sampler, blockStart + j, samplePoint);
+
+			if (correlatedSampler != NULL)
+			{
+				correlatedSamplerTransformPoint(correlatedSampler, sampler, blockStart + j, samplePoint, correlationState, &isCorrelationStateValid);
+			}
+
+			for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+			{
+				uniforms[k][j] = samplePoint[k];
+			}
+
+			/*
+			 *	The calibration parameters take the sampler dimensions after the raw ADC inputs.
+			 */
+			if (calibrationTable != NULL)
+			{
+				calibrationTableDraw(calibrationTable, arguments->calibrationSampling, &samplePoint[kInputDistributionIndexMax], calibrationSamples[j]);
+			}
+		}
+
+		/*
+		 *	Correlated uniform variates need the monotone quantile functions of the inputs, so that
+		 *	the dependence carries over to the inputs.
+		 */
+		for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+		{
+			if (correlatedSampler != NULL)
+			{
+				inputDistributionQuantileBatch(&inputDistributions[k], uniforms[k], inputSamples[k], blockSize);
+			}
+			else
+			{
+				inputDistributionFromUniformBatch(&inputDistributions[k], uniforms[k], inputSamples[k], blockSize);
+			}
+		}
+
+		for (size_t j = 0; j < blockSize; j++)
+		{
+			size_t	i = blockStart + j - firstIteration;
+			float	inputVariables[kInputDistributionIndexMax];
+			float	outputVariables[kOutputDistributionIndexMax];
+
+			for (size_t k = 0; k < kInputDistributionIndexMax; k++)
+			{
+				inputVariables[k] = inputSamples[k][j];
+			}
+
+			if (calibrationTable != NULL)
+			{
+				calculateBME680ConversionRoutines(arguments,
+						inputVariables,
+						outputVariables,
+						&calibrationSamples[j][0],
+						&calibrationSamples[j][kBME680ConstantsNumberOfTemperatureParameters],
+						&calibrationSamples[j][kBME680ConstantsNumberOfTemperatureParameters + kBME680ConstantsNumberOfPressureParameters]);
+			}
+			else
+			{
+				calculateBME680ConversionRoutines(arguments,
+						inputVariables,
+						outputVariables,
+						temperatureParameters,
+						pressureParameters,
+						humidityParameters);
+			}
+
+			monteCarloOutputSamples[i] = outputVariables[arguments->common.outputSelect];
+
+			if (monteCarloControlSamples != NULL)
+			{
+				monteCarloControlSamples[i] = outputVariables[kOutputDistributionIndexForTemperature];
+			}
+		}
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Number of iterations that every call of `runMonteCarloIterations()` runs in a native
+ *		Monte Carlo run: the batch of adaptive Monte Carlo, the checkpoint interval, or all
+ *		iterations. The sample stores touch their pages in the same segments.
+ *
+ *	@param	arguments	: Pointer to command-line arguments struct.
+ *	@return			: Number of iterations of a segment.
+ */
+static size_t
+monteCarloSegmentSize(const CommandLineArguments *  arguments)
+{
+	if (arguments->isAdaptiveMode)
+	{
+		/*
+		 *	Keep antithetic pairs within a batch.
+		 */
+		if ((arguments->samplingMethod == kSamplingMethodAntithetic) && ((arguments->adaptiveBatchSize % 2) != 0))
+		{
+			return arguments->adaptiveBatchSize + 1;
+		}
+
+		return arguments->adaptiveBatchSize;
+	}
+
+	if (arguments->useCheckpoint)
+	{
+		return arguments->checkpointInterval;
+	}
+
+	return arguments->common.numberOfMonteCarloIterations;
+}
+
+/**
+ *	@brief	Number of iterations that every call of `runMonteCarloIterations()` runs in a run
+ *		with 16-bit codes (`-Q`): the segment of `monteCarloSegmentSize()`, at most
+ *		`kMonteCarloConstantQuantizedSegmentSize`.
+ *
+ *	@param	arguments	: Pointer to command-line arguments struct.
+ *	@return			: Number of iterations of a segment.
+ */
+static size_t
+quantizedSegmentSize(const CommandLineArguments *  arguments)
+{
+	size_t	segmentSize = monteCarloSegmentSize(arguments);
+
+	return (segmentSize < kMonteCarloConstantQuantizedSegmentSize) ? segmentSize : kMonteCarloConstantQuantizedSegmentSize;
+}
+
+/**
+ *	@brief	Run the native Monte Carlo iterations from `firstIteration` up to `-M` in segments of
+ *		`-I` iterations, saving the samples to the checkpoint after every segment.
+ *
+ *	@param	arguments		: Pointer to command-line arguments struct.
+ *	@param	sampler			: Pointer to the sampler for the raw ADC inputs.
+ *	@param	firstIteration		: Index of the first iteration to run (the iterations before it come from the checkpoint).
+ *	@param	inputDistributions	: The distributions of the input variables.
+ *	@param	temperatureParameters	: The temperature calibration parameters.
+ *	@param	pressureParameters	: The pressure calibration parameters.
+ *	@param	humidityParameters	: The humidity calibration parameters.
+ *	@param	calibrationTable	: Calibration parameters of all devices to draw from in every iteration,
+ *					  or `NULL` to use the parameters above.
+ *	@param	correlatedSampler	: Copula that correlates the raw ADC inputs, or `NULL` for independent inputs.
+ *	@param	monteCarloOutputSamples	: Array to store the selected output of each iteration.
+ *	@param	monteCarloControlSamples: Array to store the temperature output of each iteration, or `NULL`.
+ *	@param	checkpoint		: Pointer to the checkpoint, or `NULL` to run all iterations in one segment.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+runCheckpointedMonteCarloIterations(
+	CommandLineArguments *	arguments,
+	const Sampler *		sampler,
+	size_t			firstIteration,
+	const InputDistribution *	inputDistributions,
+	float *			temperatureParameters,
+	float *			pressureParameters,
+	float *			humidityParameters,
+	const CalibrationTable *	calibrationTable,
+	const CorrelatedSampler *	correlatedSampler,
+	float *			monteCarloOutputSamples,
+	float *			monteCarloControlSamples,
+	Checkpoint *		checkpoint)
+{
+	size_t	numberOfIterations = arguments->common.numberOfMonteCarloIterations;
+	size_t	segmentSize = (checkpoint != NULL) ? monteCarloSegmentSize(arguments) : numberOfIterations;
+
+	for (size_t i = firstIteration; i < numberOfIterations; i += segmentSize)
+	{
+		size_t	numberOfSegmentIterations = (numberOfIterations - i < segmentSize) ? (numberOfIterations - i) : segmentSize;
+
+		runMonteCarloIterations(
+			arguments,
+			sampler,
+			i,
+			numberOfSegmentIterations,
+			inputDistributions,
+			temperatureParameters,
+			pressureParameters,
+			humidityParameters,
+			calibrationTable,
+			correlatedSampler,
+			&monteCarloOutputSamples[i],
+			(monteCarloControlSamples != NULL) ? &monteCarloControlSamples[i] : NULL);
+
+		if ((checkpoint != NULL) &&
+			(checkpointSave(checkpoint, monteCarloOutputSamples, monteCarloControlSamples, i + numberOfSegmentIterations) != kCommonConstantReturnTypeSuccess))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Set up a run with 16-bit codes (`-Q`) over its open sample stores.
+ *
+ *	@param	run		: Pointer to the run to set up.
+ *	@param	arguments	: Pointer to command-line arguments struct.
+ *	@param	outputStore	: Pointer to the store of the codes of the outputs.
+ *	@param	controlStore	: Pointer to the store of the codes of the control-variate samples, or `NULL`.
+ */
+static void
+quantizedRunInit(QuantizedRun *  run, const CommandLineArguments *  arguments, SampleStore *  outputStore, SampleStore *  controlStore)
+{
+	size_t	bufferSize = quantizedSegmentSize(arguments);
+
+	bufferSize = (bufferSize > kMonteCarloConstantQuantizedPilotSize) ? bufferSize : kMonteCarloConstantQuantizedPilotSize;
+	*run = (QuantizedRun) {
+		.outputStore	= outputStore,
+		.controlStore	= controlStore,
+		.outputBuffer	= (float *) checkedMalloc(bufferSize * sizeof(float), __FILE__, __LINE__),
+		.controlBuffer	= NULL,
+		.hasQuantizers	= false,
+	};
+
+	if (arguments->useControlVariate)
+	{
+		run->controlBuffer = (float *) checkedMalloc(bufferSize * sizeof(float), __FILE__, __LINE__);
+	}
+}
+
+/**
+ *	@brief	Set up the quantizers of a run with 16-bit codes from the samples of a pilot in its
+ *		buffers.
+ *
+ *	@param	run			: Pointer to the run.
+ *	@param	arguments		: Pointer to command-line arguments struct.
+ *	@param	numberOfPilotIterations	: Number of iterations of the pilot.
+ */
+static void
+quantizedRunSetQuantizers(QuantizedRun *  run, const CommandLineArguments *  arguments, size_t numberOfPilotIterations)
+{
+	run->outputStore->quantizer = sampleQuantizerForPilotSamples(arguments->samplePrecision, run->outputBuffer, numberOfPilotIterations);
+
+	if (run->controlStore != NULL)
+	{
+		run->controlStore->quantizer = sampleQuantizerForPilotSamples(arguments->samplePrecision, run->controlBuffer, numberOfPilotIterations);
+	}
+
+	if (arguments->isAdaptiveMode && (arguments->adaptiveStoppingCriterion.numberOfQuantiles > 0))
+	{
+		sampleCodeHistogramInit(&run->histogram, &run->outputStore->quantizer);
+	}
+
+	run->hasQuantizers = true;
+}
+
+/**
+ *	@brief	Run native Monte Carlo iterations whose samples are stored as 16-bit codes (`-Q`), in
+ *		segments of at most `kMonteCarloConstantQuantizedSegmentSize` iterations. The exact
+ *		samples of every segment go into the running statistics and the quantization error
+ *		before their codes go into the sample stores. The quantizers come from a pilot of
+ *		the first `kMonteCarloConstantQuantizedPilotSize` iterations of the run, which are
+ *		the start of its first segment unless that is shorter.
+ *
+ *	@param	arguments		: Pointer to command-line arguments struct.
+ *	@param	sampler			: Pointer to the sampler for the raw ADC inputs.
+ *	@param	firstIteration		: Index of the first iteration to run.
+ *	@param	numberOfIterations	: Number of iterations to run.
+ *	@param	inputDistributions	: The distributions of the input variables.
+ *	@param	temperatureParameters	: The temperature calibration parameters.
+ *	@param	pressureParameters	: The pressure calibration parameters.
+ *	@param	humidityParameters	: The humidity calibration parameters.
+ *	@param	calibrationTable	: Calibration parameters of all devices to draw from in every iteration,
+ *					  or `NULL` to use the parameters above.
+ *	@param	correlatedSampler	: Copula that correlates the raw ADC inputs, or `NULL` for independent inputs.
+ *	@param	run			: Pointer to the run.
+ */
+static void
+runQuantizedMonteCarloIterations(
+	CommandLineArguments *	arguments,
+	const Sampler *		sampler,
+	size_t			firstIteration,
+	size_t			numberOfIterations,
+	const InputDistribution *	inputDistributions,
+	float *			temperatureParameters,
+	float *			pressureParameters,
+	float *			humidityParameters,
+	const CalibrationTable *	calibrationTable,
+	const CorrelatedSampler *	correlatedSampler,
+	QuantizedRun *		run)
+{
+	size_t	segmentSize = quantizedSegmentSize(arguments);
+	size_t	numberOfPilotIterations = (arguments->common.numberOfMonteCarloIterations < kMonteCarloConstantQuantizedPilotSize)
+						? arguments->common.numberOfMonteCarloIterations
+						: kMonteCarloConstantQuantizedPilotSize;
+	bool	isAntithetic = (arguments->samplingMethod == kSamplingMethodAntithetic);
+
+	/*
+	 *	A first batch of adaptive Monte Carlo shorter than the pilot runs the pilot on its own.
+	 */
+	if (!run->hasQuantizers && (numberOfIterations < numberOfPilotIterations))
+	{
+		runMonteCarloIterations(
+			arguments,
+			sampler,
+			0,
+			numberOfPilotIterations,
+			inputDistributions,
+			temperatureParameters,
+			pressureParameters,
+			humidityParameters,
+			calibrationTable,
+			correlatedSampler,
+			run->outputBuffer,
+			run->controlBuffer);
+		quantizedRunSetQuantizers(run, arguments, numberOfPilotIterations);
+	}
+
+	for (size_t i = firstIteration; i < firstIteration + numberOfIterations; i += segmentSize)
+	{
+		size_t	numberOfSegmentIterations = (firstIteration + numberOfIterations - i < segmentSize) ? (firstIteration + numberOfIterations - i) : segmentSize;
+
+		runMonteCarloIterations(
+			arguments,
+			sampler,
+			i,
+			numberOfSegmentIterations,
+			inputDistributions,
+			temperatureParameters,
+			pressureParameters,
+			humidityParameters,
+			calibrationTable,
+			correlatedSampler,
+			run->outputBuffer,
+			run->controlBuffer);
+
+		if (!run->hasQuantizers)
+		{
+			quantizedRunSetQuantizers(run, arguments, numberOfPilotIterations);
+		}
+
+		monteCarloRunningStatisticsAdd(&run->statistics, run->outputBuffer, run->controlBuffer, numberOfSegmentIterations, isAntithetic);
+		sampleStoreEncode(run->outputStore, i, run->outputBuffer, numberOfSegmentIterations, &run->error);
+
+		if (run->controlStore != NULL)
+		{
+			sampleStoreEncode(run->controlStore, i, run->controlBuffer, numberOfSegmentIterations, NULL);
+		}
+
+		if (run->histogram.counts != NULL)
+		{
+			sampleCodeHistogramAdd(&run->histogram, &run->outputStore->codes[i], numberOfSegmentIterations);
+		}
+	}
+}
+
+/**
+ *	@brief	Free the buffers and histogram of a run with 16-bit codes. The sample stores stay open.
+ *
+ *	@param	run	: Pointer to the run.
+ */
+static void
+quantizedRunFree(QuantizedRun *  run)
+{
+	free(run->outputBuffer);
+	free(run->controlBuffer);
+	sampleCodeHistogramFree(&run->histogram);
+	run->outputBuffer = NULL;
+	run->controlBuffer = NULL;
+}
+
+/**
+ *	@brief	Mean of the temperature control variate for the distribution of the temperature raw ADC input.
+ *
+ *	@param	inputDistributions	: The distributions of the input variables.
+ *	@param	temperatureParameters	: The temperature calibration parameters.
+ *	@return				: Mean of the calibrated temperature.
+ */
+static double
+calculateControlVariateMean(const InputDistribution *  inputDistributions, const float *  temperatureParameters)
+{
+	const InputDistribution *	distribution = &inputDistributions[kInputDistributionIndexForTemperatureRawADCValue];
+
+	return calculateTemperatureMean(inputDistributionMean(distribution), inputDistributionVariance(distribution), temperatureParameters);
+}
+
+/**
+ *	@brief	Run adaptive Monte Carlo: run batches of iterations until the stopping criterion
+ *		holds or `-M` iterations have run.
+ *
+ *	@param	arguments		: Pointer to command-line arguments struct.
+ *	@param	sampler			: Pointer to the sampler for the raw ADC inputs.
+ *	@param	inputDistributions	: The distributions of the input variables.
+ *	@param	temperatureParameters	: The temperature calibration parameters.
+ *	@param	pressureParameters	: The pressure calibration parameters.
+ *	@param	humidityParameters	: The humidity calibration parameters.
+ *	@param	calibrationTable	: Calibration parameters of all devices to draw from in every iteration,
+ *					  or `NULL` to use the parameters above.
+ *	@param	correlatedSampler	: Copula that correlates the raw ADC inputs, or `NULL` for independent inputs.
+ *	@param	monteCarloOutputSamples	: Array to store the selected output of each iteration, or `NULL` with `quantizedRun`.
+ *	@param	monteCarloControlSamples: Array to store the temperature output of each iteration, or `NULL`.
+ *	@param	quantizedRun		: Pointer to the run with 16-bit codes that stores the samples instead
+ *					  of the arrays above, or `NULL`.
+ *	@param	checkpoint		: Pointer to the checkpoint to save to every `-I` iterations, or `NULL`.
+ *	@param	iterationsRun		: Pointer to the number of iterations run, which holds the iterations loaded
+ *					  from the checkpoint on entry.
+ *	@param	hasConverged		: Pointer to store whether the stopping criterion holds.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+runAdaptiveMonteCarloIterations(
+	CommandLineArguments *	arguments,
+	const Sampler *		sampler,
+	const InputDistribution *	inputDistributions,
+	float *			temperatureParameters,
+	float *			pressureParameters,
+	float *			humidityParameters,
+	const CalibrationTable *	calibrationTable,
+	const CorrelatedSampler *	correlatedSampler,
+	float *			monteCarloOutputSamples,
+	float *			monteCarloControlSamples,
+	QuantizedRun *		quantizedRun,
+	Checkpoint *		checkpoint,
+	size_t *		iterationsRun,
+	bool *			hasConverged)
+{
+	size_t				maximumIterations = arguments->common.numberOfMonteCarloIterations;
+	size_t				batchSize = monteCarloSegmentSize(arguments);
+	size_t				lastCheckpoint = *iterationsRun;
+	double				largestHalfWidth = INFINITY;
+	float *				scratch = NULL;
+	bool				isAntithetic = (arguments->samplingMethod == kSamplingMethodAntithetic);
+	MonteCarloRunningStatistics	sampleStatistics = {0};
+	MonteCarloRunningStatistics *	statistics = (quantizedRun != NULL) ? &quantizedRun->statistics : &sampleStatistics;
+
+	/*
+	 *	The codes of a run with 16-bit codes give the quantiles through their histogram.
+	 */
+	if ((arguments->adaptiveStoppingCriterion.numberOfQuantiles > 0) && (quantizedRun == NULL))
+	{
+		scratch = (float *) checkedMalloc(maximumIterations * sizeof(float), __FILE__, __LINE__);
+	}
+
+	/*
+	 *	A resumed run may have converged before it was interrupted.
+	 */
+	*hasConverged = false;
+
+	if (*iterationsRun > 0)
+	{
+		monteCarloRunningStatisticsAdd(statistics, monteCarloOutputSamples, monteCarloControlSamples, *iterationsRun, isAntithetic);
+		*hasConverged = hasMonteCarloConverged(
+					&arguments->adaptiveStoppingCriterion,
+					statistics,
+					monteCarloOutputSamples,
+					NULL,
+					scratch,
+					&largestHalfWidth);
+	}
+
+	while ((*iterationsRun < maximumIterations) && !*hasConverged)
+	{
+		size_t	numberOfIterations = (maximumIterations - *iterationsRun < batchSize) ? (maximumIterations - *iterationsRun) : batchSize;
+
+		if (quantizedRun != NULL)
+		{
+			runQuantizedMonteCarloIterations(
+				arguments,
+				sampler,
+				*iterationsRun,
+				numberOfIterations,
+				inputDistributions,
+				temperatureParameters,
+				pressureParameters,
+				humidityParameters,
+				calibrationTable,
+				correlatedSampler,
+				quantizedRun);
+		}
+		else
+		{
+			runMonteCarloIterations(
+				arguments,
+				sampler,
+				*iterationsRun,
+				numberOfIterations,
+				inputDistributions,
+				temperatureParameters,
+				pressureParameters,
+				humidityParameters,
+				calibrationTable,
+				correlatedSampler,
+				&monteCarloOutputSamples[*iterationsRun],
+				(monteCarloControlSamples != NULL) ? &monteCarloControlSamples[*iterationsRun] : NULL);
+			monteCarloRunningStatisticsAdd(
+				statistics,
+				&monteCarloOutputSamples[*iterationsRun],
+				(monteCarloControlSamples != NULL) ? &monteCarloControlSamples[*iterationsRun] : NULL,
+				numberOfIterations,
+				isAntithetic);
+		}
+
+		*iterationsRun += numberOfIterations;
+
+		*hasConverged = hasMonteCarloConverged(
+					&arguments->adaptiveStoppingCriterion,
+					statistics,
+					monteCarloOutputSamples,
+					(quantizedRun != NULL) ? &quantizedRun->histogram : NULL,
+					scratch,
+					&largestHalfWidth);
+
+		if ((checkpoint != NULL) && ((*iterationsRun - lastCheckpoint >= arguments->checkpointInterval) || *hasConverged || (*iterationsRun == maximumIterations)))
+		{
+			if (checkpointSave(checkpoint, monteCarloOutputSamples, monteCarloControlSamples, *iterationsRun) != kCommonConstantReturnTypeSuccess)
+			{
+				free(scratch);
+
+				return kCommonConstantReturnTypeError;
+			}
+
+			lastCheckpoint = *iterationsRun;
+		}
+	}
+
+	free(scratch);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Run the analysis selected with `-A` instead of plain Monte Carlo iterations, print its
+ *		results, and free the input distributions and calibration table.
+ *
+ *	@param	arguments		: Pointer to command-line arguments struct.
+ *	@param	inputDistributions	: The distributions of the input variables.
+ *	@param	temperatureParameters	: The temperature calibration parameters.
+ *	@param	pressureParameters	: The pressure calibration parameters.
+ *	@param	humidityParameters	: The humidity calibration parameters.
+ *	@param	calibrationTable	: Calibration parameters of all devices (empty for fixed calibration parameters).
+ *	@param	outputVariableNames	: Names of the outputs.
+ *	@return				: `EXIT_SUCCESS` if successful, else `EXIT_FAILURE`.
+ */
+static int
+runAnalysis(
+	CommandLineArguments *	arguments,
+	InputDistribution *	inputDistributions,
+	float *			temperatureParameters,
+	float *			pressureParameters,
+	float *			humidityParameters,
+	CalibrationTable *	calibrationTable,
+	const char *		outputVariableNames[kOutputDistributionIndexMax])
+{
+	ConversionModel		model = {
+					.arguments		= arguments,
+					.inputDistributions	= inputDistributions,
+					.temperatureParameters	= temperatureParameters,
+					.pressureParameters	= pressureParameters,
+					.humidityParameters	= humidityParameters,
+					.calibrationTable	= (arguments->calibrationSampling != kCalibrationSamplingFixed) ? calibrationTable : NULL,
+					/*
+					 *	Importance sampling tilts the inputs towards the event, which
+					 *	only works if the outputs change monotonically with them, and a
+					 *	polynomial chaos expansion fits smooth functions best.
+					 */
+					.useQuantiles		= (arguments->analysisMode == kAnalysisModeImportance) || (arguments->analysisMode == kAnalysisModePolynomialChaos),
+				};
+	const char *		outputName = outputVariableNames[arguments->common.outputSelect];
+	int			ret = EXIT_SUCCESS;
+	clock_t			start = clock();
+
+	/*
+	 *	These analyses evaluate hand transcriptions of the conversion routines rather than
+	 *	the driver, so check the transcriptions against the driver before trusting them.
+	 */
+	if ((arguments->analysisMode == kAnalysisModeDelta) ||
+		(arguments->analysisMode == kAnalysisModeUnscented) ||
+		(arguments->analysisMode == kAnalysisModeMoments) ||
+		(arguments->analysisMode == kAnalysisModeInterval) ||
+		(arguments->analysisMode == kAnalysisModeGradient) ||
+		(arguments->analysisMode == kAnalysisModeParticle))
+	{
+		if (kernelCheckConversionRoutines(&model, outputVariableNames) != kCommonConstantReturnTypeSuccess)
+		{
+			ret = EXIT_FAILURE;
+		}
+	}
+
+	switch ((ret == EXIT_SUCCESS) ? arguments->analysisMode : kAnalysisModeNone)
+	{
+		case kAnalysisModeSensitivity:
+		{
+			SobolIndices	indices;
+
+			if (runSensitivityAnalysis(&model, arguments->common.numberOfMonteCarloIterations, &indices) != kCommonConstantReturnTypeSuccess)
+			{
+				ret = EXIT_FAILURE;
+
+				break;
+			}
+
+			printSobolIndices(&model, &indices, outputName);
+
+			break;
+		}
+
+		case kAnalysisModeImportance:
+		{
+			ImportanceSamplingResult	result;
+
+			if (runImportanceSampling(&model, &arguments->outputEvent, arguments->common.numberOfMonteCarloIterations, &result) != kCommonConstantReturnTypeSuccess)
+			{
+				ret = EXIT_FAILURE;
+
+				break;
+			}
+
+			printImportanceSamplingResult(&model, &arguments->outputEvent, &result, outputName);
+
+			break;
+		}
+
+		case kAnalysisModeDelta:
+		{
+			DeltaMethodResult	result;
+
+			if (runDeltaMethod(&model, &result) != kCommonConstantReturnTypeSuccess)
+			{
+				ret = EXIT_FAILURE;
+
+				break;
+			}
+
+			printDeltaMethodResult(&result, outputVariableNames);
+
+			break;
+		}
+
+		case kAnalysisModeUnscented:
+		{
+			UnscentedTransformResult	result;
+
+			if (runUnscentedTransform(&model, &result) != kCommonConstantReturnTypeSuccess)
+			{
+				ret = EXIT_FAILURE;
+
+				break;
+			}
+
+			printUnscentedTransformResult(&result, outputVariableNames);
+
+			break;
+		}
+
+		case kAnalysisModeMoments:
+		{
+			MomentPropagationResult	result;
+
+			if (runMomentPropagation(&model, arguments->momentOrder, &result) != kCommonConstantReturnTypeSuccess)
+			{
+				ret = EXIT_FAILURE;
+
+				break;
+			}
+
+			printMomentPropagationResult(&result, outputVariableNames);
+
+			break;
+		}
+
+		case kAnalysisModeDensity:
+		{
+			if (runTemperatureDensity(&model, &arguments->densityGrid, arguments->common.numberOfMonteCarloIterations) != kCommonConstantReturnTypeSuccess)
+			{
+				ret = EXIT_FAILURE;
+			}
+
+			break;
+		}
+
+		case kAnalysisModeInterval:
+		{
+			IntervalBoundsResult	result;
+
+			if (runIntervalBounds(&model, arguments->common.numberOfMonteCarloIterations, &result) != kCommonConstantReturnTypeSuccess)
+			{
+				ret = EXIT_FAILURE;
+
+				break;
+			}
+
+			printIntervalBoundsResult(&result, outputVariableNames);
+
+			break;
+		}
+
+		case kAnalysisModeGradient:
+		{
+			GradientAnalysisResult	result;
+
+			if (runGradientAnalysis(&model, arguments->common.numberOfMonteCarloIterations, &result) != kCommonConstantReturnTypeSuccess)
+			{
+				ret = EXIT_FAILURE;
+
+				break;
+			}
+
+			printGradientAnalysisResult(&result, outputName);
+
+			break;
+		}
+
+		case kAnalysisModeParticle:
+		{
+			ParticlePropagationResult	result;
+
+			if (runParticlePropagation(&model, arguments->common.numberOfMonteCarloIterations, &result) != kCommonConstantReturnTypeSuccess)
+			{
+				ret = EXIT_FAILURE;
+
+				break;
+			}
+
+			printParticlePropagationResult(&result, arguments->common.outputSelect, outputVariableNames);
+
+			break;
+		}
+
+		case kAnalysisModePolynomialChaos:
+		{
+			PolynomialChaosResult	result;
+
+			if (runPolynomialChaos(&model, arguments->polynomialChaosDegree, arguments->common.numberOfMonteCarloIterations, &result) != kCommonConstantReturnTypeSuccess)
+			{
+				ret = EXIT_FAILURE;
+
+				break;
+			}
+
+			printPolynomialChaosResult(&model, &result, outputVariableNames);
+
+			if (samplePolynomialChaosExpansion(&model, &result.expansion, arguments->common.numberOfMonteCarloIterations) != kCommonConstantReturnTypeSuccess)
+			{
+				ret = EXIT_FAILURE;
+			}
+
+			polynomialChaosExpansionFree(&result.expansion);
+
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+
+	if ((ret == EXIT_SUCCESS) && arguments->common.isTimingEnabled)
+	{
+		printf("\nCPU time used: %lf seconds\n", ((double)(clock() - start)) / CLOCKS_PER_SEC);
+	}
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		inputDistributionFree(&inputDistributions[i]);
+	}
+
+	calibrationTableFree(calibrationTable);
+
+	return ret;
+}
 
 /**
- *	@brief	Calculate the output of the BME680 conversion routines.
+ *	@brief	Run the iterations of shard `-P i/N` of the logical run and write its partial result.
+ *		All shards first run the same pilot iterations, so that they bin their outputs alike.
  *
- *	@param	arguments	: Pointer to command-line arguments struct.
- *	@param	inputVariables	: The input variables.
- *	@param	outputVariables	: The output variables.
+ *	@param	arguments		: Pointer to the command-line arguments struct.
+ *	@param	sampler			: Sampler of the logical run, with all `-M` iterations.
+ *	@param	inputDistributions	: Distributions of the raw ADC inputs.
+ *	@param	temperatureParameters	: The temperature calibration parameters.
+ *	@param	pressureParameters	: The pressure calibration parameters.
+ *	@param	humidityParameters	: The humidity calibration parameters.
+ *	@param	calibrationTable	: Calibration parameters of all devices, or `NULL` for fixed parameters.
+ *	@param	correlatedSampler	: Copula that correlates the raw ADC inputs, or `NULL` for independent inputs.
+ *	@param	configurationHash	: Hash of the configuration of the logical run.
+ *	@return				: `EXIT_SUCCESS` if successful, else `EXIT_FAILURE`.
  */
-static void
-calculateBME680ConversionRoutines(
+static int
+runShard(
 	CommandLineArguments *	arguments,
-	float *			inputVariables,
-	float *			outputVariables,
+	const Sampler *		sampler,
+	const InputDistribution *	inputDistributions,
 	float *			temperatureParameters,
 	float *			pressureParameters,
-	float *			humidityParameters)
+	float *			humidityParameters,
+	const CalibrationTable *	calibrationTable,
+	const CorrelatedSampler *	correlatedSampler,
+	uint64_t		configurationHash)
 {
-	bool	calculateAllOutputs = (arguments->common.outputSelect == kOutputDistributionIndexMax);
-
-	/*
-	 *	Not guarded because we need temperature calculation in all cases.
-	 */
-	outputVariables[kOutputDistributionIndexForTemperature] = calc_temperature(
-									inputVariables[kInputDistributionIndexForTemperatureRawADCValue],
-									temperatureParameters[0],
-									temperatureParameters[1],
-									temperatureParameters[2]);
+	size_t	numberOfPilotIterations = arguments->common.numberOfMonteCarloIterations;
+	size_t	firstIteration;
+	size_t		numberOfShardIterations;
+	float *		pilotSamples;
+	SampleStore	outputStore;
+	SampleStore	controlStore = {0};
+	double		binWidth;
+	int		ret = EXIT_SUCCESS;
+	clock_t		start = clock();
 
-	if (calculateAllOutputs || (arguments->common.outputSelect == kOutputDistributionIndexForPressure))
+	if (numberOfPilotIterations > kShardConstantPilotIterations)
 	{
-		outputVariables[kOutputDistributionIndexForPressure] = calc_pressure(
-										inputVariables[kInputDistributionIndexForPressureRawADCValue],
-										outputVariables[kOutputDistributionIndexForTemperature],
-										pressureParameters[0],
-										pressureParameters[1],
-										pressureParameters[2],
-										pressureParameters[3],
-										pressureParameters[4],
-										pressureParameters[5],
-										pressureParameters[6],
-										pressureParameters[7],
-										pressureParameters[8],
-										pressureParameters[9]) / 1000;
+		numberOfPilotIterations = kShardConstantPilotIterations;
 	}
 
-	if (calculateAllOutputs || (arguments->common.outputSelect == kOutputDistributionIndexForHumidity))
+	pilotSamples = (float *) checkedMalloc(numberOfPilotIterations * sizeof(float), __FILE__, __LINE__);
+	runMonteCarloIterations(
+		arguments,
+		sampler,
+		0,
+		numberOfPilotIterations,
+		inputDistributions,
+		temperatureParameters,
+		pressureParameters,
+		humidityParameters,
+		calibrationTable,
+		correlatedSampler,
+		pilotSamples,
+		NULL);
+	binWidth = shardHistogramBinWidth(pilotSamples, numberOfPilotIterations);
+	free(pilotSamples);
+
+	shardIterationRange(
+		arguments->common.numberOfMonteCarloIterations,
+		arguments->shardIndex,
+		arguments->numberOfShards,
+		&firstIteration,
+		&numberOfShardIterations);
+
+	if (sampleStoresOpen(
+			&outputStore,
+			arguments->useControlVariate ? &controlStore : NULL,
+			arguments->sampleStoreBackend,
+			arguments->sampleStorePath,
+			numberOfShardIterations,
+			numberOfShardIterations,
+			kSamplePrecisionFloat32) != kCommonConstantReturnTypeSuccess)
 	{
-		outputVariables[kOutputDistributionIndexForHumidity] = calc_humidity(
-										inputVariables[kInputDistributionIndexForHumidityRawADCValue],
-										outputVariables[kOutputDistributionIndexForTemperature],
-										humidityParameters[0],
-										humidityParameters[1],
-										humidityParameters[2],
-										humidityParameters[3],
-										humidityParameters[4],
-										humidityParameters[5],
-										humidityParameters[6]);
+		return EXIT_FAILURE;
 	}
 
-	return;
-}
+	runMonteCarloIterations(
+		arguments,
+		sampler,
+		firstIteration,
+		numberOfShardIterations,
+		inputDistributions,
+		temperatureParameters,
+		pressureParameters,
+		humidityParameters,
+		calibrationTable,
+		correlatedSampler,
+		outputStore.samples,
+		controlStore.samples);
 
-/**
- *	@brief	Set distributions for input variables via UxHw calls if they are not already set from command line.
- *
- *	@param	inputVariables	: The input variables.
- */
-static void
-setInputVariables(CommandLineArguments *  arguments, float *  inputVariables)
-{
-	if (!arguments->isInputSetFromCommandLine[kInputDistributionIndexForTemperatureRawADCValue])
+	if (shardPartialResultWrite(arguments, configurationHash, binWidth, outputStore.samples, controlStore.samples) != kCommonConstantReturnTypeSuccess)
 	{
-		inputVariables[kInputDistributionIndexForTemperatureRawADCValue] = UxHwFloatUniformDist(
-											kBME680ConstantsTemperatureRawADCValueLowerBound,
-											kBME680ConstantsTemperatureRawADCValueUpperBound);
+		ret = EXIT_FAILURE;
 	}
-
-	if (!arguments->isInputSetFromCommandLine[kInputDistributionIndexForPressureRawADCValue])
+	else
 	{
-		inputVariables[kInputDistributionIndexForPressureRawADCValue] = UxHwFloatUniformDist(
-											kBME680ConstantsPressureRawADCValueLowerBound,
-											kBME680ConstantsPressureRawADCValueUpperBound);
+		printf("Shard %zu of %zu: iterations [%zu, %zu) written to \"%s-%zu-of-%zu.part\"\n",
+			arguments->shardIndex,
+			arguments->numberOfShards,
+			firstIteration,
+			firstIteration + numberOfShardIterations,
+			arguments->partialResultPrefix,
+			arguments->shardIndex,
+			arguments->numberOfShards);
+
+		if (arguments->common.isTimingEnabled)
+		{
+			printf("\nCPU time used: %lf seconds\n", ((double)(clock() - start)) / CLOCKS_PER_SEC);
+		}
 	}
 
-	if (!arguments->isInputSetFromCommandLine[kInputDistributionIndexForHumidityRawADCValue])
+	if (sampleStoreSync(&outputStore, numberOfShardIterations) != kCommonConstantReturnTypeSuccess)
 	{
-		inputVariables[kInputDistributionIndexForHumidityRawADCValue] = UxHwFloatUniformDist(
-											kBME680ConstantsHumidityRawADCValueLowerBound,
-											kBME680ConstantshumidityRawADCValueUpperBound);
+		ret = EXIT_FAILURE;
 	}
 
-	return;
+	sampleStoreClose(&outputStore);
+	sampleStoreClose(&controlStore);
+
+	return ret;
 }
 
 int
@@ -141,6 +1080,20 @@ main(int argc, char *  argv[])
 	 *	Variable `inputVariables[2]` corresponds to the raw ADC value for the humidity reading.
 	 */
 	float			inputVariables[kInputDistributionIndexMax];
+	/*
+	 *	Distributions from which native Monte Carlo mode draws `inputVariables` in every iteration.
+	 */
+	InputDistribution	inputDistributions[kInputDistributionIndexMax] = {0};
+	/*
+	 *	Calibration parameters of all devices, when native Monte Carlo mode draws them in every iteration.
+	 */
+	CalibrationTable	calibrationTable = {0};
+	const CalibrationTable *	sampledCalibrationTable = NULL;
+	/*
+	 *	Copula of the raw ADC inputs, when native Monte Carlo mode draws them with correlation.
+	 */
+	CorrelatedSampler	correlatedSampler;
+	const CorrelatedSampler *	correlatedInputSampler = NULL;
 	/*
 	 *	Variable `outputVariables[0]` corresponds to the converted temperature reading.
 	 *	Variable `outputVariables[1]` corresponds to the converted pressure reading.
@@ -161,7 +1114,48 @@ main(int argc, char *  argv[])
 				};
 	float			benchmarkOutput;
 	float *			monteCarloOutputSamples = NULL;
+	float *			monteCarloControlSamples = NULL;
+	/*
+	 *	Memory behind `monteCarloOutputSamples` and `monteCarloControlSamples` (`-D`).
+	 */
+	SampleStore		outputSampleStore = {0};
+	SampleStore		controlSampleStore = {0};
+	/*
+	 *	Samples to write and print: all of `monteCarloOutputSamples`, or a uniform subset of `-L` of them.
+	 */
+	float *			monteCarloOutputReservoir = NULL;
+	float *			outputSamplesToPrint = NULL;
+	size_t			numberOfOutputSamplesToPrint = 0;
+	/*
+	 *	With `-Q`, the store holds the codes of the samples instead of `monteCarloOutputSamples`,
+	 *	and the codes to write and print are all of them or a subset of `-L` of them. Printing
+	 *	decodes them to `outputSamplesToPrint`.
+	 */
+	bool			isQuantized = false;
+	QuantizedRun		quantizedRun = {0};
+	uint16_t *		monteCarloOutputCodeReservoir = NULL;
+	uint16_t *		outputCodesToPrint = NULL;
+	float *			decodedOutputSamples = NULL;
+	Sampler			sampler;
+	/*
+	 *	Checkpoint file of the run, and the number of iterations loaded from it.
+	 */
+	Checkpoint		checkpoint = {0};
+	Checkpoint *		runCheckpoint = NULL;
+	size_t			numberOfResumedIterations = 0;
+	/*
+	 *	Hash of the configuration, which checkpoints and partial results of shards must match.
+	 */
+	uint64_t		configurationHash = 0;
+	ShardSummary		shardSummary;
+	/*
+	 *	Whether the samples of a merge are draws from the merged histogram of the shards.
+	 */
+	bool			areSamplesDrawnFromHistogram = false;
 	MeanAndVariance		monteCarloOutputMeanAndVariance = {0};
+	MonteCarloEstimate	monteCarloEstimate = {0};
+	bool			isVarianceReduced = false;
+	bool			hasAdaptiveRunConverged = false;
 	clock_t			start = 0;
 	clock_t			end = 0;
 	float			cpuTimeUsedInSeconds;
@@ -190,14 +1184,226 @@ main(int argc, char *  argv[])
 	}
 
 	/*
-	 *	Allocate for `monteCarloOutputSamples` if in Monte Carlo mode.
+	 *	The response-surface grid replaces the single evaluation of the inputs.
+	 */
+	if (arguments.responseGrid.isEnabled)
+	{
+		CommonConstantReturnType	ret;
+
+		start = clock();
+		ret = runResponseSurfaceGrid(&arguments, temperatureParameters, pressureParameters, humidityParameters);
+		end = clock();
+		responseGridFree(&arguments.responseGrid);
+
+		if (ret != kCommonConstantReturnTypeSuccess)
+		{
+			return EXIT_FAILURE;
+		}
+
+		if (arguments.common.isTimingEnabled)
+		{
+			printf("\nCPU time used: %lf seconds\n", ((double)(end - start)) / CLOCKS_PER_SEC);
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	/*
+	 *	Allocate for `monteCarloOutputSamples` and set up the input sampler if in Monte Carlo mode.
 	 */
 	if (arguments.common.isMonteCarloMode)
 	{
-		monteCarloOutputSamples = (float *) checkedMalloc(
-								arguments.common.numberOfMonteCarloIterations * sizeof(float),
-								__FILE__,
-								__LINE__);
+		if (loadInputDistributions(&arguments, inputVariables, inputDistributions) != kCommonConstantReturnTypeSuccess)
+		{
+			return EXIT_FAILURE;
+		}
+
+		if (arguments.calibrationSampling != kCalibrationSamplingFixed)
+		{
+			if (loadCalibrationTable(&arguments, &calibrationTable) != kCommonConstantReturnTypeSuccess)
+			{
+				return EXIT_FAILURE;
+			}
+
+			sampledCalibrationTable = &calibrationTable;
+		}
+
+		if (arguments.inputCorrelation != kInputCorrelationIndependent)
+		{
+			if (loadCorrelatedSampler(&arguments, &correlatedSampler) != kCommonConstantReturnTypeSuccess)
+			{
+				return EXIT_FAILURE;
+			}
+
+			correlatedInputSampler = &correlatedSampler;
+		}
+
+		if (arguments.analysisMode != kAnalysisModeNone)
+		{
+			return runAnalysis(
+					&arguments,
+					inputDistributions,
+					temperatureParameters,
+					pressureParameters,
+					humidityParameters,
+					&calibrationTable,
+					outputVariableNames);
+		}
+
+		if (samplerInit(
+				&sampler,
+				arguments.samplingMethod,
+				arguments.randomSeed,
+				arguments.common.numberOfMonteCarloIterations,
+				kInputDistributionIndexMax + calibrationSamplingNumberOfDimensions(&calibrationTable, arguments.calibrationSampling)) != kCommonConstantReturnTypeSuccess)
+		{
+			return EXIT_FAILURE;
+		}
+
+		if (arguments.useCheckpoint || (arguments.shardMode != kShardModeNone))
+		{
+			ConversionModel	model = {
+						.arguments		= &arguments,
+						.inputDistributions	= inputDistributions,
+						.temperatureParameters	= temperatureParameters,
+						.pressureParameters	= pressureParameters,
+						.humidityParameters	= humidityParameters,
+						.calibrationTable	= sampledCalibrationTable,
+					};
+
+			configurationHash = checkpointConfigurationHash(&model);
+		}
+
+		if (arguments.shardMode == kShardModeRun)
+		{
+			int	ret = runShard(
+					&arguments,
+					&sampler,
+					inputDistributions,
+					temperatureParameters,
+					pressureParameters,
+					humidityParameters,
+					sampledCalibrationTable,
+					correlatedInputSampler,
+					configurationHash);
+
+			for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+			{
+				inputDistributionFree(&inputDistributions[i]);
+			}
+
+			calibrationTableFree(&calibrationTable);
+
+			return ret;
+		}
+
+		/*
+		 *	Merging shards loads the samples of all iterations from their partial results. If
+		 *	the shards did not all save their samples, equal-mass draws from the merged histogram
+		 *	stand in for them.
+		 */
+		if (arguments.shardMode == kShardModeMerge)
+		{
+			if (shardPartialResultsMerge(
+					&arguments,
+					configurationHash,
+					&shardSummary,
+					&outputSampleStore,
+					&controlSampleStore) != kCommonConstantReturnTypeSuccess)
+			{
+				return EXIT_FAILURE;
+			}
+
+			if (outputSampleStore.samples == NULL)
+			{
+				if (sampleStoresOpen(
+						&outputSampleStore,
+						NULL,
+						arguments.sampleStoreBackend,
+						arguments.sampleStorePath,
+						arguments.common.numberOfMonteCarloIterations,
+						arguments.common.numberOfMonteCarloIterations,
+						kSamplePrecisionFloat32) != kCommonConstantReturnTypeSuccess)
+				{
+					shardSummaryFree(&shardSummary);
+
+					return EXIT_FAILURE;
+				}
+
+				shardSummaryQuantileDraws(&shardSummary, outputSampleStore.samples);
+				areSamplesDrawnFromHistogram = true;
+				fprintf(stderr, "Warning: Not all partial results hold their samples, so the outputs use equal-mass draws from the merged histogram, with the exact mean and variance. Run every shard with `-W` for the samples themselves.\n");
+
+				if (!arguments.common.isOutputJSONMode && !arguments.common.isBenchmarkingMode)
+				{
+					printShardSummary(&shardSummary, outputVariableNames[arguments.common.outputSelect]);
+					printf("\n");
+				}
+			}
+
+			shardSummaryFree(&shardSummary);
+		}
+		/*
+		 *	With `-Q`, the statistics take the exact control-variate samples as the iterations
+		 *	run, so their codes are only stored for the sample file of `-D file`.
+		 */
+		else if (arguments.samplePrecision != kSamplePrecisionFloat32)
+		{
+			isQuantized = true;
+
+			if (sampleStoresOpen(
+					&outputSampleStore,
+					(arguments.useControlVariate && (arguments.sampleStoreBackend == kSampleStoreBackendFile)) ? &controlSampleStore : NULL,
+					arguments.sampleStoreBackend,
+					arguments.sampleStorePath,
+					arguments.common.numberOfMonteCarloIterations,
+					quantizedSegmentSize(&arguments),
+					arguments.samplePrecision) != kCommonConstantReturnTypeSuccess)
+			{
+				return EXIT_FAILURE;
+			}
+
+			quantizedRunInit(
+				&quantizedRun,
+				&arguments,
+				&outputSampleStore,
+				(controlSampleStore.memory != NULL) ? &controlSampleStore : NULL);
+		}
+		else if (sampleStoresOpen(
+				&outputSampleStore,
+				arguments.useControlVariate ? &controlSampleStore : NULL,
+				arguments.sampleStoreBackend,
+				arguments.sampleStorePath,
+				arguments.common.numberOfMonteCarloIterations,
+				monteCarloSegmentSize(&arguments),
+				kSamplePrecisionFloat32) != kCommonConstantReturnTypeSuccess)
+		{
+			return EXIT_FAILURE;
+		}
+
+		monteCarloOutputSamples = outputSampleStore.samples;
+		monteCarloControlSamples = controlSampleStore.samples;
+
+		if (arguments.useCheckpoint)
+		{
+			if (checkpointOpen(
+					&checkpoint,
+					&arguments,
+					configurationHash,
+					monteCarloOutputSamples,
+					monteCarloControlSamples,
+					&numberOfResumedIterations) != kCommonConstantReturnTypeSuccess)
+			{
+				return EXIT_FAILURE;
+			}
+
+			runCheckpoint = &checkpoint;
+		}
+
+		/*
+		 *	Draws from a histogram carry neither antithetic pairs nor control-variate samples.
+		 */
+		isVarianceReduced = !areSamplesDrawnFromHistogram && (arguments.useControlVariate || (arguments.samplingMethod == kSamplingMethodAntithetic));
 	}
 
 	/*
@@ -209,9 +1415,85 @@ main(int argc, char *  argv[])
 	}
 
 	/*
-	 *	Execute process kernel in a loop. The size of loop is 1 unless in Monte Carlo mode.
+	 *	If in Monte Carlo mode, execute process kernel in a loop drawing the inputs from `sampler`.
+	 */
+	if (arguments.common.isMonteCarloMode)
+	{
+		/*
+		 *	In adaptive mode, the number of iterations that ran replaces `-M` for all later
+		 *	processing and output.
+		 */
+		CommonConstantReturnType	ret;
+
+		if (arguments.isAdaptiveMode)
+		{
+			size_t	iterationsRun = numberOfResumedIterations;
+
+			ret = runAdaptiveMonteCarloIterations(
+					&arguments,
+					&sampler,
+					inputDistributions,
+					temperatureParameters,
+					pressureParameters,
+					humidityParameters,
+					sampledCalibrationTable,
+					correlatedInputSampler,
+					monteCarloOutputSamples,
+					monteCarloControlSamples,
+					isQuantized ? &quantizedRun : NULL,
+					runCheckpoint,
+					&iterationsRun,
+					&hasAdaptiveRunConverged);
+			arguments.common.numberOfMonteCarloIterations = iterationsRun;
+		}
+		else if (arguments.shardMode == kShardModeMerge)
+		{
+			ret = kCommonConstantReturnTypeSuccess;
+		}
+		else if (isQuantized)
+		{
+			runQuantizedMonteCarloIterations(
+				&arguments,
+				&sampler,
+				0,
+				arguments.common.numberOfMonteCarloIterations,
+				inputDistributions,
+				temperatureParameters,
+				pressureParameters,
+				humidityParameters,
+				sampledCalibrationTable,
+				correlatedInputSampler,
+				&quantizedRun);
+			ret = kCommonConstantReturnTypeSuccess;
+		}
+		else
+		{
+			ret = runCheckpointedMonteCarloIterations(
+					&arguments,
+					&sampler,
+					numberOfResumedIterations,
+					inputDistributions,
+					temperatureParameters,
+					pressureParameters,
+					humidityParameters,
+					sampledCalibrationTable,
+					correlatedInputSampler,
+					monteCarloOutputSamples,
+					monteCarloControlSamples,
+					runCheckpoint);
+		}
+
+		checkpointClose(&checkpoint);
+
+		if (ret != kCommonConstantReturnTypeSuccess)
+		{
+			return EXIT_FAILURE;
+		}
+	}
+	/*
+	 *	Else, execute process kernel once.
 	 */
-	for (size_t i = 0; i < arguments.common.numberOfMonteCarloIterations; ++i)
+	else
 	{
 		/*
 		 *	Set inputs via UxHw calls if input from file is not enabled.
@@ -232,16 +1514,9 @@ main(int argc, char *  argv[])
 				humidityParameters);
 
 		/*
-		 *	If in Monte Carlo mode, populate `monteCarloOutputSamples`.
-		 */
-		if (arguments.common.isMonteCarloMode)
-		{
-			monteCarloOutputSamples[i] = outputVariables[arguments.common.outputSelect];
-		}
-		/*
-		 *	Else, if in benchmarking mode, populate `benchmarkOutput`.
+		 *	If in benchmarking mode, populate `benchmarkOutput`.
 		 */
-		else if (arguments.common.isBenchmarkingMode)
+		if (arguments.common.isBenchmarkingMode)
 		{
 			benchmarkOutput = outputVariables[arguments.common.outputSelect];
 		}
@@ -249,14 +1524,56 @@ main(int argc, char *  argv[])
 
 	/*
 	 *	If not doing Laplace version, then approximate the cost of the third phase of
-	 *	Monte Carlo (post-processing), by calculating the mean and variance.
+	 *	Monte Carlo (post-processing), by calculating the mean and variance. With `-Q`, the
+	 *	running statistics of the exact samples already hold them.
 	 */
 	if (arguments.common.isMonteCarloMode)
 	{
-		monteCarloOutputMeanAndVariance = calculateMeanAndVarianceOfFloatSamples(
-								monteCarloOutputSamples,
-								arguments.common.numberOfMonteCarloIterations);
+		if (isQuantized)
+		{
+			monteCarloOutputMeanAndVariance.mean = quantizedRun.statistics.mean;
+			monteCarloOutputMeanAndVariance.variance = (quantizedRun.statistics.numberOfSamples > 1)
+								? (quantizedRun.statistics.secondCentralSum / (quantizedRun.statistics.numberOfSamples - 1))
+								: 0.0;
+		}
+		else
+		{
+			monteCarloOutputMeanAndVariance = calculateMeanAndVarianceOfFloatSamples(
+									monteCarloOutputSamples,
+									arguments.common.numberOfMonteCarloIterations);
+		}
+
 		benchmarkOutput = monteCarloOutputMeanAndVariance.mean;
+
+		/*
+		 *	With variance reduction, the estimate of the mean comes from the antithetic pairs
+		 *	and/or the control-variate regression instead of the plain sample mean.
+		 */
+		if (isVarianceReduced)
+		{
+			double	controlMean = 0.0;
+
+			if (arguments.useControlVariate)
+			{
+				controlMean = calculateControlVariateMean(inputDistributions, temperatureParameters);
+			}
+
+			if (isQuantized)
+			{
+				monteCarloEstimate = monteCarloRunningStatisticsEstimate(&quantizedRun.statistics, controlMean);
+			}
+			else
+			{
+				monteCarloEstimate = estimateMonteCarloMean(
+							monteCarloOutputSamples,
+							monteCarloControlSamples,
+							controlMean,
+							arguments.common.numberOfMonteCarloIterations,
+							arguments.samplingMethod == kSamplingMethodAntithetic);
+			}
+
+			benchmarkOutput = monteCarloEstimate.mean;
+		}
 	}
 
 	/*
@@ -268,20 +1585,73 @@ main(int argc, char *  argv[])
 		cpuTimeUsedInSeconds = ((double)(end - start)) / CLOCKS_PER_SEC;
 	}
 
+	/*
+	 *	All statistics above use every sample. With `-L`, only a uniform random subset of the
+	 *	samples goes to the output, so its size does not grow with `-M`.
+	 */
+	outputSamplesToPrint = monteCarloOutputSamples;
+	outputCodesToPrint = outputSampleStore.codes;
+	numberOfOutputSamplesToPrint = arguments.common.numberOfMonteCarloIterations;
+
+	if (arguments.common.isMonteCarloMode && (arguments.maxOutputSamples > 0) &&
+		(arguments.common.numberOfMonteCarloIterations > arguments.maxOutputSamples))
+	{
+		if (isQuantized)
+		{
+			monteCarloOutputCodeReservoir = (uint16_t *) checkedMalloc(arguments.maxOutputSamples * sizeof(uint16_t), __FILE__, __LINE__);
+			numberOfOutputSamplesToPrint = reservoirSampleCodes(
+								outputSampleStore.codes,
+								arguments.common.numberOfMonteCarloIterations,
+								arguments.maxOutputSamples,
+								arguments.randomSeed,
+								monteCarloOutputCodeReservoir);
+			outputCodesToPrint = monteCarloOutputCodeReservoir;
+		}
+		else
+		{
+			monteCarloOutputReservoir = (float *) checkedMalloc(arguments.maxOutputSamples * sizeof(float), __FILE__, __LINE__);
+			numberOfOutputSamplesToPrint = reservoirSampleOutputs(
+								monteCarloOutputSamples,
+								arguments.common.numberOfMonteCarloIterations,
+								arguments.maxOutputSamples,
+								arguments.randomSeed,
+								monteCarloOutputReservoir);
+			outputSamplesToPrint = monteCarloOutputReservoir;
+		}
+	}
+
 	/*
 	 *	If in benchmarking mode, print timing result in a special format:
 	 *		(1) Benchmark output (for calculating Wasserstein distance to reference)
 	 *		(2) Time in microseconds
+	 *		(3) Effective sample size (only with variance reduction)
 	 */
 	if (arguments.common.isBenchmarkingMode)
 	{
-		printf("%lf %" PRIu64 "\n", benchmarkOutput, (uint64_t)(cpuTimeUsedInSeconds * 1000000));
+		if (isVarianceReduced)
+		{
+			printf("%lf %" PRIu64 " %lf\n", benchmarkOutput, (uint64_t)(cpuTimeUsedInSeconds * 1000000), monteCarloEstimate.effectiveSampleSize);
+		}
+		else
+		{
+			printf("%lf %" PRIu64 "\n", benchmarkOutput, (uint64_t)(cpuTimeUsedInSeconds * 1000000));
+		}
 	}
 	/*
 	 *	If not in benchmarking mode...
 	 */
 	else
 	{
+		/*
+		 *	With `-Q`, the printed samples are the values that their codes store.
+		 */
+		if (isQuantized)
+		{
+			decodedOutputSamples = (float *) checkedMalloc(numberOfOutputSamplesToPrint * sizeof(float), __FILE__, __LINE__);
+			sampleQuantizerDecode(&outputSampleStore.quantizer, outputCodesToPrint, numberOfOutputSamplesToPrint, decodedOutputSamples);
+			outputSamplesToPrint = decodedOutputSamples;
+		}
+
 		/*
 		 *	Print json outputs if in JSON output mode.
 		 */
@@ -294,7 +1664,8 @@ main(int argc, char *  argv[])
 				&arguments,
 				outputVariables,
 				outputVariableDescriptions,
-				monteCarloOutputSamples);
+				outputSamplesToPrint,
+				numberOfOutputSamplesToPrint);
 		}
 		/*
 		 *	Print human-consumable output if not in JSON output mode.
@@ -306,7 +1677,42 @@ main(int argc, char *  argv[])
 				outputVariables,
 				outputVariableNames,
 				outputVariableDescriptions,
-				monteCarloOutputSamples);
+				outputSamplesToPrint,
+				numberOfOutputSamplesToPrint);
+
+			/*
+			 *	Print the number of iterations that adaptive Monte Carlo used.
+			 */
+			if (arguments.isAdaptiveMode)
+			{
+				printf("\nMonte Carlo iterations used: %zu (%s)\n",
+					arguments.common.numberOfMonteCarloIterations,
+					hasAdaptiveRunConverged ? "converged" : "reached maximum before converging");
+			}
+
+			/*
+			 *	Print the number of iterations that came from the checkpoint.
+			 */
+			if (numberOfResumedIterations > 0)
+			{
+				printf("\nMonte Carlo iterations resumed from checkpoint: %zu\n", numberOfResumedIterations);
+			}
+
+			/*
+			 *	Print the variance-reduced estimate of the mean.
+			 */
+			if (isVarianceReduced)
+			{
+				printf("\nMean estimate: %lf (standard error: %lf, effective sample size: %lf)\n",
+					monteCarloEstimate.mean,
+					monteCarloEstimate.standardError,
+					monteCarloEstimate.effectiveSampleSize);
+			}
+
+			if (isQuantized)
+			{
+				printQuantizationError(&outputSampleStore.quantizer, &quantizedRun.error, sqrt(monteCarloOutputMeanAndVariance.variance));
+			}
 		}
 
 		/*
@@ -315,18 +1721,45 @@ main(int argc, char *  argv[])
 		if (arguments.common.isTimingEnabled)
 		{
 			printf("\nCPU time used: %lf seconds\n", cpuTimeUsedInSeconds);
+
+			if (arguments.common.isMonteCarloMode)
+			{
+				printPlacement();
+			}
 		}
 	}
 
 	/*
-	 *	Save Monte Carlo data to "data.out" if in Monte Carlo mode.
+	 *	Save Monte Carlo data to "data.out" if in Monte Carlo mode, streamed from the sample
+	 *	store, as 16-bit codes with `-Q`. With a file-backed sample store, the samples in their
+	 *	file are an extra output, which only needs to be written back.
 	 */
 	if (arguments.common.isMonteCarloMode)
 	{
-		saveMonteCarloFloatDataToDataDotOutFile(
-			monteCarloOutputSamples,
-			(uint64_t)(cpuTimeUsedInSeconds * 1000000),
-			arguments.common.numberOfMonteCarloIterations);
+		if (isQuantized)
+		{
+			if (saveMonteCarloCodesToDataDotOutFile(
+					&outputSampleStore.quantizer,
+					outputCodesToPrint,
+					(uint64_t)(cpuTimeUsedInSeconds * 1000000),
+					numberOfOutputSamplesToPrint) != kCommonConstantReturnTypeSuccess)
+			{
+				return EXIT_FAILURE;
+			}
+		}
+		else
+		{
+			saveMonteCarloFloatDataToDataDotOutFile(
+				outputSamplesToPrint,
+				(uint64_t)(cpuTimeUsedInSeconds * 1000000),
+				numberOfOutputSamplesToPrint);
+		}
+
+		if ((sampleStoreSync(&outputSampleStore, arguments.common.numberOfMonteCarloIterations) != kCommonConstantReturnTypeSuccess) ||
+			(sampleStoreSync(&controlSampleStore, arguments.common.numberOfMonteCarloIterations) != kCommonConstantReturnTypeSuccess))
+		{
+			return EXIT_FAILURE;
+		}
 	}
 	/*
 	 *	Save outputs to file if not in Monte Carlo mode and write to file is enabled.
@@ -352,7 +1785,19 @@ main(int argc, char *  argv[])
 	 */
 	if (arguments.common.isMonteCarloMode)
 	{
-		free(monteCarloOutputSamples);
+		sampleStoreClose(&outputSampleStore);
+		sampleStoreClose(&controlSampleStore);
+		free(monteCarloOutputReservoir);
+		quantizedRunFree(&quantizedRun);
+		free(monteCarloOutputCodeReservoir);
+		free(decodedOutputSamples);
+
+		for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+		{
+			inputDistributionFree(&inputDistributions[i]);
+		}
+
+		calibrationTableFree(&calibrationTable);
 	}
 
 	return EXIT_SUCCESS;
@@ -0,0 +1,392 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "bme680.h"
+#include "model.h"
+#include "dual.h"
+
+static const char *	kConversionModelInputNames[kConversionModelConstantMaxInputs] =
+			{
+				"temperature ADC",
+				"pressure ADC",
+				"humidity ADC",
+				"par_t1",
+				"par_t2",
+				"par_t3",
+				"par_p1",
+				"par_p2",
+				"par_p3",
+				"par_p4",
+				"par_p5",
+				"par_p6",
+				"par_p7",
+				"par_p8",
+				"par_p9",
+				"par_p10",
+				"par_h1",
+				"par_h2",
+				"par_h3",
+				"par_h4",
+				"par_h5",
+				"par_h6",
+				"par_h7",
+			};
+
+/**
+ *	@brief	Calculate the output of the BME680 conversion routines.
+ *
+ *	@param	arguments	: Pointer to command-line arguments struct.
+ *	@param	inputVariables	: The input variables.
+ *	@param	outputVariables	: The output variables.
+ */
+void
+calculateBME680ConversionRoutines(
+	CommandLineArguments *	arguments,
+	float *			inputVariables,
+	float *			outputVariables,
+	float *			temperatureParameters,
+	float *			pressureParameters,
+	float *			humidityParameters)
+{
+	bool	calculateAllOutputs = (arguments->common.outputSelect == kOutputDistributionIndexMax);
+
+	/*
+	 *	Not guarded because we need temperature calculation in all cases.
+	 */
+	outputVariables[kOutputDistributionIndexForTemperature] = calc_temperature(
+									inputVariables[kInputDistributionIndexForTemperatureRawADCValue],
+									temperatureParameters[0],
+									temperatureParameters[1],
+									temperatureParameters[2]);
+
+	if (calculateAllOutputs || (arguments->common.outputSelect == kOutputDistributionIndexForPressure))
+	{
+		outputVariables[kOutputDistributionIndexForPressure] = calc_pressure(
+										inputVariables[kInputDistributionIndexForPressureRawADCValue],
+										outputVariables[kOutputDistributionIndexForTemperature],
+										pressureParameters[0],
+										pressureParameters[1],
+										pressureParameters[2],
+										pressureParameters[3],
+										pressureParameters[4],
+										pressureParameters[5],
+										pressureParameters[6],
+										pressureParameters[7],
+										pressureParameters[8],
+										pressureParameters[9]) / 1000;
+	}
+
+	if (calculateAllOutputs || (arguments->common.outputSelect == kOutputDistributionIndexForHumidity))
+	{
+		outputVariables[kOutputDistributionIndexForHumidity] = calc_humidity(
+										inputVariables[kInputDistributionIndexForHumidityRawADCValue],
+										outputVariables[kOutputDistributionIndexForTemperature],
+										humidityParameters[0],
+										humidityParameters[1],
+										humidityParameters[2],
+										humidityParameters[3],
+										humidityParameters[4],
+										humidityParameters[5],
+										humidityParameters[6]);
+	}
+
+	return;
+}
+
+size_t
+conversionModelNumberOfInputs(const ConversionModel *  model)
+{
+	if (model->calibrationTable == NULL)
+	{
+		return kInputDistributionIndexMax;
+	}
+
+	return kInputDistributionIndexMax + calibrationSamplingNumberOfDimensions(model->calibrationTable, model->arguments->calibrationSampling);
+}
+
+const char *
+conversionModelInputName(const ConversionModel *  model, size_t inputIndex)
+{
+	/*
+	 *	Joint calibration sampling has a single input that selects the device.
+	 */
+	if ((inputIndex == kInputDistributionIndexMax) && (model->calibrationTable != NULL) && (model->arguments->calibrationSampling == kCalibrationSamplingJoint))
+	{
+		return "device";
+	}
+
+	return conversionModelVariableName(inputIndex);
+}
+
+/**
+ *	@brief	Map a point of the unit hypercube to the raw ADC inputs and calibration parameters
+ *		of a conversion model.
+ *
+ *	@param	model			: Pointer to the conversion model.
+ *	@param	samplePoint		: Point in (0, 1)^conversionModelNumberOfInputs().
+ *	@param	inputVariables		: Array of `kInputDistributionIndexMax` entries to store the raw ADC inputs.
+ *	@param	calibrationParameters	: Array of `kBME680ConstantsNumberOfCalibrationParameters` entries to store the calibration parameters.
+ */
+static void
+drawConversionModelInputs(const ConversionModel *  model, const double *  samplePoint, float *  inputVariables, float *  calibrationParameters)
+{
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		inputVariables[i] = model->useQuantiles ?
+					inputDistributionQuantile(&model->inputDistributions[i], samplePoint[i]) :
+					inputDistributionFromUniform(&model->inputDistributions[i], samplePoint[i]);
+	}
+
+	if (model->calibrationTable != NULL)
+	{
+		calibrationTableDraw(model->calibrationTable, model->arguments->calibrationSampling, &samplePoint[kInputDistributionIndexMax], calibrationParameters);
+
+		return;
+	}
+
+	memcpy(&calibrationParameters[0], model->temperatureParameters, kBME680ConstantsNumberOfTemperatureParameters * sizeof(float));
+	memcpy(&calibrationParameters[kBME680ConstantsNumberOfTemperatureParameters], model->pressureParameters, kBME680ConstantsNumberOfPressureParameters * sizeof(float));
+	memcpy(&calibrationParameters[kBME680ConstantsNumberOfTemperatureParameters + kBME680ConstantsNumberOfPressureParameters], model->humidityParameters, kBME680ConstantsNumberOfHumidityParameters * sizeof(float));
+
+	return;
+}
+
+float
+conversionModelEvaluate(const ConversionModel *  model, const double *  samplePoint, float *  outputVariables)
+{
+	float	inputVariables[kInputDistributionIndexMax];
+	float	calibrationParameters[kBME680ConstantsNumberOfCalibrationParameters];
+
+	drawConversionModelInputs(model, samplePoint, inputVariables, calibrationParameters);
+	calculateBME680ConversionRoutines(
+		model->arguments,
+		inputVariables,
+		outputVariables,
+		&calibrationParameters[0],
+		&calibrationParameters[kBME680ConstantsNumberOfTemperatureParameters],
+		&calibrationParameters[kBME680ConstantsNumberOfTemperatureParameters + kBME680ConstantsNumberOfPressureParameters]);
+
+	return outputVariables[model->arguments->common.outputSelect];
+}
+
+void
+conversionModelInputValues(const ConversionModel *  model, const double *  samplePoint, double *  inputs)
+{
+	float	inputVariables[kInputDistributionIndexMax];
+	float	calibrationParameters[kBME680ConstantsNumberOfCalibrationParameters];
+
+	drawConversionModelInputs(model, samplePoint, inputVariables, calibrationParameters);
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		inputs[i] = inputVariables[i];
+	}
+
+	for (size_t i = 0; i < kBME680ConstantsNumberOfCalibrationParameters; i++)
+	{
+		inputs[kInputDistributionIndexMax + i] = calibrationParameters[i];
+	}
+
+	return;
+}
+
+const char *
+conversionModelVariableName(size_t index)
+{
+	return (index < kConversionModelConstantMaxInputs) ? kConversionModelInputNames[index] : "unknown";
+}
+
+void
+conversionModelInputMoments(const ConversionModel *  model, double *  mean, double *  covariance)
+{
+	const size_t		n = kConversionModelConstantMaxInputs;
+	const CalibrationTable *	table = model->calibrationTable;
+
+	memset(covariance, 0, n * n * sizeof(double));
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		mean[i] = inputDistributionMean(&model->inputDistributions[i]);
+		covariance[i * n + i] = inputDistributionVariance(&model->inputDistributions[i]);
+	}
+
+	if (table == NULL)
+	{
+		for (size_t i = 0; i < kBME680ConstantsNumberOfTemperatureParameters; i++)
+		{
+			mean[kInputDistributionIndexMax + i] = model->temperatureParameters[i];
+		}
+
+		for (size_t i = 0; i < kBME680ConstantsNumberOfPressureParameters; i++)
+		{
+			mean[kInputDistributionIndexMax + kBME680ConstantsNumberOfTemperatureParameters + i] = model->pressureParameters[i];
+		}
+
+		for (size_t i = 0; i < kBME680ConstantsNumberOfHumidityParameters; i++)
+		{
+			mean[kInputDistributionIndexMax + kBME680ConstantsNumberOfTemperatureParameters + kBME680ConstantsNumberOfPressureParameters + i] = model->humidityParameters[i];
+		}
+
+		return;
+	}
+
+	/*
+	 *	Every device is drawn with the same probability, so these are population moments.
+	 */
+	for (size_t i = 0; i < kBME680ConstantsNumberOfCalibrationParameters; i++)
+	{
+		double	sum = 0.0;
+
+		for (size_t device = 0; device < table->numberOfDevices; device++)
+		{
+			sum += table->rows[device * table->numberOfParameters + i];
+		}
+
+		mean[kInputDistributionIndexMax + i] = sum / table->numberOfDevices;
+	}
+
+	for (size_t i = 0; i < kBME680ConstantsNumberOfCalibrationParameters; i++)
+	{
+		for (size_t j = 0; j <= i; j++)
+		{
+			double	sum = 0.0;
+
+			if ((i != j) && (model->arguments->calibrationSampling == kCalibrationSamplingIndependent))
+			{
+				continue;
+			}
+
+			for (size_t device = 0; device < table->numberOfDevices; device++)
+			{
+				const float *	row = &table->rows[device * table->numberOfParameters];
+
+				sum += (row[i] - mean[kInputDistributionIndexMax + i]) * (row[j] - mean[kInputDistributionIndexMax + j]);
+			}
+
+			covariance[(kInputDistributionIndexMax + i) * n + kInputDistributionIndexMax + j] = sum / table->numberOfDevices;
+			covariance[(kInputDistributionIndexMax + j) * n + kInputDistributionIndexMax + i] = sum / table->numberOfDevices;
+		}
+	}
+
+	return;
+}
+
+void
+conversionModelCovarianceFactor(const double *  covariance, double *  factor)
+{
+	const size_t	n = kConversionModelConstantMaxInputs;
+
+	memset(factor, 0, n * n * sizeof(double));
+
+	for (size_t j = 0; j < n; j++)
+	{
+		double	pivot = covariance[j * n + j];
+
+		for (size_t k = 0; k < j; k++)
+		{
+			pivot -= factor[j * n + k] * factor[j * n + k];
+		}
+
+		/*
+		 *	Relative to the variance of the input, so that the tolerance does not depend on
+		 *	its units.
+		 */
+		if (!(pivot > 1e-12 * covariance[j * n + j]))
+		{
+			continue;
+		}
+
+		factor[j * n + j] = sqrt(pivot);
+
+		for (size_t i = j + 1; i < n; i++)
+		{
+			double	sum = covariance[i * n + j];
+
+			for (size_t k = 0; k < j; k++)
+			{
+				sum -= factor[i * n + k] * factor[j * n + k];
+			}
+
+			factor[i * n + j] = sum / factor[j * n + j];
+		}
+	}
+
+	return;
+}
+
+void
+conversionModelEvaluateWithJacobian(const double *  inputs, double *  outputs, double *  jacobian)
+{
+	const size_t	n = kConversionModelConstantMaxInputs;
+	Dual		dualInputs[kConversionModelConstantMaxInputs];
+	Dual		dualOutputs[kOutputDistributionIndexMax];
+
+	for (size_t i = 0; i < n; i++)
+	{
+		dualInputs[i] = dualVariable(inputs[i], i);
+	}
+
+	dualConversionRoutines(dualInputs, dualOutputs);
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		outputs[o] = dualOutputs[o].value;
+
+		for (size_t i = 0; (jacobian != NULL) && (i < n); i++)
+		{
+			jacobian[o * n + i] = dualOutputs[o].gradient[i];
+		}
+	}
+
+	return;
+}
+
+void
+printConversionModelOutputCovariance(const double  covariance[kOutputDistributionIndexMax][kOutputDistributionIndexMax], const char *  outputNames[kOutputDistributionIndexMax])
+{
+	printf("Covariance:\n%-16s", "");
+
+	for (size_t p = 0; p < kOutputDistributionIndexMax; p++)
+	{
+		printf(" %14s", outputNames[p]);
+	}
+
+	printf("\n");
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		printf("%-16s", outputNames[o]);
+
+		for (size_t p = 0; p < kOutputDistributionIndexMax; p++)
+		{
+			printf(" %14.6le", covariance[o][p]);
+		}
+
+		printf("\n");
+	}
+
+	return;
+}
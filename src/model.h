@@ -0,0 +1,166 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "utilities.h"
+
+typedef enum
+{
+	kConversionModelConstantMaxInputs	= kInputDistributionIndexMax + kBME680ConstantsNumberOfCalibrationParameters,
+} ConversionModelConstant;
+
+/*
+ *	The BME680 conversion routines as a function of a point in the unit hypercube: the first
+ *	coordinates map through the distributions of the raw ADC inputs and, when the calibration
+ *	parameters are sampled, the remaining coordinates select calibration parameters from
+ *	`calibrationTable`. The analyses of native Monte Carlo mode evaluate the model through this.
+ */
+typedef struct ConversionModel
+{
+	CommandLineArguments *		arguments;
+	const InputDistribution *	inputDistributions;
+	float *				temperatureParameters;
+	float *				pressureParameters;
+	float *				humidityParameters;
+	/*
+	 *	Calibration parameters of all devices, or `NULL` for the fixed parameters above.
+	 */
+	const CalibrationTable *	calibrationTable;
+	/*
+	 *	Map the raw ADC coordinates through the quantile functions of their distributions rather
+	 *	than their alias tables, so that the outputs are monotone in these coordinates.
+	 */
+	bool				useQuantiles;
+} ConversionModel;
+
+/**
+ *	@brief	Calculate the output of the BME680 conversion routines.
+ *
+ *	@param	arguments		: Pointer to command-line arguments struct.
+ *	@param	inputVariables		: The input variables.
+ *	@param	outputVariables		: The output variables.
+ *	@param	temperatureParameters	: The temperature calibration parameters.
+ *	@param	pressureParameters	: The pressure calibration parameters.
+ *	@param	humidityParameters	: The humidity calibration parameters.
+ */
+void		calculateBME680ConversionRoutines(
+			CommandLineArguments *	arguments,
+			float *			inputVariables,
+			float *			outputVariables,
+			float *			temperatureParameters,
+			float *			pressureParameters,
+			float *			humidityParameters);
+
+/**
+ *	@brief	Number of coordinates of the sample points of a conversion model.
+ *
+ *	@param	model	: Pointer to the conversion model.
+ *	@return		: Number of uncertain inputs.
+ */
+size_t		conversionModelNumberOfInputs(const ConversionModel *  model);
+
+/**
+ *	@brief	Name of an input of a conversion model.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	inputIndex	: Index of the input.
+ *	@return			: Name of the input.
+ */
+const char *	conversionModelInputName(const ConversionModel *  model, size_t inputIndex);
+
+/**
+ *	@brief	Evaluate a conversion model at a point of the unit hypercube.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	samplePoint	: Point in (0, 1)^conversionModelNumberOfInputs().
+ *	@param	outputVariables	: Array of `kOutputDistributionIndexMax` entries to store the outputs.
+ *	@return			: The selected output.
+ */
+float		conversionModelEvaluate(const ConversionModel *  model, const double *  samplePoint, float *  outputVariables);
+
+/**
+ *	@brief	Raw ADC inputs and calibration parameters of a conversion model at a point of the
+ *		unit hypercube, as `conversionModelEvaluate()` draws them.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	samplePoint	: Point in (0, 1)^conversionModelNumberOfInputs().
+ *	@param	inputs		: Array of `kConversionModelConstantMaxInputs` entries to store the inputs and parameters.
+ */
+void		conversionModelInputValues(const ConversionModel *  model, const double *  samplePoint, double *  inputs);
+
+/**
+ *	@brief	Name of a raw ADC input or calibration parameter, in the order of
+ *		`conversionModelInputValues()`.
+ *
+ *	@param	index	: Index of the input or parameter.
+ *	@return		: Name of the input or parameter.
+ */
+const char *	conversionModelVariableName(size_t index);
+
+/**
+ *	@brief	Mean and covariance of the raw ADC inputs and calibration parameters of a conversion
+ *		model, in the order of `conversionModelInputName()` for independent calibration
+ *		sampling. Fixed calibration parameters have zero variance; parameters drawn from the
+ *		calibration table have the moments of its rows, uncorrelated for independent sampling.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	mean		: Array of `kConversionModelConstantMaxInputs` entries to store the means.
+ *	@param	covariance	: Row-major `kConversionModelConstantMaxInputs` x `kConversionModelConstantMaxInputs` array to store the covariance.
+ */
+void		conversionModelInputMoments(const ConversionModel *  model, double *  mean, double *  covariance);
+
+/**
+ *	@brief	Lower-triangular factor `L` with `L L^T = covariance` of the covariance of the inputs
+ *		of a conversion model. Columns whose pivot vanishes, such as those of constant inputs
+ *		or of the directions that a few calibration devices do not span, are zero.
+ *
+ *	@param	covariance	: Row-major `kConversionModelConstantMaxInputs` x `kConversionModelConstantMaxInputs` covariance.
+ *	@param	factor		: Row-major `kConversionModelConstantMaxInputs` x `kConversionModelConstantMaxInputs` array to store the factor.
+ */
+void		conversionModelCovarianceFactor(const double *  covariance, double *  factor);
+
+/**
+ *	@brief	Evaluate the BME680 conversion routines, and optionally their partial derivatives, in
+ *		double precision at given raw ADC inputs and calibration parameters. The formulas are
+ *		those of the floating-point `calc_temperature()`, `calc_pressure()` (in kPa), and
+ *		`calc_humidity()`, differentiated in forward mode by `dualConversionRoutines()`.
+ *		Where pressure is undefined or humidity is clamped, the derivatives are zero.
+ *
+ *	@param	inputs		: Array of `kConversionModelConstantMaxInputs` raw ADC inputs and calibration parameters.
+ *	@param	outputs		: Array of `kOutputDistributionIndexMax` entries to store the outputs.
+ *	@param	jacobian	: Row-major `kOutputDistributionIndexMax` x `kConversionModelConstantMaxInputs` array to store the partial derivatives, or `NULL`.
+ */
+void		conversionModelEvaluateWithJacobian(const double *  inputs, double *  outputs, double *  jacobian);
+
+/**
+ *	@brief	Print the covariance of the outputs of a conversion model.
+ *
+ *	@param	covariance	: The covariance.
+ *	@param	outputNames	: Names of the outputs.
+ */
+void		printConversionModelOutputCovariance(const double  covariance[kOutputDistributionIndexMax][kOutputDistributionIndexMax], const char *  outputNames[kOutputDistributionIndexMax]);
@@ -0,0 +1,565 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "moments.h"
+
+/*
+ *	Discrete representation of the distribution of one input: expectations over the input are
+ *	weighted sums over its nodes.
+ */
+typedef struct MomentNodes
+{
+	size_t		numberOfNodes;
+	double *	values;
+	double *	weights;
+	double		mean;
+	double		minimum;
+	double		maximum;
+} MomentNodes;
+
+/**
+ *	@brief	Gauss-Legendre nodes and weights on [-1, 1], from Newton iterations on the
+ *		three-term recurrence of the Legendre polynomials.
+ *
+ *	@param	numberOfNodes	: Number of nodes.
+ *	@param	nodes		: Array to store the nodes.
+ *	@param	weights		: Array to store the weights, which sum to 2.
+ */
+static void
+gaussLegendreRule(size_t numberOfNodes, double *  nodes, double *  weights)
+{
+	const double	pi = acos(-1.0);
+
+	for (size_t i = 0; i < numberOfNodes; i++)
+	{
+		double	x = cos(pi * (i + 0.75) / (numberOfNodes + 0.5));
+		double	derivative = 1.0;
+
+		for (int iteration = 0; iteration < 100; iteration++)
+		{
+			double	previous = 1.0;
+			double	current = x;
+			double	step;
+
+			for (size_t k = 2; k <= numberOfNodes; k++)
+			{
+				double	next = ((2.0 * k - 1.0) * x * current - (k - 1.0) * previous) / k;
+
+				previous = current;
+				current = next;
+			}
+
+			derivative = numberOfNodes * (x * current - previous) / (x * x - 1.0);
+			step = current / derivative;
+			x -= step;
+
+			if (fabs(step) < 1e-15)
+			{
+				break;
+			}
+		}
+
+		nodes[i] = x;
+		weights[i] = 2.0 / ((1.0 - x * x) * derivative * derivative);
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Nodes of an input distribution: the value of a constant, the outcomes of an empirical
+ *		distribution, and Gauss-Legendre nodes over the support of a uniform distribution.
+ *
+ *	@param	nodes		: Pointer to the nodes to initialize.
+ *	@param	distribution	: Pointer to the distribution.
+ */
+static void
+momentNodesInit(MomentNodes *  nodes, const InputDistribution *  distribution)
+{
+	size_t	numberOfNodes = 1;
+
+	if (distribution->kind == kInputDistributionKindUniform)
+	{
+		numberOfNodes = kMomentsConstantQuadratureNodes;
+	}
+	else if (distribution->kind == kInputDistributionKindEmpirical)
+	{
+		numberOfNodes = distribution->aliasTable.numberOfOutcomes;
+	}
+
+	*nodes = (MomentNodes) {
+		.numberOfNodes	= numberOfNodes,
+		.values		= (double *) checkedMalloc(numberOfNodes * sizeof(double), __FILE__, __LINE__),
+		.weights	= (double *) checkedMalloc(numberOfNodes * sizeof(double), __FILE__, __LINE__),
+		.mean		= inputDistributionMean(distribution),
+	};
+
+	switch (distribution->kind)
+	{
+		case kInputDistributionKindUniform:
+		{
+			double	halfWidth = 0.5 * (distribution->upperBound - distribution->lowerBound);
+
+			gaussLegendreRule(numberOfNodes, nodes->values, nodes->weights);
+
+			for (size_t i = 0; i < numberOfNodes; i++)
+			{
+				nodes->values[i] = nodes->mean + halfWidth * nodes->values[i];
+				nodes->weights[i] *= 0.5;
+			}
+
+			break;
+		}
+
+		case kInputDistributionKindEmpirical:
+		{
+			const AliasTable *	table = &distribution->aliasTable;
+
+			for (size_t i = 0; i < numberOfNodes; i++)
+			{
+				nodes->values[i] = table->values[i];
+				nodes->weights[i] = table->cumulativeProbabilities[i] - ((i > 0) ? table->cumulativeProbabilities[i - 1] : 0.0);
+			}
+
+			break;
+		}
+
+		default:
+		{
+			nodes->values[0] = distribution->value;
+			nodes->weights[0] = 1.0;
+
+			break;
+		}
+	}
+
+	nodes->minimum = nodes->values[0];
+	nodes->maximum = nodes->values[0];
+
+	for (size_t i = 1; i < numberOfNodes; i++)
+	{
+		nodes->minimum = fmin(nodes->minimum, nodes->values[i]);
+		nodes->maximum = fmax(nodes->maximum, nodes->values[i]);
+	}
+
+	/*
+	 *	A uniform distribution reaches beyond its outermost Gauss-Legendre nodes.
+	 */
+	if (distribution->kind == kInputDistributionKindUniform)
+	{
+		nodes->minimum = distribution->lowerBound;
+		nodes->maximum = distribution->upperBound;
+	}
+
+	return;
+}
+
+static void
+momentNodesFree(MomentNodes *  nodes)
+{
+	free(nodes->values);
+	free(nodes->weights);
+	nodes->values = NULL;
+	nodes->weights = NULL;
+
+	return;
+}
+
+/**
+ *	@brief	Central moments of an input, exact for all three kinds of distribution since the
+ *		Gauss-Legendre nodes integrate polynomials of these degrees exactly.
+ *
+ *	@param	nodes		: Pointer to the nodes of the input.
+ *	@param	centralMoments	: Array of `kMomentsConstantMaxDegree + 1` entries to store the moments.
+ */
+static void
+momentNodesCentralMoments(const MomentNodes *  nodes, double *  centralMoments)
+{
+	memset(centralMoments, 0, (kMomentsConstantMaxDegree + 1) * sizeof(double));
+
+	for (size_t i = 0; i < nodes->numberOfNodes; i++)
+	{
+		double	power = nodes->weights[i];
+
+		for (size_t m = 0; m <= kMomentsConstantMaxDegree; m++)
+		{
+			centralMoments[m] += power;
+			power *= nodes->values[i] - nodes->mean;
+		}
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Expectations of the powers 1 to `order` of a polynomial of a centred input.
+ *
+ *	@param	coefficients	: Coefficients of the polynomial, constant first.
+ *	@param	degree		: Degree of the polynomial.
+ *	@param	centralMoments	: Central moments of the input.
+ *	@param	order		: Highest power.
+ *	@param	expectations	: Array of `order + 1` entries to store the expectations.
+ */
+static void
+polynomialPowerExpectations(const double *  coefficients, size_t degree, const double *  centralMoments, size_t order, double *  expectations)
+{
+	double	power[kMomentsConstantMaxDegree + 1] = {1.0};
+	size_t	powerDegree = 0;
+
+	expectations[0] = 1.0;
+
+	for (size_t b = 1; b <= order; b++)
+	{
+		double	product[kMomentsConstantMaxDegree + 1] = {0};
+
+		for (size_t i = 0; i <= powerDegree; i++)
+		{
+			for (size_t j = 0; j <= degree; j++)
+			{
+				product[i + j] += power[i] * coefficients[j];
+			}
+		}
+
+		powerDegree += degree;
+		memcpy(power, product, sizeof(power));
+		expectations[b] = 0.0;
+
+		for (size_t m = 0; m <= powerDegree; m++)
+		{
+			expectations[b] += power[m] * centralMoments[m];
+		}
+	}
+
+	return;
+}
+
+void
+momentsConditionalPolynomials(
+	double		temperatureADC,
+	const double *	parameters,
+	double		pressureCentre,
+	double		humidityCentre,
+	double *	temperature,
+	double *	pressure,
+	double *	humidity)
+{
+	const double *	t = &parameters[0];
+	const double *	p = &parameters[kBME680ConstantsNumberOfTemperatureParameters];
+	const double *	h = &parameters[kBME680ConstantsNumberOfTemperatureParameters + kBME680ConstantsNumberOfPressureParameters];
+
+	/*
+	 *	Temperature, as `calc_temperature()`, is fixed by the temperature ADC input.
+	 */
+	double	a = temperatureADC / 16384.0 - t[0] / 1024.0;
+	double	b = temperatureADC / 131072.0 - t[0] / 8192.0;
+
+	*temperature = (a * t[1] + b * b * t[2] * 16.0) / 5120.0;
+
+	/*
+	 *	Pressure, as `calc_pressure()` in kPa, is a cubic polynomial of `c`, which is linear in
+	 *	the centred pressure ADC input `y` with the slope `-6250 / q`.
+	 */
+	double	v1 = 2560.0 * *temperature - 64000.0;
+	double	v2 = (v1 * v1 * p[5] / 131072.0 + 2.0 * v1 * p[4]) / 4.0 + p[3] * 65536.0;
+	double	u = (p[2] * v1 * v1 / 16384.0 + p[1] * v1) / 524288.0;
+	double	q = (1.0 + u / 32768.0) * p[0];
+
+	for (size_t j = 0; j < 4; j++)
+	{
+		pressure[j] = 0.0;
+	}
+
+	if ((int)q != 0)
+	{
+		double	c[2] = {
+				(1048576.0 - pressureCentre - v2 / 4096.0) * 6250.0 / q,
+				-6250.0 / q,
+			};
+		double	c2[3] = {c[0] * c[0], 2.0 * c[0] * c[1], c[1] * c[1]};
+		double	c3[4] = {c2[0] * c[0], c2[0] * c[1] + c2[1] * c[0], c2[1] * c[1] + c2[2] * c[0], c2[2] * c[1]};
+
+		for (size_t j = 0; j < 4; j++)
+		{
+			pressure[j] = (((j < 2) ? c[j] * (1.0 + p[7] / (32768.0 * 16.0)) : 0.0) +
+					((j < 3) ? c2[j] * p[8] / (2147483648.0 * 16.0) : 0.0) +
+					c3[j] * p[9] / (16777216.0 * 131072.0 * 16.0)) / 1000.0;
+		}
+
+		pressure[0] += p[6] * 8.0 / 1000.0;
+	}
+
+	/*
+	 *	Humidity, as `calc_humidity()` before its clamp, is a quadratic polynomial of the
+	 *	centred humidity ADC input `y` through `v2 = s (a0 + y)`.
+	 */
+	double	a0 = humidityCentre - (h[0] * 16.0 + h[2] / 2.0 * *temperature);
+	double	s = h[1] / 262144.0 * (1.0 + h[3] / 16384.0 * *temperature + h[4] / 1048576.0 * *temperature * *temperature);
+	double	k = h[5] / 16384.0 + h[6] / 2097152.0 * *temperature;
+
+	humidity[0] = s * a0 + k * s * s * a0 * a0;
+	humidity[1] = s + 2.0 * k * s * s * a0;
+	humidity[2] = k * s * s;
+
+	return;
+}
+
+CommonConstantReturnType
+runMomentPropagation(const ConversionModel *  model, size_t order, MomentPropagationResult *  result)
+{
+	const CalibrationTable *	table = model->calibrationTable;
+	size_t				numberOfDevices = (table != NULL) ? table->numberOfDevices : 1;
+	double				inputMean[kConversionModelConstantMaxInputs];
+	double				inputCovariance[kConversionModelConstantMaxInputs * kConversionModelConstantMaxInputs];
+	double				shift[kOutputDistributionIndexMax];
+	double				pressureMoments[kMomentsConstantMaxDegree + 1];
+	double				humidityMoments[kMomentsConstantMaxDegree + 1];
+	/*
+	 *	Moments about `shift`, which keeps the cancellation in the central moments small.
+	 */
+	double				rawMoments[kOutputDistributionIndexMax][kMomentsConstantMaxOrder + 1] = {{0}};
+	double				crossMoments[kOutputDistributionIndexMax][kOutputDistributionIndexMax] = {{0}};
+	MomentNodes			nodes[kInputDistributionIndexMax];
+
+	if ((table != NULL) && (model->arguments->calibrationSampling != kCalibrationSamplingJoint))
+	{
+		fprintf(stderr, "Error: Moment propagation supports fixed or jointly sampled calibration parameters only.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	*result = (MomentPropagationResult) {
+		.order	= order,
+	};
+
+	conversionModelInputMoments(model, inputMean, inputCovariance);
+	conversionModelEvaluateWithJacobian(inputMean, shift, NULL);
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		momentNodesInit(&nodes[i], &model->inputDistributions[i]);
+	}
+
+	momentNodesCentralMoments(&nodes[kInputDistributionIndexForPressureRawADCValue], pressureMoments);
+	momentNodesCentralMoments(&nodes[kInputDistributionIndexForHumidityRawADCValue], humidityMoments);
+
+	for (size_t device = 0; device < numberOfDevices; device++)
+	{
+		double	parameters[kBME680ConstantsNumberOfCalibrationParameters];
+
+		for (size_t i = 0; i < kBME680ConstantsNumberOfCalibrationParameters; i++)
+		{
+			parameters[i] = (table != NULL) ? table->rows[device * table->numberOfParameters + i] : inputMean[kInputDistributionIndexMax + i];
+		}
+
+		for (size_t node = 0; node < nodes[kInputDistributionIndexForTemperatureRawADCValue].numberOfNodes; node++)
+		{
+			double	temperatureADC = nodes[kInputDistributionIndexForTemperatureRawADCValue].values[node];
+			double	weight = nodes[kInputDistributionIndexForTemperatureRawADCValue].weights[node] / numberOfDevices;
+			double	conditionalMoments[kOutputDistributionIndexMax][kMomentsConstantMaxOrder + 1];
+
+			double	temperature;
+			double	pressure[4];
+			double	humidity[3];
+
+			momentsConditionalPolynomials(
+				temperatureADC,
+				parameters,
+				nodes[kInputDistributionIndexForPressureRawADCValue].mean,
+				nodes[kInputDistributionIndexForHumidityRawADCValue].mean,
+				&temperature,
+				pressure,
+				humidity);
+
+			for (size_t k = 0; k <= order; k++)
+			{
+				conditionalMoments[kOutputDistributionIndexForTemperature][k] = pow(temperature - shift[kOutputDistributionIndexForTemperature], k);
+			}
+
+			pressure[0] -= shift[kOutputDistributionIndexForPressure];
+			polynomialPowerExpectations(pressure, 3, pressureMoments, order, conditionalMoments[kOutputDistributionIndexForPressure]);
+
+			/*
+			 *	The humidity polynomial holds unless the clamp to [0, 100] can be active over
+			 *	the support of the input.
+			 */
+			double	lowest = INFINITY;
+			double	highest = -INFINITY;
+			double	ends[3] = {
+					nodes[kInputDistributionIndexForHumidityRawADCValue].minimum - nodes[kInputDistributionIndexForHumidityRawADCValue].mean,
+					nodes[kInputDistributionIndexForHumidityRawADCValue].maximum - nodes[kInputDistributionIndexForHumidityRawADCValue].mean,
+					(humidity[2] != 0.0) ? -humidity[1] / (2.0 * humidity[2]) : 0.0,
+				};
+
+			for (size_t j = 0; j < 3; j++)
+			{
+				double	y = fmin(fmax(ends[j], ends[0]), ends[1]);
+				double	value = humidity[0] + humidity[1] * y + humidity[2] * y * y;
+
+				lowest = fmin(lowest, value);
+				highest = fmax(highest, value);
+			}
+
+			if ((lowest >= 0.0) && (highest <= 100.0))
+			{
+				humidity[0] -= shift[kOutputDistributionIndexForHumidity];
+				polynomialPowerExpectations(humidity, 2, humidityMoments, order, conditionalMoments[kOutputDistributionIndexForHumidity]);
+			}
+			else
+			{
+				const MomentNodes *	humidityNodes = &nodes[kInputDistributionIndexForHumidityRawADCValue];
+
+				memset(conditionalMoments[kOutputDistributionIndexForHumidity], 0, sizeof(conditionalMoments[kOutputDistributionIndexForHumidity]));
+
+				for (size_t j = 0; j < humidityNodes->numberOfNodes; j++)
+				{
+					double	y = humidityNodes->values[j] - humidityNodes->mean;
+					double	value = fmin(fmax(humidity[0] + humidity[1] * y + humidity[2] * y * y, 0.0), 100.0);
+
+					for (size_t m = 0; m <= order; m++)
+					{
+						conditionalMoments[kOutputDistributionIndexForHumidity][m] += humidityNodes->weights[j] * pow(value - shift[kOutputDistributionIndexForHumidity], m);
+					}
+				}
+
+				result->numberOfClampedNodes++;
+			}
+
+			/*
+			 *	Pressure and humidity are independent given the node.
+			 */
+			for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+			{
+				for (size_t m = 1; m <= order; m++)
+				{
+					rawMoments[o][m] += weight * conditionalMoments[o][m];
+				}
+
+				for (size_t r = 0; r < o; r++)
+				{
+					crossMoments[o][r] += weight * conditionalMoments[o][1] * conditionalMoments[r][1];
+				}
+			}
+
+			result->numberOfNodes++;
+		}
+	}
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		momentNodesFree(&nodes[i]);
+	}
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		double	offset = rawMoments[o][1];
+
+		result->mean[o] = shift[o] + offset;
+
+		/*
+		 *	Binomial expansion of `E[(X - shift - offset)^m]`.
+		 */
+		for (size_t m = 0; m <= order; m++)
+		{
+			double	binomial = 1.0;
+
+			result->centralMoments[o][m] = 0.0;
+
+			for (size_t j = 0; j <= m; j++)
+			{
+				result->centralMoments[o][m] += binomial * ((j == 0) ? 1.0 : rawMoments[o][j]) * pow(-offset, m - j);
+				binomial = binomial * (m - j) / (j + 1);
+			}
+		}
+
+		result->covariance[o][o] = result->centralMoments[o][2];
+
+		for (size_t r = 0; r < o; r++)
+		{
+			result->covariance[o][r] = crossMoments[o][r] - rawMoments[o][1] * rawMoments[r][1];
+			result->covariance[r][o] = result->covariance[o][r];
+		}
+
+		if (!isfinite(result->mean[o]) || !isfinite(result->covariance[o][o]))
+		{
+			fprintf(stderr, "Error: The moments of the outputs are not finite.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+printMomentPropagationResult(const MomentPropagationResult *  result, const char *  outputNames[kOutputDistributionIndexMax])
+{
+	printf("Moment propagation up to order %zu (%zu nodes, humidity clamp possible at %zu):\n",
+		result->order,
+		result->numberOfNodes,
+		result->numberOfClampedNodes);
+	printf("%-16s %14s %14s", "Output", "Mean", "Variance");
+
+	for (size_t m = 3; m <= result->order; m++)
+	{
+		if (m == 3)
+		{
+			printf(" %14s", "Skewness");
+		}
+		else if (m == 4)
+		{
+			printf(" %14s", "Kurtosis");
+		}
+		else
+		{
+			printf("       Moment %zu", m);
+		}
+	}
+
+	printf("\n");
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		double	variance = result->centralMoments[o][2];
+
+		printf("%-16s %14.6lf %14.6le", outputNames[o], result->mean[o], variance);
+
+		/*
+		 *	Standardized central moments.
+		 */
+		for (size_t m = 3; m <= result->order; m++)
+		{
+			printf(" %14.6lf", (variance > 0.0) ? result->centralMoments[o][m] / pow(variance, 0.5 * m) : 0.0);
+		}
+
+		printf("\n");
+	}
+
+	printf("\n");
+	printConversionModelOutputCovariance(result->covariance, outputNames);
+
+	return;
+}
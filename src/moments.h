@@ -0,0 +1,121 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "model.h"
+
+typedef enum
+{
+	/*
+	 *	Highest order of the central moments that moment propagation computes.
+	 */
+	kMomentsConstantMaxOrder		= 8,
+	/*
+	 *	Number of Gauss-Legendre nodes for the expectations over uniform inputs. They are exact
+	 *	for polynomials of degree up to `2 * 16 - 1`.
+	 */
+	kMomentsConstantQuadratureNodes		= 16,
+	/*
+	 *	Pressure is a cubic polynomial of the pressure ADC input, so its powers up to the
+	 *	highest order have this degree.
+	 */
+	kMomentsConstantMaxDegree		= 3 * kMomentsConstantMaxOrder,
+} MomentsConstant;
+
+/*
+ *	Moments of all outputs of a conversion model, propagated from the moments of the raw ADC
+ *	inputs rather than sampled. Given the temperature ADC input and the calibration parameters,
+ *	pressure is a cubic polynomial of the pressure ADC input and humidity a quadratic polynomial
+ *	of the humidity ADC input, and the two are independent, so their conditional moments follow
+ *	exactly from the central moments of those inputs. Only the steps that are not polynomial, the
+ *	division by the pressure scale term and the humidity clamp, are evaluated at nodes: the
+ *	outcomes of an empirical temperature ADC input (exact), the Gauss-Legendre nodes of a
+ *	uniform one, and the devices of joint calibration sampling.
+ */
+typedef struct MomentPropagationResult
+{
+	size_t	order;
+	/*
+	 *	Number of (temperature ADC, device) nodes.
+	 */
+	size_t	numberOfNodes;
+	/*
+	 *	Number of those nodes at which the humidity clamp can be active, so that the humidity
+	 *	moments there come from the nodes of the humidity ADC input instead.
+	 */
+	size_t	numberOfClampedNodes;
+	double	mean[kOutputDistributionIndexMax];
+	/*
+	 *	Central moments of orders 2 up to `order` (entries 0 and 1 are 1 and 0).
+	 */
+	double	centralMoments[kOutputDistributionIndexMax][kMomentsConstantMaxOrder + 1];
+	double	covariance[kOutputDistributionIndexMax][kOutputDistributionIndexMax];
+} MomentPropagationResult;
+
+/**
+ *	@brief	Coefficients of the outputs of the conversion routines given the temperature ADC input
+ *		and the calibration parameters: the temperature, the pressure in kPa as a cubic
+ *		polynomial of the centred pressure ADC input, and the humidity before its clamp to
+ *		[0, 100] as a quadratic polynomial of the centred humidity ADC input.
+ *
+ *	@param	temperatureADC	: The temperature ADC input.
+ *	@param	parameters	: Array of `kBME680ConstantsNumberOfCalibrationParameters` calibration parameters.
+ *	@param	pressureCentre	: Value of the pressure ADC input at which the pressure polynomial is centred.
+ *	@param	humidityCentre	: Value of the humidity ADC input at which the humidity polynomial is centred.
+ *	@param	temperature	: Pointer to store the temperature.
+ *	@param	pressure	: Array of 4 entries to store the coefficients of the pressure polynomial.
+ *	@param	humidity	: Array of 3 entries to store the coefficients of the humidity polynomial.
+ */
+void				momentsConditionalPolynomials(
+					double		temperatureADC,
+					const double *	parameters,
+					double		pressureCentre,
+					double		humidityCentre,
+					double *	temperature,
+					double *	pressure,
+					double *	humidity);
+
+/**
+ *	@brief	Propagate the moments of the raw ADC inputs of a conversion model with fixed or
+ *		jointly sampled calibration parameters to the moments of all of its outputs.
+ *
+ *	@param	model	: Pointer to the conversion model.
+ *	@param	order	: Highest order of the central moments, from 2 to `kMomentsConstantMaxOrder`.
+ *	@param	result	: Pointer to store the result.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runMomentPropagation(const ConversionModel *  model, size_t order, MomentPropagationResult *  result);
+
+/**
+ *	@brief	Print the result of moment propagation.
+ *
+ *	@param	result		: Pointer to the result.
+ *	@param	outputNames	: Names of the outputs.
+ */
+void				printMomentPropagationResult(const MomentPropagationResult *  result, const char *  outputNames[kOutputDistributionIndexMax]);
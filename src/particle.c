@@ -0,0 +1,710 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include "particle.h"
+
+typedef struct Particle
+{
+	double	value;
+	double	weight;
+} Particle;
+
+static int
+compareParticles(const void *  a, const void *  b)
+{
+	double	valueA = ((const Particle *) a)->value;
+	double	valueB = ((const Particle *) b)->value;
+
+	return (valueA > valueB) - (valueA < valueB);
+}
+
+/**
+ *	@brief	Distribution of weighted particles, reduced to `supportSize` particles.
+ *
+ *	@param	particles		: The particles, with weights that sum to one. They are sorted in place.
+ *	@param	numberOfParticles	: Number of particles.
+ *	@param	supportSize		: Largest number of particles of the result.
+ *	@return				: The distribution.
+ */
+static ParticleDistribution
+particleReduce(Particle *  particles, size_t numberOfParticles, size_t supportSize)
+{
+	ParticleDistribution	result = {.supportSize = supportSize};
+	double			target = 1.0 / supportSize;
+	double			groupWeight = 0.0;
+	double			groupMoment = 0.0;
+
+	qsort(particles, numberOfParticles, sizeof(Particle), compareParticles);
+
+	if (numberOfParticles <= supportSize)
+	{
+		for (size_t i = 0; i < numberOfParticles; i++)
+		{
+			result.values[i] = particles[i].value;
+			result.weights[i] = particles[i].weight;
+		}
+		result.numberOfParticles = numberOfParticles;
+
+		return result;
+	}
+
+	/*
+	 *	Merge consecutive particles into groups of weight `1 / supportSize`, splitting the
+	 *	particles that straddle two groups.
+	 */
+	for (size_t i = 0; i < numberOfParticles; i++)
+	{
+		double	weight = particles[i].weight;
+
+		while ((result.numberOfParticles < supportSize - 1) && (groupWeight + weight >= target))
+		{
+			double	share = target - groupWeight;
+
+			result.values[result.numberOfParticles] = (groupMoment + share * particles[i].value) / target;
+			result.weights[result.numberOfParticles] = target;
+			result.numberOfParticles++;
+			weight -= share;
+			groupWeight = 0.0;
+			groupMoment = 0.0;
+		}
+
+		groupWeight += weight;
+		groupMoment += weight * particles[i].value;
+	}
+
+	if (groupWeight > 0.0)
+	{
+		result.values[result.numberOfParticles] = groupMoment / groupWeight;
+		result.weights[result.numberOfParticles] = groupWeight;
+		result.numberOfParticles++;
+	}
+
+	return result;
+}
+
+static double
+addValues(double a, double b, const double *  parameters)
+{
+	(void) parameters;
+
+	return a + b;
+}
+
+static double
+subtractValues(double a, double b, const double *  parameters)
+{
+	(void) parameters;
+
+	return a - b;
+}
+
+static double
+multiplyValues(double a, double b, const double *  parameters)
+{
+	(void) parameters;
+
+	return a * b;
+}
+
+static double
+divideValues(double a, double b, const double *  parameters)
+{
+	(void) parameters;
+
+	return a / b;
+}
+
+ParticleDistribution
+particleApply(ParticleDistribution a, ParticleDistribution b, double (*function)(double, double, const double *), const double *  parameters)
+{
+	size_t			numberOfPairs = a.numberOfParticles * b.numberOfParticles;
+	Particle *		pairs = (Particle *) checkedMalloc(numberOfPairs * sizeof(Particle), __FILE__, __LINE__);
+	ParticleDistribution	result;
+
+	for (size_t i = 0; i < a.numberOfParticles; i++)
+	{
+		for (size_t j = 0; j < b.numberOfParticles; j++)
+		{
+			pairs[i * b.numberOfParticles + j] = (Particle) {
+								.value	= function(a.values[i], b.values[j], parameters),
+								.weight	= a.weights[i] * b.weights[j],
+							};
+		}
+	}
+
+	result = particleReduce(pairs, numberOfPairs, (a.supportSize > b.supportSize) ? a.supportSize : b.supportSize);
+	free(pairs);
+
+	return result;
+}
+
+/**
+ *	@brief	Scale or square every particle of a distribution.
+ *
+ *	@param	a		: The distribution.
+ *	@param	factor		: Factor of the map, for scaling.
+ *	@param	isSquare	: Square rather than scale the particles.
+ *	@return			: The distribution of the mapped particles.
+ */
+static ParticleDistribution
+particleMap(ParticleDistribution a, double factor, bool isSquare)
+{
+	Particle	particles[kParticleConstantMaxSupportSize];
+
+	for (size_t i = 0; i < a.numberOfParticles; i++)
+	{
+		particles[i] = (Particle) {
+					.value	= isSquare ? a.values[i] * a.values[i] : factor * a.values[i],
+					.weight	= a.weights[i],
+				};
+	}
+
+	return particleReduce(particles, a.numberOfParticles, a.supportSize);
+}
+
+ParticleDistribution
+particleConstant(double value)
+{
+	return (ParticleDistribution) {
+			.supportSize		= 1,
+			.numberOfParticles	= 1,
+			.values			= {value},
+			.weights		= {1.0},
+		};
+}
+
+ParticleDistribution
+particleAdd(ParticleDistribution a, ParticleDistribution b)
+{
+	return particleApply(a, b, addValues, NULL);
+}
+
+ParticleDistribution
+particleSubtract(ParticleDistribution a, ParticleDistribution b)
+{
+	return particleApply(a, b, subtractValues, NULL);
+}
+
+ParticleDistribution
+particleMultiply(ParticleDistribution a, ParticleDistribution b)
+{
+	return particleApply(a, b, multiplyValues, NULL);
+}
+
+ParticleDistribution
+particleDivide(ParticleDistribution a, ParticleDistribution b)
+{
+	return particleApply(a, b, divideValues, NULL);
+}
+
+ParticleDistribution
+particleScale(ParticleDistribution a, double factor)
+{
+	return particleMap(a, factor, false);
+}
+
+ParticleDistribution
+particleSquare(ParticleDistribution a)
+{
+	return particleMap(a, 1.0, true);
+}
+
+ParticleDistribution
+particleMixture(const ParticleDistribution *  components, size_t numberOfComponents)
+{
+	size_t			numberOfParticles = 0;
+	size_t			supportSize = 1;
+	Particle *		particles;
+	ParticleDistribution	result;
+
+	for (size_t c = 0; c < numberOfComponents; c++)
+	{
+		numberOfParticles += components[c].numberOfParticles;
+		supportSize = (components[c].supportSize > supportSize) ? components[c].supportSize : supportSize;
+	}
+
+	particles = (Particle *) checkedMalloc(numberOfParticles * sizeof(Particle), __FILE__, __LINE__);
+	numberOfParticles = 0;
+
+	for (size_t c = 0; c < numberOfComponents; c++)
+	{
+		for (size_t i = 0; i < components[c].numberOfParticles; i++)
+		{
+			particles[numberOfParticles++] = (Particle) {
+								.value	= components[c].values[i],
+								.weight	= components[c].weights[i] / numberOfComponents,
+							};
+		}
+	}
+
+	result = particleReduce(particles, numberOfParticles, supportSize);
+	free(particles);
+
+	return result;
+}
+
+double
+particleMean(const ParticleDistribution *  a)
+{
+	double	mean = 0.0;
+
+	for (size_t i = 0; i < a->numberOfParticles; i++)
+	{
+		mean += a->weights[i] * a->values[i];
+	}
+
+	return mean;
+}
+
+double
+particleVariance(const ParticleDistribution *  a)
+{
+	double	mean = particleMean(a);
+	double	variance = 0.0;
+
+	for (size_t i = 0; i < a->numberOfParticles; i++)
+	{
+		variance += a->weights[i] * (a->values[i] - mean) * (a->values[i] - mean);
+	}
+
+	return variance;
+}
+
+double
+particleQuantile(const ParticleDistribution *  a, double probability)
+{
+	double	cumulativeWeight = 0.0;
+
+	for (size_t i = 0; i < a->numberOfParticles; i++)
+	{
+		cumulativeWeight += a->weights[i];
+
+		if (cumulativeWeight >= probability)
+		{
+			return a->values[i];
+		}
+	}
+
+	return a->values[a->numberOfParticles - 1];
+}
+
+/**
+ *	@brief	Whether distributions are all constants.
+ *
+ *	@param	distributions		: The distributions.
+ *	@param	numberOfDistributions	: Number of distributions.
+ *	@return				: `true` if every distribution has a single particle.
+ */
+static bool
+particleDistributionsAreConstant(const ParticleDistribution *  distributions, size_t numberOfDistributions)
+{
+	for (size_t i = 0; i < numberOfDistributions; i++)
+	{
+		if (distributions[i].numberOfParticles != 1)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ *	The pressure term `c` of `calc_pressure()` before its second-order correction, as a function
+ *	of `v1` and the pressure ADC input, with `par_p1` to `par_p6` in `parameters`.
+ */
+static double
+scaledAdcFromTemperatureTerm(double v1, double pressureAdc, const double *  parameters)
+{
+	double	v2 = (v1 * v1 * parameters[5] / 131072.0 + 2.0 * v1 * parameters[4]) / 4.0 + parameters[3] * 65536.0;
+	double	u = (parameters[2] * v1 * v1 / 16384.0 + parameters[1] * v1) / 524288.0;
+	double	q = (1.0 + u / 32768.0) * parameters[0];
+
+	return (1048576.0 - pressureAdc - v2 / 4096.0) * 6250.0 / q;
+}
+
+/*
+ *	`calc_pressure()` in kPa as a function of `c` and `par_p8`, with `par_p7`, `par_p9`, and
+ *	`par_p10` in `parameters`.
+ */
+static double
+pressureFromScaledAdc(double c, double parameterP8, const double *  parameters)
+{
+	double	c256 = c / 256.0;
+
+	return (c + (parameters[8] * c * c / 2147483648.0 + c * parameterP8 / 32768.0 + c256 * c256 * c256 * parameters[9] / 131072.0 + parameters[6] * 128.0) / 16.0) / 1000.0;
+}
+
+/*
+ *	The quadratic correction of `calc_humidity()`, `v2 + k * v2^2`.
+ */
+static double
+humidityCorrection(double v2, double k, const double *  parameters)
+{
+	(void) parameters;
+
+	return v2 + k * v2 * v2;
+}
+
+CommonConstantReturnType
+particleConversionRoutines(const ParticleDistribution *  inputs, ParticleDistribution *  outputs)
+{
+	const ParticleDistribution *	t = &inputs[kInputDistributionIndexMax];
+	const ParticleDistribution *	p = &t[kBME680ConstantsNumberOfTemperatureParameters];
+	const ParticleDistribution *	h = &p[kBME680ConstantsNumberOfPressureParameters];
+	size_t				numberOfZeroScales = 0;
+
+	/*
+	 *	Temperature, as `calc_temperature()`.
+	 */
+	ParticleDistribution	a = particleSubtract(particleScale(inputs[kInputDistributionIndexForTemperatureRawADCValue], 1.0 / 16384.0), particleScale(t[0], 1.0 / 1024.0));
+	ParticleDistribution	temperature = particleScale(
+						particleAdd(
+							particleMultiply(a, t[1]),
+							particleScale(particleMultiply(particleSquare(a), t[2]), 1.0 / 4.0)),
+						1.0 / 5120.0);
+
+	/*
+	 *	Pressure, as `calc_pressure()` on `t_fine = 5120 * temperature`, in kPa.
+	 */
+	ParticleDistribution	v1 = particleSubtract(particleScale(temperature, 2560.0), particleConstant(64000.0));
+	ParticleDistribution	v1Squared = particleSquare(v1);
+	ParticleDistribution	v2 = particleAdd(
+					particleScale(particleAdd(particleScale(particleMultiply(v1Squared, p[5]), 1.0 / 131072.0), particleScale(particleMultiply(v1, p[4]), 2.0)), 1.0 / 4.0),
+					particleScale(p[3], 65536.0));
+	ParticleDistribution	u = particleScale(particleAdd(particleScale(particleMultiply(p[2], v1Squared), 1.0 / 16384.0), particleMultiply(p[1], v1)), 1.0 / 524288.0);
+	ParticleDistribution	q = particleMultiply(particleAdd(particleConstant(1.0), particleScale(u, 1.0 / 32768.0)), p[0]);
+
+	/*
+	 *	`calc_pressure()` returns zero where `(int)q` is zero. A distribution of pressure that
+	 *	mixes both branches would need the dependence between `q` and the other terms.
+	 */
+	for (size_t i = 0; i < q.numberOfParticles; i++)
+	{
+		numberOfZeroScales += ((int)q.values[i] == 0);
+	}
+
+	if ((numberOfZeroScales > 0) && (numberOfZeroScales < q.numberOfParticles))
+	{
+		fprintf(stderr, "Error: The pressure scale term of the particle propagation straddles zero.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	outputs[kOutputDistributionIndexForPressure] = particleConstant(0.0);
+
+	if (numberOfZeroScales == 0)
+	{
+		ParticleDistribution	c;
+		double			constantParameters[kBME680ConstantsNumberOfPressureParameters] = {0.0};
+
+		/*
+		 *	`v2` and `q` both depend on `v1`, through which temperature makes up much of the
+		 *	variance of pressure. With constant `par_p1` to `par_p6`, `c` is a single function
+		 *	of `v1` and the pressure ADC input.
+		 */
+		if (particleDistributionsAreConstant(p, 6))
+		{
+			for (size_t i = 0; i < 6; i++)
+			{
+				constantParameters[i] = p[i].values[0];
+			}
+
+			c = particleApply(v1, inputs[kInputDistributionIndexForPressureRawADCValue], scaledAdcFromTemperatureTerm, constantParameters);
+		}
+		else
+		{
+			c = particleDivide(
+				particleScale(
+					particleSubtract(
+						particleSubtract(particleConstant(1048576.0), inputs[kInputDistributionIndexForPressureRawADCValue]),
+						particleScale(v2, 1.0 / 4096.0)),
+					6250.0),
+				q);
+		}
+
+		/*
+		 *	Likewise, with constant `par_p7`, `par_p9`, and `par_p10`, pressure is a single
+		 *	function of `c` and `par_p8`. Otherwise, only the terms linear in `c` are, and the
+		 *	others, which vary little, are independent of them.
+		 */
+		if (particleDistributionsAreConstant(&p[6], 1) && particleDistributionsAreConstant(&p[8], 2))
+		{
+			constantParameters[6] = p[6].values[0];
+			constantParameters[8] = p[8].values[0];
+			constantParameters[9] = p[9].values[0];
+			outputs[kOutputDistributionIndexForPressure] = particleApply(c, p[7], pressureFromScaledAdc, constantParameters);
+		}
+		else
+		{
+			ParticleDistribution	c256 = particleScale(c, 1.0 / 256.0);
+			ParticleDistribution	correction = particleAdd(
+								particleAdd(
+									particleScale(particleMultiply(p[8], particleSquare(c)), 1.0 / 2147483648.0),
+									particleScale(particleMultiply(particleMultiply(particleSquare(c256), c256), p[9]), 1.0 / 131072.0)),
+								particleScale(p[6], 128.0));
+
+			constantParameters[6] = 0.0;
+			constantParameters[8] = 0.0;
+			constantParameters[9] = 0.0;
+			outputs[kOutputDistributionIndexForPressure] = particleAdd(
+										particleApply(c, p[7], pressureFromScaledAdc, constantParameters),
+										particleScale(correction, 1.0 / 16000.0));
+		}
+	}
+
+	/*
+	 *	Humidity, as `calc_humidity()`, clamped to [0, 100] like it.
+	 */
+	ParticleDistribution	v1Humidity = particleSubtract(
+						inputs[kInputDistributionIndexForHumidityRawADCValue],
+						particleAdd(particleScale(h[0], 16.0), particleMultiply(particleScale(h[2], 1.0 / 2.0), temperature)));
+	ParticleDistribution	g = particleAdd(
+					particleConstant(1.0),
+					particleAdd(
+						particleMultiply(particleScale(h[3], 1.0 / 16384.0), temperature),
+						particleMultiply(particleScale(h[4], 1.0 / 1048576.0), particleSquare(temperature))));
+	ParticleDistribution	v2Humidity = particleMultiply(v1Humidity, particleMultiply(particleScale(h[1], 1.0 / 262144.0), g));
+	ParticleDistribution	k = particleAdd(particleScale(h[5], 1.0 / 16384.0), particleMultiply(particleScale(h[6], 1.0 / 2097152.0), temperature));
+	ParticleDistribution	humidity = particleApply(v2Humidity, k, humidityCorrection, NULL);
+
+	for (size_t i = 0; i < humidity.numberOfParticles; i++)
+	{
+		humidity.values[i] = fmin(fmax(humidity.values[i], 0.0), 100.0);
+	}
+
+	outputs[kOutputDistributionIndexForTemperature] = temperature;
+	outputs[kOutputDistributionIndexForHumidity] = humidity;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Distribution of equally likely values, reduced to `supportSize` particles.
+ *
+ *	@param	values		: The values.
+ *	@param	stride		: Distance between consecutive values in `values`.
+ *	@param	numberOfValues	: Number of values.
+ *	@param	supportSize	: Largest number of particles.
+ *	@return			: The distribution.
+ */
+static ParticleDistribution
+particleFromValues(const float *  values, size_t stride, size_t numberOfValues, size_t supportSize)
+{
+	Particle *		particles = (Particle *) checkedMalloc(numberOfValues * sizeof(Particle), __FILE__, __LINE__);
+	ParticleDistribution	result;
+
+	for (size_t i = 0; i < numberOfValues; i++)
+	{
+		particles[i] = (Particle) {.value = values[i * stride], .weight = 1.0 / numberOfValues};
+	}
+
+	result = particleReduce(particles, numberOfValues, supportSize);
+	free(particles);
+
+	return result;
+}
+
+/**
+ *	@brief	Distribution of a raw ADC input. A uniform input has a particle at the midpoint of
+ *		every one of `supportSize` cells of equal probability, which is the reduction of the
+ *		uniform distribution itself.
+ *
+ *	@param	input		: Pointer to the distribution of the input.
+ *	@param	supportSize	: Largest number of particles.
+ *	@return			: The distribution.
+ */
+static ParticleDistribution
+particleFromInputDistribution(const InputDistribution *  input, size_t supportSize)
+{
+	ParticleDistribution	result = particleConstant(input->value);
+
+	result.supportSize = supportSize;
+
+	if (input->kind == kInputDistributionKindUniform)
+	{
+		result.numberOfParticles = supportSize;
+
+		for (size_t i = 0; i < supportSize; i++)
+		{
+			result.values[i] = input->lowerBound + (i + 0.5) / supportSize * (input->upperBound - input->lowerBound);
+			result.weights[i] = 1.0 / supportSize;
+		}
+	}
+	else if (input->kind == kInputDistributionKindEmpirical)
+	{
+		size_t		numberOfOutcomes = input->aliasTable.numberOfOutcomes;
+		Particle *	particles = (Particle *) checkedMalloc(numberOfOutcomes * sizeof(Particle), __FILE__, __LINE__);
+
+		for (size_t i = 0; i < numberOfOutcomes; i++)
+		{
+			particles[i] = (Particle) {
+						.value	= input->aliasTable.values[i],
+						.weight	= input->aliasTable.cumulativeProbabilities[i] - ((i > 0) ? input->aliasTable.cumulativeProbabilities[i - 1] : 0.0),
+					};
+		}
+
+		result = particleReduce(particles, numberOfOutcomes, supportSize);
+		free(particles);
+	}
+
+	return result;
+}
+
+CommonConstantReturnType
+runParticlePropagation(const ConversionModel *  model, size_t supportSize, ParticlePropagationResult *  result)
+{
+	const CalibrationTable *	table = model->calibrationTable;
+	bool				isJoint = (table != NULL) && (model->arguments->calibrationSampling == kCalibrationSamplingJoint);
+	size_t				numberOfComponents = isJoint ? table->numberOfDevices : 1;
+	ParticleDistribution *		inputs;
+	ParticleDistribution *		components;
+	CommonConstantReturnType	ret = kCommonConstantReturnTypeSuccess;
+
+	if (supportSize < 1)
+	{
+		fprintf(stderr, "Error: The support size of particle propagation (-M) must be at least 1.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	`-M` counts iterations in the other modes, so a large value is clamped rather than refused.
+	 */
+	if (supportSize > kParticleConstantMaxSupportSize)
+	{
+		fprintf(stderr, "Warning: Particle propagation supports at most %d particles per distribution. Using %d instead of -M %zu.\n",
+			kParticleConstantMaxSupportSize,
+			kParticleConstantMaxSupportSize,
+			supportSize);
+		supportSize = kParticleConstantMaxSupportSize;
+	}
+
+	inputs = (ParticleDistribution *) checkedMalloc(kConversionModelConstantMaxInputs * sizeof(ParticleDistribution), __FILE__, __LINE__);
+	components = (ParticleDistribution *) checkedMalloc(numberOfComponents * kOutputDistributionIndexMax * sizeof(ParticleDistribution), __FILE__, __LINE__);
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		inputs[i] = particleFromInputDistribution(&model->inputDistributions[i], supportSize);
+	}
+
+	/*
+	 *	Fixed and independently sampled calibration parameters are inputs of a single pass.
+	 *	Jointly sampled ones are dependent, so every device is a pass with constant parameters
+	 *	and the outputs are the mixture of the passes.
+	 */
+	for (size_t device = 0; (device < numberOfComponents) && (ret == kCommonConstantReturnTypeSuccess); device++)
+	{
+		for (size_t i = 0; i < kBME680ConstantsNumberOfCalibrationParameters; i++)
+		{
+			ParticleDistribution *	parameter = &inputs[kInputDistributionIndexMax + i];
+
+			if (isJoint)
+			{
+				*parameter = particleConstant(table->rows[device * table->numberOfParameters + i]);
+			}
+			else if (table != NULL)
+			{
+				*parameter = particleFromValues(&table->rows[i], table->numberOfParameters, table->numberOfDevices, supportSize);
+			}
+			else if (i < kBME680ConstantsNumberOfTemperatureParameters)
+			{
+				*parameter = particleConstant(model->temperatureParameters[i]);
+			}
+			else if (i < kBME680ConstantsNumberOfTemperatureParameters + kBME680ConstantsNumberOfPressureParameters)
+			{
+				*parameter = particleConstant(model->pressureParameters[i - kBME680ConstantsNumberOfTemperatureParameters]);
+			}
+			else
+			{
+				*parameter = particleConstant(model->humidityParameters[i - kBME680ConstantsNumberOfTemperatureParameters - kBME680ConstantsNumberOfPressureParameters]);
+			}
+		}
+
+		ret = particleConversionRoutines(inputs, &components[device * kOutputDistributionIndexMax]);
+	}
+
+	if (ret == kCommonConstantReturnTypeSuccess)
+	{
+		*result = (ParticlePropagationResult) {
+				.supportSize		= supportSize,
+				.numberOfComponents	= numberOfComponents,
+			};
+
+		for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+		{
+			ParticleDistribution *	outputComponents = (ParticleDistribution *) checkedMalloc(numberOfComponents * sizeof(ParticleDistribution), __FILE__, __LINE__);
+
+			for (size_t device = 0; device < numberOfComponents; device++)
+			{
+				outputComponents[device] = components[device * kOutputDistributionIndexMax + o];
+			}
+
+			result->outputs[o] = particleMixture(outputComponents, numberOfComponents);
+			result->outputs[o].supportSize = supportSize;
+			free(outputComponents);
+		}
+	}
+
+	free(inputs);
+	free(components);
+
+	return ret;
+}
+
+void
+printParticlePropagationResult(const ParticlePropagationResult *  result, size_t outputSelect, const char *  outputNames[kOutputDistributionIndexMax])
+{
+	const ParticleDistribution *	selected = &result->outputs[outputSelect];
+
+	printf("Particle propagation (support size %zu, %zu bytes per distribution, %zu pass%s):\n",
+		result->supportSize,
+		sizeof(ParticleDistribution),
+		result->numberOfComponents,
+		(result->numberOfComponents == 1) ? "" : "es");
+	printf("%-16s %14s %14s %14s %14s %14s\n", "Output", "Mean", "Variance", "5% quantile", "Median", "95% quantile");
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		printf("%-16s %14.6lf %14.6le %14.6lf %14.6lf %14.6lf\n",
+			outputNames[o],
+			particleMean(&result->outputs[o]),
+			particleVariance(&result->outputs[o]),
+			particleQuantile(&result->outputs[o], 0.05),
+			particleQuantile(&result->outputs[o], 0.5),
+			particleQuantile(&result->outputs[o], 0.95));
+	}
+
+	printf("\nParticles of %s:\n", outputNames[outputSelect]);
+	printf("%14s %14s\n", "Value", "Weight");
+
+	for (size_t i = 0; i < selected->numberOfParticles; i++)
+	{
+		printf("%14.6lf %14.6le\n", selected->values[i], selected->weights[i]);
+	}
+
+	return;
+}
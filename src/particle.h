@@ -0,0 +1,209 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "model.h"
+
+typedef enum
+{
+	kParticleConstantMaxSupportSize	= 256,
+} ParticleConstant;
+
+/*
+ *	Discrete distribution of at most `supportSize` weighted particles (Dirac deltas), in
+ *	ascending order of value, with weights that sum to one. Arithmetic on two distributions
+ *	treats them as independent: it combines every pair of particles and then reduces the
+ *	support back to `supportSize` particles, by merging runs of consecutive particles of equal
+ *	total weight into their weighted mean. The reduction keeps the mean and the ordering.
+ */
+typedef struct ParticleDistribution
+{
+	size_t		supportSize;
+	size_t		numberOfParticles;
+	double		values[kParticleConstantMaxSupportSize];
+	double		weights[kParticleConstantMaxSupportSize];
+} ParticleDistribution;
+
+typedef struct ParticlePropagationResult
+{
+	size_t			supportSize;
+	/*
+	 *	Number of equally likely calibration devices that the outputs are a mixture over (one
+	 *	unless the calibration parameters are sampled jointly).
+	 */
+	size_t			numberOfComponents;
+	ParticleDistribution	outputs[kOutputDistributionIndexMax];
+} ParticlePropagationResult;
+
+/**
+ *	@brief	Distribution of a constant.
+ *
+ *	@param	value	: The constant.
+ *	@return		: The distribution with a single particle.
+ */
+ParticleDistribution		particleConstant(double value);
+
+/**
+ *	@brief	Distribution of a function of two independent distributions. A subexpression in
+ *		which an input occurs more than once is exact as a single function, where a chain of
+ *		operations would treat the occurrences as independent.
+ *
+ *	@param	a		: The first operand.
+ *	@param	b		: The second operand.
+ *	@param	function	: The function, of a particle of `a`, a particle of `b`, and `parameters`.
+ *	@param	parameters	: Constant parameters of the function, or `NULL`.
+ *	@return			: The distribution of function(a, b).
+ */
+ParticleDistribution		particleApply(ParticleDistribution a, ParticleDistribution b, double (*function)(double, double, const double *), const double *  parameters);
+
+/**
+ *	@brief	Sum of two independent distributions.
+ *
+ *	@param	a	: The first operand.
+ *	@param	b	: The second operand.
+ *	@return		: The distribution of a + b.
+ */
+ParticleDistribution		particleAdd(ParticleDistribution a, ParticleDistribution b);
+
+/**
+ *	@brief	Difference of two independent distributions.
+ *
+ *	@param	a	: The first operand.
+ *	@param	b	: The second operand.
+ *	@return		: The distribution of a - b.
+ */
+ParticleDistribution		particleSubtract(ParticleDistribution a, ParticleDistribution b);
+
+/**
+ *	@brief	Product of two independent distributions.
+ *
+ *	@param	a	: The first operand.
+ *	@param	b	: The second operand.
+ *	@return		: The distribution of a * b.
+ */
+ParticleDistribution		particleMultiply(ParticleDistribution a, ParticleDistribution b);
+
+/**
+ *	@brief	Quotient of two independent distributions.
+ *
+ *	@param	a	: The dividend.
+ *	@param	b	: The divisor, without particles at zero.
+ *	@return		: The distribution of a / b.
+ */
+ParticleDistribution		particleDivide(ParticleDistribution a, ParticleDistribution b);
+
+/**
+ *	@brief	Product of a distribution and a constant.
+ *
+ *	@param	a	: The distribution.
+ *	@param	factor	: The constant.
+ *	@return		: The distribution of factor * a.
+ */
+ParticleDistribution		particleScale(ParticleDistribution a, double factor);
+
+/**
+ *	@brief	Square of a distribution, which unlike `particleMultiply(a, a)` is exact.
+ *
+ *	@param	a	: The distribution.
+ *	@return		: The distribution of a^2.
+ */
+ParticleDistribution		particleSquare(ParticleDistribution a);
+
+/**
+ *	@brief	Mixture of equally likely distributions, reduced to the largest support size of
+ *		its components.
+ *
+ *	@param	components		: The components.
+ *	@param	numberOfComponents	: Number of components.
+ *	@return				: The mixture.
+ */
+ParticleDistribution		particleMixture(const ParticleDistribution *  components, size_t numberOfComponents);
+
+/**
+ *	@brief	Mean of a distribution.
+ *
+ *	@param	a	: Pointer to the distribution.
+ *	@return		: The mean.
+ */
+double				particleMean(const ParticleDistribution *  a);
+
+/**
+ *	@brief	Variance of a distribution.
+ *
+ *	@param	a	: Pointer to the distribution.
+ *	@return		: The variance.
+ */
+double				particleVariance(const ParticleDistribution *  a);
+
+/**
+ *	@brief	Quantile of a distribution: the smallest particle at which the cumulative weight
+ *		reaches `probability`.
+ *
+ *	@param	a		: Pointer to the distribution.
+ *	@param	probability	: Probability in [0, 1].
+ *	@return			: The quantile.
+ */
+double				particleQuantile(const ParticleDistribution *  a, double probability);
+
+/**
+ *	@brief	Evaluate the BME680 conversion routines on distributions of the raw ADC inputs and
+ *		calibration parameters, with the formulas of `conversionModelEvaluateWithJacobian()`.
+ *		Every operation treats its operands as independent. The squares of the formulas and
+ *		the steps of pressure and humidity in which one intermediate occurs more than once are
+ *		single functions; the other repeated occurrences, mostly of temperature, are
+ *		approximated.
+ *
+ *	@param	inputs	: Array of `kConversionModelConstantMaxInputs` distributions of the inputs.
+ *	@param	outputs	: Array of `kOutputDistributionIndexMax` entries to store the distributions of the outputs.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	particleConversionRoutines(const ParticleDistribution *  inputs, ParticleDistribution *  outputs);
+
+/**
+ *	@brief	Propagate the distributions of the inputs of a conversion model to all of its
+ *		outputs in one deterministic pass on distributions of `supportSize` particles.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	supportSize	: Largest number of particles of every distribution, clamped with a warning
+ *				  to `kParticleConstantMaxSupportSize`.
+ *	@param	result		: Pointer to store the result.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runParticlePropagation(const ConversionModel *  model, size_t supportSize, ParticlePropagationResult *  result);
+
+/**
+ *	@brief	Print the result of particle propagation: summaries of all outputs and the particles
+ *		of the selected output.
+ *
+ *	@param	result		: Pointer to the result.
+ *	@param	outputSelect	: Index of the selected output.
+ *	@param	outputNames	: Names of the outputs.
+ */
+void				printParticlePropagationResult(const ParticlePropagationResult *  result, size_t outputSelect, const char *  outputNames[kOutputDistributionIndexMax]);
@@ -0,0 +1,749 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "pce.h"
+#include "sampling.h"
+
+/**
+ *	@brief	Orthonormal polynomials of a uniform input: Legendre polynomials on [-1, 1].
+ *
+ *	@param	marginal	: Pointer to the marginal to initialize.
+ *	@param	lowerBound	: Lower bound of the input.
+ *	@param	upperBound	: Upper bound of the input.
+ *	@param	degree		: Highest degree.
+ */
+static void
+marginalFromUniform(PolynomialChaosMarginal *  marginal, double lowerBound, double upperBound, size_t degree)
+{
+	*marginal = (PolynomialChaosMarginal) {
+				.shift		= 0.5 * (lowerBound + upperBound),
+				.scale		= 0.5 * (upperBound - lowerBound),
+				.maxDegree	= (upperBound > lowerBound) ? degree : 0,
+			};
+
+	for (size_t k = 1; k <= degree; k++)
+	{
+		marginal->b[k] = k / sqrt(4.0 * k * k - 1.0);
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Orthonormal polynomials of a discrete input, from the Stieltjes procedure.
+ *
+ *	@param	marginal	: Pointer to the marginal to initialize.
+ *	@param	values		: Values of the input.
+ *	@param	weights		: Probabilities of the values.
+ *	@param	numberOfValues	: Number of values.
+ *	@param	degree		: Highest degree.
+ */
+static void
+marginalFromValues(PolynomialChaosMarginal *  marginal, const double *  values, const double *  weights, size_t numberOfValues, size_t degree)
+{
+	double *	current = (double *) checkedMalloc(numberOfValues * sizeof(double), __FILE__, __LINE__);
+	double *	previous = (double *) checkedMalloc(numberOfValues * sizeof(double), __FILE__, __LINE__);
+	double		mean = 0.0;
+	double		variance = 0.0;
+
+	for (size_t j = 0; j < numberOfValues; j++)
+	{
+		mean += weights[j] * values[j];
+	}
+
+	for (size_t j = 0; j < numberOfValues; j++)
+	{
+		variance += weights[j] * (values[j] - mean) * (values[j] - mean);
+		current[j] = 1.0;
+		previous[j] = 0.0;
+	}
+
+	*marginal = (PolynomialChaosMarginal) {
+				.shift	= mean,
+				.scale	= (variance > 0.0) ? sqrt(variance) : 1.0,
+			};
+
+	/*
+	 *	Stop where the next polynomial vanishes on all values, i.e., after as many
+	 *	polynomials as distinct values.
+	 */
+	for (size_t k = 0; k < degree; k++)
+	{
+		double	a = 0.0;
+		double	normSquared = 0.0;
+
+		for (size_t j = 0; j < numberOfValues; j++)
+		{
+			double	x = (values[j] - marginal->shift) / marginal->scale;
+
+			a += weights[j] * x * current[j] * current[j];
+		}
+
+		for (size_t j = 0; j < numberOfValues; j++)
+		{
+			double	x = (values[j] - marginal->shift) / marginal->scale;
+			double	next = (x - a) * current[j] - marginal->b[k] * previous[j];
+
+			previous[j] = current[j];
+			current[j] = next;
+			normSquared += weights[j] * next * next;
+		}
+
+		marginal->a[k] = a;
+
+		if (!(normSquared > 1e-16))
+		{
+			break;
+		}
+
+		marginal->b[k + 1] = sqrt(normSquared);
+		marginal->maxDegree = k + 1;
+
+		for (size_t j = 0; j < numberOfValues; j++)
+		{
+			current[j] /= marginal->b[k + 1];
+		}
+	}
+
+	free(current);
+	free(previous);
+
+	return;
+}
+
+/**
+ *	@brief	Orthonormal polynomials of an input at a value.
+ *
+ *	@param	marginal	: Pointer to the marginal of the input.
+ *	@param	value		: The value.
+ *	@param	polynomials	: Array of `maxDegree + 1` entries to store the polynomials of degree 0 to `maxDegree`.
+ */
+static void
+marginalPolynomials(const PolynomialChaosMarginal *  marginal, double value, double *  polynomials)
+{
+	double	x = (value - marginal->shift) / marginal->scale;
+
+	polynomials[0] = 1.0;
+
+	for (size_t k = 0; k < marginal->maxDegree; k++)
+	{
+		polynomials[k + 1] = ((x - marginal->a[k]) * polynomials[k] - ((k > 0) ? marginal->b[k] * polynomials[k - 1] : 0.0)) / marginal->b[k + 1];
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Inputs of the polynomial chaos expansion of a conversion model at a sample point.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	samplePoint	: Point in (0, 1)^conversionModelNumberOfInputs().
+ *	@param	variables	: Array of `conversionModelNumberOfInputs()` entries to store the inputs.
+ */
+static void
+polynomialChaosVariables(const ConversionModel *  model, const double *  samplePoint, double *  variables)
+{
+	double	inputs[kConversionModelConstantMaxInputs];
+
+	conversionModelInputValues(model, samplePoint, inputs);
+
+	for (size_t i = 0; i < conversionModelNumberOfInputs(model); i++)
+	{
+		variables[i] = inputs[i];
+	}
+
+	/*
+	 *	The device of joint calibration sampling, as `calibrationTableDraw()` selects it.
+	 */
+	if ((model->calibrationTable != NULL) && (model->arguments->calibrationSampling == kCalibrationSamplingJoint))
+	{
+		size_t	device = (size_t)(samplePoint[kInputDistributionIndexMax] * model->calibrationTable->numberOfDevices);
+
+		variables[kInputDistributionIndexMax] = (device < model->calibrationTable->numberOfDevices) ? device : (model->calibrationTable->numberOfDevices - 1);
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Distributions and orthonormal polynomials of the inputs of a conversion model.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	expansion	: Pointer to the expansion, whose `numberOfInputs` and `degree` are set.
+ */
+static void
+polynomialChaosMarginals(const ConversionModel *  model, PolynomialChaosExpansion *  expansion)
+{
+	const CalibrationTable *	table = model->calibrationTable;
+	size_t				numberOfValues = (table != NULL) ? table->numberOfDevices : 1;
+	double *			values;
+	double *			weights;
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		numberOfValues = (model->inputDistributions[i].kind == kInputDistributionKindEmpirical) && (model->inputDistributions[i].aliasTable.numberOfOutcomes > numberOfValues) ?
+					model->inputDistributions[i].aliasTable.numberOfOutcomes : numberOfValues;
+	}
+
+	values = (double *) checkedMalloc(numberOfValues * sizeof(double), __FILE__, __LINE__);
+	weights = (double *) checkedMalloc(numberOfValues * sizeof(double), __FILE__, __LINE__);
+
+	for (size_t i = 0; i < expansion->numberOfInputs; i++)
+	{
+		PolynomialChaosMarginal *	marginal = &expansion->marginals[i];
+
+		numberOfValues = 1;
+
+		if (i < kInputDistributionIndexMax)
+		{
+			const InputDistribution *	input = &model->inputDistributions[i];
+
+			if (input->kind == kInputDistributionKindUniform)
+			{
+				marginalFromUniform(marginal, input->lowerBound, input->upperBound, expansion->degree);
+
+				continue;
+			}
+
+			values[0] = input->value;
+			weights[0] = 1.0;
+
+			if (input->kind == kInputDistributionKindEmpirical)
+			{
+				numberOfValues = input->aliasTable.numberOfOutcomes;
+
+				for (size_t j = 0; j < numberOfValues; j++)
+				{
+					values[j] = input->aliasTable.values[j];
+					weights[j] = input->aliasTable.cumulativeProbabilities[j] - ((j > 0) ? input->aliasTable.cumulativeProbabilities[j - 1] : 0.0);
+				}
+			}
+		}
+		else
+		{
+			/*
+			 *	The device of joint sampling, or one parameter of independent sampling.
+			 */
+			bool	isJoint = (model->arguments->calibrationSampling == kCalibrationSamplingJoint);
+
+			numberOfValues = table->numberOfDevices;
+
+			for (size_t device = 0; device < numberOfValues; device++)
+			{
+				values[device] = isJoint ? device : table->rows[device * table->numberOfParameters + (i - kInputDistributionIndexMax)];
+				weights[device] = 1.0 / numberOfValues;
+			}
+		}
+
+		marginalFromValues(marginal, values, weights, numberOfValues, expansion->degree);
+	}
+
+	free(values);
+	free(weights);
+
+	return;
+}
+
+/**
+ *	@brief	Append all multi-indices that sum to `remaining` over the entries from `input` on, in
+ *		descending lexicographic order, within the highest degree of every input.
+ *
+ *	@param	expansion	: Pointer to the expansion, whose `basisSize` counts the multi-indices so far.
+ *	@param	current		: The entries of the multi-index before `input`.
+ *	@param	input		: Index of the first entry to fill.
+ *	@param	remaining	: Sum of the entries from `input` on.
+ */
+static void
+appendMultiIndices(PolynomialChaosExpansion *  expansion, uint8_t *  current, size_t input, size_t remaining)
+{
+	size_t	maxDegree = expansion->marginals[input].maxDegree;
+
+	if (input == expansion->numberOfInputs - 1)
+	{
+		if (remaining > maxDegree)
+		{
+			return;
+		}
+
+		/*
+		 *	Count the multi-indices beyond the capacity, so that the caller can report them.
+		 */
+		current[input] = (uint8_t) remaining;
+
+		if (expansion->basisSize < kPolynomialChaosConstantMaxBasisSize)
+		{
+			memcpy(&expansion->multiIndices[expansion->basisSize * expansion->numberOfInputs], current, expansion->numberOfInputs);
+		}
+
+		expansion->basisSize++;
+
+		return;
+	}
+
+	for (size_t value = ((remaining < maxDegree) ? remaining : maxDegree) + 1; value-- > 0;)
+	{
+		current[input] = (uint8_t) value;
+		appendMultiIndices(expansion, current, input + 1, remaining - value);
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Initialize a polynomial chaos expansion of a conversion model with the basis of total
+ *		degree `degree`.
+ *
+ *	@param	expansion	: Pointer to the expansion to initialize.
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	degree		: Total degree.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+polynomialChaosExpansionInit(PolynomialChaosExpansion *  expansion, const ConversionModel *  model, size_t degree)
+{
+	uint8_t	current[kConversionModelConstantMaxInputs];
+
+	*expansion = (PolynomialChaosExpansion) {
+				.numberOfInputs	= conversionModelNumberOfInputs(model),
+				.degree		= degree,
+			};
+	polynomialChaosMarginals(model, expansion);
+	expansion->multiIndices = (uint8_t *) checkedMalloc(kPolynomialChaosConstantMaxBasisSize * expansion->numberOfInputs, __FILE__, __LINE__);
+
+	for (size_t totalDegree = 0; totalDegree <= degree; totalDegree++)
+	{
+		appendMultiIndices(expansion, current, 0, totalDegree);
+	}
+
+	if (expansion->basisSize > kPolynomialChaosConstantMaxBasisSize)
+	{
+		fprintf(stderr, "Error: A polynomial chaos expansion of degree %zu in %zu inputs has %zu basis polynomials, more than %d. Lower the degree (-d).\n",
+			degree,
+			expansion->numberOfInputs,
+			expansion->basisSize,
+			kPolynomialChaosConstantMaxBasisSize);
+		free(expansion->multiIndices);
+		expansion->multiIndices = NULL;
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	expansion->coefficients = (double *) checkedMalloc(expansion->basisSize * kOutputDistributionIndexMax * sizeof(double), __FILE__, __LINE__);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Evaluate the basis polynomials of a polynomial chaos expansion.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	expansion	: Pointer to the expansion.
+ *	@param	samplePoint	: Point in (0, 1)^numberOfInputs.
+ *	@param	basis		: Array of `basisSize` entries to store the basis polynomials.
+ */
+static void
+polynomialChaosBasis(const ConversionModel *  model, const PolynomialChaosExpansion *  expansion, const double *  samplePoint, double *  basis)
+{
+	double	variables[kConversionModelConstantMaxInputs];
+	double	polynomials[kConversionModelConstantMaxInputs][kPolynomialChaosConstantMaxDegree + 1];
+
+	polynomialChaosVariables(model, samplePoint, variables);
+
+	for (size_t i = 0; i < expansion->numberOfInputs; i++)
+	{
+		marginalPolynomials(&expansion->marginals[i], variables[i], polynomials[i]);
+	}
+
+	for (size_t b = 0; b < expansion->basisSize; b++)
+	{
+		const uint8_t *	multiIndex = &expansion->multiIndices[b * expansion->numberOfInputs];
+
+		basis[b] = 1.0;
+
+		for (size_t i = 0; i < expansion->numberOfInputs; i++)
+		{
+			basis[b] *= polynomials[i][multiIndex[i]];
+		}
+	}
+
+	return;
+}
+
+void
+polynomialChaosExpansionEvaluate(const ConversionModel *  model, const PolynomialChaosExpansion *  expansion, const double *  samplePoint, double *  outputs)
+{
+	double	basis[kPolynomialChaosConstantMaxBasisSize];
+
+	polynomialChaosBasis(model, expansion, samplePoint, basis);
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		outputs[o] = 0.0;
+
+		for (size_t b = 0; b < expansion->basisSize; b++)
+		{
+			outputs[o] += expansion->coefficients[b * kOutputDistributionIndexMax + o] * basis[b];
+		}
+	}
+
+	return;
+}
+
+void
+polynomialChaosExpansionFree(PolynomialChaosExpansion *  expansion)
+{
+	free(expansion->multiIndices);
+	free(expansion->coefficients);
+	expansion->multiIndices = NULL;
+	expansion->coefficients = NULL;
+
+	return;
+}
+
+/**
+ *	@brief	Solve the normal equations `G x = r` of the least-squares fit for all outputs, with
+ *		the Cholesky factorization of `G`.
+ *
+ *	@param	gram		: Row-major `size` x `size` Gram matrix, of which the lower triangle is read and overwritten with the factor.
+ *	@param	rightHandSides	: Row-major `size` x `kOutputDistributionIndexMax` right-hand sides, overwritten with the solutions.
+ *	@param	size		: Number of unknowns.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError` for a singular `G`.
+ */
+static CommonConstantReturnType
+solveNormalEquations(double *  gram, double *  rightHandSides, size_t size)
+{
+	const size_t	m = kOutputDistributionIndexMax;
+
+	for (size_t j = 0; j < size; j++)
+	{
+		double	pivot = gram[j * size + j];
+
+		for (size_t k = 0; k < j; k++)
+		{
+			pivot -= gram[j * size + k] * gram[j * size + k];
+		}
+
+		if (!(pivot > 0.0))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		gram[j * size + j] = sqrt(pivot);
+
+		#pragma omp parallel for schedule(static)
+		for (size_t i = j + 1; i < size; i++)
+		{
+			double	sum = gram[i * size + j];
+
+			for (size_t k = 0; k < j; k++)
+			{
+				sum -= gram[i * size + k] * gram[j * size + k];
+			}
+
+			gram[i * size + j] = sum / gram[j * size + j];
+		}
+	}
+
+	for (size_t o = 0; o < m; o++)
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			for (size_t k = 0; k < i; k++)
+			{
+				rightHandSides[i * m + o] -= gram[i * size + k] * rightHandSides[k * m + o];
+			}
+
+			rightHandSides[i * m + o] /= gram[i * size + i];
+		}
+
+		for (size_t i = size; i-- > 0;)
+		{
+			for (size_t k = i + 1; k < size; k++)
+			{
+				rightHandSides[i * m + o] -= gram[k * size + i] * rightHandSides[k * m + o];
+			}
+
+			rightHandSides[i * m + o] /= gram[i * size + i];
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+runPolynomialChaos(const ConversionModel *  model, size_t degree, size_t numberOfEvaluations, PolynomialChaosResult *  result)
+{
+	const size_t			m = kOutputDistributionIndexMax;
+	size_t				numberOfInputs = conversionModelNumberOfInputs(model);
+	PolynomialChaosExpansion *	expansion = &result->expansion;
+	CommandLineArguments		allOutputsArguments = *model->arguments;
+	ConversionModel			allOutputsModel = *model;
+	Sampler				sampler;
+	Sampler				validationSampler;
+	size_t				basisSize;
+	double *			design;
+	double *			outputs;
+	double *			gram;
+	double				squaredErrors[kOutputDistributionIndexMax] = {0.0};
+
+	*result = (PolynomialChaosResult) {.numberOfEvaluations = numberOfEvaluations + kPolynomialChaosConstantValidationSamples};
+
+	/*
+	 *	The fit evaluates all outputs at once, whichever output is selected.
+	 */
+	allOutputsArguments.common.outputSelect = kOutputDistributionIndexMax;
+	allOutputsModel.arguments = &allOutputsArguments;
+
+	if (polynomialChaosExpansionInit(expansion, model, degree) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	basisSize = expansion->basisSize;
+
+	if (numberOfEvaluations < basisSize)
+	{
+		fprintf(stderr, "Error: The fit needs at least as many model evaluations (-M) as basis polynomials (%zu); twice as many are advisable.\n", basisSize);
+		polynomialChaosExpansionFree(expansion);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	The validation points use a seed drawn from a stream that samplers do not use, so that
+	 *	they are independent of the points of the fit.
+	 */
+	if ((samplerInit(&sampler, model->arguments->samplingMethod, model->arguments->randomSeed, numberOfEvaluations, numberOfInputs) != kCommonConstantReturnTypeSuccess) ||
+		(samplerInit(&validationSampler, model->arguments->samplingMethod, samplingRandomBits(model->arguments->randomSeed, kSamplingStreamMax, 0), kPolynomialChaosConstantValidationSamples, numberOfInputs) != kCommonConstantReturnTypeSuccess))
+	{
+		polynomialChaosExpansionFree(expansion);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	design = (double *) checkedMalloc(numberOfEvaluations * basisSize * sizeof(double), __FILE__, __LINE__);
+	outputs = (double *) checkedMalloc(numberOfEvaluations * m * sizeof(double), __FILE__, __LINE__);
+	gram = (double *) checkedMalloc(basisSize * basisSize * sizeof(double), __FILE__, __LINE__);
+
+	#pragma omp parallel for schedule(static)
+	for (size_t j = 0; j < numberOfEvaluations; j++)
+	{
+		double	samplePoint[kConversionModelConstantMaxInputs];
+		double	basis[kPolynomialChaosConstantMaxBasisSize];
+		float	outputVariables[kOutputDistributionIndexMax];
+
+		samplerGetPoint(&sampler, j, samplePoint);
+		conversionModelEvaluate(&allOutputsModel, samplePoint, outputVariables);
+		polynomialChaosBasis(model, expansion, samplePoint, basis);
+
+		for (size_t b = 0; b < basisSize; b++)
+		{
+			design[b * numberOfEvaluations + j] = basis[b];
+		}
+
+		for (size_t o = 0; o < m; o++)
+		{
+			outputs[j * m + o] = outputVariables[o];
+		}
+	}
+
+	/*
+	 *	Normal equations of the least-squares fit, from the design matrix stored by basis
+	 *	polynomial. The basis is orthonormal, so the Gram matrix is close to
+	 *	`numberOfEvaluations` times the identity and well conditioned.
+	 */
+	#pragma omp parallel for schedule(dynamic)
+	for (size_t a = 0; a < basisSize; a++)
+	{
+		for (size_t b = 0; b <= a; b++)
+		{
+			double	sum = 0.0;
+
+			for (size_t j = 0; j < numberOfEvaluations; j++)
+			{
+				sum += design[a * numberOfEvaluations + j] * design[b * numberOfEvaluations + j];
+			}
+
+			gram[a * basisSize + b] = sum;
+		}
+
+		for (size_t o = 0; o < m; o++)
+		{
+			double	sum = 0.0;
+
+			for (size_t j = 0; j < numberOfEvaluations; j++)
+			{
+				sum += design[a * numberOfEvaluations + j] * outputs[j * m + o];
+			}
+
+			expansion->coefficients[a * m + o] = sum;
+		}
+	}
+
+	free(design);
+	free(outputs);
+
+	if (solveNormalEquations(gram, expansion->coefficients, basisSize) != kCommonConstantReturnTypeSuccess)
+	{
+		fprintf(stderr, "Error: The least-squares fit of the polynomial chaos expansion is singular.\n");
+		free(gram);
+		polynomialChaosExpansionFree(expansion);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	free(gram);
+
+	/*
+	 *	Moments and Sobol indices from the coefficients: the constant is the mean, every other
+	 *	basis polynomial contributes its squared coefficient to the variance, and to the indices
+	 *	of the inputs that it depends on.
+	 */
+	for (size_t o = 0; o < m; o++)
+	{
+		result->mean[o] = expansion->coefficients[o];
+
+		for (size_t b = 1; b < basisSize; b++)
+		{
+			const uint8_t *	multiIndex = &expansion->multiIndices[b * numberOfInputs];
+			double		contribution = expansion->coefficients[b * m + o] * expansion->coefficients[b * m + o];
+			size_t		numberOfDependencies = 0;
+			size_t		dependency = 0;
+
+			result->variance[o] += contribution;
+
+			for (size_t i = 0; i < numberOfInputs; i++)
+			{
+				if (multiIndex[i] > 0)
+				{
+					result->totalEffect[o][i] += contribution;
+					numberOfDependencies++;
+					dependency = i;
+				}
+			}
+
+			if (numberOfDependencies == 1)
+			{
+				result->firstOrder[o][dependency] += contribution;
+			}
+		}
+
+		for (size_t i = 0; (i < numberOfInputs) && (result->variance[o] > 0.0); i++)
+		{
+			result->firstOrder[o][i] /= result->variance[o];
+			result->totalEffect[o][i] /= result->variance[o];
+		}
+	}
+
+	for (size_t j = 0; j < kPolynomialChaosConstantValidationSamples; j++)
+	{
+		double	samplePoint[kConversionModelConstantMaxInputs];
+		float	outputVariables[kOutputDistributionIndexMax];
+		double	surrogateOutputs[kOutputDistributionIndexMax];
+
+		samplerGetPoint(&validationSampler, j, samplePoint);
+		conversionModelEvaluate(&allOutputsModel, samplePoint, outputVariables);
+		polynomialChaosExpansionEvaluate(model, expansion, samplePoint, surrogateOutputs);
+
+		for (size_t o = 0; o < m; o++)
+		{
+			squaredErrors[o] += (surrogateOutputs[o] - outputVariables[o]) * (surrogateOutputs[o] - outputVariables[o]);
+		}
+	}
+
+	for (size_t o = 0; o < m; o++)
+	{
+		double	rootMeanSquareError = sqrt(squaredErrors[o] / kPolynomialChaosConstantValidationSamples);
+
+		result->relativeError[o] = (result->variance[o] > 0.0) ? rootMeanSquareError / sqrt(result->variance[o]) : rootMeanSquareError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+printPolynomialChaosResult(const ConversionModel *  model, const PolynomialChaosResult *  result, const char *  outputNames[kOutputDistributionIndexMax])
+{
+	size_t	outputSelect = model->arguments->common.outputSelect;
+
+	printf("Polynomial chaos expansion of degree %zu in %zu inputs (%zu basis polynomials, %zu model evaluations):\n",
+		result->expansion.degree,
+		result->expansion.numberOfInputs,
+		result->expansion.basisSize,
+		result->numberOfEvaluations);
+	printf("%-16s %14s %14s %14s\n", "Output", "Mean", "Variance", "Relative error");
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		printf("%-16s %14.6lf %14.6le %14.6lf\n", outputNames[o], result->mean[o], result->variance[o], result->relativeError[o]);
+	}
+
+	printf("\nSobol indices of %s:\n", outputNames[outputSelect]);
+	printf("%-16s %12s %12s\n", "Input", "First-order", "Total-effect");
+
+	for (size_t i = 0; i < result->expansion.numberOfInputs; i++)
+	{
+		printf("%-16s %12.6lf %12.6lf\n", conversionModelInputName(model, i), result->firstOrder[outputSelect][i], result->totalEffect[outputSelect][i]);
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+samplePolynomialChaosExpansion(const ConversionModel *  model, const PolynomialChaosExpansion *  expansion, size_t numberOfSamples)
+{
+	size_t		outputSelect = model->arguments->common.outputSelect;
+	float *		samples = (float *) checkedMalloc(numberOfSamples * sizeof(float), __FILE__, __LINE__);
+	clock_t		start = clock();
+	double		microseconds;
+	Sampler		sampler;
+
+	if (samplerInit(&sampler, model->arguments->samplingMethod, samplingRandomBits(model->arguments->randomSeed, kSamplingStreamMax, 1), numberOfSamples, expansion->numberOfInputs) != kCommonConstantReturnTypeSuccess)
+	{
+		free(samples);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t j = 0; j < numberOfSamples; j++)
+	{
+		double	samplePoint[kConversionModelConstantMaxInputs];
+		double	outputs[kOutputDistributionIndexMax];
+
+		samplerGetPoint(&sampler, j, samplePoint);
+		polynomialChaosExpansionEvaluate(model, expansion, samplePoint, outputs);
+		samples[j] = (float) outputs[outputSelect];
+	}
+
+	microseconds = ((double)(clock() - start)) / CLOCKS_PER_SEC * 1000000;
+	saveMonteCarloFloatDataToDataDotOutFile(samples, (uint64_t) microseconds, numberOfSamples);
+	printf("\nWrote %zu samples of the expansion to data.out (%.3lf microseconds per sample).\n", numberOfSamples, microseconds / numberOfSamples);
+	free(samples);
+
+	return kCommonConstantReturnTypeSuccess;
+}
@@ -0,0 +1,154 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "model.h"
+
+typedef enum
+{
+	/*
+	 *	Highest total degree of the expansion, and largest number of its basis polynomials,
+	 *	which bounds the size of the least-squares system.
+	 */
+	kPolynomialChaosConstantMaxDegree		= 8,
+	kPolynomialChaosConstantMaxBasisSize		= 1024,
+	/*
+	 *	Number of model evaluations, apart from the fit, for the error of the expansion.
+	 */
+	kPolynomialChaosConstantValidationSamples	= 1000,
+} PolynomialChaosConstant;
+
+/*
+ *	Distribution of one input of a polynomial chaos expansion and the three-term recurrence
+ *	`b[k + 1] P[k + 1](x) = (x - a[k]) P[k](x) - b[k] P[k - 1](x)` of its orthonormal polynomials
+ *	in the standardized input `x = (value - shift) / scale`: Legendre polynomials for a uniform
+ *	input, and from the Stieltjes procedure on the values of a discrete one.
+ */
+typedef struct PolynomialChaosMarginal
+{
+	double		shift;
+	double		scale;
+	/*
+	 *	Highest degree, at most one less than the number of distinct values of a discrete input.
+	 */
+	size_t		maxDegree;
+	double		a[kPolynomialChaosConstantMaxDegree + 1];
+	double		b[kPolynomialChaosConstantMaxDegree + 1];
+} PolynomialChaosMarginal;
+
+/*
+ *	Polynomial chaos expansion of all outputs of a conversion model: a linear combination of
+ *	products of the orthonormal polynomials of its inputs, of total degree at most `degree`.
+ *	The inputs are the raw ADC inputs and the calibration parameters, or for joint calibration
+ *	sampling the index of the device. They are independent, so the products are orthonormal.
+ */
+typedef struct PolynomialChaosExpansion
+{
+	size_t				numberOfInputs;
+	size_t				degree;
+	size_t				basisSize;
+	PolynomialChaosMarginal		marginals[kConversionModelConstantMaxInputs];
+	/*
+	 *	Degree of every input in every basis polynomial, `basisSize` rows of `numberOfInputs`
+	 *	entries, starting with the constant.
+	 */
+	uint8_t *			multiIndices;
+	/*
+	 *	Coefficients of every basis polynomial for every output, `basisSize` rows of
+	 *	`kOutputDistributionIndexMax` entries.
+	 */
+	double *			coefficients;
+} PolynomialChaosExpansion;
+
+typedef struct PolynomialChaosResult
+{
+	PolynomialChaosExpansion	expansion;
+	size_t				numberOfEvaluations;
+	double				mean[kOutputDistributionIndexMax];
+	double				variance[kOutputDistributionIndexMax];
+	/*
+	 *	Root-mean-square error of the expansion at independent samples, relative to the
+	 *	standard deviation of each output.
+	 */
+	double				relativeError[kOutputDistributionIndexMax];
+	double				firstOrder[kOutputDistributionIndexMax][kConversionModelConstantMaxInputs];
+	double				totalEffect[kOutputDistributionIndexMax][kConversionModelConstantMaxInputs];
+} PolynomialChaosResult;
+
+/**
+ *	@brief	Evaluate a polynomial chaos expansion of a conversion model.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	expansion	: Pointer to the expansion.
+ *	@param	samplePoint	: Point in (0, 1)^conversionModelNumberOfInputs().
+ *	@param	outputs		: Array of `kOutputDistributionIndexMax` entries to store the outputs.
+ */
+void				polynomialChaosExpansionEvaluate(const ConversionModel *  model, const PolynomialChaosExpansion *  expansion, const double *  samplePoint, double *  outputs);
+
+/**
+ *	@brief	Free the memory held by a polynomial chaos expansion.
+ *
+ *	@param	expansion	: Pointer to the expansion.
+ */
+void				polynomialChaosExpansionFree(PolynomialChaosExpansion *  expansion);
+
+/**
+ *	@brief	Fit a polynomial chaos expansion of all outputs of a conversion model by least
+ *		squares on model evaluations, and derive the moments and Sobol indices of the outputs
+ *		from its coefficients.
+ *
+ *	@param	model			: Pointer to the conversion model.
+ *	@param	degree			: Total degree of the expansion.
+ *	@param	numberOfEvaluations	: Number of model evaluations of the fit.
+ *	@param	result			: Pointer to store the result, whose expansion the caller frees.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runPolynomialChaos(const ConversionModel *  model, size_t degree, size_t numberOfEvaluations, PolynomialChaosResult *  result);
+
+/**
+ *	@brief	Print the result of a polynomial chaos expansion: the moments and error of all
+ *		outputs and the Sobol indices of the selected output.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	result		: Pointer to the result.
+ *	@param	outputNames	: Names of the outputs.
+ */
+void				printPolynomialChaosResult(const ConversionModel *  model, const PolynomialChaosResult *  result, const char *  outputNames[kOutputDistributionIndexMax]);
+
+/**
+ *	@brief	Sample the selected output of a polynomial chaos expansion at independent points and
+ *		write the samples to data.out in the format of native Monte Carlo mode.
+ *
+ *	@param	model			: Pointer to the conversion model.
+ *	@param	expansion		: Pointer to the expansion.
+ *	@param	numberOfSamples		: Number of samples.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	samplePolynomialChaosExpansion(const ConversionModel *  model, const PolynomialChaosExpansion *  expansion, size_t numberOfSamples);
@@ -0,0 +1,116 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include "common.h"
+#include "placement.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ *	@brief	Touch the pages of an array of the samples of native Monte Carlo iterations, in any
+ *		representation, first from the threads that will later write them, setting all
+ *		bytes to zero.
+ *
+ *	@param	bytes		: The array.
+ *	@param	sampleSize	: Size of one sample in bytes.
+ *	@param	numberOfSamples	: Number of samples.
+ *	@param	segmentSize	: Number of iterations that every run of the loop over the iterations covers.
+ */
+static void
+firstTouch(unsigned char *  bytes, size_t sampleSize, size_t numberOfSamples, size_t segmentSize)
+{
+	if (segmentSize == 0)
+	{
+		segmentSize = numberOfSamples;
+	}
+
+	for (size_t segmentStart = 0; segmentStart < numberOfSamples; segmentStart += segmentSize)
+	{
+		size_t	segmentEnd = (numberOfSamples - segmentStart < segmentSize) ? numberOfSamples : (segmentStart + segmentSize);
+		size_t	numberOfBlocks = (segmentEnd - segmentStart + kPlacementConstantBlockSize - 1) / kPlacementConstantBlockSize;
+
+		/*
+		 *	Same blocks, static partition, and thread binding as `runMonteCarloIterations()`,
+		 *	so that each thread touches first the pages it later fills.
+		 */
+		#pragma omp parallel for schedule(static) proc_bind(spread)
+		for (size_t block = 0; block < numberOfBlocks; block++)
+		{
+			size_t	blockStart = segmentStart + block * kPlacementConstantBlockSize;
+			size_t	blockEnd = (segmentEnd - blockStart < kPlacementConstantBlockSize) ? segmentEnd : (blockStart + kPlacementConstantBlockSize);
+
+			memset(&bytes[blockStart * sampleSize], 0, (blockEnd - blockStart) * sampleSize);
+		}
+	}
+}
+
+void
+placementFirstTouchSamples(float *  samples, size_t numberOfSamples, size_t segmentSize)
+{
+	firstTouch((unsigned char *) samples, sizeof(float), numberOfSamples, segmentSize);
+}
+
+float *
+placementAllocateSamples(size_t numberOfSamples, size_t segmentSize, const char *  file, int line)
+{
+	float *	samples = (float *) checkedMalloc(numberOfSamples * sizeof(float), file, line);
+
+	placementFirstTouchSamples(samples, numberOfSamples, segmentSize);
+
+	return samples;
+}
+
+void
+placementFirstTouchCodes(uint16_t *  codes, size_t numberOfSamples, size_t segmentSize)
+{
+	firstTouch((unsigned char *) codes, sizeof(uint16_t), numberOfSamples, segmentSize);
+}
+
+uint16_t *
+placementAllocateCodes(size_t numberOfSamples, size_t segmentSize, const char *  file, int line)
+{
+	uint16_t *	codes = (uint16_t *) checkedMalloc(numberOfSamples * sizeof(uint16_t), file, line);
+
+	placementFirstTouchCodes(codes, numberOfSamples, segmentSize);
+
+	return codes;
+}
+
+void
+printPlacement(void)
+{
+#ifdef _OPENMP
+	int	numberOfPlaces = omp_get_num_places();
+
+	printf("OpenMP threads: %d, places: %d%s\n",
+		omp_get_max_threads(),
+		numberOfPlaces,
+		(numberOfPlaces == 0) ? " (threads are not bound; set OMP_PLACES=cores to bind them)" : "");
+#else
+	printf("OpenMP threads: 1 (compiled without OpenMP)\n");
+#endif
+}
@@ -0,0 +1,91 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <stddef.h>
+#include <inttypes.h>
+
+typedef enum
+{
+	/*
+	 *	Number of consecutive native Monte Carlo iterations that one thread runs together. The
+	 *	loops over the iterations share them among the threads in blocks of this size.
+	 */
+	kPlacementConstantBlockSize	= 256,
+} PlacementConstant;
+
+/**
+ *	@brief	Touch the pages of an array of samples of native Monte Carlo iterations first from
+ *		the threads that will later write them, setting all samples to zero. Like the loop
+ *		over the iterations, every segment of `segmentSize` samples is shared among the
+ *		threads in blocks of `kPlacementConstantBlockSize` samples.
+ *
+ *	@param	samples		: The array of samples.
+ *	@param	numberOfSamples	: Number of samples.
+ *	@param	segmentSize	: Number of iterations that every run of the loop over the iterations covers.
+ */
+void	placementFirstTouchSamples(float *  samples, size_t numberOfSamples, size_t segmentSize);
+
+/**
+ *	@brief	Allocate an array for the samples of native Monte Carlo iterations, and touch its
+ *		pages first from the threads that will later write and reduce them. The kernel then
+ *		places every page on the NUMA node of the thread that owns that part of the array,
+ *		instead of placing all of them on the node of the allocating thread.
+ *
+ *	@param	numberOfSamples	: Number of samples.
+ *	@param	segmentSize	: Number of iterations that every run of the loop over the iterations covers.
+ *	@param	file		: Name of the calling source file, for the error message of a failed allocation.
+ *	@param	line		: Line in the calling source file.
+ *	@return			: Pointer to the array, with all samples set to zero.
+ */
+float *	placementAllocateSamples(size_t numberOfSamples, size_t segmentSize, const char *  file, int line);
+
+/**
+ *	@brief	Touch the pages of an array of the 16-bit codes of the samples of native Monte Carlo
+ *		iterations first from the threads that will later write them, as
+ *		`placementFirstTouchSamples()`, setting all codes to zero.
+ *
+ *	@param	codes		: The array of codes.
+ *	@param	numberOfSamples	: Number of codes.
+ *	@param	segmentSize	: Number of iterations that every run of the loop over the iterations covers.
+ */
+void	placementFirstTouchCodes(uint16_t *  codes, size_t numberOfSamples, size_t segmentSize);
+
+/**
+ *	@brief	Allocate an array for the 16-bit codes of the samples of native Monte Carlo
+ *		iterations, and touch its pages first from the threads that will later write them.
+ *
+ *	@param	numberOfSamples	: Number of codes.
+ *	@param	segmentSize	: Number of iterations that every run of the loop over the iterations covers.
+ *	@param	file		: Name of the calling source file, for the error message of a failed allocation.
+ *	@param	line		: Line in the calling source file.
+ *	@return			: Pointer to the array, with all codes set to zero.
+ */
+uint16_t *	placementAllocateCodes(size_t numberOfSamples, size_t segmentSize, const char *  file, int line);
+
+/**
+ *	@brief	Print the number of threads and of the places (e.g., cores) they are bound to.
+ */
+void	printPlacement(void);
@@ -0,0 +1,560 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "precision.h"
+
+/*
+ *	GCC and Clang compile the F16C conversions for x86 processors whether or not the compiler
+ *	targets F16C, and the bulk conversions check for it at run time.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define PRECISION_HAS_F16C_CONVERSIONS
+#endif
+
+/*
+ *	Part of the range of the pilot samples by which the range of the `quantized16` codes
+ *	extends beyond it on either side.
+ */
+static const double	kPrecisionPilotRangeMargin = 0.5;
+
+/*
+ *	Largest finite half-precision float.
+ */
+static const double	kPrecisionHalfMaximum = 65504.0;
+
+static const char *	kSamplePrecisionNames[kSamplePrecisionMax] =
+			{
+				"float32",
+				"float16",
+				"quantized16",
+			};
+
+CommonConstantReturnType
+samplePrecisionFromString(const char *  name, SamplePrecision *  precision)
+{
+	for (SamplePrecision i = 0; i < kSamplePrecisionMax; i++)
+	{
+		if (strcmp(name, kSamplePrecisionNames[i]) == 0)
+		{
+			*precision = i;
+
+			return kCommonConstantReturnTypeSuccess;
+		}
+	}
+
+	return kCommonConstantReturnTypeError;
+}
+
+const char *
+samplePrecisionToString(SamplePrecision precision)
+{
+	return (precision < kSamplePrecisionMax) ? kSamplePrecisionNames[precision] : "unknown";
+}
+
+/**
+ *	@brief	Round a float to the nearest half-precision float, ties to even.
+ *
+ *	@param	value	: The float.
+ *	@return		: Bits of the half-precision float.
+ */
+static uint16_t
+floatToHalf(float value)
+{
+	uint32_t	bits;
+	uint32_t	sign;
+	uint32_t	mantissa;
+	int32_t		exponent;
+	uint32_t	half;
+	uint32_t	remainder;
+	uint32_t	halfway;
+	uint32_t	shift;
+
+	memcpy(&bits, &value, sizeof(bits));
+	sign = (bits >> 16) & 0x8000;
+	mantissa = bits & 0x7fffff;
+
+	if (((bits >> 23) & 0xff) == 0xff)
+	{
+		return (uint16_t)(sign | 0x7c00 | ((mantissa != 0) ? 0x200 : 0));
+	}
+
+	exponent = (int32_t)((bits >> 23) & 0xff) - 127 + 15;
+
+	if (exponent >= 0x1f)
+	{
+		return (uint16_t)(sign | 0x7c00);
+	}
+
+	if (exponent <= 0)
+	{
+		/*
+		 *	Subnormal half-precision float, or zero.
+		 */
+		if (exponent < -10)
+		{
+			return (uint16_t) sign;
+		}
+
+		mantissa |= 0x800000;
+		shift = (uint32_t)(14 - exponent);
+	}
+	else
+	{
+		mantissa |= (uint32_t) exponent << 23;
+		shift = 13;
+	}
+
+	half = mantissa >> shift;
+	remainder = mantissa & ((1u << shift) - 1);
+	halfway = 1u << (shift - 1);
+
+	/*
+	 *	A carry out of the mantissa increments the exponent, which is the correct rounding.
+	 */
+	if ((remainder > halfway) || ((remainder == halfway) && ((half & 1) != 0)))
+	{
+		half++;
+	}
+
+	return (uint16_t)(sign | half);
+}
+
+/**
+ *	@brief	Convert a half-precision float to a float.
+ *
+ *	@param	half	: Bits of the half-precision float.
+ *	@return		: The float.
+ */
+static float
+halfToFloat(uint16_t half)
+{
+	uint32_t	sign = ((uint32_t) half & 0x8000) << 16;
+	uint32_t	exponent = ((uint32_t) half >> 10) & 0x1f;
+	uint32_t	mantissa = (uint32_t) half & 0x3ff;
+	uint32_t	bits;
+	float		value;
+
+	if (exponent == 0)
+	{
+		value = ldexpf((float) mantissa, -24);
+
+		return (sign != 0) ? -value : value;
+	}
+
+	if (exponent == 0x1f)
+	{
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+	}
+
+	memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+#ifdef PRECISION_HAS_F16C_CONVERSIONS
+/**
+ *	@brief	Convert floats to half-precision floats with F16C instructions, eight at a time.
+ *
+ *	@param	samples		: The floats.
+ *	@param	numberOfSamples	: Number of floats.
+ *	@param	codes		: Array to store the bits of the half-precision floats into.
+ *	@return			: Number of floats converted, the largest multiple of eight up to `numberOfSamples`.
+ */
+__attribute__((target("avx,f16c")))
+static size_t
+encodeHalvesF16C(const float *  samples, size_t numberOfSamples, uint16_t *  codes)
+{
+	size_t	i = 0;
+
+	for (; i + 8 <= numberOfSamples; i += 8)
+	{
+		__m128i	halves = _mm256_cvtps_ph(_mm256_loadu_ps(&samples[i]), _MM_FROUND_TO_NEAREST_INT);
+
+		_mm_storeu_si128((__m128i *) &codes[i], halves);
+	}
+
+	return i;
+}
+
+/**
+ *	@brief	Convert half-precision floats to floats with F16C instructions, eight at a time.
+ *
+ *	@param	codes		: Bits of the half-precision floats.
+ *	@param	numberOfSamples	: Number of half-precision floats.
+ *	@param	samples		: Array to store the floats into.
+ *	@return			: Number of half-precision floats converted, the largest multiple of eight up to `numberOfSamples`.
+ */
+__attribute__((target("avx,f16c")))
+static size_t
+decodeHalvesF16C(const uint16_t *  codes, size_t numberOfSamples, float *  samples)
+{
+	size_t	i = 0;
+
+	for (; i + 8 <= numberOfSamples; i += 8)
+	{
+		_mm256_storeu_ps(&samples[i], _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *) &codes[i])));
+	}
+
+	return i;
+}
+#endif
+
+/**
+ *	@brief	Map the code of a sample to its rank among the codes in the order of the values
+ *		they store. The codes of `quantized16` are in order already; half-precision floats
+ *		with the sign bit set are in reverse order, below those without it.
+ *
+ *	@param	quantizer	: Pointer to the quantizer.
+ *	@param	code		: The code.
+ *	@return			: The rank of the code.
+ */
+static inline uint16_t
+orderKeyOfCode(const SampleQuantizer *  quantizer, uint16_t code)
+{
+	if (quantizer->precision != kSamplePrecisionFloat16)
+	{
+		return code;
+	}
+
+	return ((code & 0x8000) != 0) ? (uint16_t)(0xffff - code) : (uint16_t)(code | 0x8000);
+}
+
+/**
+ *	@brief	Map a rank among the codes back to its code, the inverse of `orderKeyOfCode()`.
+ *
+ *	@param	quantizer	: Pointer to the quantizer.
+ *	@param	key		: The rank of the code.
+ *	@return			: The code.
+ */
+static inline uint16_t
+codeOfOrderKey(const SampleQuantizer *  quantizer, uint16_t key)
+{
+	if (quantizer->precision != kSamplePrecisionFloat16)
+	{
+		return key;
+	}
+
+	return ((key & 0x8000) != 0) ? (uint16_t)(key & 0x7fff) : (uint16_t)(0xffff - key);
+}
+
+bool
+samplePrecisionHasF16C(void)
+{
+#ifdef PRECISION_HAS_F16C_CONVERSIONS
+	return __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+#else
+	return false;
+#endif
+}
+
+SampleQuantizer
+sampleQuantizerForPilotSamples(SamplePrecision precision, const float *  samples, size_t numberOfSamples)
+{
+	SampleQuantizer	quantizer = {
+				.precision	= precision,
+				.offset		= 0.0,
+				.step		= 0.0,
+			};
+	float		minimum = FLT_MAX;
+	float		maximum = -FLT_MAX;
+	double		margin;
+
+	if ((precision != kSamplePrecisionQuantized16) || (numberOfSamples == 0))
+	{
+		return quantizer;
+	}
+
+	#pragma omp parallel for schedule(static) proc_bind(spread) reduction(min: minimum) reduction(max: maximum)
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		minimum = fminf(minimum, samples[i]);
+		maximum = fmaxf(maximum, samples[i]);
+	}
+
+	margin = kPrecisionPilotRangeMargin * ((double) maximum - (double) minimum);
+	quantizer.offset = (double) minimum - margin;
+	quantizer.step = ((double) maximum - (double) minimum + 2.0 * margin) / kPrecisionConstantMaxQuantizedCode;
+
+	return quantizer;
+}
+
+size_t
+sampleQuantizerHeaderSize(const SampleQuantizer *  quantizer)
+{
+	return (quantizer->precision == kSamplePrecisionQuantized16) ? 2 * sizeof(double) : 0;
+}
+
+void
+sampleQuantizerEncode(const SampleQuantizer *  quantizer, const float *  samples, size_t numberOfSamples, uint16_t *  codes)
+{
+	size_t	i = 0;
+
+	if (quantizer->precision == kSamplePrecisionQuantized16)
+	{
+		double	scale = (quantizer->step > 0.0) ? (1.0 / quantizer->step) : 0.0;
+
+		#pragma omp simd
+		for (i = 0; i < numberOfSamples; i++)
+		{
+			double	code = nearbyint((samples[i] - quantizer->offset) * scale);
+
+			codes[i] = (uint16_t) fmin(fmax(code, 0.0), (double) kPrecisionConstantMaxQuantizedCode);
+		}
+
+		return;
+	}
+
+#ifdef PRECISION_HAS_F16C_CONVERSIONS
+	if (samplePrecisionHasF16C())
+	{
+		i = encodeHalvesF16C(samples, numberOfSamples, codes);
+	}
+#endif
+
+	for (; i < numberOfSamples; i++)
+	{
+		codes[i] = floatToHalf(samples[i]);
+	}
+}
+
+void
+sampleQuantizerEncodeMeasured(
+	const SampleQuantizer *	quantizer,
+	const float *		samples,
+	size_t			numberOfSamples,
+	uint16_t *		codes,
+	QuantizationError *	error)
+{
+	size_t	numberOfBlocks = (numberOfSamples + kPrecisionConstantBlockSize - 1) / kPrecisionConstantBlockSize;
+	double	lowest = -kPrecisionHalfMaximum;
+	double	highest = kPrecisionHalfMaximum;
+	double	maximumAbsoluteError = 0.0;
+	double	sumOfAbsoluteErrors = 0.0;
+	size_t	numberOfClampedSamples = 0;
+
+	if (error == NULL)
+	{
+		#pragma omp parallel for schedule(static) proc_bind(spread)
+		for (size_t block = 0; block < numberOfBlocks; block++)
+		{
+			size_t	blockStart = block * kPrecisionConstantBlockSize;
+			size_t	blockSize = numberOfSamples - blockStart;
+
+			blockSize = (blockSize < kPrecisionConstantBlockSize) ? blockSize : kPrecisionConstantBlockSize;
+			sampleQuantizerEncode(quantizer, &samples[blockStart], blockSize, &codes[blockStart]);
+		}
+
+		return;
+	}
+
+	if (quantizer->precision == kSamplePrecisionQuantized16)
+	{
+		lowest = quantizer->offset;
+		highest = quantizer->offset + kPrecisionConstantMaxQuantizedCode * quantizer->step;
+	}
+
+	#pragma omp parallel for schedule(static) proc_bind(spread) reduction(max: maximumAbsoluteError) reduction(+: sumOfAbsoluteErrors, numberOfClampedSamples)
+	for (size_t block = 0; block < numberOfBlocks; block++)
+	{
+		size_t	blockStart = block * kPrecisionConstantBlockSize;
+		size_t	blockSize = numberOfSamples - blockStart;
+		float	stored[kPrecisionConstantBlockSize];
+
+		blockSize = (blockSize < kPrecisionConstantBlockSize) ? blockSize : kPrecisionConstantBlockSize;
+		sampleQuantizerEncode(quantizer, &samples[blockStart], blockSize, &codes[blockStart]);
+		sampleQuantizerDecode(quantizer, &codes[blockStart], blockSize, stored);
+
+		for (size_t j = 0; j < blockSize; j++)
+		{
+			/*
+			 *	The stored samples are the codes decoded to floats, so the error includes
+			 *	the rounding to floats, which can exceed the steps of `quantized16`.
+			 */
+			double	sample = samples[blockStart + j];
+			double	absoluteError = fabs((double) stored[j] - sample);
+
+			maximumAbsoluteError = fmax(maximumAbsoluteError, absoluteError);
+			sumOfAbsoluteErrors += absoluteError;
+			numberOfClampedSamples += ((sample < lowest) || (sample > highest)) ? 1 : 0;
+		}
+	}
+
+	error->numberOfSamples += numberOfSamples;
+	error->numberOfClampedSamples += numberOfClampedSamples;
+	error->maximumAbsoluteError = fmax(error->maximumAbsoluteError, maximumAbsoluteError);
+	error->sumOfAbsoluteErrors += sumOfAbsoluteErrors;
+}
+
+void
+sampleQuantizerDecode(const SampleQuantizer *  quantizer, const uint16_t *  codes, size_t numberOfSamples, float *  samples)
+{
+	size_t	i = 0;
+
+	if (quantizer->precision == kSamplePrecisionQuantized16)
+	{
+		#pragma omp simd
+		for (i = 0; i < numberOfSamples; i++)
+		{
+			samples[i] = (float)(quantizer->offset + codes[i] * quantizer->step);
+		}
+
+		return;
+	}
+
+#ifdef PRECISION_HAS_F16C_CONVERSIONS
+	if (samplePrecisionHasF16C())
+	{
+		i = decodeHalvesF16C(codes, numberOfSamples, samples);
+	}
+#endif
+
+	for (; i < numberOfSamples; i++)
+	{
+		samples[i] = halfToFloat(codes[i]);
+	}
+}
+
+bool
+sampleQuantizerWriteCodes(const SampleQuantizer *  quantizer, const uint16_t *  codes, size_t numberOfSamples, FILE *  file)
+{
+	if ((quantizer->precision == kSamplePrecisionQuantized16) &&
+		((fwrite(&quantizer->offset, sizeof(double), 1, file) != 1) || (fwrite(&quantizer->step, sizeof(double), 1, file) != 1)))
+	{
+		return false;
+	}
+
+	return (fwrite(codes, sizeof(uint16_t), numberOfSamples, file) == numberOfSamples);
+}
+
+void
+printQuantizationError(const SampleQuantizer *  quantizer, const QuantizationError *  error, double standardDeviation)
+{
+	double	meanAbsoluteError = (error->numberOfSamples > 0) ? (error->sumOfAbsoluteErrors / error->numberOfSamples) : 0.0;
+
+	printf("\nSamples stored as %s", samplePrecisionToString(quantizer->precision));
+
+	if (quantizer->precision == kSamplePrecisionQuantized16)
+	{
+		printf(" (offset %.9g, step %.6e)", quantizer->offset, quantizer->step);
+	}
+	else if (samplePrecisionHasF16C())
+	{
+		printf(" (F16C conversions)");
+	}
+
+	printf(": maximum error %.6e, Wasserstein-1 distance to the exact samples %.6e", error->maximumAbsoluteError, meanAbsoluteError);
+
+	if (standardDeviation > 0.0)
+	{
+		printf(" (%.3e standard deviations)", meanAbsoluteError / standardDeviation);
+	}
+
+	printf("\n");
+
+	if (error->numberOfClampedSamples > 0)
+	{
+		printf("%zu samples were outside the range of the codes and store its nearest end.\n", error->numberOfClampedSamples);
+	}
+}
+
+void
+sampleCodeHistogramInit(SampleCodeHistogram *  histogram, const SampleQuantizer *  quantizer)
+{
+	histogram->quantizer = *quantizer;
+	histogram->counts = (size_t *) checkedMalloc(kPrecisionConstantNumberOfCodes * sizeof(size_t), __FILE__, __LINE__);
+	histogram->numberOfSamples = 0;
+	memset(histogram->counts, 0, kPrecisionConstantNumberOfCodes * sizeof(size_t));
+}
+
+void
+sampleCodeHistogramAdd(SampleCodeHistogram *  histogram, const uint16_t *  codes, size_t numberOfSamples)
+{
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		histogram->counts[orderKeyOfCode(&histogram->quantizer, codes[i])]++;
+	}
+
+	histogram->numberOfSamples += numberOfSamples;
+}
+
+/**
+ *	@brief	Decode the code of a rank among the codes.
+ *
+ *	@param	quantizer	: Pointer to the quantizer.
+ *	@param	key		: Rank of the code.
+ *	@return			: The value of the code.
+ */
+static float
+valueOfOrderKey(const SampleQuantizer *  quantizer, uint16_t key)
+{
+	uint16_t	code = codeOfOrderKey(quantizer, key);
+	float		value;
+
+	sampleQuantizerDecode(quantizer, &code, 1, &value);
+
+	return value;
+}
+
+void
+sampleCodeHistogramSelect(const SampleCodeHistogram *  histogram, size_t k, float *  lowerEdge, float *  upperEdge)
+{
+	size_t	cumulativeCount = 0;
+	float	value;
+
+	for (size_t key = 0; key < kPrecisionConstantNumberOfCodes; key++)
+	{
+		cumulativeCount += histogram->counts[key];
+
+		if (cumulativeCount > k)
+		{
+			value = valueOfOrderKey(&histogram->quantizer, (uint16_t) key);
+			*lowerEdge = (key > 0) ?
+					0.5f * (value + valueOfOrderKey(&histogram->quantizer, (uint16_t)(key - 1))) :
+					value;
+			*upperEdge = (key < kPrecisionConstantMaxQuantizedCode) ?
+					0.5f * (value + valueOfOrderKey(&histogram->quantizer, (uint16_t)(key + 1))) :
+					value;
+
+			return;
+		}
+	}
+
+	*lowerEdge = NAN;
+	*upperEdge = NAN;
+}
+
+void
+sampleCodeHistogramFree(SampleCodeHistogram *  histogram)
+{
+	free(histogram->counts);
+	histogram->counts = NULL;
+}
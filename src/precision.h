@@ -0,0 +1,228 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+
+typedef enum
+{
+	kSamplePrecisionFloat32			= 0,
+	kSamplePrecisionFloat16,
+	kSamplePrecisionQuantized16,
+	kSamplePrecisionMax
+} SamplePrecision;
+
+typedef enum
+{
+	kPrecisionConstantMaxQuantizedCode	= 65535,
+	kPrecisionConstantNumberOfCodes		= 65536,
+	/*
+	 *	Number of samples that one step of a bulk conversion handles.
+	 */
+	kPrecisionConstantBlockSize		= 4096,
+} PrecisionConstant;
+
+/*
+ *	Mapping of samples to 16-bit codes: IEEE 754 half-precision floats, or the offsets from
+ *	`offset` in steps of `step`.
+ */
+typedef struct SampleQuantizer
+{
+	SamplePrecision	precision;
+	double		offset;
+	double		step;
+} SampleQuantizer;
+
+/*
+ *	Error of storing samples as 16-bit codes, summed over the samples stored so far. Rounding
+ *	to the nearest code keeps the order of the samples, so the mean absolute error is also the
+ *	Wasserstein-1 distance between the distributions of the samples before and after storing
+ *	them. Zero-initialize before storing the first samples.
+ */
+typedef struct QuantizationError
+{
+	size_t	numberOfSamples;
+	/*
+	 *	Number of samples outside the range of the codes, which store the nearest end of it.
+	 */
+	size_t	numberOfClampedSamples;
+	double	maximumAbsoluteError;
+	double	sumOfAbsoluteErrors;
+} QuantizationError;
+
+/*
+ *	Counts of the 16-bit codes of a set of samples, in the order of the values that the codes
+ *	store, from which order statistics of the stored samples follow without the samples.
+ */
+typedef struct SampleCodeHistogram
+{
+	SampleQuantizer	quantizer;
+	size_t *	counts;
+	size_t		numberOfSamples;
+} SampleCodeHistogram;
+
+/**
+ *	@brief	Parse a sample precision name.
+ *
+ *	@param	name		: One of "float32", "float16", or "quantized16".
+ *	@param	precision	: Pointer to store the parsed precision.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	samplePrecisionFromString(const char *  name, SamplePrecision *  precision);
+
+/**
+ *	@brief	Get the name of a sample precision.
+ *
+ *	@param	precision	: The precision.
+ *	@return			: Name of the precision.
+ */
+const char *			samplePrecisionToString(SamplePrecision precision);
+
+/**
+ *	@brief	Check whether the processor converts half-precision floats with F16C instructions,
+ *		which the bulk conversions then use whether or not the compiler targets them.
+ *
+ *	@return	: `true` if the conversions use F16C instructions.
+ */
+bool				samplePrecisionHasF16C(void);
+
+/**
+ *	@brief	Set up the quantizer of a precision for the samples of a run from a pilot of its
+ *		first samples. For `quantized16`, the codes span the range of the pilot, widened by
+ *		half of it on either side for the samples of the run beyond the pilot.
+ *
+ *	@param	precision	: The precision.
+ *	@param	samples		: The samples of the pilot.
+ *	@param	numberOfSamples	: Number of samples of the pilot.
+ *	@return			: The quantizer.
+ */
+SampleQuantizer			sampleQuantizerForPilotSamples(SamplePrecision precision, const float *  samples, size_t numberOfSamples);
+
+/**
+ *	@brief	Size of the header that precedes the codes in files: the offset and step (two
+ *		doubles) for `quantized16`, none for `float16`.
+ *
+ *	@param	quantizer	: Pointer to the quantizer.
+ *	@return			: Size of the header in bytes.
+ */
+size_t				sampleQuantizerHeaderSize(const SampleQuantizer *  quantizer);
+
+/**
+ *	@brief	Convert samples to 16-bit codes, with F16C instructions for `float16` if the
+ *		processor has them.
+ *
+ *	@param	quantizer	: Pointer to the quantizer.
+ *	@param	samples		: The samples.
+ *	@param	numberOfSamples	: Number of samples.
+ *	@param	codes		: Array of `numberOfSamples` entries to store the codes into.
+ */
+void				sampleQuantizerEncode(const SampleQuantizer *  quantizer, const float *  samples, size_t numberOfSamples, uint16_t *  codes);
+
+/**
+ *	@brief	Convert samples to 16-bit codes in parallel, and add the error of the values that
+ *		the codes store to `error`.
+ *
+ *	@param	quantizer	: Pointer to the quantizer.
+ *	@param	samples		: The samples.
+ *	@param	numberOfSamples	: Number of samples.
+ *	@param	codes		: Array of `numberOfSamples` entries to store the codes into.
+ *	@param	error		: Pointer to the error to add to, or `NULL`.
+ */
+void				sampleQuantizerEncodeMeasured(
+					const SampleQuantizer *	quantizer,
+					const float *		samples,
+					size_t			numberOfSamples,
+					uint16_t *		codes,
+					QuantizationError *	error);
+
+/**
+ *	@brief	Convert 16-bit codes back to samples.
+ *
+ *	@param	quantizer	: Pointer to the quantizer.
+ *	@param	codes		: The codes.
+ *	@param	numberOfSamples	: Number of codes.
+ *	@param	samples		: Array of `numberOfSamples` entries to store the samples into.
+ */
+void				sampleQuantizerDecode(const SampleQuantizer *  quantizer, const uint16_t *  codes, size_t numberOfSamples, float *  samples);
+
+/**
+ *	@brief	Write the header of `sampleQuantizerHeaderSize()` bytes and then the codes, in the
+ *		byte order of the machine.
+ *
+ *	@param	quantizer	: Pointer to the quantizer.
+ *	@param	codes		: The codes.
+ *	@param	numberOfSamples	: Number of codes.
+ *	@param	file		: The file to write to.
+ *	@return			: `true` if everything was written.
+ */
+bool				sampleQuantizerWriteCodes(const SampleQuantizer *  quantizer, const uint16_t *  codes, size_t numberOfSamples, FILE *  file);
+
+/**
+ *	@brief	Print the error of storing the samples at reduced precision.
+ *
+ *	@param	quantizer		: Pointer to the quantizer.
+ *	@param	error			: Pointer to the error.
+ *	@param	standardDeviation	: Standard deviation of the samples, to put the error in scale.
+ */
+void				printQuantizationError(const SampleQuantizer *  quantizer, const QuantizationError *  error, double standardDeviation);
+
+/**
+ *	@brief	Create an empty histogram of the codes of a quantizer.
+ *
+ *	@param	histogram	: Pointer to the histogram to create.
+ *	@param	quantizer	: Pointer to the quantizer of the codes.
+ */
+void				sampleCodeHistogramInit(SampleCodeHistogram *  histogram, const SampleQuantizer *  quantizer);
+
+/**
+ *	@brief	Count codes into a histogram.
+ *
+ *	@param	histogram	: Pointer to the histogram.
+ *	@param	codes		: The codes.
+ *	@param	numberOfSamples	: Number of codes.
+ */
+void				sampleCodeHistogramAdd(SampleCodeHistogram *  histogram, const uint16_t *  codes, size_t numberOfSamples);
+
+/**
+ *	@brief	Find the range of exact values that the `k`-th smallest (from zero) code of a
+ *		histogram stands for: from halfway to the next smaller code to halfway to the next
+ *		larger one.
+ *
+ *	@param	histogram	: Pointer to the histogram.
+ *	@param	k		: Rank of the sample, less than the number of samples of the histogram.
+ *	@param	lowerEdge	: Pointer to store the lower end of the range.
+ *	@param	upperEdge	: Pointer to store the upper end of the range.
+ */
+void				sampleCodeHistogramSelect(const SampleCodeHistogram *  histogram, size_t k, float *  lowerEdge, float *  upperEdge);
+
+/**
+ *	@brief	Free the counts of a histogram.
+ *
+ *	@param	histogram	: Pointer to the histogram.
+ */
+void				sampleCodeHistogramFree(SampleCodeHistogram *  histogram);
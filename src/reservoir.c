@@ -0,0 +1,254 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <string.h>
+#include "reservoir.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+typedef struct ReservoirEntry
+{
+	uint64_t	key;
+	uint64_t	index;
+} ReservoirEntry;
+
+static int
+compareKeys(const void *  a, const void *  b)
+{
+	uint64_t	keyA = ((const ReservoirEntry *) a)->key;
+	uint64_t	keyB = ((const ReservoirEntry *) b)->key;
+
+	return (keyA > keyB) - (keyA < keyB);
+}
+
+static int
+compareIndices(const void *  a, const void *  b)
+{
+	uint64_t	indexA = ((const ReservoirEntry *) a)->index;
+	uint64_t	indexB = ((const ReservoirEntry *) b)->index;
+
+	return (indexA > indexB) - (indexA < indexB);
+}
+
+/**
+ *	@brief	Restore the max-heap order of the entries above `position` after its key increased.
+ *
+ *	@param	heap		: The entries of the heap.
+ *	@param	position	: Position of the entry whose key increased.
+ */
+static void
+siftUp(ReservoirEntry *  heap, size_t position)
+{
+	while ((position > 0) && (heap[(position - 1) / 2].key < heap[position].key))
+	{
+		ReservoirEntry	swap = heap[position];
+
+		heap[position] = heap[(position - 1) / 2];
+		heap[(position - 1) / 2] = swap;
+		position = (position - 1) / 2;
+	}
+}
+
+/**
+ *	@brief	Restore the max-heap order of the entries below `position` after its key decreased.
+ *
+ *	@param	heap		: The entries of the heap.
+ *	@param	heapSize	: Number of entries of the heap.
+ *	@param	position	: Position of the entry whose key decreased.
+ */
+static void
+siftDown(ReservoirEntry *  heap, size_t heapSize, size_t position)
+{
+	for (;;)
+	{
+		size_t		largest = position;
+		size_t		left = 2 * position + 1;
+		size_t		right = left + 1;
+		ReservoirEntry	swap;
+
+		if ((left < heapSize) && (heap[left].key > heap[largest].key))
+		{
+			largest = left;
+		}
+
+		if ((right < heapSize) && (heap[right].key > heap[largest].key))
+		{
+			largest = right;
+		}
+
+		if (largest == position)
+		{
+			return;
+		}
+
+		swap = heap[position];
+		heap[position] = heap[largest];
+		heap[largest] = swap;
+		position = largest;
+	}
+}
+
+/**
+ *	@brief	Select the entries of the samples with the `reservoirSize` smallest keys, for more
+ *		samples than `reservoirSize`.
+ *
+ *	@param	numberOfSamples	: Number of samples.
+ *	@param	reservoirSize	: Number of samples to select.
+ *	@param	seed		: Seed of the run.
+ *	@return			: Array whose first `reservoirSize` entries are the selected samples in their
+ *				  original order. The caller frees it.
+ */
+static ReservoirEntry *
+selectSmallestKeys(size_t numberOfSamples, size_t reservoirSize, uint64_t seed)
+{
+	size_t			numberOfThreads = 1;
+	ReservoirEntry *	candidates;
+	size_t *		numberOfCandidates;
+	size_t			numberOfMergedCandidates = 0;
+
+#ifdef _OPENMP
+	numberOfThreads = (size_t) omp_get_max_threads();
+#endif
+
+	candidates = (ReservoirEntry *) checkedMalloc(numberOfThreads * reservoirSize * sizeof(ReservoirEntry), __FILE__, __LINE__);
+	numberOfCandidates = (size_t *) checkedMalloc(numberOfThreads * sizeof(size_t), __FILE__, __LINE__);
+
+	for (size_t thread = 0; thread < numberOfThreads; thread++)
+	{
+		numberOfCandidates[thread] = 0;
+	}
+
+	/*
+	 *	Each thread keeps the entries of the smallest keys of its part as a max-heap, whose
+	 *	root is the entry to replace next.
+	 */
+	#pragma omp parallel num_threads(numberOfThreads) proc_bind(spread)
+	{
+		size_t			thread = 0;
+		ReservoirEntry *	heap;
+		size_t			heapSize = 0;
+
+#ifdef _OPENMP
+		thread = (size_t) omp_get_thread_num();
+#endif
+		heap = &candidates[thread * reservoirSize];
+
+		#pragma omp for schedule(static)
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			ReservoirEntry	entry = {
+						.key	= samplingRandomBits(seed, kReservoirConstantKeyStream, i),
+						.index	= i,
+					};
+
+			if (heapSize < reservoirSize)
+			{
+				heap[heapSize] = entry;
+				siftUp(heap, heapSize);
+				heapSize++;
+			}
+			else if (entry.key < heap[0].key)
+			{
+				heap[0] = entry;
+				siftDown(heap, heapSize, 0);
+			}
+		}
+
+		numberOfCandidates[thread] = heapSize;
+	}
+
+	/*
+	 *	Merge: the smallest keys overall are the smallest among the threads' smallest keys.
+	 */
+	for (size_t thread = 0; thread < numberOfThreads; thread++)
+	{
+		memmove(&candidates[numberOfMergedCandidates], &candidates[thread * reservoirSize], numberOfCandidates[thread] * sizeof(ReservoirEntry));
+		numberOfMergedCandidates += numberOfCandidates[thread];
+	}
+
+	qsort(candidates, numberOfMergedCandidates, sizeof(ReservoirEntry), compareKeys);
+	qsort(candidates, reservoirSize, sizeof(ReservoirEntry), compareIndices);
+	free(numberOfCandidates);
+
+	return candidates;
+}
+
+size_t
+reservoirSampleOutputs(
+	const float *	samples,
+	size_t		numberOfSamples,
+	size_t		reservoirSize,
+	uint64_t	seed,
+	float *		reservoir)
+{
+	ReservoirEntry *	selected;
+
+	if (numberOfSamples <= reservoirSize)
+	{
+		memcpy(reservoir, samples, numberOfSamples * sizeof(float));
+
+		return numberOfSamples;
+	}
+
+	selected = selectSmallestKeys(numberOfSamples, reservoirSize, seed);
+
+	for (size_t i = 0; i < reservoirSize; i++)
+	{
+		reservoir[i] = samples[selected[i].index];
+	}
+
+	free(selected);
+
+	return reservoirSize;
+}
+
+size_t
+reservoirSampleCodes(
+	const uint16_t *	codes,
+	size_t			numberOfSamples,
+	size_t			reservoirSize,
+	uint64_t		seed,
+	uint16_t *		reservoir)
+{
+	ReservoirEntry *	selected;
+
+	if (numberOfSamples <= reservoirSize)
+	{
+		memcpy(reservoir, codes, numberOfSamples * sizeof(uint16_t));
+
+		return numberOfSamples;
+	}
+
+	selected = selectSmallestKeys(numberOfSamples, reservoirSize, seed);
+
+	for (size_t i = 0; i < reservoirSize; i++)
+	{
+		reservoir[i] = codes[selected[i].index];
+	}
+
+	free(selected);
+
+	return reservoirSize;
+}
@@ -0,0 +1,78 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include "common.h"
+#include "sampling.h"
+
+typedef enum
+{
+	/*
+	 *	Stream of the random keys that select the samples of the reservoir, after the streams
+	 *	that the sampler and the analyses use.
+	 */
+	kReservoirConstantKeyStream	= kSamplingStreamMax + 1,
+} ReservoirConstant;
+
+/**
+ *	@brief	Select a uniform random subset of at most `reservoirSize` of the samples, without
+ *		replacement, for output. Every sample gets a random key from a counter-based stream
+ *		indexed by its position, and the subset is the samples with the smallest keys. Each
+ *		thread keeps the smallest keys of its part of the samples, and merging the threads'
+ *		reservoirs gives the same subset for any number of threads.
+ *
+ *	@param	samples		: The samples.
+ *	@param	numberOfSamples	: Number of samples.
+ *	@param	reservoirSize	: Maximum number of samples to select.
+ *	@param	seed		: Seed of the run.
+ *	@param	reservoir	: Array of `reservoirSize` entries to store the selected samples into, in their original order.
+ *	@return			: Number of samples selected, the smaller of `numberOfSamples` and `reservoirSize`.
+ */
+size_t	reservoirSampleOutputs(
+		const float *	samples,
+		size_t		numberOfSamples,
+		size_t		reservoirSize,
+		uint64_t	seed,
+		float *		reservoir);
+
+/**
+ *	@brief	Select the same subset as `reservoirSampleOutputs()` from the 16-bit codes of the
+ *		samples.
+ *
+ *	@param	codes		: The codes of the samples.
+ *	@param	numberOfSamples	: Number of samples.
+ *	@param	reservoirSize	: Maximum number of samples to select.
+ *	@param	seed		: Seed of the run.
+ *	@param	reservoir	: Array of `reservoirSize` entries to store the codes of the selected samples into, in their original order.
+ *	@return			: Number of samples selected, the smaller of `numberOfSamples` and `reservoirSize`.
+ */
+size_t	reservoirSampleCodes(
+		const uint16_t *	codes,
+		size_t			numberOfSamples,
+		size_t			reservoirSize,
+		uint64_t		seed,
+		uint16_t *		reservoir);
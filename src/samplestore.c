@@ -0,0 +1,463 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include "samplestore.h"
+#include "placement.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static const char *	kSampleStoreBackendNames[kSampleStoreBackendMax] =
+			{
+				"heap",
+				"huge-pages",
+				"file",
+			};
+
+CommonConstantReturnType
+sampleStoreBackendFromString(const char *  name, SampleStoreBackend *  backend)
+{
+	for (SampleStoreBackend i = 0; i < kSampleStoreBackendMax; i++)
+	{
+		if (strcmp(name, kSampleStoreBackendNames[i]) == 0)
+		{
+			*backend = i;
+
+			return kCommonConstantReturnTypeSuccess;
+		}
+	}
+
+	return kCommonConstantReturnTypeError;
+}
+
+const char *
+sampleStoreBackendToString(SampleStoreBackend backend)
+{
+	return (backend < kSampleStoreBackendMax) ? kSampleStoreBackendNames[backend] : "unknown";
+}
+
+#ifdef MAP_FAILED
+/**
+ *	@brief	Size of one sample of a store: a float, or a 16-bit code.
+ *
+ *	@param	store	: Pointer to the sample store.
+ *	@return		: Size of one sample in bytes.
+ */
+static size_t
+sampleSize(const SampleStore *  store)
+{
+	return (store->quantizer.precision == kSamplePrecisionFloat32) ? sizeof(float) : sizeof(uint16_t);
+}
+
+/**
+ *	@brief	Size of the header of the quantizer at the start of the file of a file-backed store.
+ *
+ *	@param	store	: Pointer to the sample store.
+ *	@return		: Size of the header in bytes.
+ */
+static size_t
+fileHeaderSize(const SampleStore *  store)
+{
+	return (store->backend == kSampleStoreBackendFile) ? sampleQuantizerHeaderSize(&store->quantizer) : 0;
+}
+#endif
+
+/**
+ *	@brief	Point the samples or codes of a store into its memory, after the file header.
+ *
+ *	@param	store		: Pointer to the sample store.
+ *	@param	memory		: The memory of the store.
+ *	@param	headerSize	: Size of the file header at the start of the memory in bytes.
+ */
+static void
+setSampleArrays(SampleStore *  store, unsigned char *  memory, size_t headerSize)
+{
+	store->memory = memory;
+
+	if (store->quantizer.precision == kSamplePrecisionFloat32)
+	{
+		store->samples = (float *) &memory[headerSize];
+	}
+	else
+	{
+		store->codes = (uint16_t *) &memory[headerSize];
+	}
+}
+
+/**
+ *	@brief	Allocate heap memory for the samples or codes of a store.
+ *
+ *	@param	store		: Pointer to the sample store, with `numberOfSamples` set.
+ *	@param	segmentSize	: Number of iterations that every run of the loop over the iterations covers.
+ */
+static void
+allocateSampleArrays(SampleStore *  store, size_t segmentSize)
+{
+	if (store->quantizer.precision == kSamplePrecisionFloat32)
+	{
+		setSampleArrays(store, (unsigned char *) placementAllocateSamples(store->numberOfSamples, segmentSize, __FILE__, __LINE__), 0);
+	}
+	else
+	{
+		setSampleArrays(store, (unsigned char *) placementAllocateCodes(store->numberOfSamples, segmentSize, __FILE__, __LINE__), 0);
+	}
+}
+
+/**
+ *	@brief	Map anonymous memory for a huge-page store, from the reserved explicit huge pages
+ *		if possible, else from normal pages that the kernel may merge into transparent
+ *		huge pages.
+ *
+ *	@param	store		: Pointer to the sample store, with `numberOfSamples` set.
+ *	@param	segmentSize	: Number of iterations that every run of the loop over the iterations covers.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+mapHugePages(SampleStore *  store, size_t segmentSize)
+{
+#ifdef MAP_FAILED
+	void *	mapping = MAP_FAILED;
+
+	store->mappedSize = ((store->numberOfSamples * sampleSize(store) + kSampleStoreConstantHugePageSize - 1) / kSampleStoreConstantHugePageSize) * kSampleStoreConstantHugePageSize;
+
+#ifdef MAP_HUGETLB
+	mapping = mmap(NULL, store->mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	store->hasExplicitHugePages = (mapping != MAP_FAILED);
+#endif
+
+	if (mapping == MAP_FAILED)
+	{
+		mapping = mmap(NULL, store->mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if (mapping == MAP_FAILED)
+		{
+			fprintf(stderr, "Error: Could not map %zu bytes for the samples: %s.\n", store->mappedSize, strerror(errno));
+
+			return kCommonConstantReturnTypeError;
+		}
+
+#ifdef MADV_HUGEPAGE
+		madvise(mapping, store->mappedSize, MADV_HUGEPAGE);
+#endif
+	}
+
+	setSampleArrays(store, (unsigned char *) mapping, 0);
+
+	/*
+	 *	Anonymous memory is already zero, but the touch places its pages on the nodes of the
+	 *	threads that use them.
+	 */
+	if (store->samples != NULL)
+	{
+		placementFirstTouchSamples(store->samples, store->numberOfSamples, segmentSize);
+	}
+	else
+	{
+		placementFirstTouchCodes(store->codes, store->numberOfSamples, segmentSize);
+	}
+#else
+	fprintf(stderr, "Warning: Huge pages need mmap(), which this system does not provide. The samples use heap memory.\n");
+	store->backend = kSampleStoreBackendHeap;
+	allocateSampleArrays(store, segmentSize);
+#endif
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Create the file of a file-backed store and map it. Without `mmap()`, the samples are
+ *		in heap memory until `sampleStoreSync()` writes them to the file.
+ *
+ *	@param	store		: Pointer to the sample store, with `numberOfSamples` set.
+ *	@param	path		: Path of the file.
+ *	@param	segmentSize	: Number of iterations that every run of the loop over the iterations covers.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+mapFile(SampleStore *  store, const char *  path, size_t segmentSize)
+{
+#ifdef MAP_FAILED
+	void *	mapping;
+#endif
+	int	ret = snprintf(store->path, kCommonConstantMaxCharsPerFilepath, "%s", path);
+
+	if ((ret < 0) || (ret >= kCommonConstantMaxCharsPerFilepath))
+	{
+		fprintf(stderr, "Error: The sample file path is too long.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+#ifdef MAP_FAILED
+	(void) segmentSize;
+	store->mappedSize = fileHeaderSize(store) + store->numberOfSamples * sampleSize(store);
+	store->fileDescriptor = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+	if (store->fileDescriptor < 0)
+	{
+		fprintf(stderr, "Error: Could not create sample file \"%s\": %s.\n", path, strerror(errno));
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	The file starts sparse, so it takes disk space only as the iterations fill it.
+	 */
+	if (ftruncate(store->fileDescriptor, (off_t) store->mappedSize) != 0)
+	{
+		fprintf(stderr, "Error: Could not size sample file \"%s\" for %zu samples: %s.\n", path, store->numberOfSamples, strerror(errno));
+		close(store->fileDescriptor);
+		store->fileDescriptor = -1;
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	mapping = mmap(NULL, store->mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, store->fileDescriptor, 0);
+
+	if (mapping == MAP_FAILED)
+	{
+		fprintf(stderr, "Error: Could not map sample file \"%s\": %s.\n", path, strerror(errno));
+		close(store->fileDescriptor);
+		store->fileDescriptor = -1;
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	Every thread fills and reads its part of the samples front to back.
+	 */
+#ifdef MADV_SEQUENTIAL
+	madvise(mapping, store->mappedSize, MADV_SEQUENTIAL);
+#endif
+	setSampleArrays(store, (unsigned char *) mapping, fileHeaderSize(store));
+#else
+	allocateSampleArrays(store, segmentSize);
+#endif
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+sampleStoreOpen(
+	SampleStore *		store,
+	SampleStoreBackend	backend,
+	const char *		path,
+	size_t			numberOfSamples,
+	size_t			segmentSize,
+	SamplePrecision		precision)
+{
+	*store = (SampleStore) {
+		.backend		= backend,
+		.samples		= NULL,
+		.codes			= NULL,
+		.quantizer		= {
+						.precision	= precision,
+						.offset		= 0.0,
+						.step		= 0.0,
+					},
+		.numberOfSamples	= numberOfSamples,
+		.memory			= NULL,
+		.mappedSize		= 0,
+		.fileDescriptor		= -1,
+		.hasExplicitHugePages	= false,
+	};
+
+	switch (backend)
+	{
+		case kSampleStoreBackendHugePages:
+		{
+			return mapHugePages(store, segmentSize);
+		}
+
+		case kSampleStoreBackendFile:
+		{
+			return mapFile(store, path, segmentSize);
+		}
+
+		default:
+		{
+			allocateSampleArrays(store, segmentSize);
+
+			return kCommonConstantReturnTypeSuccess;
+		}
+	}
+}
+
+CommonConstantReturnType
+sampleStoresOpen(
+	SampleStore *		outputStore,
+	SampleStore *		controlStore,
+	SampleStoreBackend	backend,
+	const char *		path,
+	size_t			numberOfSamples,
+	size_t			segmentSize,
+	SamplePrecision		precision)
+{
+	char	controlPath[kCommonConstantMaxCharsPerFilepath];
+	int	ret = snprintf(controlPath, kCommonConstantMaxCharsPerFilepath, "%s.control", path);
+
+	if ((ret < 0) || (ret >= kCommonConstantMaxCharsPerFilepath))
+	{
+		fprintf(stderr, "Error: The sample file path is too long.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (sampleStoreOpen(outputStore, backend, path, numberOfSamples, segmentSize, precision) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((controlStore != NULL) && (sampleStoreOpen(controlStore, backend, controlPath, numberOfSamples, segmentSize, precision) != kCommonConstantReturnTypeSuccess))
+	{
+		sampleStoreClose(outputStore);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+sampleStoreEncode(
+	SampleStore *		store,
+	size_t			firstSample,
+	const float *		samples,
+	size_t			numberOfSamples,
+	QuantizationError *	error)
+{
+	sampleQuantizerEncodeMeasured(&store->quantizer, samples, numberOfSamples, &store->codes[firstSample], error);
+}
+
+#ifndef MAP_FAILED
+/**
+ *	@brief	Write the samples of a file-backed store in heap memory to its file, in the layout
+ *		of the mapped file.
+ *
+ *	@param	store		: Pointer to the sample store.
+ *	@param	numberOfSamples	: Number of samples.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+writeSampleFile(const SampleStore *  store, size_t numberOfSamples)
+{
+	FILE *	file = fopen(store->path, "wb");
+	bool	isWritten;
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not create sample file \"%s\": %s.\n", store->path, strerror(errno));
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (store->codes != NULL)
+	{
+		isWritten = sampleQuantizerWriteCodes(&store->quantizer, store->codes, numberOfSamples, file);
+	}
+	else
+	{
+		isWritten = (fwrite(store->samples, sizeof(float), numberOfSamples, file) == numberOfSamples);
+	}
+
+	if ((fclose(file) != 0) || !isWritten)
+	{
+		fprintf(stderr, "Error: Could not write the samples to their file \"%s\".\n", store->path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+#endif
+
+CommonConstantReturnType
+sampleStoreSync(SampleStore *  store, size_t numberOfSamples)
+{
+#ifdef MAP_FAILED
+	size_t	fileSize = fileHeaderSize(store) + numberOfSamples * sampleSize(store);
+#endif
+
+	if ((store->backend != kSampleStoreBackendFile) || (store->memory == NULL))
+	{
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+#ifdef MAP_FAILED
+	if (fileHeaderSize(store) > 0)
+	{
+		memcpy(&store->memory[0], &store->quantizer.offset, sizeof(double));
+		memcpy(&store->memory[sizeof(double)], &store->quantizer.step, sizeof(double));
+	}
+
+	if ((msync(store->memory, store->mappedSize, MS_SYNC) != 0) ||
+		(ftruncate(store->fileDescriptor, (off_t) fileSize) != 0))
+	{
+		fprintf(stderr, "Error: Could not write the samples to their file: %s.\n", strerror(errno));
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+#else
+	return writeSampleFile(store, numberOfSamples);
+#endif
+}
+
+void
+sampleStoreClose(SampleStore *  store)
+{
+	if (store->memory == NULL)
+	{
+		return;
+	}
+
+#ifdef MAP_FAILED
+	if (store->backend == kSampleStoreBackendHeap)
+	{
+		free(store->memory);
+	}
+	else
+	{
+		munmap(store->memory, store->mappedSize);
+	}
+
+	if (store->fileDescriptor >= 0)
+	{
+		close(store->fileDescriptor);
+	}
+#else
+	free(store->memory);
+#endif
+
+	store->memory = NULL;
+	store->samples = NULL;
+	store->codes = NULL;
+	store->fileDescriptor = -1;
+}
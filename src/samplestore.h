@@ -0,0 +1,171 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "common.h"
+#include "precision.h"
+
+typedef enum
+{
+	kSampleStoreBackendHeap			= 0,
+	kSampleStoreBackendHugePages,
+	kSampleStoreBackendFile,
+	kSampleStoreBackendMax
+} SampleStoreBackend;
+
+typedef enum
+{
+	/*
+	 *	Size of the explicit huge pages that the huge-page backend rounds its mapping up to.
+	 */
+	kSampleStoreConstantHugePageSize	= 2 * 1024 * 1024,
+} SampleStoreConstant;
+
+/*
+ *	Memory that holds the samples of native Monte Carlo iterations. The heap backend is plain
+ *	allocated memory. The huge-page backend maps anonymous memory backed by explicit huge pages
+ *	if the system has reserved them, else by transparent huge pages. The file backend maps a
+ *	file of raw samples, so the kernel writes the samples back to disk as needed and a run can
+ *	hold more samples than fit in memory. On systems without `mmap()`, both use heap memory,
+ *	and the file backend writes its file when it is synced. A store of a 16-bit precision
+ *	holds the codes of `quantizer` instead of 32-bit floats, and its file starts with the
+ *	header of the quantizer.
+ */
+typedef struct SampleStore
+{
+	SampleStoreBackend	backend;
+	/*
+	 *	The samples as 32-bit floats, or their 16-bit codes, in `memory`. The pointer that the
+	 *	precision of the store does not use is `NULL`.
+	 */
+	float *			samples;
+	uint16_t *		codes;
+	SampleQuantizer		quantizer;
+	size_t			numberOfSamples;
+	unsigned char *		memory;
+	size_t			mappedSize;
+	int			fileDescriptor;
+	bool			hasExplicitHugePages;
+	char			path[kCommonConstantMaxCharsPerFilepath];
+} SampleStore;
+
+/**
+ *	@brief	Parse a sample store backend name.
+ *
+ *	@param	name	: One of "heap", "huge-pages", or "file".
+ *	@param	backend	: Pointer to store the parsed backend.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	sampleStoreBackendFromString(const char *  name, SampleStoreBackend *  backend);
+
+/**
+ *	@brief	Get the name of a sample store backend.
+ *
+ *	@param	backend	: The backend.
+ *	@return		: Name of the backend.
+ */
+const char *			sampleStoreBackendToString(SampleStoreBackend backend);
+
+/**
+ *	@brief	Create a sample store with room for `numberOfSamples` samples, all set to zero. A
+ *		store of a 16-bit precision needs its quantizer set before the first samples are
+ *		encoded into it.
+ *
+ *	@param	store		: Pointer to the sample store to create.
+ *	@param	backend		: The backend of the store.
+ *	@param	path		: Path of the file of the file backend (ignored by the other backends).
+ *	@param	numberOfSamples	: Number of samples.
+ *	@param	segmentSize	: Number of iterations that every run of the loop over the iterations
+ *				  covers, which decides the threads that touch the pages first.
+ *	@param	precision	: Precision of the samples of the store.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	sampleStoreOpen(
+					SampleStore *		store,
+					SampleStoreBackend	backend,
+					const char *		path,
+					size_t			numberOfSamples,
+					size_t			segmentSize,
+					SamplePrecision		precision);
+
+/**
+ *	@brief	Create the sample stores of a native Monte Carlo run: one for the selected output
+ *		and, if `controlStore` is not `NULL`, one for the control-variate samples, whose
+ *		file (for the file backend) is `path` with ".control" appended.
+ *
+ *	@param	outputStore	: Pointer to the sample store of the outputs to create.
+ *	@param	controlStore	: Pointer to the sample store of the control-variate samples to create, or `NULL`.
+ *	@param	backend		: The backend of the stores.
+ *	@param	path		: Path of the file of the outputs for the file backend.
+ *	@param	numberOfSamples	: Number of samples of each store.
+ *	@param	segmentSize	: Number of iterations that every run of the loop over the iterations covers.
+ *	@param	precision	: Precision of the samples of the stores.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	sampleStoresOpen(
+					SampleStore *		outputStore,
+					SampleStore *		controlStore,
+					SampleStoreBackend	backend,
+					const char *		path,
+					size_t			numberOfSamples,
+					size_t			segmentSize,
+					SamplePrecision		precision);
+
+/**
+ *	@brief	Encode samples into the codes of a store of a 16-bit precision, with its quantizer.
+ *
+ *	@param	store		: Pointer to the sample store.
+ *	@param	firstSample	: Index of the first sample to encode into.
+ *	@param	samples		: The samples.
+ *	@param	numberOfSamples	: Number of samples.
+ *	@param	error		: Pointer to the quantization error to add the error of the samples to, or `NULL`.
+ */
+void				sampleStoreEncode(
+					SampleStore *		store,
+					size_t			firstSample,
+					const float *		samples,
+					size_t			numberOfSamples,
+					QuantizationError *	error);
+
+/**
+ *	@brief	Write the first `numberOfSamples` samples of a file-backed store to its file and cut
+ *		the file to them. Does nothing for the other backends. The file of a store of a
+ *		16-bit precision gets the header of its quantizer: the offset and step (two doubles)
+ *		for `quantized16`.
+ *
+ *	@param	store		: Pointer to the sample store.
+ *	@param	numberOfSamples	: Number of samples to keep.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	sampleStoreSync(SampleStore *  store, size_t numberOfSamples);
+
+/**
+ *	@brief	Release the memory of a sample store. A file-backed store keeps its file.
+ *
+ *	@param	store	: Pointer to the sample store.
+ */
+void				sampleStoreClose(SampleStore *  store);
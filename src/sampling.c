@@ -0,0 +1,330 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "sampling.h"
+
+static const char *	kSamplingMethodNames[kSamplingMethodMax] =
+			{
+				"pseudorandom",
+				"latin-hypercube",
+				"stratified",
+				"antithetic",
+			};
+
+/**
+ *	@brief	Integer power that saturates to `UINT64_MAX` on overflow.
+ *
+ *	@param	base		: The base.
+ *	@param	exponent	: The exponent.
+ *	@return			: `base^exponent`, or `UINT64_MAX` if it does not fit in 64 bits.
+ */
+static uint64_t
+saturatingPower(uint64_t base, size_t exponent)
+{
+	uint64_t	result = 1;
+
+	for (size_t i = 0; i < exponent; i++)
+	{
+		if ((base != 0) && (result > UINT64_MAX / base))
+		{
+			return UINT64_MAX;
+		}
+
+		result *= base;
+	}
+
+	return result;
+}
+
+double
+samplingNormalQuantile(double u)
+{
+	/*
+	 *	Acklam's rational approximations (relative error below 1.2e-9), refined with one step
+	 *	of Halley's method.
+	 */
+	static const double	a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+	static const double	b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01};
+	static const double	c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+	static const double	d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00};
+	const double		lowerTail = 0.02425;
+	double			z;
+	double			error;
+
+	if (u <= 0.0)
+	{
+		return -INFINITY;
+	}
+
+	if (u >= 1.0)
+	{
+		return INFINITY;
+	}
+
+	if ((u < lowerTail) || (u > 1.0 - lowerTail))
+	{
+		double	q = sqrt(-2.0 * log((u < lowerTail) ? u : (1.0 - u)));
+
+		z = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+		z = (u < lowerTail) ? z : -z;
+	}
+	else
+	{
+		double	q = u - 0.5;
+		double	r = q * q;
+
+		z = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+	}
+
+	error = samplingNormalCdf(z) - u;
+	z -= error * 2.50662827463100050242 * exp(0.5 * z * z) / (1.0 + 0.5 * z * error * 2.50662827463100050242 * exp(0.5 * z * z));
+
+	return z;
+}
+
+CommonConstantReturnType
+samplingMethodFromString(const char *  name, SamplingMethod *  method)
+{
+	for (SamplingMethod i = 0; i < kSamplingMethodMax; i++)
+	{
+		if (strcmp(name, kSamplingMethodNames[i]) == 0)
+		{
+			*method = i;
+
+			return kCommonConstantReturnTypeSuccess;
+		}
+	}
+
+	return kCommonConstantReturnTypeError;
+}
+
+const char *
+samplingMethodToString(SamplingMethod method)
+{
+	return (method < kSamplingMethodMax) ? kSamplingMethodNames[method] : "unknown";
+}
+
+void
+samplingPermutationInit(SamplingPermutation *  permutation, uint64_t domainSize, uint64_t seed, uint64_t stream)
+{
+	unsigned	bits = 2;
+
+	while ((bits < 64) && ((UINT64_C(1) << bits) < domainSize))
+	{
+		bits++;
+	}
+
+	permutation->domainSize = domainSize;
+	permutation->halfBits = (bits + 1) / 2;
+	permutation->halfMask = (UINT64_C(1) << permutation->halfBits) - 1;
+
+	for (int i = 0; i < kSamplingConstantFeistelRounds; i++)
+	{
+		permutation->roundKeys[i] = samplingRandomBits(seed, stream, i);
+	}
+
+	return;
+}
+
+uint64_t
+samplingPermutationApply(const SamplingPermutation *  permutation, uint64_t index)
+{
+	uint64_t	value = index;
+
+	if (permutation->domainSize <= 1)
+	{
+		return 0;
+	}
+
+	/*
+	 *	The Feistel network is a bijection on [0, 2^(2 * halfBits)), which is at most four times
+	 *	the domain. Walking the cycle until we land inside the domain restricts it to a bijection
+	 *	on [0, domainSize), with fewer than four rounds of walking on average.
+	 */
+	do
+	{
+		uint64_t	left = value >> permutation->halfBits;
+		uint64_t	right = value & permutation->halfMask;
+
+		for (int i = 0; i < kSamplingConstantFeistelRounds; i++)
+		{
+			uint64_t	mixed = samplingMix64(right ^ permutation->roundKeys[i]) & permutation->halfMask;
+			uint64_t	newRight = left ^ mixed;
+
+			left = right;
+			right = newRight;
+		}
+
+		value = (left << permutation->halfBits) | right;
+	} while (value >= permutation->domainSize);
+
+	return value;
+}
+
+CommonConstantReturnType
+samplerInit(
+	Sampler *	sampler,
+	SamplingMethod	method,
+	uint64_t	seed,
+	uint64_t	numberOfSamples,
+	size_t		numberOfDimensions)
+{
+	if ((numberOfDimensions == 0) || (numberOfDimensions > kSamplingConstantMaxDimensions))
+	{
+		fprintf(stderr, "Error: Sampler dimensionality must be in [1, %d].\n", kSamplingConstantMaxDimensions);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (method >= kSamplingMethodMax)
+	{
+		fprintf(stderr, "Error: Unknown sampling method.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	*sampler = (Sampler) {
+		.method				= method,
+		.seed				= seed,
+		.numberOfSamples		= numberOfSamples,
+		.numberOfDimensions		= numberOfDimensions,
+		.numberOfStrataPerDimension	= 1,
+		.numberOfStratifiedSamples	= 0,
+	};
+
+	switch (method)
+	{
+		case kSamplingMethodLatinHypercube:
+		{
+			sampler->numberOfStrataPerDimension = numberOfSamples;
+			sampler->numberOfStratifiedSamples = numberOfSamples;
+
+			/*
+			 *	One independent permutation of the strata per dimension.
+			 */
+			for (size_t i = 0; i < numberOfDimensions; i++)
+			{
+				samplingPermutationInit(&sampler->permutations[i], numberOfSamples, seed, kSamplingStreamPermutationKey + i);
+			}
+
+			break;
+		}
+
+		case kSamplingMethodStratified:
+		{
+			uint64_t	strata = (uint64_t) floor(pow((double) numberOfSamples, 1.0 / numberOfDimensions));
+
+			/*
+			 *	Correct for rounding in `pow()`, so that `strata` is the largest integer with `strata^D <= N`.
+			 */
+			while ((strata > 1) && (saturatingPower(strata, numberOfDimensions) > numberOfSamples))
+			{
+				strata--;
+			}
+			while (saturatingPower(strata + 1, numberOfDimensions) <= numberOfSamples)
+			{
+				strata++;
+			}
+
+			sampler->numberOfStrataPerDimension = (strata == 0) ? 1 : strata;
+			sampler->numberOfStratifiedSamples = saturatingPower(sampler->numberOfStrataPerDimension, numberOfDimensions);
+
+			/*
+			 *	A single permutation over the cells of the grid, so that any prefix of the run visits
+			 *	a uniformly-random subset of the cells.
+			 */
+			samplingPermutationInit(&sampler->permutations[0], sampler->numberOfStratifiedSamples, seed, kSamplingStreamPermutationKey);
+
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+samplerGetPoint(const Sampler *  sampler, uint64_t sampleIndex, double *  point)
+{
+	if ((sampler->method == kSamplingMethodLatinHypercube) && (sampleIndex < sampler->numberOfStratifiedSamples))
+	{
+		double	inverseStrata = 1.0 / (double) sampler->numberOfStrataPerDimension;
+
+		for (size_t i = 0; i < sampler->numberOfDimensions; i++)
+		{
+			uint64_t	stratum = samplingPermutationApply(&sampler->permutations[i], sampleIndex);
+
+			point[i] = ((double) stratum + samplingUniform(sampler->seed, kSamplingStreamJitter + i, sampleIndex)) * inverseStrata;
+		}
+
+		return;
+	}
+
+	if ((sampler->method == kSamplingMethodStratified) && (sampleIndex < sampler->numberOfStratifiedSamples))
+	{
+		double		inverseStrata = 1.0 / (double) sampler->numberOfStrataPerDimension;
+		uint64_t	cell = samplingPermutationApply(&sampler->permutations[0], sampleIndex);
+
+		for (size_t i = 0; i < sampler->numberOfDimensions; i++)
+		{
+			uint64_t	stratum = cell % sampler->numberOfStrataPerDimension;
+
+			cell /= sampler->numberOfStrataPerDimension;
+			point[i] = ((double) stratum + samplingUniform(sampler->seed, kSamplingStreamJitter + i, sampleIndex)) * inverseStrata;
+		}
+
+		return;
+	}
+
+	/*
+	 *	Antithetic pairs: the point with an odd index is the reflection `1 - u` of the point
+	 *	before it, which shares the same counter.
+	 */
+	if (sampler->method == kSamplingMethodAntithetic)
+	{
+		for (size_t i = 0; i < sampler->numberOfDimensions; i++)
+		{
+			double	u = samplingUniform(sampler->seed, kSamplingStreamJitter + i, sampleIndex >> 1);
+
+			point[i] = (sampleIndex & 1) ? (1.0 - u) : u;
+		}
+
+		return;
+	}
+
+	/*
+	 *	Pseudo-random points, and the remainder of a stratified run that does not fill a whole grid.
+	 */
+	for (size_t i = 0; i < sampler->numberOfDimensions; i++)
+	{
+		point[i] = samplingUniform(sampler->seed, kSamplingStreamJitter + i, sampleIndex);
+	}
+
+	return;
+}
@@ -0,0 +1,214 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <math.h>
+#include "common.h"
+
+typedef enum
+{
+	kSamplingConstantMaxDimensions		= 32,
+	kSamplingConstantFeistelRounds		= 4,
+} SamplingConstant;
+
+typedef enum
+{
+	kSamplingMethodPseudoRandom		= 0,
+	kSamplingMethodLatinHypercube,
+	kSamplingMethodStratified,
+	kSamplingMethodAntithetic,
+	kSamplingMethodMax
+} SamplingMethod;
+
+/*
+ *	Streams of the counter-based generator. Each stream is an independent sequence indexed by
+ *	the sample counter, so any sample can be regenerated in any order, from any thread.
+ */
+typedef enum
+{
+	kSamplingStreamJitter			= 0,
+	kSamplingStreamPermutationKey		= kSamplingConstantMaxDimensions,
+	kSamplingStreamMax			= 2 * kSamplingConstantMaxDimensions
+} SamplingStream;
+
+/*
+ *	Stateless random-permutation of the integers in [0, domainSize) built from a balanced
+ *	Feistel network over the smallest even power of two covering the domain, with cycle-walking
+ *	for indices that fall outside the domain.
+ */
+typedef struct SamplingPermutation
+{
+	uint64_t	domainSize;
+	uint64_t	halfMask;
+	unsigned	halfBits;
+	uint64_t	roundKeys[kSamplingConstantFeistelRounds];
+} SamplingPermutation;
+
+typedef struct Sampler
+{
+	SamplingMethod		method;
+	uint64_t		seed;
+	uint64_t		numberOfSamples;
+	size_t			numberOfDimensions;
+	/*
+	 *	Number of strata along each dimension. For Latin hypercube sampling this equals
+	 *	`numberOfSamples`; for stratified sampling it is the largest `K` with `K^D <= numberOfSamples`.
+	 */
+	uint64_t		numberOfStrataPerDimension;
+	/*
+	 *	Number of samples that fall into a stratum. Samples beyond this count are pseudo-random.
+	 */
+	uint64_t		numberOfStratifiedSamples;
+	SamplingPermutation	permutations[kSamplingConstantMaxDimensions];
+} Sampler;
+
+/**
+ *	@brief	Mix a 64-bit value with the SplitMix64 finalizer.
+ *
+ *	@param	value	: The value to mix.
+ *	@return		: The mixed value.
+ */
+static inline uint64_t
+samplingMix64(uint64_t value)
+{
+	value = (value ^ (value >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+	value = (value ^ (value >> 27)) * UINT64_C(0x94d049bb133111eb);
+
+	return value ^ (value >> 31);
+}
+
+/**
+ *	@brief	Counter-based random bits: the `counter`-th 64-bit word of stream `stream` for `seed`.
+ *
+ *	@param	seed	: Seed of the run.
+ *	@param	stream	: Index of the stream.
+ *	@param	counter	: Position within the stream.
+ *	@return		: 64 random bits.
+ */
+static inline uint64_t
+samplingRandomBits(uint64_t seed, uint64_t stream, uint64_t counter)
+{
+	uint64_t	key = samplingMix64(seed + UINT64_C(0x9e3779b97f4a7c15) * (stream + 1));
+
+	return samplingMix64(key ^ (counter * UINT64_C(0xd1b54a32d192ed03)));
+}
+
+/**
+ *	@brief	Counter-based uniform variate in the open interval (0, 1).
+ *
+ *	@param	seed	: Seed of the run.
+ *	@param	stream	: Index of the stream.
+ *	@param	counter	: Position within the stream.
+ *	@return		: Uniform variate in (0, 1).
+ */
+static inline double
+samplingUniform(uint64_t seed, uint64_t stream, uint64_t counter)
+{
+	return ((double)(samplingRandomBits(seed, stream, counter) >> 11) + 0.5) * 0x1.0p-53;
+}
+
+/**
+ *	@brief	Cumulative distribution function of the standard normal distribution.
+ *
+ *	@param	z	: The argument.
+ *	@return		: Probability of a standard normal variate being at most `z`.
+ */
+static inline double
+samplingNormalCdf(double z)
+{
+	return 0.5 * erfc(-z * 0.70710678118654752440);
+}
+
+/**
+ *	@brief	Quantile function of the standard normal distribution.
+ *
+ *	@param	u	: Probability in (0, 1).
+ *	@return		: The `z` with `samplingNormalCdf(z) == u`, to double precision.
+ */
+double				samplingNormalQuantile(double u);
+
+/**
+ *	@brief	Parse a sampling method name.
+ *
+ *	@param	name		: One of "pseudorandom", "latin-hypercube", "stratified", or "antithetic".
+ *	@param	method		: Pointer to store the parsed sampling method.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	samplingMethodFromString(const char *  name, SamplingMethod *  method);
+
+/**
+ *	@brief	Get the name of a sampling method.
+ *
+ *	@param	method	: The sampling method.
+ *	@return		: Name of the sampling method.
+ */
+const char *			samplingMethodToString(SamplingMethod method);
+
+/**
+ *	@brief	Initialize a random permutation of [0, domainSize).
+ *
+ *	@param	permutation	: Pointer to the permutation to initialize.
+ *	@param	domainSize	: Number of elements to permute.
+ *	@param	seed		: Seed of the run.
+ *	@param	stream		: Stream from which the round keys are drawn.
+ */
+void				samplingPermutationInit(SamplingPermutation *  permutation, uint64_t domainSize, uint64_t seed, uint64_t stream);
+
+/**
+ *	@brief	Apply a random permutation to an index.
+ *
+ *	@param	permutation	: Pointer to the permutation.
+ *	@param	index		: Index in [0, domainSize).
+ *	@return			: Permuted index in [0, domainSize).
+ */
+uint64_t			samplingPermutationApply(const SamplingPermutation *  permutation, uint64_t index);
+
+/**
+ *	@brief	Initialize a sampler. The sampler only holds a few keys, so it is cheap to create and
+ *		any point can be generated independently of all others (e.g., from parallel threads).
+ *
+ *	@param	sampler			: Pointer to the sampler to initialize.
+ *	@param	method			: The sampling method.
+ *	@param	seed			: Seed of the run.
+ *	@param	numberOfSamples		: Total number of points that the run will draw.
+ *	@param	numberOfDimensions	: Dimensionality of the points.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	samplerInit(
+					Sampler *	sampler,
+					SamplingMethod	method,
+					uint64_t	seed,
+					uint64_t	numberOfSamples,
+					size_t		numberOfDimensions);
+
+/**
+ *	@brief	Get the point with index `sampleIndex` in the unit hypercube (0, 1)^D.
+ *
+ *	@param	sampler		: Pointer to the sampler.
+ *	@param	sampleIndex	: Index of the point in [0, numberOfSamples).
+ *	@param	point		: Array of `numberOfDimensions` entries to store the point.
+ */
+void				samplerGetPoint(const Sampler *  sampler, uint64_t sampleIndex, double *  point);
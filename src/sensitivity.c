@@ -0,0 +1,225 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "sensitivity.h"
+
+void
+sobolAccumulatorInit(SobolAccumulator *  accumulator, size_t numberOfInputs, double shift)
+{
+	*accumulator = (SobolAccumulator) {
+		.numberOfInputs	= numberOfInputs,
+		.shift		= shift,
+	};
+
+	return;
+}
+
+void
+sobolAccumulatorAdd(SobolAccumulator *  accumulator, double outputA, double outputB, const double *  outputsAB)
+{
+	double	a = outputA - accumulator->shift;
+	double	b = outputB - accumulator->shift;
+
+	accumulator->numberOfSamples++;
+	accumulator->sumOfOutputs += a + b;
+	accumulator->sumOfSquaredOutputs += a * a + b * b;
+
+	for (size_t i = 0; i < accumulator->numberOfInputs; i++)
+	{
+		double	ab = outputsAB[i] - accumulator->shift;
+
+		accumulator->firstOrderSums[i] += b * (ab - a);
+		accumulator->totalEffectSums[i] += (a - ab) * (a - ab);
+	}
+
+	return;
+}
+
+void
+sobolAccumulatorMerge(SobolAccumulator *  accumulator, const SobolAccumulator *  other)
+{
+	accumulator->numberOfSamples += other->numberOfSamples;
+	accumulator->sumOfOutputs += other->sumOfOutputs;
+	accumulator->sumOfSquaredOutputs += other->sumOfSquaredOutputs;
+
+	for (size_t i = 0; i < accumulator->numberOfInputs; i++)
+	{
+		accumulator->firstOrderSums[i] += other->firstOrderSums[i];
+		accumulator->totalEffectSums[i] += other->totalEffectSums[i];
+	}
+
+	return;
+}
+
+void
+sobolIndicesFromAccumulator(const SobolAccumulator *  accumulator, SobolIndices *  indices)
+{
+	double	numberOfOutputs = 2.0 * accumulator->numberOfSamples;
+	double	shiftedMean = (numberOfOutputs > 0) ? (accumulator->sumOfOutputs / numberOfOutputs) : 0.0;
+
+	*indices = (SobolIndices) {
+		.numberOfInputs		= accumulator->numberOfInputs,
+		.numberOfSamples	= accumulator->numberOfSamples,
+		.mean			= accumulator->shift + shiftedMean,
+	};
+
+	if (numberOfOutputs < 2)
+	{
+		return;
+	}
+
+	/*
+	 *	Variance of the outputs at `A` and `B` together.
+	 */
+	indices->variance = (accumulator->sumOfSquaredOutputs - numberOfOutputs * shiftedMean * shiftedMean) / (numberOfOutputs - 1);
+
+	if (!(indices->variance > 0.0))
+	{
+		indices->variance = 0.0;
+
+		return;
+	}
+
+	for (size_t i = 0; i < accumulator->numberOfInputs; i++)
+	{
+		indices->firstOrder[i] = accumulator->firstOrderSums[i] / accumulator->numberOfSamples / indices->variance;
+		indices->totalEffect[i] = accumulator->totalEffectSums[i] / (2.0 * accumulator->numberOfSamples) / indices->variance;
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+runSensitivityAnalysis(const ConversionModel *  model, size_t numberOfSamples, SobolIndices *  indices)
+{
+	size_t			numberOfInputs = conversionModelNumberOfInputs(model);
+	size_t			numberOfBlocks = (numberOfSamples + kSensitivityConstantBlockSize - 1) / kSensitivityConstantBlockSize;
+	SobolAccumulator *	blockAccumulators;
+	SobolAccumulator	accumulator;
+	Sampler			samplerA;
+	Sampler			samplerB;
+	double			centerPoint[kSensitivityConstantMaxInputs];
+	float			outputVariables[kOutputDistributionIndexMax];
+
+	if ((numberOfSamples < 2) || (numberOfInputs > kSensitivityConstantMaxInputs))
+	{
+		fprintf(stderr, "Error: Sensitivity analysis needs at least 2 base samples and at most %d inputs.\n", kSensitivityConstantMaxInputs);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	`B` uses a seed drawn from a stream that samplers do not use, so that it is independent
+	 *	of `A` and of the `A` of any other seed.
+	 */
+	if ((samplerInit(&samplerA, model->arguments->samplingMethod, model->arguments->randomSeed, numberOfSamples, numberOfInputs) != kCommonConstantReturnTypeSuccess) ||
+		(samplerInit(&samplerB, model->arguments->samplingMethod, samplingRandomBits(model->arguments->randomSeed, kSamplingStreamMax, 0), numberOfSamples, numberOfInputs) != kCommonConstantReturnTypeSuccess))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	Shift the outputs by the output at the center of the input space.
+	 */
+	for (size_t i = 0; i < numberOfInputs; i++)
+	{
+		centerPoint[i] = 0.5;
+	}
+	sobolAccumulatorInit(&accumulator, numberOfInputs, conversionModelEvaluate(model, centerPoint, outputVariables));
+
+	/*
+	 *	One accumulator per block, merged in block order, so the result does not depend on the
+	 *	number of threads.
+	 */
+	blockAccumulators = (SobolAccumulator *) checkedMalloc(numberOfBlocks * sizeof(SobolAccumulator), __FILE__, __LINE__);
+
+	#pragma omp parallel for schedule(static)
+	for (size_t block = 0; block < numberOfBlocks; block++)
+	{
+		size_t	blockEnd = (block + 1) * kSensitivityConstantBlockSize;
+
+		blockEnd = (blockEnd < numberOfSamples) ? blockEnd : numberOfSamples;
+		sobolAccumulatorInit(&blockAccumulators[block], numberOfInputs, accumulator.shift);
+
+		for (size_t j = block * kSensitivityConstantBlockSize; j < blockEnd; j++)
+		{
+			double	pointA[kSensitivityConstantMaxInputs];
+			double	pointB[kSensitivityConstantMaxInputs];
+			double	pointAB[kSensitivityConstantMaxInputs];
+			double	outputsAB[kSensitivityConstantMaxInputs];
+			float	blockOutputVariables[kOutputDistributionIndexMax];
+			double	outputA;
+			double	outputB;
+
+			samplerGetPoint(&samplerA, j, pointA);
+			samplerGetPoint(&samplerB, j, pointB);
+			outputA = conversionModelEvaluate(model, pointA, blockOutputVariables);
+			outputB = conversionModelEvaluate(model, pointB, blockOutputVariables);
+
+			for (size_t i = 0; i < numberOfInputs; i++)
+			{
+				pointAB[i] = pointA[i];
+			}
+
+			for (size_t i = 0; i < numberOfInputs; i++)
+			{
+				pointAB[i] = pointB[i];
+				outputsAB[i] = conversionModelEvaluate(model, pointAB, blockOutputVariables);
+				pointAB[i] = pointA[i];
+			}
+
+			sobolAccumulatorAdd(&blockAccumulators[block], outputA, outputB, outputsAB);
+		}
+	}
+
+	for (size_t block = 0; block < numberOfBlocks; block++)
+	{
+		sobolAccumulatorMerge(&accumulator, &blockAccumulators[block]);
+	}
+
+	free(blockAccumulators);
+	sobolIndicesFromAccumulator(&accumulator, indices);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+printSobolIndices(const ConversionModel *  model, const SobolIndices *  indices, const char *  outputName)
+{
+	printf("Sobol indices of %s (%zu base samples, %zu model evaluations):\n",
+		outputName,
+		indices->numberOfSamples,
+		indices->numberOfSamples * (indices->numberOfInputs + 2));
+	printf("Mean: %lf, variance: %le\n\n", indices->mean, indices->variance);
+	printf("%-16s %12s %12s\n", "Input", "First-order", "Total-effect");
+
+	for (size_t i = 0; i < indices->numberOfInputs; i++)
+	{
+		printf("%-16s %12.6lf %12.6lf\n", conversionModelInputName(model, i), indices->firstOrder[i], indices->totalEffect[i]);
+	}
+
+	return;
+}
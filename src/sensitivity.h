@@ -0,0 +1,125 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "sampling.h"
+#include "model.h"
+
+typedef enum
+{
+	kSensitivityConstantMaxInputs		= kSamplingConstantMaxDimensions,
+	/*
+	 *	Number of base samples per parallel work item.
+	 */
+	kSensitivityConstantBlockSize		= 256,
+} SensitivityConstant;
+
+/*
+ *	Running sums of the Saltelli scheme for Sobol indices. Every base sample contributes the
+ *	outputs at two independent points `A` and `B` and at the points `AB_i`, which equal `A`
+ *	except for input `i`, taken from `B`. Outputs are shifted by `shift` (a typical output value)
+ *	to avoid cancellation in the variance.
+ */
+typedef struct SobolAccumulator
+{
+	size_t		numberOfInputs;
+	size_t		numberOfSamples;
+	double		shift;
+	double		sumOfOutputs;
+	double		sumOfSquaredOutputs;
+	double		firstOrderSums[kSensitivityConstantMaxInputs];
+	double		totalEffectSums[kSensitivityConstantMaxInputs];
+} SobolAccumulator;
+
+typedef struct SobolIndices
+{
+	size_t		numberOfInputs;
+	size_t		numberOfSamples;
+	double		mean;
+	double		variance;
+	double		firstOrder[kSensitivityConstantMaxInputs];
+	double		totalEffect[kSensitivityConstantMaxInputs];
+} SobolIndices;
+
+/**
+ *	@brief	Initialize a Sobol accumulator.
+ *
+ *	@param	accumulator	: Pointer to the accumulator to initialize.
+ *	@param	numberOfInputs	: Number of inputs, at most `kSensitivityConstantMaxInputs`.
+ *	@param	shift		: Value subtracted from all outputs before accumulating them.
+ */
+void	sobolAccumulatorInit(SobolAccumulator *  accumulator, size_t numberOfInputs, double shift);
+
+/**
+ *	@brief	Add the outputs of one base sample to a Sobol accumulator.
+ *
+ *	@param	accumulator	: Pointer to the accumulator.
+ *	@param	outputA		: Output at point `A`.
+ *	@param	outputB		: Output at point `B`.
+ *	@param	outputsAB	: Outputs at points `AB_i`, one per input.
+ */
+void	sobolAccumulatorAdd(SobolAccumulator *  accumulator, double outputA, double outputB, const double *  outputsAB);
+
+/**
+ *	@brief	Merge the sums of one Sobol accumulator into another.
+ *
+ *	@param	accumulator	: Pointer to the accumulator to merge into.
+ *	@param	other		: Pointer to the accumulator to merge, with the same inputs and shift.
+ */
+void	sobolAccumulatorMerge(SobolAccumulator *  accumulator, const SobolAccumulator *  other);
+
+/**
+ *	@brief	Estimate first-order (Saltelli 2010) and total-effect (Jansen) Sobol indices from a
+ *		Sobol accumulator.
+ *
+ *	@param	accumulator	: Pointer to the accumulator.
+ *	@param	indices		: Pointer to store the indices. Indices are zero if the output has no variance.
+ */
+void	sobolIndicesFromAccumulator(const SobolAccumulator *  accumulator, SobolIndices *  indices);
+
+/**
+ *	@brief	Run a global sensitivity analysis of the selected output of a conversion model with
+ *		respect to all of its inputs. Each of `numberOfSamples` base samples evaluates the model
+ *		`numberOfInputs + 2` times, with the points `A` and `B` drawn by two independent samplers
+ *		of the method in the command-line arguments.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	numberOfSamples	: Number of base samples.
+ *	@param	indices		: Pointer to store the Sobol indices.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runSensitivityAnalysis(const ConversionModel *  model, size_t numberOfSamples, SobolIndices *  indices);
+
+/**
+ *	@brief	Print a table of Sobol indices.
+ *
+ *	@param	model		: Pointer to the conversion model.
+ *	@param	indices		: Pointer to the Sobol indices.
+ *	@param	outputName	: Name of the output that the indices are about.
+ */
+void				printSobolIndices(const ConversionModel *  model, const SobolIndices *  indices, const char *  outputName);
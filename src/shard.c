@@ -0,0 +1,894 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <errno.h>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "shard.h"
+
+static const char	kShardMagic[kShardConstantMagicLength] = {'B', 'M', 'E', '6', '8', '0', 'S', 'H'};
+
+/*
+ *	Header at the start of a partial-result file. The histogram bins (all keys, then all counts)
+ *	follow the header, and then, if `recordSize` is not zero, the samples as records of the
+ *	selected output and, with the control variate, the temperature output. In the file, every
+ *	field is little-endian and the fields follow each other in this order without padding, so
+ *	that partial results merge across compilers and machines.
+ */
+typedef struct ShardHeader
+{
+	char		magic[kShardConstantMagicLength];
+	uint32_t	version;
+	uint32_t	recordSize;
+	uint64_t	configurationHash;
+	uint64_t	numberOfIterations;
+	uint64_t	shardIndex;
+	uint64_t	numberOfShards;
+	uint64_t	firstIteration;
+	uint64_t	numberOfShardIterations;
+	double		binWidth;
+	uint64_t	numberOfBins;
+	OutputMoments	moments;
+} ShardHeader;
+
+typedef struct HistogramBin
+{
+	int64_t		key;
+	uint64_t	count;
+} HistogramBin;
+
+/**
+ *	@brief	Encode an unsigned integer as little-endian bytes.
+ *
+ *	@param	bytes		: Array to store the bytes.
+ *	@param	value		: The value.
+ *	@param	numberOfBytes	: Number of bytes to store, at most 8.
+ */
+static void
+encodeLittleEndian(uint8_t *  bytes, uint64_t value, size_t numberOfBytes)
+{
+	for (size_t i = 0; i < numberOfBytes; i++)
+	{
+		bytes[i] = (uint8_t)(value >> (8 * i));
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Decode an unsigned integer from little-endian bytes.
+ *
+ *	@param	bytes		: The bytes.
+ *	@param	numberOfBytes	: Number of bytes to read, at most 8.
+ *	@return			: The value.
+ */
+static uint64_t
+decodeLittleEndian(const uint8_t *  bytes, size_t numberOfBytes)
+{
+	uint64_t	value = 0;
+
+	for (size_t i = 0; i < numberOfBytes; i++)
+	{
+		value |= (uint64_t) bytes[i] << (8 * i);
+	}
+
+	return value;
+}
+
+/**
+ *	@brief	Encode a double as the little-endian bytes of its IEEE-754 value.
+ *
+ *	@param	bytes	: Array of 8 bytes to store the encoded value.
+ *	@param	value	: The value.
+ */
+static void
+encodeDouble(uint8_t *  bytes, double value)
+{
+	uint64_t	bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+	encodeLittleEndian(bytes, bits, sizeof(bits));
+
+	return;
+}
+
+/**
+ *	@brief	Decode a double from the little-endian bytes of its IEEE-754 value.
+ *
+ *	@param	bytes	: Array of the 8 bytes of the encoded value.
+ *	@return		: The value.
+ */
+static double
+decodeDouble(const uint8_t *  bytes)
+{
+	uint64_t	bits = decodeLittleEndian(bytes, sizeof(bits));
+	double		value;
+
+	memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+/**
+ *	@brief	Write an unsigned 64-bit integer to a file as little-endian bytes.
+ *
+ *	@param	file	: The file.
+ *	@param	value	: The value.
+ *	@return		: `true` if the value was written.
+ */
+static bool
+writeUint64(FILE *  file, uint64_t value)
+{
+	uint8_t	bytes[sizeof(uint64_t)];
+
+	encodeLittleEndian(bytes, value, sizeof(bytes));
+
+	return fwrite(bytes, sizeof(bytes), 1, file) == 1;
+}
+
+/**
+ *	@brief	Read an unsigned 64-bit integer from little-endian bytes of a file.
+ *
+ *	@param	file	: The file.
+ *	@param	value	: Pointer to store the value.
+ *	@return		: `true` if the value was read.
+ */
+static bool
+readUint64(FILE *  file, uint64_t *  value)
+{
+	uint8_t	bytes[sizeof(uint64_t)];
+
+	if (fread(bytes, sizeof(bytes), 1, file) != 1)
+	{
+		return false;
+	}
+
+	*value = decodeLittleEndian(bytes, sizeof(bytes));
+
+	return true;
+}
+
+/**
+ *	@brief	Write a sample to a file as the little-endian bytes of its IEEE-754 single-precision value.
+ *
+ *	@param	file	: The file.
+ *	@param	value	: The sample.
+ *	@return		: `true` if the sample was written.
+ */
+static bool
+writeFloat(FILE *  file, float value)
+{
+	uint8_t		bytes[sizeof(uint32_t)];
+	uint32_t	bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+	encodeLittleEndian(bytes, bits, sizeof(bytes));
+
+	return fwrite(bytes, sizeof(bytes), 1, file) == 1;
+}
+
+/**
+ *	@brief	Read a sample from the little-endian bytes of its IEEE-754 single-precision value in a file.
+ *
+ *	@param	file	: The file.
+ *	@param	value	: Pointer to store the sample.
+ *	@return		: `true` if the sample was read.
+ */
+static bool
+readFloat(FILE *  file, float *  value)
+{
+	uint8_t		bytes[sizeof(uint32_t)];
+	uint32_t	bits;
+
+	if (fread(bytes, sizeof(bytes), 1, file) != 1)
+	{
+		return false;
+	}
+
+	bits = (uint32_t) decodeLittleEndian(bytes, sizeof(bytes));
+	memcpy(value, &bits, sizeof(bits));
+
+	return true;
+}
+
+/**
+ *	@brief	Encode the header of a partial-result file in its file layout.
+ *
+ *	@param	header	: Pointer to the header.
+ *	@param	bytes	: Array of `kShardConstantHeaderSize` bytes to store the encoded header.
+ */
+static void
+encodeShardHeader(const ShardHeader *  header, uint8_t *  bytes)
+{
+	uint8_t *	field = bytes;
+
+	memcpy(field, header->magic, kShardConstantMagicLength);
+	field += kShardConstantMagicLength;
+	encodeLittleEndian(field, header->version, 4);
+	field += 4;
+	encodeLittleEndian(field, header->recordSize, 4);
+	field += 4;
+	encodeLittleEndian(field, header->configurationHash, 8);
+	field += 8;
+	encodeLittleEndian(field, header->numberOfIterations, 8);
+	field += 8;
+	encodeLittleEndian(field, header->shardIndex, 8);
+	field += 8;
+	encodeLittleEndian(field, header->numberOfShards, 8);
+	field += 8;
+	encodeLittleEndian(field, header->firstIteration, 8);
+	field += 8;
+	encodeLittleEndian(field, header->numberOfShardIterations, 8);
+	field += 8;
+	encodeDouble(field, header->binWidth);
+	field += 8;
+	encodeLittleEndian(field, header->numberOfBins, 8);
+	field += 8;
+	encodeLittleEndian(field, header->moments.count, 8);
+	field += 8;
+	encodeDouble(field, header->moments.mean);
+	field += 8;
+	encodeDouble(field, header->moments.m2);
+	field += 8;
+	encodeDouble(field, header->moments.m3);
+	field += 8;
+	encodeDouble(field, header->moments.m4);
+	field += 8;
+	encodeDouble(field, header->moments.minimum);
+	field += 8;
+	encodeDouble(field, header->moments.maximum);
+
+	return;
+}
+
+/**
+ *	@brief	Decode the header of a partial-result file from its file layout.
+ *
+ *	@param	bytes	: Array of `kShardConstantHeaderSize` bytes of the encoded header.
+ *	@param	header	: Pointer to store the header.
+ */
+static void
+decodeShardHeader(const uint8_t *  bytes, ShardHeader *  header)
+{
+	const uint8_t *	field = bytes;
+
+	memcpy(header->magic, field, kShardConstantMagicLength);
+	field += kShardConstantMagicLength;
+	header->version = (uint32_t) decodeLittleEndian(field, 4);
+	field += 4;
+	header->recordSize = (uint32_t) decodeLittleEndian(field, 4);
+	field += 4;
+	header->configurationHash = decodeLittleEndian(field, 8);
+	field += 8;
+	header->numberOfIterations = decodeLittleEndian(field, 8);
+	field += 8;
+	header->shardIndex = decodeLittleEndian(field, 8);
+	field += 8;
+	header->numberOfShards = decodeLittleEndian(field, 8);
+	field += 8;
+	header->firstIteration = decodeLittleEndian(field, 8);
+	field += 8;
+	header->numberOfShardIterations = decodeLittleEndian(field, 8);
+	field += 8;
+	header->binWidth = decodeDouble(field);
+	field += 8;
+	header->numberOfBins = decodeLittleEndian(field, 8);
+	field += 8;
+	header->moments.count = decodeLittleEndian(field, 8);
+	field += 8;
+	header->moments.mean = decodeDouble(field);
+	field += 8;
+	header->moments.m2 = decodeDouble(field);
+	field += 8;
+	header->moments.m3 = decodeDouble(field);
+	field += 8;
+	header->moments.m4 = decodeDouble(field);
+	field += 8;
+	header->moments.minimum = decodeDouble(field);
+	field += 8;
+	header->moments.maximum = decodeDouble(field);
+
+	return;
+}
+
+static int
+compareKeys(const void *  a, const void *  b)
+{
+	int64_t	x = *(const int64_t *) a;
+	int64_t	y = *(const int64_t *) b;
+
+	return (x > y) - (x < y);
+}
+
+static int
+compareBins(const void *  a, const void *  b)
+{
+	return compareKeys(&((const HistogramBin *) a)->key, &((const HistogramBin *) b)->key);
+}
+
+/**
+ *	@brief	Path of the partial-result file of a shard.
+ *
+ *	@param	arguments	: Pointer to the command-line arguments struct.
+ *	@param	shardIndex	: Index of the shard.
+ *	@param	path		: Array of `kCommonConstantMaxCharsPerFilepath` characters to store the path.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+partialResultPath(const CommandLineArguments *  arguments, size_t shardIndex, char *  path)
+{
+	int	ret = snprintf(path, kCommonConstantMaxCharsPerFilepath, "%s-%zu-of-%zu.part", arguments->partialResultPrefix, shardIndex, arguments->numberOfShards);
+
+	if ((ret < 0) || (ret >= kCommonConstantMaxCharsPerFilepath))
+	{
+		fprintf(stderr, "Error: The path of the partial result of shard %zu is too long.\n", shardIndex);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Moments of a set of samples, from two passes over the samples.
+ *
+ *	@param	samples		: The samples.
+ *	@param	numberOfSamples	: Number of entries in `samples`.
+ *	@return			: The moments.
+ */
+static OutputMoments
+calculateOutputMoments(const float *  samples, size_t numberOfSamples)
+{
+	OutputMoments	moments = {
+				.count		= numberOfSamples,
+				.minimum	= INFINITY,
+				.maximum	= -INFINITY,
+			};
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		moments.mean += samples[i];
+		moments.minimum = fmin(moments.minimum, samples[i]);
+		moments.maximum = fmax(moments.maximum, samples[i]);
+	}
+	moments.mean = (numberOfSamples > 0) ? (moments.mean / numberOfSamples) : 0.0;
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		double	deviation = samples[i] - moments.mean;
+		double	squaredDeviation = deviation * deviation;
+
+		moments.m2 += squaredDeviation;
+		moments.m3 += squaredDeviation * deviation;
+		moments.m4 += squaredDeviation * squaredDeviation;
+	}
+
+	return moments;
+}
+
+/**
+ *	@brief	Merge the moments of a disjoint set of samples into other moments.
+ *
+ *	@param	moments	: Pointer to the moments to merge into.
+ *	@param	other	: Pointer to the moments to merge.
+ */
+static void
+mergeOutputMoments(OutputMoments *  moments, const OutputMoments *  other)
+{
+	double	na = (double) moments->count;
+	double	nb = (double) other->count;
+	double	n = na + nb;
+	double	delta = other->mean - moments->mean;
+	double	delta2 = delta * delta;
+
+	if (other->count == 0)
+	{
+		return;
+	}
+
+	if (moments->count == 0)
+	{
+		*moments = *other;
+
+		return;
+	}
+
+	moments->m4 += other->m4 + delta2 * delta2 * na * nb * (na * na - na * nb + nb * nb) / (n * n * n)
+			+ 6.0 * delta2 * (na * na * other->m2 + nb * nb * moments->m2) / (n * n)
+			+ 4.0 * delta * (na * other->m3 - nb * moments->m3) / n;
+	moments->m3 += other->m3 + delta2 * delta * na * nb * (na - nb) / (n * n)
+			+ 3.0 * delta * (na * other->m2 - nb * moments->m2) / n;
+	moments->m2 += other->m2 + delta2 * na * nb / n;
+	moments->mean += delta * nb / n;
+	moments->count += other->count;
+	moments->minimum = fmin(moments->minimum, other->minimum);
+	moments->maximum = fmax(moments->maximum, other->maximum);
+
+	return;
+}
+
+/**
+ *	@brief	Build the sparse histogram of a set of samples.
+ *
+ *	@param	histogram	: Pointer to the histogram to build.
+ *	@param	binWidth	: Bin width of the histogram.
+ *	@param	samples		: The samples.
+ *	@param	numberOfSamples	: Number of entries in `samples`.
+ */
+static void
+buildSparseHistogram(SparseHistogram *  histogram, double binWidth, const float *  samples, size_t numberOfSamples)
+{
+	int64_t *	keys = (int64_t *) checkedMalloc((numberOfSamples + 1) * sizeof(int64_t), __FILE__, __LINE__);
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		keys[i] = (int64_t) floor(samples[i] / binWidth);
+	}
+
+	qsort(keys, numberOfSamples, sizeof(int64_t), compareKeys);
+
+	*histogram = (SparseHistogram) {
+		.binWidth	= binWidth,
+		.keys		= keys,
+		.counts		= (uint64_t *) checkedMalloc((numberOfSamples + 1) * sizeof(uint64_t), __FILE__, __LINE__),
+	};
+
+	/*
+	 *	Run-length encode the sorted keys in place.
+	 */
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		if ((histogram->numberOfBins > 0) && (keys[i] == histogram->keys[histogram->numberOfBins - 1]))
+		{
+			histogram->counts[histogram->numberOfBins - 1]++;
+
+			continue;
+		}
+
+		histogram->keys[histogram->numberOfBins] = keys[i];
+		histogram->counts[histogram->numberOfBins] = 1;
+		histogram->numberOfBins++;
+	}
+
+	return;
+}
+
+void
+shardIterationRange(
+	size_t		numberOfIterations,
+	size_t		shardIndex,
+	size_t		numberOfShards,
+	size_t *	firstIteration,
+	size_t *	numberOfShardIterations)
+{
+	/*
+	 *	Shards differ in size by at most one iteration.
+	 */
+	size_t	quotient = numberOfIterations / numberOfShards;
+	size_t	remainder = numberOfIterations % numberOfShards;
+
+	*firstIteration = shardIndex * quotient + ((shardIndex < remainder) ? shardIndex : remainder);
+	*numberOfShardIterations = quotient + ((shardIndex < remainder) ? 1 : 0);
+
+	return;
+}
+
+double
+shardHistogramBinWidth(const float *  pilotSamples, size_t numberOfPilotSamples)
+{
+	OutputMoments	moments = calculateOutputMoments(pilotSamples, numberOfPilotSamples);
+	double		standardDeviation = (numberOfPilotSamples > 1) ? sqrt(moments.m2 / (numberOfPilotSamples - 1)) : 0.0;
+
+	/*
+	 *	A constant pilot still needs bins that resolve the spread of later iterations.
+	 */
+	if (!(standardDeviation > 0.0))
+	{
+		standardDeviation = fmax(fabs(moments.mean), 1.0) * FLT_EPSILON * kShardConstantBinsPerStandardDeviation;
+	}
+
+	return standardDeviation / kShardConstantBinsPerStandardDeviation;
+}
+
+CommonConstantReturnType
+shardPartialResultWrite(
+	const CommandLineArguments *	arguments,
+	uint64_t			configurationHash,
+	double				binWidth,
+	const float *			outputSamples,
+	const float *			controlSamples)
+{
+	char		path[kCommonConstantMaxCharsPerFilepath];
+	FILE *		file;
+	ShardHeader	header;
+	uint8_t		headerBytes[kShardConstantHeaderSize];
+	SparseHistogram	histogram;
+	size_t		firstIteration;
+	size_t		numberOfShardIterations;
+	bool		isWritten;
+
+	if (partialResultPath(arguments, arguments->shardIndex, path) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	shardIterationRange(arguments->common.numberOfMonteCarloIterations, arguments->shardIndex, arguments->numberOfShards, &firstIteration, &numberOfShardIterations);
+	buildSparseHistogram(&histogram, binWidth, outputSamples, numberOfShardIterations);
+
+	header = (ShardHeader) {
+		.version			= kShardConstantVersion,
+		.recordSize			= arguments->savePartialSamples ? (uint32_t)(((controlSamples != NULL) ? 2 : 1) * sizeof(float)) : 0,
+		.configurationHash		= configurationHash,
+		.numberOfIterations		= arguments->common.numberOfMonteCarloIterations,
+		.shardIndex			= arguments->shardIndex,
+		.numberOfShards			= arguments->numberOfShards,
+		.firstIteration			= firstIteration,
+		.numberOfShardIterations	= numberOfShardIterations,
+		.binWidth			= binWidth,
+		.numberOfBins			= histogram.numberOfBins,
+		.moments			= calculateOutputMoments(outputSamples, numberOfShardIterations),
+	};
+	memcpy(header.magic, kShardMagic, kShardConstantMagicLength);
+	encodeShardHeader(&header, headerBytes);
+
+	file = fopen(path, "wb");
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not create partial result \"%s\": %s.\n", path, strerror(errno));
+		free(histogram.keys);
+		free(histogram.counts);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	isWritten = (fwrite(headerBytes, sizeof(headerBytes), 1, file) == 1);
+
+	for (size_t i = 0; isWritten && (i < histogram.numberOfBins); i++)
+	{
+		isWritten = writeUint64(file, (uint64_t) histogram.keys[i]);
+	}
+
+	for (size_t i = 0; isWritten && (i < histogram.numberOfBins); i++)
+	{
+		isWritten = writeUint64(file, histogram.counts[i]);
+	}
+
+	for (size_t i = 0; isWritten && (header.recordSize > 0) && (i < numberOfShardIterations); i++)
+	{
+		isWritten = writeFloat(file, outputSamples[i]) && ((controlSamples == NULL) || writeFloat(file, controlSamples[i]));
+	}
+
+	free(histogram.keys);
+	free(histogram.counts);
+
+	if ((fclose(file) != 0) || !isWritten)
+	{
+		fprintf(stderr, "Error: Could not write partial result \"%s\".\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Release everything a failed merge has allocated so far.
+ */
+static CommonConstantReturnType
+abandonMerge(HistogramBin *  bins, SampleStore *  outputStore, SampleStore *  controlStore)
+{
+	free(bins);
+	sampleStoreClose(outputStore);
+	sampleStoreClose(controlStore);
+
+	return kCommonConstantReturnTypeError;
+}
+
+CommonConstantReturnType
+shardPartialResultsMerge(
+	const CommandLineArguments *	arguments,
+	uint64_t			configurationHash,
+	ShardSummary *			summary,
+	SampleStore *			outputStore,
+	SampleStore *			controlStore)
+{
+	uint32_t	recordSize = (uint32_t)((arguments->useControlVariate ? 2 : 1) * sizeof(float));
+	size_t		numberOfIterations = arguments->common.numberOfMonteCarloIterations;
+	HistogramBin *	bins = NULL;
+	size_t		numberOfBins = 0;
+	size_t		nextIteration = 0;
+	bool		hasSamples = true;
+
+	*summary = (ShardSummary) {
+		.numberOfShards	= arguments->numberOfShards,
+	};
+	outputStore->memory = NULL;
+	outputStore->samples = NULL;
+	controlStore->memory = NULL;
+	controlStore->samples = NULL;
+
+	for (size_t shard = 0; shard < arguments->numberOfShards; shard++)
+	{
+		char		path[kCommonConstantMaxCharsPerFilepath];
+		ShardHeader	header;
+		uint8_t		headerBytes[kShardConstantHeaderSize];
+		HistogramBin *	grownBins;
+		FILE *		file;
+		bool		isValid;
+
+		if (partialResultPath(arguments, shard, path) != kCommonConstantReturnTypeSuccess)
+		{
+			return abandonMerge(bins, outputStore, controlStore);
+		}
+
+		file = fopen(path, "rb");
+
+		if (file == NULL)
+		{
+			fprintf(stderr, "Error: Could not open partial result \"%s\": %s.\n", path, strerror(errno));
+			return abandonMerge(bins, outputStore, controlStore);
+		}
+
+		isValid = (fread(headerBytes, sizeof(headerBytes), 1, file) == 1);
+
+		if (isValid)
+		{
+			decodeShardHeader(headerBytes, &header);
+			isValid = (memcmp(header.magic, kShardMagic, kShardConstantMagicLength) == 0) &&
+					(header.version == kShardConstantVersion);
+		}
+
+		if (!isValid || (header.configurationHash != configurationHash) ||
+			(header.numberOfIterations != arguments->common.numberOfMonteCarloIterations) ||
+			(header.numberOfShards != arguments->numberOfShards) || (header.shardIndex != shard) ||
+			(header.firstIteration != nextIteration) ||
+			((shard > 0) && (header.binWidth != summary->histogram.binWidth)))
+		{
+			fprintf(stderr, "Error: \"%s\" is not the partial result of shard %zu of this run.\n", path, shard);
+			fclose(file);
+			return abandonMerge(bins, outputStore, controlStore);
+		}
+
+		grownBins = (HistogramBin *) realloc(bins, (numberOfBins + header.numberOfBins) * sizeof(HistogramBin));
+
+		if (grownBins == NULL)
+		{
+			fprintf(stderr, "Error: Could not allocate the merged histogram.\n");
+			fclose(file);
+
+			return abandonMerge(bins, outputStore, controlStore);
+		}
+
+		bins = grownBins;
+
+		for (size_t i = 0; isValid && (i < header.numberOfBins); i++)
+		{
+			uint64_t	key;
+
+			isValid = readUint64(file, &key);
+			bins[numberOfBins + i].key = (int64_t) key;
+		}
+
+		for (size_t i = 0; isValid && (i < header.numberOfBins); i++)
+		{
+			isValid = readUint64(file, &bins[numberOfBins + i].count);
+		}
+
+		/*
+		 *	The samples are only used if every shard saved them, with the same kind of records.
+		 */
+		hasSamples = hasSamples && (header.recordSize == recordSize);
+
+		if (hasSamples && (outputStore->samples == NULL) &&
+			(sampleStoresOpen(
+				outputStore,
+				arguments->useControlVariate ? controlStore : NULL,
+				arguments->sampleStoreBackend,
+				arguments->sampleStorePath,
+				numberOfIterations,
+				numberOfIterations,
+				kSamplePrecisionFloat32) != kCommonConstantReturnTypeSuccess))
+		{
+			fclose(file);
+
+			return abandonMerge(bins, outputStore, controlStore);
+		}
+		else if (!hasSamples && (outputStore->samples != NULL))
+		{
+			sampleStoreClose(outputStore);
+			sampleStoreClose(controlStore);
+		}
+
+		for (size_t i = 0; isValid && hasSamples && (i < header.numberOfShardIterations); i++)
+		{
+			isValid = readFloat(file, &outputStore->samples[header.firstIteration + i]) &&
+					((controlStore->samples == NULL) || readFloat(file, &controlStore->samples[header.firstIteration + i]));
+		}
+
+		fclose(file);
+
+		if (!isValid)
+		{
+			fprintf(stderr, "Error: Partial result \"%s\" is truncated.\n", path);
+			return abandonMerge(bins, outputStore, controlStore);
+		}
+
+		numberOfBins += header.numberOfBins;
+		nextIteration += header.numberOfShardIterations;
+		summary->histogram.binWidth = header.binWidth;
+		mergeOutputMoments(&summary->moments, &header.moments);
+	}
+
+	if (nextIteration != arguments->common.numberOfMonteCarloIterations)
+	{
+		fprintf(stderr, "Error: The partial results cover %zu of %zu iterations.\n", nextIteration, arguments->common.numberOfMonteCarloIterations);
+		return abandonMerge(bins, outputStore, controlStore);
+	}
+
+	/*
+	 *	Merge the bins of all shards by adding the counts of equal keys.
+	 */
+	qsort(bins, numberOfBins, sizeof(HistogramBin), compareBins);
+	summary->histogram.keys = (int64_t *) checkedMalloc((numberOfBins + 1) * sizeof(int64_t), __FILE__, __LINE__);
+	summary->histogram.counts = (uint64_t *) checkedMalloc((numberOfBins + 1) * sizeof(uint64_t), __FILE__, __LINE__);
+
+	for (size_t i = 0; i < numberOfBins; i++)
+	{
+		size_t	last = summary->histogram.numberOfBins;
+
+		if ((last > 0) && (bins[i].key == summary->histogram.keys[last - 1]))
+		{
+			summary->histogram.counts[last - 1] += bins[i].count;
+
+			continue;
+		}
+
+		summary->histogram.keys[last] = bins[i].key;
+		summary->histogram.counts[last] = bins[i].count;
+		summary->histogram.numberOfBins++;
+	}
+
+	free(bins);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+double
+shardSummaryQuantile(const ShardSummary *  summary, double level)
+{
+	const SparseHistogram *	histogram = &summary->histogram;
+	double			rank = level * (double)(summary->moments.count - 1);
+	double			cumulativeCount = 0.0;
+
+	for (size_t i = 0; i < histogram->numberOfBins; i++)
+	{
+		cumulativeCount += (double) histogram->counts[i];
+
+		if (cumulativeCount > rank)
+		{
+			double	center = ((double) histogram->keys[i] + 0.5) * histogram->binWidth;
+
+			return fmin(fmax(center, summary->moments.minimum), summary->moments.maximum);
+		}
+	}
+
+	return summary->moments.maximum;
+}
+
+void
+shardSummaryQuantileDraws(const ShardSummary *  summary, float *  samples)
+{
+	const SparseHistogram *	histogram = &summary->histogram;
+	const OutputMoments *	moments = &summary->moments;
+	size_t			numberOfSamples = (size_t) moments->count;
+	size_t			bin = 0;
+	double			countBeforeBin = 0.0;
+	double			sum = 0.0;
+	double			drawMean;
+	double			sumOfSquaredDeviations = 0.0;
+	double			scale;
+
+	if ((numberOfSamples == 0) || (histogram->numberOfBins == 0))
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		double	rank = (double) i + 0.5;
+		double	position;
+
+		while ((bin + 1 < histogram->numberOfBins) && (countBeforeBin + (double) histogram->counts[bin] <= rank))
+		{
+			countBeforeBin += (double) histogram->counts[bin];
+			bin++;
+		}
+
+		position = ((double) histogram->keys[bin] + (rank - countBeforeBin) / (double) histogram->counts[bin]) * histogram->binWidth;
+		samples[i] = (float) fmin(fmax(position, moments->minimum), moments->maximum);
+		sum += samples[i];
+	}
+
+	drawMean = sum / numberOfSamples;
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		sumOfSquaredDeviations += (samples[i] - drawMean) * (samples[i] - drawMean);
+	}
+
+	/*
+	 *	The bins are a thousandth of a standard deviation wide, so the draws only need a tiny
+	 *	correction to reproduce the exact moments.
+	 */
+	scale = (sumOfSquaredDeviations > 0.0) ? sqrt(moments->m2 / sumOfSquaredDeviations) : 0.0;
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		samples[i] = (float)(moments->mean + (samples[i] - drawMean) * scale);
+	}
+
+	return;
+}
+
+void
+printShardSummary(const ShardSummary *  summary, const char *  outputName)
+{
+	const OutputMoments *	moments = &summary->moments;
+	const double		levels[] = {0.001, 0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99, 0.999};
+	double			n = (double) moments->count;
+
+	printf("Merged %zu shards (%" PRIu64 " iterations) of %s:\n", summary->numberOfShards, moments->count, outputName);
+	printf("Mean: %lf, variance: %le\n", moments->mean, (n > 1) ? (moments->m2 / (n - 1)) : 0.0);
+
+	if (moments->m2 > 0.0)
+	{
+		printf("Skewness: %lf, excess kurtosis: %lf\n",
+			sqrt(n) * moments->m3 / pow(moments->m2, 1.5),
+			n * moments->m4 / (moments->m2 * moments->m2) - 3.0);
+	}
+
+	printf("Minimum: %lf, maximum: %lf\n", moments->minimum, moments->maximum);
+	printf("\nQuantiles (histogram bin width %le):\n", summary->histogram.binWidth);
+
+	for (size_t i = 0; i < sizeof(levels) / sizeof(levels[0]); i++)
+	{
+		printf("%-8.3lf %lf\n", levels[i], shardSummaryQuantile(summary, levels[i]));
+	}
+
+	return;
+}
+
+void
+shardSummaryFree(ShardSummary *  summary)
+{
+	free(summary->histogram.keys);
+	free(summary->histogram.counts);
+	summary->histogram.keys = NULL;
+	summary->histogram.counts = NULL;
+	summary->histogram.numberOfBins = 0;
+
+	return;
+}
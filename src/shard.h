@@ -0,0 +1,186 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "utilities.h"
+
+typedef enum
+{
+	kShardConstantVersion			= 2,
+	kShardConstantMagicLength		= 8,
+	/*
+	 *	Size in bytes of the header of a partial-result file.
+	 */
+	kShardConstantHeaderSize		= 136,
+	/*
+	 *	Number of leading iterations of the logical run from which every shard derives the same
+	 *	histogram bin width.
+	 */
+	kShardConstantPilotIterations		= 1024,
+	/*
+	 *	Number of histogram bins per standard deviation of the pilot iterations.
+	 */
+	kShardConstantBinsPerStandardDeviation	= 1000,
+} ShardConstant;
+
+/*
+ *	Count, mean, central moment sums, and range of a set of output samples. Moments of disjoint
+ *	sets merge exactly (Pébay, 2008), in any grouping.
+ */
+typedef struct OutputMoments
+{
+	uint64_t	count;
+	double		mean;
+	double		m2;
+	double		m3;
+	double		m4;
+	double		minimum;
+	double		maximum;
+} OutputMoments;
+
+/*
+ *	Sparse histogram of output samples with bins `[key * binWidth, (key + 1) * binWidth)`, in
+ *	ascending order of key. Histograms with the same bin width merge by adding counts.
+ */
+typedef struct SparseHistogram
+{
+	double		binWidth;
+	size_t		numberOfBins;
+	int64_t *	keys;
+	uint64_t *	counts;
+} SparseHistogram;
+
+/*
+ *	Merged result of all shards of a logical run.
+ */
+typedef struct ShardSummary
+{
+	size_t		numberOfShards;
+	OutputMoments	moments;
+	SparseHistogram	histogram;
+} ShardSummary;
+
+/**
+ *	@brief	Get the iterations of the logical run of `-M` iterations that a shard runs.
+ *
+ *	@param	numberOfIterations	: Number of iterations of the logical run.
+ *	@param	shardIndex		: Index of the shard.
+ *	@param	numberOfShards		: Number of shards.
+ *	@param	firstIteration		: Pointer to store the first iteration of the shard.
+ *	@param	numberOfShardIterations	: Pointer to store the number of iterations of the shard.
+ */
+void				shardIterationRange(
+					size_t		numberOfIterations,
+					size_t		shardIndex,
+					size_t		numberOfShards,
+					size_t *	firstIteration,
+					size_t *	numberOfShardIterations);
+
+/**
+ *	@brief	Bin width of the histograms of all shards, from the pilot iterations of the logical run.
+ *
+ *	@param	pilotSamples		: Outputs of the first iterations of the logical run.
+ *	@param	numberOfPilotSamples	: Number of entries in `pilotSamples`.
+ *	@return				: The bin width.
+ */
+double				shardHistogramBinWidth(const float *  pilotSamples, size_t numberOfPilotSamples);
+
+/**
+ *	@brief	Write the partial result of a shard: the moments and histogram of its outputs and,
+ *		with `-W`, the samples themselves.
+ *
+ *	@param	arguments		: Pointer to the command-line arguments struct.
+ *	@param	configurationHash	: Hash of the configuration of the logical run.
+ *	@param	binWidth		: Bin width of the histogram.
+ *	@param	outputSamples		: Outputs of the iterations of the shard.
+ *	@param	controlSamples		: Control-variate samples of the iterations of the shard, or `NULL`.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	shardPartialResultWrite(
+					const CommandLineArguments *	arguments,
+					uint64_t			configurationHash,
+					double				binWidth,
+					const float *			outputSamples,
+					const float *			controlSamples);
+
+/**
+ *	@brief	Merge the partial results of all shards of a logical run, after checking that they
+ *		belong to the same run and cover all of its iterations exactly once. If all partial
+ *		results hold their samples, the samples of all iterations are loaded in order, as an
+ *		unsharded run would have produced them.
+ *
+ *	@param	arguments		: Pointer to the command-line arguments struct.
+ *	@param	configurationHash	: Hash of the configuration of the logical run.
+ *	@param	summary			: Pointer to store the merged moments and histogram.
+ *	@param	outputStore		: Pointer to the sample store to create for the outputs of all iterations, left
+ *					  without samples if the partial results do not hold them.
+ *	@param	controlStore		: Pointer to the sample store to create for the control-variate samples, if `-C`.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	shardPartialResultsMerge(
+					const CommandLineArguments *	arguments,
+					uint64_t			configurationHash,
+					ShardSummary *			summary,
+					SampleStore *			outputStore,
+					SampleStore *			controlStore);
+
+/**
+ *	@brief	Quantile of the merged histogram of a shard summary, clamped to the range of the samples.
+ *
+ *	@param	summary	: Pointer to the shard summary.
+ *	@param	level	: Quantile level in [0, 1].
+ *	@return		: Center of the histogram bin of the quantile.
+ */
+double				shardSummaryQuantile(const ShardSummary *  summary, double level);
+
+/**
+ *	@brief	Draw samples of equal probability mass from the merged histogram of a shard summary,
+ *		for the outputs of a merge whose partial results do not hold their samples. Draw `i`
+ *		is the quantile at cumulative count `i + 1/2`, interpolated linearly within its bin
+ *		and clamped to the range of the samples. The draws are then scaled about their mean
+ *		so that their mean and variance are those of the merged moments.
+ *
+ *	@param	summary	: Pointer to the shard summary.
+ *	@param	samples	: Array of as many entries as the summary has samples, to store the draws.
+ */
+void				shardSummaryQuantileDraws(const ShardSummary *  summary, float *  samples);
+
+/**
+ *	@brief	Print the moments and quantiles of a shard summary.
+ *
+ *	@param	summary		: Pointer to the shard summary.
+ *	@param	outputName	: Name of the selected output.
+ */
+void				printShardSummary(const ShardSummary *  summary, const char *  outputName);
+
+/**
+ *	@brief	Free the memory held by a shard summary.
+ *
+ *	@param	summary	: Pointer to the shard summary.
+ */
+void				shardSummaryFree(ShardSummary *  summary);
@@ -0,0 +1,135 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include "unscented.h"
+
+CommonConstantReturnType
+runUnscentedTransform(const ConversionModel *  model, UnscentedTransformResult *  result)
+{
+	const size_t	n = kConversionModelConstantMaxInputs;
+	const double	spread = sqrt(3.0);
+	double		mean[kConversionModelConstantMaxInputs];
+	double		covariance[kConversionModelConstantMaxInputs * kConversionModelConstantMaxInputs];
+	double		factor[kConversionModelConstantMaxInputs * kConversionModelConstantMaxInputs];
+	/*
+	 *	Outputs at the input means, followed by pairs of outputs at `mu + sqrt(3) l_i` and
+	 *	`mu - sqrt(3) l_i`.
+	 */
+	double		outputs[2 * kConversionModelConstantMaxInputs + 1][kOutputDistributionIndexMax];
+	size_t		numberOfColumns = 0;
+
+	*result = (UnscentedTransformResult) {0};
+
+	conversionModelInputMoments(model, mean, covariance);
+	conversionModelCovarianceFactor(covariance, factor);
+	conversionModelEvaluateWithJacobian(mean, outputs[0], NULL);
+
+	for (size_t j = 0; j < n; j++)
+	{
+		double	plus[kConversionModelConstantMaxInputs];
+		double	minus[kConversionModelConstantMaxInputs];
+
+		if (factor[j * n + j] == 0.0)
+		{
+			continue;
+		}
+
+		for (size_t i = 0; i < n; i++)
+		{
+			plus[i] = mean[i] + spread * factor[i * n + j];
+			minus[i] = mean[i] - spread * factor[i * n + j];
+		}
+
+		conversionModelEvaluateWithJacobian(plus, outputs[2 * numberOfColumns + 1], NULL);
+		conversionModelEvaluateWithJacobian(minus, outputs[2 * numberOfColumns + 2], NULL);
+		numberOfColumns++;
+	}
+
+	result->numberOfSigmaPoints = 2 * numberOfColumns + 1;
+
+	/*
+	 *	Weights `1 - m / 3` for the centre and `1 / 6` for every other sigma point. The centre
+	 *	weight is negative for more than three uncertain inputs, but the weights still sum to one.
+	 */
+	double	centreWeight = 1.0 - numberOfColumns / 3.0;
+	double	weight = 1.0 / 6.0;
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		result->mean[o] = centreWeight * outputs[0][o];
+
+		for (size_t k = 1; k < result->numberOfSigmaPoints; k++)
+		{
+			result->mean[o] += weight * outputs[k][o];
+		}
+	}
+
+	for (size_t k = 0; k < result->numberOfSigmaPoints; k++)
+	{
+		double	w = (k == 0) ? centreWeight : weight;
+
+		for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+		{
+			for (size_t p = 0; p < kOutputDistributionIndexMax; p++)
+			{
+				result->covariance[o][p] += w * (outputs[k][o] - result->mean[o]) * (outputs[k][p] - result->mean[p]);
+			}
+		}
+	}
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		if (!isfinite(result->mean[o]) || !isfinite(result->covariance[o][o]))
+		{
+			fprintf(stderr, "Error: The conversion routines are not finite at the sigma points of the inputs.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+printUnscentedTransformResult(const UnscentedTransformResult *  result, const char *  outputNames[kOutputDistributionIndexMax])
+{
+	printf("Unscented transform (%zu sigma points):\n", result->numberOfSigmaPoints);
+	printf("%-16s %14s %14s %14s\n", "Output", "Mean", "Variance", "Std. dev.");
+
+	for (size_t o = 0; o < kOutputDistributionIndexMax; o++)
+	{
+		printf("%-16s %14.6lf %14.6le %14.6le\n",
+			outputNames[o],
+			result->mean[o],
+			result->covariance[o][o],
+			sqrt(fmax(result->covariance[o][o], 0.0)));
+	}
+
+	printf("\n");
+	printConversionModelOutputCovariance(result->covariance, outputNames);
+
+	return;
+}
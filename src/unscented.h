@@ -0,0 +1,65 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "model.h"
+
+/*
+ *	Unscented transform of the inputs of a conversion model: the model is evaluated at its input
+ *	means and at `2 m` sigma points `mu +/- sqrt(3) l_i` along the `m` nonzero columns `l_i` of a
+ *	Cholesky factor of the input covariance, and the weighted outputs give their means and
+ *	covariance. The spread `sqrt(3)` (Julier's `kappa = 3 - m`) matches the fourth moments of
+ *	normal inputs along every column and puts the sigma points of uniform inputs on the edges of
+ *	their support; the means are exact for quadratic models.
+ */
+typedef struct UnscentedTransformResult
+{
+	size_t	numberOfSigmaPoints;
+	double	mean[kOutputDistributionIndexMax];
+	double	covariance[kOutputDistributionIndexMax][kOutputDistributionIndexMax];
+} UnscentedTransformResult;
+
+/**
+ *	@brief	Propagate the moments of the inputs of a conversion model to all of its outputs with
+ *		the unscented transform. Calibration parameters are among the inputs unless they are
+ *		fixed.
+ *
+ *	@param	model	: Pointer to the conversion model.
+ *	@param	result	: Pointer to store the result.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runUnscentedTransform(const ConversionModel *  model, UnscentedTransformResult *  result);
+
+/**
+ *	@brief	Print the result of the unscented transform.
+ *
+ *	@param	result		: Pointer to the result.
+ *	@param	outputNames	: Names of the outputs.
+ */
+void				printUnscentedTransformResult(const UnscentedTransformResult *  result, const char *  outputNames[kOutputDistributionIndexMax]);
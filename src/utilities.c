@@ -31,9 +31,88 @@
 #include <uxhw.h>
 #include "utilities.h"
 #include "common.h"
+#include "moments.h"
+#include "interval.h"
+#include "particle.h"
+#include "pce.h"
 
 const char *	kDefaultMeasurementsPathPrefix		= "warp-board-002";
 const char *	kDefaultCalibrationConstantsPathPrefix	= "BME680-par";
+const size_t	kDefaultAdaptiveBatchSize		= 1000;
+const size_t	kDefaultCheckpointInterval		= 1000000;
+const size_t	kDefaultMomentOrder			= 3;
+const size_t	kDefaultDensityGridPoints		= 101;
+const size_t	kDefaultPolynomialChaosDegree		= 3;
+const char *	kDefaultPartialResultPrefix		= "shard";
+const char *	kDefaultSampleStorePath			= "samples.bin";
+
+static const char *	kAnalysisModeNames[kAnalysisModeMax] =
+			{
+				"none",
+				"sensitivity",
+				"importance",
+				"delta",
+				"unscented",
+				"moments",
+				"density",
+				"interval",
+				"gradient",
+				"particle",
+				"pce",
+			};
+
+/**
+ *	@brief	Parse a comma-separated list of statistics for adaptive Monte Carlo. Entries are
+ *		"mean", "variance", or a quantile level in (0, 1).
+ *
+ *	@param	statisticsList	: The comma-separated list.
+ *	@param	criterion	: Pointer to the stopping criterion to populate.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseAdaptiveStatistics(const char *  statisticsList, AdaptiveStoppingCriterion *  criterion)
+{
+	char	listCopy[kCommonConstantMaxCharsPerFilepath];
+	char *	savePointer = NULL;
+	int	ret = snprintf(listCopy, kCommonConstantMaxCharsPerFilepath, "%s", statisticsList);
+
+	if ((ret < 0) || (ret >= kCommonConstantMaxCharsPerFilepath))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	criterion->checkMean = false;
+	criterion->checkVariance = false;
+	criterion->numberOfQuantiles = 0;
+
+	for (char *  token = strtok_r(listCopy, ",", &savePointer); token != NULL; token = strtok_r(NULL, ",", &savePointer))
+	{
+		float	quantileLevel;
+
+		if (strcmp(token, "mean") == 0)
+		{
+			criterion->checkMean = true;
+		}
+		else if (strcmp(token, "variance") == 0)
+		{
+			criterion->checkVariance = true;
+		}
+		else if ((parseFloatChecked(token, &quantileLevel) == kCommonConstantReturnTypeSuccess) &&
+			(quantileLevel > 0.0f) && (quantileLevel < 1.0f) &&
+			(criterion->numberOfQuantiles < kEstimatorsConstantMaxQuantiles))
+		{
+			criterion->quantileLevels[criterion->numberOfQuantiles++] = quantileLevel;
+		}
+		else
+		{
+			fprintf(stderr, "Error: Invalid statistic \"%s\" for adaptive Monte Carlo.\n", token);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
 
 /**
  *	@brief	Set default values for the application-specific command-line arguments.
@@ -71,14 +150,74 @@ setDefaultCommandLineArguments(CommandLineArguments *  arguments)
 		.pressureRawADCValue		= kBME680ConstantsPressureRawADCDefaultValue,
 		.humidityRawADCValue		= kBME680ConstantsHumidityRawADCDefaultValue,
 		.useInputADCFiles		= false,
+		.samplingMethod			= kSamplingMethodPseudoRandom,
+		.randomSeed			= 0,
+		.calibrationSampling		= kCalibrationSamplingFixed,
+		.analysisMode			= kAnalysisModeNone,
+		.momentOrder			= kDefaultMomentOrder,
+		.densityGrid			= (DensityGrid) {
+							.hasRange	= false,
+							.numberOfPoints	= kDefaultDensityGridPoints,
+							.isHistogram	= false,
+						},
+		.polynomialChaosDegree		= kDefaultPolynomialChaosDegree,
+		.inputCorrelation		= kInputCorrelationIndependent,
+		.checkpointPath			= "",
+		.useCheckpoint			= false,
+		.checkpointInterval		= kDefaultCheckpointInterval,
+		.resumeFromCheckpoint		= false,
+		.extendCheckpoint		= false,
+		.shardMode			= kShardModeNone,
+		.shardIndex			= 0,
+		.numberOfShards			= 1,
+		.partialResultPrefix		= "",
+		.savePartialSamples		= false,
+		.sampleStoreBackend		= kSampleStoreBackendHeap,
+		.sampleStorePath		= "",
+		.maxOutputSamples		= 0,
+		.samplePrecision		= kSamplePrecisionFloat32,
+		.useControlVariate		= false,
+		.isAdaptiveMode			= false,
+		.adaptiveBatchSize		= kDefaultAdaptiveBatchSize,
+		.adaptiveStoppingCriterion	= (AdaptiveStoppingCriterion) {
+							.tolerance	= 0.0,
+							.checkMean	= true,
+						},
+		.responseGrid			= (ResponseGrid) {
+							.isEnabled	= false,
+							.format		= kResponseGridFormatCsv,
+							.useAllDevices	= false,
+							.numberOfDevices	= 1,
+							.deviceIndices	= NULL,
+						},
 	};
 #pragma GCC diagnostic pop
 
 	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
 	{
 		arguments->isInputSetFromCommandLine[i] = false;
+		arguments->inputUxStrings[i] = NULL;
 	}
 
+	arguments->responseGrid.axes[kInputDistributionIndexForTemperatureRawADCValue] = (ResponseGridAxis) {
+		.numberOfValues	= 1,
+		.lowerBound	= arguments->temperatureRawADCValue,
+		.upperBound	= arguments->temperatureRawADCValue,
+		.values		= NULL,
+	};
+	arguments->responseGrid.axes[kInputDistributionIndexForPressureRawADCValue] = (ResponseGridAxis) {
+		.numberOfValues	= 1,
+		.lowerBound	= arguments->pressureRawADCValue,
+		.upperBound	= arguments->pressureRawADCValue,
+		.values		= NULL,
+	};
+	arguments->responseGrid.axes[kInputDistributionIndexForHumidityRawADCValue] = (ResponseGridAxis) {
+		.numberOfValues	= 1,
+		.lowerBound	= arguments->humidityRawADCValue,
+		.upperBound	= arguments->humidityRawADCValue,
+		.values		= NULL,
+	};
+
 	snprintf(
 		arguments->measurementsPathPrefix,
 		kCommonConstantMaxCharsPerFilepath,
@@ -93,6 +232,20 @@ setDefaultCommandLineArguments(CommandLineArguments *  arguments)
 		(char *) kDefaultCalibrationConstantsPathPrefix
 		);
 
+	snprintf(
+		arguments->partialResultPrefix,
+		kCommonConstantMaxCharsPerFilepath,
+		"%s",
+		(char *) kDefaultPartialResultPrefix
+		);
+
+	snprintf(
+		arguments->sampleStorePath,
+		kCommonConstantMaxCharsPerFilepath,
+		"%s",
+		(char *) kDefaultSampleStorePath
+		);
+
 	return kCommonConstantReturnTypeSuccess;
 }
 
@@ -116,59 +269,434 @@ printUsage(void)
 		"\t[-n, --calibration-parameter-index <index of calibration parameter: int in [0, 4]> (Default: 0)]\n"
 		"\t[-t, --override-temperature-measurement <temperature measurement : str> (Default: '')]\n"
 		"\t[-p, --override-pressure-measurement <pressure measurement: str> (Default: '')]\n"
-		"\t[-u, --override-humidity-measurement <humidity measurement: str> (Default: '')]\n",
+		"\t[-u, --override-humidity-measurement <humidity measurement: str> (Default: '')]\n"
+		"\t[-g, --grid <Path to output file : str>] (Response-surface mode: evaluate all outputs on the Cartesian grid of the values of -t, -p, and -u, each a value, a range 'lower:upper:points', or a comma-separated list, and write one row per grid point to the file.)\n"
+		"\t[-f, --grid-format <csv | binary> (Default: 'csv')] (Format of the file of -g: CSV, or records of a 32-bit device index and six 32-bit floats.)\n"
+		"\t[-y, --grid-devices <all | comma-separated device indices>] (Also run the grid of -g over these devices of the calibration table instead of the device of -n.)\n"
+		"\t[-s, --sampling-method <pseudorandom | latin-hypercube | stratified | antithetic> (Default: 'pseudorandom')] (Sampling of raw ADC inputs in Monte Carlo mode.)\n"
+		"\t[-r, --random-seed <seed : int> (Default: 0)] (Seed of the random number streams in Monte Carlo mode.)\n"
+		"\t[-k, --calibration-sampling <fixed | joint | independent> (Default: 'fixed')] (Draw the calibration parameters of all devices, per device or per parameter, in Monte Carlo mode.)\n"
+		"\t[-x, --input-correlation <independent | cross | lagged> (Default: 'independent')] (Dependence between the raw ADC inputs from trace files (`-m`) in Monte Carlo mode.)\n"
+		"\t[-A, --analysis <none | sensitivity | importance | delta | unscented | moments | density | interval | gradient | particle | pce> (Default: 'none')] (Analysis to run in Monte Carlo mode: 'sensitivity' computes Sobol indices of the selected output from -M base samples, 'importance' the probability of the event of -E from -M importance samples, 'delta' and 'unscented' the mean and covariance of all outputs without sampling, to first order or from sigma points, 'moments' their central moments up to the order of -N from the moments of the inputs, 'density' the exact temperature distribution on the grid of -Z and -M exact quantiles in data.out, 'interval' guaranteed bounds of all outputs from up to min(-M, %d) interval evaluations for each lower and upper bound, 'gradient' the exact derivatives of the selected output with respect to all inputs and calibration parameters over -M samples, 'particle' the distributions of all outputs in one pass on distributions of min(-M, %d) weighted particles, 'pce' a polynomial chaos expansion of all outputs of degree -d fitted to -M model evaluations, with the moments and Sobol indices it implies and -M of its samples in data.out.)\n"
+		"\t[-E, --event <'<', '<=', '>', or '>=' followed by a threshold : str>] (Event of the selected output for '-A importance', e.g., '>=100'.)\n"
+		"\t[-N, --moment-order <order : int> (Default: %zu)] (Highest order of the central moments of '-A moments', from 2 to %d.)\n"
+		"\t[-Z, --density-grid <points, or lower:upper:points> (Default: %zu points over the support)] (Grid of '-A density'.)\n"
+		"\t[-e, --density-histogram] (Print the probabilities of the bins of the grid of -Z instead of the density and distribution function.)\n"
+		"\t[-d, --pce-degree <degree : int> (Default: %zu)] (Total degree of the expansion of '-A pce', from 1 to %d.)\n"
+		"\t[-K, --checkpoint <Path to checkpoint file : str>] (Save the Monte Carlo samples completed so far to a checkpoint file.)\n"
+		"\t[-I, --checkpoint-interval <iterations : int> (Default: %zu)] (Iterations between checkpoints.)\n"
+		"\t[-R, --resume] (Continue the run of the checkpoint file of -K, or start it if the file does not exist.)\n"
+		"\t[-X, --extend] (Continue the run of the checkpoint file of -K up to a larger -M.)\n"
+		"\t[-P, --shard <shard index/number of shards : str>] (Run one shard of the -M iterations, e.g., '2/8', and write its partial result.)\n"
+		"\t[-G, --merge <number of shards : int>] (Merge the partial results of all shards of the -M iterations; without their samples (-W), the outputs are equal-mass draws from the merged histogram.)\n"
+		"\t[-O, --partial-result-prefix <prefix of partial-result files : str> (Default: '%s')]\n"
+		"\t[-W, --partial-samples] (Include the samples in the partial results, so that merging them writes all samples to data.out.)\n"
+		"\t[-D, --sample-store <heap | huge-pages | file> (Default: 'heap')] (Memory for the Monte Carlo samples: 'file' maps the file of -F, for runs larger than memory, and keeps the file as an extra output next to data.out.)\n"
+		"\t[-F, --sample-store-path <Path to sample file : str> (Default: '%s')] (File of raw 32-bit float samples, or 16-bit codes with -Q, for '-D file'. Shards of -P append '.<index>-of-<number of shards>'.)\n"
+		"\t[-L, --max-output-samples <samples : int>] (Write and print a uniform random subset of at most this many Monte Carlo samples; statistics still use all samples.)\n"
+		"\t[-Q, --sample-precision <float32 | float16 | quantized16> (Default: 'float32')] (Store the Monte Carlo samples, in memory and in the file of '-D file', as 16-bit half floats or as 16-bit steps over the range of a pilot run, halving their memory, and write data.out as binary 16-bit codes. Statistics use the exact samples; the mode reports the error of the codes.)\n"
+		"\t[-C, --control-variate] (Use the temperature output as a control variate for the mean in Monte Carlo mode.)\n"
+		"\t[-a, --adaptive-tolerance <tolerance : float>] (Adaptive Monte Carlo: stop once the 95%% confidence intervals are narrower than +/- tolerance.)\n"
+		"\t[-B, --adaptive-batch-size <iterations : int> (Default: %zu)] (Iterations between convergence checks in adaptive Monte Carlo.)\n"
+		"\t[-q, --adaptive-statistics <comma-separated list of 'mean', 'variance', quantile levels in (0, 1)> (Default: 'mean')]\n",
 		kDefaultMeasurementsPathPrefix,
-		kDefaultCalibrationConstantsPathPrefix);
+		kDefaultCalibrationConstantsPathPrefix,
+		kIntervalConstantMaxEvaluationsPerBound,
+		kParticleConstantMaxSupportSize,
+		kDefaultMomentOrder,
+		kMomentsConstantMaxOrder,
+		kDefaultDensityGridPoints,
+		kDefaultPolynomialChaosDegree,
+		kPolynomialChaosConstantMaxDegree,
+		kDefaultCheckpointInterval,
+		kDefaultPartialResultPrefix,
+		kDefaultSampleStorePath,
+		kDefaultAdaptiveBatchSize);
 	fprintf(stderr, "\n");
 }
 
-CommonConstantReturnType
-getCommandLineArguments(int argc, char *  argv[], CommandLineArguments *  arguments)
+/**
+ *	@brief	Parse the name of an analysis.
+ *
+ *	@param	name		: Name of the analysis.
+ *	@param	analysisMode	: Pointer to store the parsed analysis.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseAnalysisMode(const char *  name, AnalysisMode *  analysisMode)
 {
-	const char *	measurementsPathPrefix = NULL;
-	const char *	calibrationConstantsPathPrefix = NULL;
-	const char *	indexForCalibrationParametersArg = NULL;
-	const char *	temperatureArg = NULL;
-	const char *	pressureArg = NULL;
-	const char *	humidityArg = NULL;
-	const char	kConstantStringUx[] = "Ux";
+	for (AnalysisMode i = 0; i < kAnalysisModeMax; i++)
+	{
+		if (strcmp(name, kAnalysisModeNames[i]) == 0)
+		{
+			*analysisMode = i;
 
-	if (arguments == NULL)
+			return kCommonConstantReturnTypeSuccess;
+		}
+	}
+
+	return kCommonConstantReturnTypeError;
+}
+
+/**
+ *	@brief	Parse a shard of the form "<index>/<number of shards>".
+ *
+ *	@param	shard		: The shard.
+ *	@param	shardIndex	: Pointer to store the index of the shard.
+ *	@param	numberOfShards	: Pointer to store the number of shards.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseShard(const char *  shard, size_t *  shardIndex, size_t *  numberOfShards)
+{
+	char	shardCopy[kCommonConstantMaxCharsPerFilepath];
+	char *	separator;
+	int	index;
+	int	count;
+	int	ret = snprintf(shardCopy, kCommonConstantMaxCharsPerFilepath, "%s", shard);
+
+	if ((ret < 0) || (ret >= kCommonConstantMaxCharsPerFilepath))
 	{
-		fprintf(stderr, "Error: Source command-line arguments are NULL.\n");
+		return kCommonConstantReturnTypeError;
+	}
+
+	separator = strchr(shardCopy, '/');
 
+	if (separator == NULL)
+	{
 		return kCommonConstantReturnTypeError;
 	}
 
-	if (setDefaultCommandLineArguments(arguments) != kCommonConstantReturnTypeSuccess)
+	*separator = '\0';
+
+	if ((parseIntChecked(shardCopy, &index) != kCommonConstantReturnTypeSuccess) ||
+		(parseIntChecked(separator + 1, &count) != kCommonConstantReturnTypeSuccess) ||
+		(index < 0) || (count < 1) || (index >= count))
 	{
 		return kCommonConstantReturnTypeError;
 	}
 
-	/*
-	 *	Specify application-specific command-line arguments.
-	 */
-	DemoOption	options[] = {
-		{ .opt = "m", .optAlternative = "measurements-prefix",			.hasArg = true,	.foundArg = &measurementsPathPrefix,		.foundOpt = NULL },
-		{ .opt = "c", .optAlternative = "calibration-constants-prefix",		.hasArg = true,	.foundArg = &calibrationConstantsPathPrefix,	.foundOpt = NULL },
-		{ .opt = "n", .optAlternative = "calibration-parameter-index",		.hasArg = true,	.foundArg = &indexForCalibrationParametersArg,	.foundOpt = NULL },
-		{ .opt = "t", .optAlternative = "override-temperature-measurement",	.hasArg = true,	.foundArg = &temperatureArg,			.foundOpt = NULL },
-		{ .opt = "p", .optAlternative = "override-pressure-measurement",	.hasArg = true,	.foundArg = &pressureArg,			.foundOpt = NULL },
-		{ .opt = "u", .optAlternative = "override-humidity-measurement",	.hasArg = true,	.foundArg = &humidityArg,			.foundOpt = NULL },
-		{0},
-	};
+	*shardIndex = index;
+	*numberOfShards = count;
 
-	if (parseArgs(argc, argv, &arguments->common, options) != kCommonConstantReturnTypeSuccess)
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Parse the grid of the density analysis: a number of points, optionally preceded by
+ *		the range "lower:upper:".
+ *
+ *	@param	string	: The grid.
+ *	@param	grid	: Pointer to store the parsed grid.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseDensityGrid(const char *  string, DensityGrid *  grid)
+{
+	char	gridCopy[kCommonConstantMaxCharsPerFilepath];
+	char *	fields[3] = {gridCopy, NULL, NULL};
+	size_t	numberOfFields = 1;
+	float	lowerBound;
+	float	upperBound;
+	int	numberOfPoints;
+	int	ret = snprintf(gridCopy, kCommonConstantMaxCharsPerFilepath, "%s", string);
+
+	if ((ret < 0) || (ret >= kCommonConstantMaxCharsPerFilepath))
 	{
-		fprintf(stderr, "Parsing command line arguments failed\n");
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (char *  separator = strchr(gridCopy, ':'); separator != NULL; separator = strchr(separator + 1, ':'))
+	{
+		if (numberOfFields == 3)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		*separator = '\0';
+		fields[numberOfFields++] = separator + 1;
+	}
+
+	if ((numberOfFields == 2) ||
+		(parseIntChecked(fields[numberOfFields - 1], &numberOfPoints) != kCommonConstantReturnTypeSuccess) ||
+		(numberOfPoints < 1))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (numberOfFields == 3)
+	{
+		if ((parseFloatChecked(fields[0], &lowerBound) != kCommonConstantReturnTypeSuccess) ||
+			(parseFloatChecked(fields[1], &upperBound) != kCommonConstantReturnTypeSuccess) ||
+			!(lowerBound < upperBound))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		grid->hasRange = true;
+		grid->lowerBound = lowerBound;
+		grid->upperBound = upperBound;
+	}
+
+	grid->numberOfPoints = numberOfPoints;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Parse the values of a raw ADC input on the response-surface grid: a range
+ *		"lower:upper:points", or a comma-separated list of values.
+ *
+ *	@param	string	: The values.
+ *	@param	axis	: Pointer to store the parsed values. Allocates `axis->values` for a list.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseResponseGridAxis(const char *  string, ResponseGridAxis *  axis)
+{
+	char	axisCopy[kCommonConstantMaxCharsPerFilepath];
+	char *	field = axisCopy;
+	size_t	numberOfValues = 1;
+	int	ret = snprintf(axisCopy, kCommonConstantMaxCharsPerFilepath, "%s", string);
+
+	if ((ret < 0) || (ret >= kCommonConstantMaxCharsPerFilepath))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (strchr(axisCopy, ':') != NULL)
+	{
+		char *	upperField = strchr(axisCopy, ':');
+		char *	pointsField = strchr(upperField + 1, ':');
+		int	numberOfPoints;
+
+		if (pointsField == NULL)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		*upperField++ = '\0';
+		*pointsField++ = '\0';
+
+		if ((parseFloatChecked(axisCopy, &axis->lowerBound) != kCommonConstantReturnTypeSuccess) ||
+			(parseFloatChecked(upperField, &axis->upperBound) != kCommonConstantReturnTypeSuccess) ||
+			(parseIntChecked(pointsField, &numberOfPoints) != kCommonConstantReturnTypeSuccess) ||
+			(numberOfPoints < 1) || !(axis->lowerBound <= axis->upperBound))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		axis->numberOfValues = numberOfPoints;
+		axis->values = NULL;
+
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	for (const char *  separator = strchr(axisCopy, ','); separator != NULL; separator = strchr(separator + 1, ','))
+	{
+		numberOfValues++;
+	}
+
+	axis->values = (float *) checkedMalloc(numberOfValues * sizeof(float), __FILE__, __LINE__);
+
+	for (size_t i = 0; i < numberOfValues; i++)
+	{
+		char *	separator = strchr(field, ',');
+
+		if (separator != NULL)
+		{
+			*separator = '\0';
+		}
+
+		if (parseFloatChecked(field, &axis->values[i]) != kCommonConstantReturnTypeSuccess)
+		{
+			free(axis->values);
+			axis->values = NULL;
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (separator == NULL)
+		{
+			break;
+		}
+
+		field = separator + 1;
+	}
+
+	axis->numberOfValues = numberOfValues;
+	axis->lowerBound = axis->values[0];
+	axis->upperBound = axis->values[numberOfValues - 1];
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Parse the devices of the response-surface grid: "all", or a comma-separated list of
+ *		device indices.
+ *
+ *	@param	string	: The devices.
+ *	@param	grid	: Pointer to the grid to store the parsed devices in. Allocates `grid->deviceIndices` for a list.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseResponseGridDevices(const char *  string, ResponseGrid *  grid)
+{
+	char	devicesCopy[kCommonConstantMaxCharsPerFilepath];
+	char *	field = devicesCopy;
+	size_t	numberOfDevices = 1;
+	int	ret = snprintf(devicesCopy, kCommonConstantMaxCharsPerFilepath, "%s", string);
+
+	if ((ret < 0) || (ret >= kCommonConstantMaxCharsPerFilepath))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (strcmp(devicesCopy, "all") == 0)
+	{
+		grid->useAllDevices = true;
+
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	for (const char *  separator = strchr(devicesCopy, ','); separator != NULL; separator = strchr(separator + 1, ','))
+	{
+		numberOfDevices++;
+	}
+
+	grid->deviceIndices = (size_t *) checkedMalloc(numberOfDevices * sizeof(size_t), __FILE__, __LINE__);
+
+	for (size_t i = 0; i < numberOfDevices; i++)
+	{
+		char *	separator = strchr(field, ',');
+		int	device;
+
+		if (separator != NULL)
+		{
+			*separator = '\0';
+		}
+
+		if ((parseIntChecked(field, &device) != kCommonConstantReturnTypeSuccess) || (device < 0))
+		{
+			free(grid->deviceIndices);
+			grid->deviceIndices = NULL;
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		grid->deviceIndices[i] = device;
+
+		if (separator == NULL)
+		{
+			break;
+		}
+
+		field = separator + 1;
+	}
+
+	grid->numberOfDevices = numberOfDevices;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Arguments of the application-specific command-line options, `NULL` for options not given.
+ */
+typedef struct OptionArguments
+{
+	const char *	measurementsPathPrefix;
+	const char *	calibrationConstantsPathPrefix;
+	const char *	indexForCalibrationParameters;
+	const char *	temperature;
+	const char *	pressure;
+	const char *	humidity;
+	const char *	gridPath;
+	const char *	gridFormat;
+	const char *	gridDevices;
+	const char *	samplingMethod;
+	const char *	randomSeed;
+	const char *	calibrationSampling;
+	const char *	analysisMode;
+	const char *	inputCorrelation;
+	const char *	outputEvent;
+	const char *	momentOrder;
+	const char *	densityGrid;
+	const char *	polynomialChaosDegree;
+	const char *	checkpointPath;
+	const char *	checkpointInterval;
+	const char *	shard;
+	const char *	merge;
+	const char *	partialResultPrefix;
+	const char *	sampleStore;
+	const char *	sampleStorePath;
+	const char *	maxOutputSamples;
+	const char *	samplePrecision;
+	const char *	adaptiveTolerance;
+	const char *	adaptiveBatchSize;
+	const char *	adaptiveStatistics;
+} OptionArguments;
+
+/*
+ *	A combination of command-line options that the application does not support.
+ */
+typedef struct OptionConstraint
+{
+	bool		isViolated;
+	const char *	message;
+} OptionConstraint;
+
+/**
+ *	@brief	Copy a path from the command line into a fixed-size field of the arguments.
+ *
+ *	@param	string		: The path.
+ *	@param	path		: Array of `kCommonConstantMaxCharsPerFilepath` characters to store the path.
+ *	@param	description	: Description of the path for the error message.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+copyPathArgument(const char *  string, char *  path, const char *  description)
+{
+	int ret = snprintf(path, kCommonConstantMaxCharsPerFilepath, "%s", string);
+
+	if ((ret < 0) || (ret >= kCommonConstantMaxCharsPerFilepath))
+	{
+		fprintf(stderr, "Error: Could not copy %s from command-line arguments.\n", description);
 		printUsage();
 
 		return kCommonConstantReturnTypeError;
 	}
 
-	/*
-	 *	Process command-line arguments.
-	 */
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Parse an integer option with a lower bound.
+ *
+ *	@param	string	: The integer.
+ *	@param	minimum	: Smallest valid value.
+ *	@param	value	: Pointer to store the parsed value.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if the string is an integer of at least `minimum`, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseIntAtLeast(const char *  string, int minimum, int *  value)
+{
+	if ((parseIntChecked(string, value) != kCommonConstantReturnTypeSuccess) || (*value < minimum))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Process the options that the common code parses: help, output selection, and modes.
+ *
+ *	@param	arguments	: Pointer to the command-line arguments struct.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+processCommonOptions(CommandLineArguments *  arguments)
+{
 	if (arguments->common.isHelpEnabled)
 	{
 		printUsage();
@@ -215,136 +743,665 @@ getCommandLineArguments(int argc, char *  argv[], CommandLineArguments *  argume
 		fprintf(stderr, "Warning: Verbose mode not supported. Continuing in non-verbose mode.\n");
 	}
 
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Process the override of a raw ADC input (`-t`, `-p`, or `-u`): the values of its axis of
+ *		the response-surface grid, a Ux string in native Monte Carlo mode, or a single value.
+ *
+ *	@param	string		: The override.
+ *	@param	input		: The input.
+ *	@param	inputName	: Name of the input for error messages.
+ *	@param	value		: Pointer to store a single value.
+ *	@param	arguments	: Pointer to the command-line arguments struct.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseInputOverride(const char *  string, InputDistributionIndex input, const char *  inputName, float *  value, CommandLineArguments *  arguments)
+{
+	if (arguments->responseGrid.isEnabled)
+	{
+		if (parseResponseGridAxis(string, &arguments->responseGrid.axes[input]) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The %s raw ADC values of the grid must be a range 'lower:upper:points' with lower <= upper, or a comma-separated list of real numbers.\n", inputName);
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
 	/*
-	 *	Process application-specific command-line arguments.
+	 *	In native Monte Carlo mode, `loadInputDistributions()` turns Ux strings into distributions.
 	 */
-	if (temperatureArg != NULL)
+	else if (arguments->common.isMonteCarloMode && isUxString(string))
 	{
-		int ret = parseFloatChecked(temperatureArg, &arguments->temperatureRawADCValue);
+		arguments->inputUxStrings[input] = string;
+	}
+	else if (parseFloatChecked(string, value) != kCommonConstantReturnTypeSuccess)
+	{
+		*value = NAN;
+		fprintf(stderr, "Error: The %s raw ADC value must be a real number. Setting it to NAN.\n", inputName);
+		printUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	arguments->isInputSetFromCommandLine[input] = true;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Parse the options of the inputs: files, calibration device, overrides, and grid.
+ *
+ *	@param	options		: Pointer to the arguments of the options.
+ *	@param	arguments	: Pointer to the command-line arguments struct.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseInputOptions(const OptionArguments *  options, CommandLineArguments *  arguments)
+{
+	/*
+	 *	The grid changes what the overrides mean, so it comes first.
+	 */
+	if (options->gridPath != NULL)
+	{
+		int ret = snprintf(arguments->responseGrid.outputPath, kCommonConstantMaxCharsPerFilepath, "%s", options->gridPath);
+
+		if ((ret < 0) || (ret >= kCommonConstantMaxCharsPerFilepath))
+		{
+			fprintf(stderr, "Error: The path of the response-surface grid is too long.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->responseGrid.isEnabled = true;
+	}
+
+	if (((options->temperature != NULL) &&
+			(parseInputOverride(options->temperature, kInputDistributionIndexForTemperatureRawADCValue, "temperature", &arguments->temperatureRawADCValue, arguments) != kCommonConstantReturnTypeSuccess)) ||
+		((options->pressure != NULL) &&
+			(parseInputOverride(options->pressure, kInputDistributionIndexForPressureRawADCValue, "pressure", &arguments->pressureRawADCValue, arguments) != kCommonConstantReturnTypeSuccess)) ||
+		((options->humidity != NULL) &&
+			(parseInputOverride(options->humidity, kInputDistributionIndexForHumidityRawADCValue, "humidity", &arguments->humidityRawADCValue, arguments) != kCommonConstantReturnTypeSuccess)))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((options->calibrationConstantsPathPrefix != NULL) &&
+		(copyPathArgument(options->calibrationConstantsPathPrefix, arguments->calibrationConstantsPathPrefix, "calibration constants path prefix") != kCommonConstantReturnTypeSuccess))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (options->measurementsPathPrefix != NULL)
+	{
+		if (copyPathArgument(options->measurementsPathPrefix, arguments->measurementsPathPrefix, "measurements path prefix") != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->useInputADCFiles = true;
+	}
+
+	if (options->indexForCalibrationParameters != NULL)
+	{
+		int indexForCalibrationParameters;
+
+		if (parseIntChecked(options->indexForCalibrationParameters, &indexForCalibrationParameters) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The calibration parameter must be an integer.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if ((indexForCalibrationParameters < 0) || (indexForCalibrationParameters > 4))
+		{
+			fprintf(stderr, "Error: Illegal argument %d for option -n. Should be an integer in [0, 4].\n", indexForCalibrationParameters);
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->indexForCalibrationParameters = indexForCalibrationParameters;
+	}
+
+	if (options->gridFormat != NULL)
+	{
+		if (strcmp(options->gridFormat, "csv") == 0)
+		{
+			arguments->responseGrid.format = kResponseGridFormatCsv;
+		}
+		else if (strcmp(options->gridFormat, "binary") == 0)
+		{
+			arguments->responseGrid.format = kResponseGridFormatBinary;
+		}
+		else
+		{
+			fprintf(stderr, "Error: Unknown response-surface grid format \"%s\".\n", options->gridFormat);
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if ((options->gridDevices != NULL) && (parseResponseGridDevices(options->gridDevices, &arguments->responseGrid) != kCommonConstantReturnTypeSuccess))
+	{
+		fprintf(stderr, "Error: The devices of the grid must be 'all' or a comma-separated list of non-negative device indices.\n");
+		printUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Parse the options of the sampling of native Monte Carlo mode and of the analysis it runs.
+ *
+ *	@param	options		: Pointer to the arguments of the options.
+ *	@param	arguments	: Pointer to the command-line arguments struct.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseSamplingAndAnalysisOptions(const OptionArguments *  options, CommandLineArguments *  arguments)
+{
+	if ((options->samplingMethod != NULL) && (samplingMethodFromString(options->samplingMethod, &arguments->samplingMethod) != kCommonConstantReturnTypeSuccess))
+	{
+		fprintf(stderr, "Error: Unknown sampling method \"%s\".\n", options->samplingMethod);
+		printUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (options->randomSeed != NULL)
+	{
+		int	randomSeed;
+
+		if (parseIntAtLeast(options->randomSeed, 0, &randomSeed) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The random seed must be a non-negative integer.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->randomSeed = (uint64_t) randomSeed;
+	}
+
+	if ((options->calibrationSampling != NULL) && (calibrationSamplingFromString(options->calibrationSampling, &arguments->calibrationSampling) != kCommonConstantReturnTypeSuccess))
+	{
+		fprintf(stderr, "Error: Unknown calibration sampling \"%s\".\n", options->calibrationSampling);
+		printUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((options->inputCorrelation != NULL) && (inputCorrelationFromString(options->inputCorrelation, &arguments->inputCorrelation) != kCommonConstantReturnTypeSuccess))
+	{
+		fprintf(stderr, "Error: Unknown input correlation \"%s\".\n", options->inputCorrelation);
+		printUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((options->analysisMode != NULL) && (parseAnalysisMode(options->analysisMode, &arguments->analysisMode) != kCommonConstantReturnTypeSuccess))
+	{
+		fprintf(stderr, "Error: Unknown analysis \"%s\".\n", options->analysisMode);
+		printUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	Sobol indices assume independent inputs, so the calibration parameters are drawn
+	 *	independently unless `-k fixed` leaves them out of the analysis.
+	 */
+	if ((arguments->analysisMode == kAnalysisModeSensitivity) && (options->calibrationSampling == NULL))
+	{
+		arguments->calibrationSampling = kCalibrationSamplingIndependent;
+	}
+
+	if ((options->outputEvent != NULL) && (outputEventFromString(options->outputEvent, &arguments->outputEvent) != kCommonConstantReturnTypeSuccess))
+	{
+		fprintf(stderr, "Error: The event must be '<', '<=', '>', or '>=' followed by a real number, e.g., '>=100'.\n");
+		printUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (options->momentOrder != NULL)
+	{
+		int	momentOrder;
+
+		if ((parseIntAtLeast(options->momentOrder, 2, &momentOrder) != kCommonConstantReturnTypeSuccess) || (momentOrder > kMomentsConstantMaxOrder))
+		{
+			fprintf(stderr, "Error: The moment order must be an integer from 2 to %d.\n", kMomentsConstantMaxOrder);
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->momentOrder = momentOrder;
+	}
+
+	if ((options->densityGrid != NULL) && (parseDensityGrid(options->densityGrid, &arguments->densityGrid) != kCommonConstantReturnTypeSuccess))
+	{
+		fprintf(stderr, "Error: The density grid must be a positive number of points, optionally preceded by 'lower:upper:' with lower < upper.\n");
+		printUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (options->polynomialChaosDegree != NULL)
+	{
+		int	polynomialChaosDegree;
+
+		if ((parseIntAtLeast(options->polynomialChaosDegree, 1, &polynomialChaosDegree) != kCommonConstantReturnTypeSuccess) || (polynomialChaosDegree > kPolynomialChaosConstantMaxDegree))
+		{
+			fprintf(stderr, "Error: The degree of the polynomial chaos expansion must be an integer from 1 to %d.\n", kPolynomialChaosConstantMaxDegree);
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->polynomialChaosDegree = polynomialChaosDegree;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Parse the options of how native Monte Carlo iterations run: control variate, adaptive
+ *		stopping, checkpoints, shards, and the storage and output of the samples.
+ *
+ *	@param	options		: Pointer to the arguments of the options.
+ *	@param	arguments	: Pointer to the command-line arguments struct.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseRunOptions(const OptionArguments *  options, CommandLineArguments *  arguments)
+{
+	int	value;
+
+	if (options->adaptiveTolerance != NULL)
+	{
+		float	tolerance;
+
+		if ((parseFloatChecked(options->adaptiveTolerance, &tolerance) != kCommonConstantReturnTypeSuccess) || !(tolerance > 0.0f))
+		{
+			fprintf(stderr, "Error: The adaptive Monte Carlo tolerance must be a positive real number.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->adaptiveStoppingCriterion.tolerance = tolerance;
+		arguments->isAdaptiveMode = true;
+	}
+
+	if (options->adaptiveBatchSize != NULL)
+	{
+		if (parseIntAtLeast(options->adaptiveBatchSize, 2, &value) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The adaptive Monte Carlo batch size must be an integer greater than 1.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->adaptiveBatchSize = value;
+	}
+
+	if ((options->adaptiveStatistics != NULL) && (parseAdaptiveStatistics(options->adaptiveStatistics, &arguments->adaptiveStoppingCriterion) != kCommonConstantReturnTypeSuccess))
+	{
+		printUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (options->checkpointPath != NULL)
+	{
+		if (copyPathArgument(options->checkpointPath, arguments->checkpointPath, "checkpoint path") != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->useCheckpoint = true;
+	}
 
-		if (arguments->common.isMonteCarloMode)
+	if (options->checkpointInterval != NULL)
+	{
+		if (parseIntAtLeast(options->checkpointInterval, 1, &value) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The checkpoint interval must be a positive integer.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->checkpointInterval = value;
+	}
+
+	if (options->shard != NULL)
+	{
+		if (parseShard(options->shard, &arguments->shardIndex, &arguments->numberOfShards) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The shard must be '<index>/<number of shards>' with 0 <= index < number of shards.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->shardMode = kShardModeRun;
+	}
+
+	if (options->merge != NULL)
+	{
+		if (parseIntAtLeast(options->merge, 1, &value) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The number of shards to merge must be a positive integer.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->numberOfShards = value;
+		arguments->shardMode = kShardModeMerge;
+	}
+
+	if ((options->partialResultPrefix != NULL) &&
+		(copyPathArgument(options->partialResultPrefix, arguments->partialResultPrefix, "partial-result prefix") != kCommonConstantReturnTypeSuccess))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((options->sampleStore != NULL) && (sampleStoreBackendFromString(options->sampleStore, &arguments->sampleStoreBackend) != kCommonConstantReturnTypeSuccess))
+	{
+		fprintf(stderr, "Error: Unknown sample store \"%s\".\n", options->sampleStore);
+		printUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((options->sampleStorePath != NULL) &&
+		(copyPathArgument(options->sampleStorePath, arguments->sampleStorePath, "sample file path") != kCommonConstantReturnTypeSuccess))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (options->maxOutputSamples != NULL)
+	{
+		if (parseIntAtLeast(options->maxOutputSamples, 1, &value) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The maximum number of output samples must be a positive integer.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->maxOutputSamples = value;
+	}
+
+	if ((options->samplePrecision != NULL) && (samplePrecisionFromString(options->samplePrecision, &arguments->samplePrecision) != kCommonConstantReturnTypeSuccess))
+	{
+		fprintf(stderr, "Error: Unknown sample precision \"%s\".\n", options->samplePrecision);
+		printUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Reject the combinations of options that the application does not support.
+ *
+ *	@param	options		: Pointer to the arguments of the options.
+ *	@param	arguments	: Pointer to the parsed command-line arguments struct.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if all combinations are supported, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+checkOptionCompatibility(const OptionArguments *  options, const CommandLineArguments *  arguments)
+{
+	bool			isMonteCarloMode = arguments->common.isMonteCarloMode;
+	bool			hasAnalysis = (arguments->analysisMode != kAnalysisModeNone);
+	bool			isGridEnabled = arguments->responseGrid.isEnabled;
+	OptionConstraint	constraints[] = {
+		{
+			isGridEnabled && (isMonteCarloMode || arguments->common.isBenchmarkingMode),
+			"The response-surface grid (`-g`) evaluates every grid point once and does not run in Monte Carlo mode (`-M`) or benchmarking mode (`-b`).",
+		},
+		{
+			((options->gridFormat != NULL) || (options->gridDevices != NULL)) && !isGridEnabled,
+			"Options `-f` and `-y` apply only to the response-surface grid (`-g`).",
+		},
+		{
+			isGridEnabled && arguments->useInputADCFiles,
+			"The response-surface grid (`-g`) takes its raw ADC values from `-t`, `-p`, and `-u`, not from ADC trace files (`-m`).",
+		},
+		{
+			(options->samplingMethod != NULL) && !isMonteCarloMode,
+			"Sampling methods apply only in native Monte Carlo mode (`-M`).",
+		},
+		{
+			(options->calibrationSampling != NULL) && !isMonteCarloMode,
+			"Calibration sampling applies only in native Monte Carlo mode (`-M`).",
+		},
+		{
+			hasAnalysis && !isMonteCarloMode,
+			"Analyses apply only in native Monte Carlo mode (`-M`).",
+		},
+		{
+			(arguments->analysisMode == kAnalysisModeSensitivity) && (arguments->calibrationSampling == kCalibrationSamplingJoint),
+			"Sensitivity analysis needs independent inputs and does not support `-k joint`.",
+		},
+		{
+			(arguments->analysisMode == kAnalysisModeImportance) != (options->outputEvent != NULL),
+			"Importance-sampling analysis (`-A importance`) requires an event (`-E`), and events apply only to it.",
+		},
+		/*
+		 *	Independent calibration sampling would make every calibration parameter another
+		 *	input of the polynomials, whose moments cannot be carried through exactly.
+		 */
+		{
+			(arguments->analysisMode == kAnalysisModeMoments) && (arguments->calibrationSampling == kCalibrationSamplingIndependent),
+			"Moment propagation (`-A moments`) supports `-k fixed` and `-k joint` only.",
+		},
+		{
+			(options->momentOrder != NULL) && (arguments->analysisMode != kAnalysisModeMoments),
+			"Option `-N` applies only to moment propagation (`-A moments`).",
+		},
+		{
+			(arguments->analysisMode == kAnalysisModeDensity) && (arguments->common.outputSelect != kOutputDistributionIndexForTemperature),
+			"The exact density (`-A density`) applies only to the temperature output (`-S 0`).",
+		},
+		{
+			((options->densityGrid != NULL) || arguments->densityGrid.isHistogram) && (arguments->analysisMode != kAnalysisModeDensity),
+			"Options `-Z` and `-e` apply only to the exact density (`-A density`).",
+		},
+		{
+			(options->polynomialChaosDegree != NULL) && (arguments->analysisMode != kAnalysisModePolynomialChaos),
+			"Option `-d` applies only to the polynomial chaos expansion (`-A pce`).",
+		},
+		{
+			(arguments->inputCorrelation != kInputCorrelationIndependent) && (!isMonteCarloMode || !arguments->useInputADCFiles),
+			"Correlated inputs require native Monte Carlo mode (`-M`) and ADC trace files (`-m`).",
+		},
+		{
+			(arguments->inputCorrelation != kInputCorrelationIndependent) && hasAnalysis,
+			"Analyses (`-A`) need independent inputs and do not support `-x`.",
+		},
+		{
+			hasAnalysis && (arguments->useControlVariate || arguments->isAdaptiveMode),
+			"The control variate (`-C`) and adaptive Monte Carlo (`-a`) do not apply to analyses (`-A`).",
+		},
+		{
+			arguments->useControlVariate && !isMonteCarloMode,
+			"The control variate applies only in native Monte Carlo mode (`-M`).",
+		},
+		/*
+		 *	The mean of the control variate is in closed form only for fixed calibration parameters.
+		 */
+		{
+			arguments->useControlVariate && (arguments->calibrationSampling != kCalibrationSamplingFixed),
+			"The control variate (`-C`) requires fixed calibration parameters.",
+		},
+		{
+			arguments->isAdaptiveMode && !isMonteCarloMode,
+			"Adaptive Monte Carlo requires native Monte Carlo mode (`-M`).",
+		},
+		{
+			((options->adaptiveBatchSize != NULL) || (options->adaptiveStatistics != NULL)) && !arguments->isAdaptiveMode,
+			"Options `-B` and `-q` require adaptive Monte Carlo (`-a`).",
+		},
+		{
+			arguments->useCheckpoint && (!isMonteCarloMode || hasAnalysis),
+			"Checkpoints apply only to native Monte Carlo iterations (`-M` without `-A`).",
+		},
+		{
+			(arguments->resumeFromCheckpoint || arguments->extendCheckpoint || (options->checkpointInterval != NULL)) && !arguments->useCheckpoint,
+			"Options `-I`, `-R`, and `-X` require a checkpoint file (`-K`).",
+		},
+		{
+			(options->shard != NULL) && (options->merge != NULL),
+			"Options `-P` and `-G` are mutually exclusive.",
+		},
+		{
+			(arguments->shardMode != kShardModeNone) && (!isMonteCarloMode || hasAnalysis || arguments->isAdaptiveMode || arguments->useCheckpoint),
+			"Shards apply only to native Monte Carlo iterations (`-M`) without analyses (`-A`), adaptive Monte Carlo (`-a`), or checkpoints (`-K`).",
+		},
+		{
+			(arguments->shardMode == kShardModeNone) && ((options->partialResultPrefix != NULL) || arguments->savePartialSamples),
+			"Options `-O` and `-W` require `-P` or `-G`.",
+		},
+		{
+			(options->sampleStore != NULL) && (!isMonteCarloMode || hasAnalysis),
+			"Sample stores apply only to native Monte Carlo iterations (`-M` without `-A`).",
+		},
 		{
-			if (strstr(temperatureArg, kConstantStringUx) != NULL)
-			{
-				fprintf(stderr, "Error: Native Monte Carlo is not compatible with Ux strings from command line.\n");
-
-				return kCommonConstantReturnTypeError;
-			}
-		}
-
-		if (ret != kCommonConstantReturnTypeSuccess)
+			(options->sampleStorePath != NULL) && (arguments->sampleStoreBackend != kSampleStoreBackendFile),
+			"Option `-F` requires `-D file`.",
+		},
 		{
-			arguments->temperatureRawADCValue = NAN;
-			fprintf(stderr, "Error: The temperature raw ADC value must be a real number. Setting it to NAN.\n");
-			printUsage();
-
-			return kCommonConstantReturnTypeError;
-		}
-
-		arguments->isInputSetFromCommandLine[kInputDistributionIndexForTemperatureRawADCValue] = true;
-	}
-
-	if (pressureArg != NULL)
-	{
-		int ret = parseFloatChecked(pressureArg, &arguments->pressureRawADCValue);
-
-		if (arguments->common.isMonteCarloMode)
+			(options->maxOutputSamples != NULL) && (!isMonteCarloMode || hasAnalysis),
+			"Option `-L` applies only to native Monte Carlo iterations (`-M` without `-A`).",
+		},
 		{
-			if (strstr(pressureArg, kConstantStringUx) != NULL)
-			{
-				fprintf(stderr, "Error: Native Monte Carlo is not compatible with Ux strings from command line.\n");
-
-				return kCommonConstantReturnTypeError;
-			}
-		}
+			(options->samplePrecision != NULL) && (!isMonteCarloMode || hasAnalysis || arguments->useCheckpoint || (arguments->shardMode != kShardModeNone)),
+			"Option `-Q` applies only to native Monte Carlo iterations (`-M`) without analyses (`-A`), checkpoints (`-K`), or shards (`-P`, `-G`).",
+		},
+	};
 
-		if (ret != kCommonConstantReturnTypeSuccess)
+	for (size_t i = 0; i < sizeof(constraints) / sizeof(constraints[0]); i++)
+	{
+		if (constraints[i].isViolated)
 		{
-			arguments->pressureRawADCValue = NAN;
-			fprintf(stderr, "Error: The pressure raw ADC value must be a real number. Setting it to NAN.\n");
-			printUsage();
+			fprintf(stderr, "Error: %s\n", constraints[i].message);
 
 			return kCommonConstantReturnTypeError;
 		}
-
-		arguments->isInputSetFromCommandLine[kInputDistributionIndexForPressureRawADCValue] = true;
 	}
 
-	if (humidityArg != NULL)
-	{
-		int ret = parseFloatChecked(humidityArg, &arguments->humidityRawADCValue);
-
-		if (arguments->common.isMonteCarloMode)
-		{
-			if (strstr(humidityArg, kConstantStringUx) != NULL)
-			{
-				fprintf(stderr, "Error: Native Monte Carlo is not compatible with Ux strings from command line.\n");
-
-				return kCommonConstantReturnTypeError;
-			}
-		}
-
-		if (ret != kCommonConstantReturnTypeSuccess)
-		{
-			arguments->humidityRawADCValue = NAN;
-			fprintf(stderr, "Error: The humidity raw ADC value must be a real number. Setting it to NAN.\n");
-			printUsage();
-
-			return kCommonConstantReturnTypeError;
-		}
+	return kCommonConstantReturnTypeSuccess;
+}
 
-		arguments->isInputSetFromCommandLine[kInputDistributionIndexForHumidityRawADCValue] = true;
-	}
+CommonConstantReturnType
+getCommandLineArguments(int argc, char *  argv[], CommandLineArguments *  arguments)
+{
+	OptionArguments	optionArguments = {0};
 
-	if (calibrationConstantsPathPrefix != NULL)
+	if (arguments == NULL)
 	{
-		int ret = snprintf(arguments->calibrationConstantsPathPrefix, kCommonConstantMaxCharsPerFilepath, "%s", calibrationConstantsPathPrefix);
+		fprintf(stderr, "Error: Source command-line arguments are NULL.\n");
 
-		if ((ret < 0) || (ret >= kCommonConstantMaxCharsPerFilepath))
-		{
-			fprintf(stderr, "Error: Could not copy calibration constants path prefix from command-line arguments.\n");
-			printUsage();
-			return kCommonConstantReturnTypeError;
-		}
+		return kCommonConstantReturnTypeError;
 	}
 
-	if (measurementsPathPrefix != NULL)
+	if (setDefaultCommandLineArguments(arguments) != kCommonConstantReturnTypeSuccess)
 	{
-		int ret = snprintf(arguments->measurementsPathPrefix, kCommonConstantMaxCharsPerFilepath, "%s", measurementsPathPrefix);
+		return kCommonConstantReturnTypeError;
+	}
 
-		if ((ret < 0) || (ret >= kCommonConstantMaxCharsPerFilepath))
-		{
-			fprintf(stderr, "Error: Could not copy measurements path prefix from command-line arguments.\n");
-			printUsage();
+	/*
+	 *	Specify application-specific command-line arguments.
+	 */
+	DemoOption	options[] = {
+		{ .opt = "m", .optAlternative = "measurements-prefix",			.hasArg = true,	.foundArg = &optionArguments.measurementsPathPrefix,		.foundOpt = NULL },
+		{ .opt = "c", .optAlternative = "calibration-constants-prefix",		.hasArg = true,	.foundArg = &optionArguments.calibrationConstantsPathPrefix,	.foundOpt = NULL },
+		{ .opt = "n", .optAlternative = "calibration-parameter-index",		.hasArg = true,	.foundArg = &optionArguments.indexForCalibrationParameters,	.foundOpt = NULL },
+		{ .opt = "t", .optAlternative = "override-temperature-measurement",	.hasArg = true,	.foundArg = &optionArguments.temperature,			.foundOpt = NULL },
+		{ .opt = "p", .optAlternative = "override-pressure-measurement",	.hasArg = true,	.foundArg = &optionArguments.pressure,				.foundOpt = NULL },
+		{ .opt = "u", .optAlternative = "override-humidity-measurement",	.hasArg = true,	.foundArg = &optionArguments.humidity,				.foundOpt = NULL },
+		{ .opt = "g", .optAlternative = "grid",					.hasArg = true,	.foundArg = &optionArguments.gridPath,				.foundOpt = NULL },
+		{ .opt = "f", .optAlternative = "grid-format",				.hasArg = true,	.foundArg = &optionArguments.gridFormat,			.foundOpt = NULL },
+		{ .opt = "y", .optAlternative = "grid-devices",				.hasArg = true,	.foundArg = &optionArguments.gridDevices,			.foundOpt = NULL },
+		{ .opt = "s", .optAlternative = "sampling-method",			.hasArg = true,	.foundArg = &optionArguments.samplingMethod,			.foundOpt = NULL },
+		{ .opt = "r", .optAlternative = "random-seed",				.hasArg = true,	.foundArg = &optionArguments.randomSeed,			.foundOpt = NULL },
+		{ .opt = "k", .optAlternative = "calibration-sampling",			.hasArg = true,	.foundArg = &optionArguments.calibrationSampling,		.foundOpt = NULL },
+		{ .opt = "x", .optAlternative = "input-correlation",			.hasArg = true,	.foundArg = &optionArguments.inputCorrelation,			.foundOpt = NULL },
+		{ .opt = "A", .optAlternative = "analysis",				.hasArg = true,	.foundArg = &optionArguments.analysisMode,			.foundOpt = NULL },
+		{ .opt = "E", .optAlternative = "event",				.hasArg = true,	.foundArg = &optionArguments.outputEvent,			.foundOpt = NULL },
+		{ .opt = "N", .optAlternative = "moment-order",				.hasArg = true,	.foundArg = &optionArguments.momentOrder,			.foundOpt = NULL },
+		{ .opt = "Z", .optAlternative = "density-grid",				.hasArg = true,	.foundArg = &optionArguments.densityGrid,			.foundOpt = NULL },
+		{ .opt = "e", .optAlternative = "density-histogram",			.hasArg = false,	.foundArg = NULL,					.foundOpt = &arguments->densityGrid.isHistogram },
+		{ .opt = "d", .optAlternative = "pce-degree",				.hasArg = true,	.foundArg = &optionArguments.polynomialChaosDegree,		.foundOpt = NULL },
+		{ .opt = "K", .optAlternative = "checkpoint",				.hasArg = true,	.foundArg = &optionArguments.checkpointPath,			.foundOpt = NULL },
+		{ .opt = "I", .optAlternative = "checkpoint-interval",			.hasArg = true,	.foundArg = &optionArguments.checkpointInterval,		.foundOpt = NULL },
+		{ .opt = "R", .optAlternative = "resume",				.hasArg = false,	.foundArg = NULL,					.foundOpt = &arguments->resumeFromCheckpoint },
+		{ .opt = "X", .optAlternative = "extend",				.hasArg = false,	.foundArg = NULL,					.foundOpt = &arguments->extendCheckpoint },
+		{ .opt = "P", .optAlternative = "shard",				.hasArg = true,	.foundArg = &optionArguments.shard,				.foundOpt = NULL },
+		{ .opt = "G", .optAlternative = "merge",				.hasArg = true,	.foundArg = &optionArguments.merge,				.foundOpt = NULL },
+		{ .opt = "O", .optAlternative = "partial-result-prefix",		.hasArg = true,	.foundArg = &optionArguments.partialResultPrefix,		.foundOpt = NULL },
+		{ .opt = "W", .optAlternative = "partial-samples",			.hasArg = false,	.foundArg = NULL,					.foundOpt = &arguments->savePartialSamples },
+		{ .opt = "D", .optAlternative = "sample-store",				.hasArg = true,	.foundArg = &optionArguments.sampleStore,			.foundOpt = NULL },
+		{ .opt = "F", .optAlternative = "sample-store-path",			.hasArg = true,	.foundArg = &optionArguments.sampleStorePath,			.foundOpt = NULL },
+		{ .opt = "L", .optAlternative = "max-output-samples",			.hasArg = true,	.foundArg = &optionArguments.maxOutputSamples,			.foundOpt = NULL },
+		{ .opt = "Q", .optAlternative = "sample-precision",			.hasArg = true,	.foundArg = &optionArguments.samplePrecision,			.foundOpt = NULL },
+		{ .opt = "C", .optAlternative = "control-variate",			.hasArg = false,	.foundArg = NULL,					.foundOpt = &arguments->useControlVariate },
+		{ .opt = "a", .optAlternative = "adaptive-tolerance",			.hasArg = true,	.foundArg = &optionArguments.adaptiveTolerance,			.foundOpt = NULL },
+		{ .opt = "B", .optAlternative = "adaptive-batch-size",			.hasArg = true,	.foundArg = &optionArguments.adaptiveBatchSize,			.foundOpt = NULL },
+		{ .opt = "q", .optAlternative = "adaptive-statistics",			.hasArg = true,	.foundArg = &optionArguments.adaptiveStatistics,		.foundOpt = NULL },
+		{0},
+	};
 
-			return kCommonConstantReturnTypeError;
-		}
+	if (parseArgs(argc, argv, &arguments->common, options) != kCommonConstantReturnTypeSuccess)
+	{
+		fprintf(stderr, "Parsing command line arguments failed\n");
+		printUsage();
 
-		arguments->useInputADCFiles = true;
+		return kCommonConstantReturnTypeError;
 	}
 
-	if (indexForCalibrationParametersArg != NULL)
+	/*
+	 *	Process command-line arguments: first each option on its own, then their combinations.
+	 */
+	if ((processCommonOptions(arguments) != kCommonConstantReturnTypeSuccess) ||
+		(parseInputOptions(&optionArguments, arguments) != kCommonConstantReturnTypeSuccess) ||
+		(parseSamplingAndAnalysisOptions(&optionArguments, arguments) != kCommonConstantReturnTypeSuccess) ||
+		(parseRunOptions(&optionArguments, arguments) != kCommonConstantReturnTypeSuccess) ||
+		(checkOptionCompatibility(&optionArguments, arguments) != kCommonConstantReturnTypeSuccess))
 	{
-		int indexForCalibrationParameters;
-		int ret = parseIntChecked(indexForCalibrationParametersArg, &indexForCalibrationParameters);
-
-		if (ret != kCommonConstantReturnTypeSuccess)
-		{
-			fprintf(stderr, "Error: The calibration parameter must be an integer.\n");
-			printUsage();
+		return kCommonConstantReturnTypeError;
+	}
 
-			return kCommonConstantReturnTypeError;
-		}
+	/*
+	 *	Shards may run side by side on one machine, so every shard maps its own sample file.
+	 */
+	if ((arguments->shardMode == kShardModeRun) && (arguments->sampleStoreBackend == kSampleStoreBackendFile))
+	{
+		char	sampleStorePath[kCommonConstantMaxCharsPerFilepath];
+		int	ret = snprintf(sampleStorePath, kCommonConstantMaxCharsPerFilepath, "%s.%zu-of-%zu", arguments->sampleStorePath, arguments->shardIndex, arguments->numberOfShards);
 
-		if ((indexForCalibrationParameters < 0) || (indexForCalibrationParameters > 4))
+		if ((ret < 0) || (ret >= kCommonConstantMaxCharsPerFilepath))
 		{
-			fprintf(stderr, "Error: Illegal argument %d for option -n. Should be an integer in [0, 4].\n", indexForCalibrationParameters);
-			printUsage();
+			fprintf(stderr, "Error: The sample file path of shard %zu is too long.\n", arguments->shardIndex);
 
 			return kCommonConstantReturnTypeError;
 		}
 
-		arguments->indexForCalibrationParameters = indexForCalibrationParameters;
+		memcpy(arguments->sampleStorePath, sampleStorePath, sizeof(sampleStorePath));
 	}
 
 	return kCommonConstantReturnTypeSuccess;
@@ -478,6 +1535,288 @@ loadInputs(
 	return kCommonConstantReturnTypeSuccess;
 }
 
+CommonConstantReturnType
+loadInputDistributions(
+	CommandLineArguments *	arguments,
+	const float *		loadedInputVariables,
+	InputDistribution *	inputDistributions)
+{
+	const char *	adcTraceNames[kInputDistributionIndexMax] =
+			{
+				"temperature",
+				"pressure",
+				"humidity",
+			};
+	const double	lowerBounds[kInputDistributionIndexMax] =
+			{
+				kBME680ConstantsTemperatureRawADCValueLowerBound,
+				kBME680ConstantsPressureRawADCValueLowerBound,
+				kBME680ConstantsHumidityRawADCValueLowerBound,
+			};
+	const double	upperBounds[kInputDistributionIndexMax] =
+			{
+				kBME680ConstantsTemperatureRawADCValueUpperBound,
+				kBME680ConstantsPressureRawADCValueUpperBound,
+				kBME680ConstantshumidityRawADCValueUpperBound,
+			};
+	char		filename[kCommonConstantMaxCharsPerFilepath];
+
+	for (InputDistributionIndex i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		if (arguments->useInputADCFiles)
+		{
+			float *		samples = NULL;
+			size_t		numberOfSamples = 0;
+			int		ret = snprintf(filename, kCommonConstantMaxCharsPerFilepath, "%s-%s-adc-trace.csv", arguments->measurementsPathPrefix, adcTraceNames[i]);
+
+			if ((ret < 1) || (ret >= kCommonConstantMaxCharsPerFilepath))
+			{
+				fprintf(stderr, "Failed to create filename for loading from %s-%s-adc-trace.csv", arguments->measurementsPathPrefix, adcTraceNames[i]);
+
+				return kCommonConstantReturnTypeError;
+			}
+
+			if (loadFloatSamplesFromPath(filename, &samples, &numberOfSamples) != kCommonConstantReturnTypeSuccess)
+			{
+				return kCommonConstantReturnTypeError;
+			}
+
+			ret = inputDistributionInitEmpirical(&inputDistributions[i], samples, numberOfSamples);
+			free(samples);
+
+			if (ret != kCommonConstantReturnTypeSuccess)
+			{
+				return kCommonConstantReturnTypeError;
+			}
+		}
+		else if (arguments->inputUxStrings[i] != NULL)
+		{
+			if (inputDistributionInitFromUxString(&inputDistributions[i], arguments->inputUxStrings[i]) != kCommonConstantReturnTypeSuccess)
+			{
+				return kCommonConstantReturnTypeError;
+			}
+		}
+		else if (arguments->isInputSetFromCommandLine[i])
+		{
+			inputDistributionInitConstant(&inputDistributions[i], loadedInputVariables[i]);
+		}
+		else
+		{
+			inputDistributionInitUniform(&inputDistributions[i], lowerBounds[i], upperBounds[i]);
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+loadCalibrationTable(CommandLineArguments *  arguments, CalibrationTable *  calibrationTable)
+{
+	const char	parameterKinds[] = {'t', 'p', 'h'};
+	const int	numberOfParametersOfKind[] =
+			{
+				kBME680ConstantsNumberOfTemperatureParameters,
+				kBME680ConstantsNumberOfPressureParameters,
+				kBME680ConstantsNumberOfHumidityParameters,
+			};
+	float *		columns[kBME680ConstantsNumberOfCalibrationParameters] = {NULL};
+	size_t		numberOfDevices = 0;
+	size_t		column = 0;
+	char		filename[kCommonConstantMaxCharsPerFilepath];
+	int		ret = kCommonConstantReturnTypeSuccess;
+
+	/*
+	 *	Read every parameter file once, then transpose the columns into device rows.
+	 */
+	for (size_t kind = 0; (kind < sizeof(parameterKinds)) && (ret == kCommonConstantReturnTypeSuccess); kind++)
+	{
+		for (int i = 0; i < numberOfParametersOfKind[kind]; i++, column++)
+		{
+			size_t	numberOfValues;
+			int	length = snprintf(filename, kCommonConstantMaxCharsPerFilepath, "%s-%c%d.csv", arguments->calibrationConstantsPathPrefix, parameterKinds[kind], i + 1);
+
+			if ((length < 1) || (length >= kCommonConstantMaxCharsPerFilepath))
+			{
+				fprintf(stderr, "Failed to create filename for loading from %s-%c%d.csv", arguments->calibrationConstantsPathPrefix, parameterKinds[kind], i + 1);
+				ret = kCommonConstantReturnTypeError;
+
+				break;
+			}
+
+			if (loadFloatSamplesFromPath(filename, &columns[column], &numberOfValues) != kCommonConstantReturnTypeSuccess)
+			{
+				ret = kCommonConstantReturnTypeError;
+
+				break;
+			}
+
+			if ((column > 0) && (numberOfValues != numberOfDevices))
+			{
+				fprintf(stderr, "Error: \"%s\" has %zu devices, but previous calibration files have %zu.\n", filename, numberOfValues, numberOfDevices);
+				ret = kCommonConstantReturnTypeError;
+
+				break;
+			}
+
+			numberOfDevices = numberOfValues;
+		}
+	}
+
+	if (ret == kCommonConstantReturnTypeSuccess)
+	{
+		calibrationTableInit(calibrationTable, numberOfDevices, kBME680ConstantsNumberOfCalibrationParameters);
+
+		for (size_t device = 0; device < numberOfDevices; device++)
+		{
+			for (size_t i = 0; i < kBME680ConstantsNumberOfCalibrationParameters; i++)
+			{
+				calibrationTable->rows[device * kBME680ConstantsNumberOfCalibrationParameters + i] = columns[i][device];
+			}
+		}
+	}
+
+	for (size_t i = 0; i < kBME680ConstantsNumberOfCalibrationParameters; i++)
+	{
+		free(columns[i]);
+	}
+
+	return ret;
+}
+
+CommonConstantReturnType
+loadCorrelatedSampler(CommandLineArguments *  arguments, CorrelatedSampler *  correlatedSampler)
+{
+	const char *	adcTraceNames[kInputDistributionIndexMax] =
+			{
+				"temperature",
+				"pressure",
+				"humidity",
+			};
+	float *		traces[kInputDistributionIndexMax] = {NULL};
+	size_t		traceLength = 0;
+	char		filename[kCommonConstantMaxCharsPerFilepath];
+	int		ret = kCommonConstantReturnTypeSuccess;
+
+	for (InputDistributionIndex i = 0; (i < kInputDistributionIndexMax) && (ret == kCommonConstantReturnTypeSuccess); i++)
+	{
+		size_t	numberOfSamples;
+		int	length = snprintf(filename, kCommonConstantMaxCharsPerFilepath, "%s-%s-adc-trace.csv", arguments->measurementsPathPrefix, adcTraceNames[i]);
+
+		if ((length < 1) || (length >= kCommonConstantMaxCharsPerFilepath))
+		{
+			fprintf(stderr, "Failed to create filename for loading from %s-%s-adc-trace.csv", arguments->measurementsPathPrefix, adcTraceNames[i]);
+			ret = kCommonConstantReturnTypeError;
+
+			break;
+		}
+
+		if (loadFloatSamplesFromPath(filename, &traces[i], &numberOfSamples) != kCommonConstantReturnTypeSuccess)
+		{
+			ret = kCommonConstantReturnTypeError;
+
+			break;
+		}
+
+		/*
+		 *	Correlations pair up the entries of the traces, so the traces must be aligned in time.
+		 */
+		if ((i > 0) && (numberOfSamples != traceLength))
+		{
+			fprintf(stderr, "Error: \"%s\" has %zu samples, but the other ADC traces have %zu.\n", filename, numberOfSamples, traceLength);
+			ret = kCommonConstantReturnTypeError;
+
+			break;
+		}
+
+		traceLength = numberOfSamples;
+	}
+
+	if (ret == kCommonConstantReturnTypeSuccess)
+	{
+		ret = correlatedSamplerInit(
+			correlatedSampler,
+			arguments->inputCorrelation,
+			(const float * const *) traces,
+			traceLength,
+			kInputDistributionIndexMax);
+	}
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		free(traces[i]);
+	}
+
+	return ret;
+}
+
+CommonConstantReturnType
+loadFloatSamplesFromPath(const char *  filename, float **  samples, size_t *  numberOfSamples)
+{
+	FILE *		fp;
+	char		line[kUtilitiesConstantMaxCharsPerCSVLine];
+	size_t		capacity = 64;
+	size_t		count = 0;
+	float *		values;
+
+	fp = fopen(filename, "r");
+	if (fp == NULL)
+	{
+		fprintf(stderr, "Error opening input file \"%s\".\n", filename);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	values = (float *) checkedMalloc(capacity * sizeof(float), __FILE__, __LINE__);
+
+	while (fgets(line, sizeof(line), fp) != NULL)
+	{
+		char *	end;
+		float	value = strtof(line, &end);
+
+		/*
+		 *	Skip lines without a number, such as the header of the ADC trace files.
+		 */
+		if (end == line)
+		{
+			continue;
+		}
+
+		if (count == capacity)
+		{
+			float *	grown;
+
+			capacity *= 2;
+			grown = (float *) realloc(values, capacity * sizeof(float));
+			if (grown == NULL)
+			{
+				fprintf(stderr, "Error: Could not allocate memory for the samples of \"%s\".\n", filename);
+				free(values);
+				fclose(fp);
+
+				return kCommonConstantReturnTypeError;
+			}
+			values = grown;
+		}
+
+		values[count++] = value;
+	}
+
+	fclose(fp);
+
+	if (count == 0)
+	{
+		fprintf(stderr, "Error: No samples in input file \"%s\".\n", filename);
+		free(values);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	*samples = values;
+	*numberOfSamples = count;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
 CommonConstantReturnType
 loadNthFloatFromPath(const char *  filename, uint64_t chosenRowNumber, float *  returnValuePtr)
 {
@@ -566,6 +1905,7 @@ determineIndexRangeOfSelectedOutputs(
  *	@param	outputVariables			: The output variables.
  *	@param	outputVariableDescriptions	: Descriptions of output variables from which the array of `JSONVariable` structs will take their descriptions.
  *	@param	monteCarloOutputSamples		: Monte Carlo output samples that will populate `JSONVariable` struct values if in Monte Carlo mode.
+ *	@param	numberOfMonteCarloOutputSamples	: Number of Monte Carlo output samples (1 if not in Monte Carlo mode).
  */
 void
 populateAndPrintJSONVariables(
@@ -573,7 +1913,8 @@ populateAndPrintJSONVariables(
 	CommandLineArguments *	arguments,
 	float *			outputVariables,
 	const char *		outputVariableDescriptions[kOutputDistributionIndexMax],
-	float			monteCarloOutputSamples[])
+	float			monteCarloOutputSamples[],
+	size_t			numberOfMonteCarloOutputSamples)
 {
 	OutputDistributionIndex	outputSelectLowerBound;
 	OutputDistributionIndex	outputSelectUpperBound;
@@ -587,9 +1928,9 @@ populateAndPrintJSONVariables(
 	{
 		/*
 		 *	If in Monte Carlo mode, `pointerToOutputVariable` points to the beginning of the `monteCarloOutputSamples` array.
-		 *	In this case, `arguments.common.numberOfMonteCarloIterations` is the length of the `monteCarloOutputSamples` array.
+		 *	In this case, `numberOfMonteCarloOutputSamples` is the length of the `monteCarloOutputSamples` array.
 		 *	Else, it points to the entry of the `outputVariables` to be used.
-		 *	In this case, `arguments.common.numberOfMonteCarloIterations` equals 1.
+		 *	In this case, `numberOfMonteCarloOutputSamples` equals 1.
 		 */
 		float *  pointerToOutputVariable = arguments->common.isMonteCarloMode ? monteCarloOutputSamples : &outputVariables[outputSelect];
 
@@ -598,7 +1939,7 @@ populateAndPrintJSONVariables(
 			pointerToOutputVariable,
 			outputVariableDescriptions[outputSelect],
 			outputSelect,
-			arguments->common.numberOfMonteCarloIterations);
+			numberOfMonteCarloOutputSamples);
 	}
 
 	printJSONVariables(
@@ -617,6 +1958,7 @@ populateAndPrintJSONVariables(
  *	@param	outputNames			: Names of the output variables to print.
  *	@param	outputVariableDescriptions	: Descriptions of output variables to print.
  *	@param	monteCarloOutputSamples		: Monte Carlo output samples that will populate JSON struct values if in Monte Carlo mode.
+ *	@param	numberOfMonteCarloOutputSamples	: Number of Monte Carlo output samples (1 if not in Monte Carlo mode).
  */
 void
 printHumanConsumableOutput(
@@ -624,7 +1966,8 @@ printHumanConsumableOutput(
 	float *			outputVariables,
 	const char *		outputVariableNames[kOutputDistributionIndexMax],
 	const char *		outputVariableDescriptions[kOutputDistributionIndexMax],
-	float			monteCarloOutputSamples[])
+	float			monteCarloOutputSamples[],
+	size_t			numberOfMonteCarloOutputSamples)
 {
 	OutputDistributionIndex	outputSelectLowerBound;
 	OutputDistributionIndex	outputSelectUpperBound;
@@ -638,13 +1981,13 @@ printHumanConsumableOutput(
 	{
 		/*
 		 *	If in Monte Carlo mode, `pointerToOutputVariable` points to the beginning of the `monteCarloOutputSamples` array.
-		 *	In this case, `arguments.common.numberOfMonteCarloIterations` is the length of the `monteCarloOutputSamples` array.
+		 *	In this case, `numberOfMonteCarloOutputSamples` is the length of the `monteCarloOutputSamples` array.
 		 *	Else, it points to the entry of the `outputVariables` to be used.
-		 *	In this case, `arguments.common.numberOfMonteCarloIterations` equals 1.
+		 *	In this case, `numberOfMonteCarloOutputSamples` equals 1.
 		 */
 		float *  pointerToValueToPrint = arguments->common.isMonteCarloMode ? monteCarloOutputSamples : &outputVariables[outputSelect];
 
-		for (size_t i = 0; i < arguments->common.numberOfMonteCarloIterations; ++i)
+		for (size_t i = 0; i < numberOfMonteCarloOutputSamples; ++i)
 		{
 			printf("%s is %f.\n", outputVariableDescriptions[outputSelect], *pointerToValueToPrint);
 			pointerToValueToPrint++;
@@ -653,3 +1996,33 @@ printHumanConsumableOutput(
 
 	return;
 }
+
+CommonConstantReturnType
+saveMonteCarloCodesToDataDotOutFile(
+	const SampleQuantizer *	quantizer,
+	const uint16_t *	codes,
+	uint64_t		microseconds,
+	size_t			numberOfSamples)
+{
+	FILE *	file = fopen("data.out", "wb");
+	bool	isWritten;
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open \"data.out\" for writing: %s.\n", strerror(errno));
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	isWritten = (fwrite(&microseconds, sizeof(uint64_t), 1, file) == 1) &&
+			sampleQuantizerWriteCodes(quantizer, codes, numberOfSamples, file);
+
+	if ((fclose(file) != 0) || !isWritten)
+	{
+		fprintf(stderr, "Error: Could not write the sample codes to \"data.out\".\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
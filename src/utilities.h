@@ -26,12 +26,20 @@
 #include <stdbool.h>
 #include <inttypes.h>
 #include "common.h"
+#include "sampling.h"
+#include "estimators.h"
+#include "distributions.h"
+#include "calibration.h"
+#include "uxstring.h"
+#include "correlation.h"
+#include "samplestore.h"
 
 typedef enum
 {
 	kBME680ConstantsNumberOfTemperatureParameters		= 3,
 	kBME680ConstantsNumberOfPressureParameters		= 10,
 	kBME680ConstantsNumberOfHumidityParameters		= 7,
+	kBME680ConstantsNumberOfCalibrationParameters		= 20,
 	kBME680ConstantsTemperatureRawADCValueLowerBound	= 499072,
 	kBME680ConstantsTemperatureRawADCDefaultValue		= 499552,
 	kBME680ConstantsTemperatureRawADCValueUpperBound	= 500032,
@@ -43,6 +51,35 @@ typedef enum
 	kBME680ConstantshumidityRawADCValueUpperBound		= 19061,
 } BME680Constants;
 
+typedef enum
+{
+	kUtilitiesConstantMaxCharsPerCSVLine	= 256,
+} UtilitiesConstant;
+
+typedef enum
+{
+	kAnalysisModeNone			= 0,
+	kAnalysisModeSensitivity,
+	kAnalysisModeImportance,
+	kAnalysisModeDelta,
+	kAnalysisModeUnscented,
+	kAnalysisModeMoments,
+	kAnalysisModeDensity,
+	kAnalysisModeInterval,
+	kAnalysisModeGradient,
+	kAnalysisModeParticle,
+	kAnalysisModePolynomialChaos,
+	kAnalysisModeMax
+} AnalysisMode;
+
+typedef enum
+{
+	kShardModeNone				= 0,
+	kShardModeRun,
+	kShardModeMerge,
+	kShardModeMax
+} ShardMode;
+
 typedef enum
 {
 	kInputDistributionIndexForTemperatureRawADCValue	= 0,
@@ -59,6 +96,63 @@ typedef enum
 	kOutputDistributionIndexMax
 } OutputDistributionIndex;
 
+/*
+ *	Grid on which the density analysis prints the exact temperature distribution.
+ */
+typedef struct DensityGrid
+{
+	/*
+	 *	Span the support of the temperature unless a range is given.
+	 */
+	bool		hasRange;
+	double		lowerBound;
+	double		upperBound;
+	size_t		numberOfPoints;
+	/*
+	 *	Print the probabilities of `numberOfPoints` equal bins instead of the density and
+	 *	distribution function at the points.
+	 */
+	bool		isHistogram;
+} DensityGrid;
+
+typedef enum
+{
+	kResponseGridFormatCsv			= 0,
+	kResponseGridFormatBinary,
+	kResponseGridFormatMax
+} ResponseGridFormat;
+
+/*
+ *	Values of one raw ADC input on the response-surface grid: `numberOfValues` equally spaced
+ *	values from `lowerBound` to `upperBound`, or the listed `values` if not `NULL`.
+ */
+typedef struct ResponseGridAxis
+{
+	size_t		numberOfValues;
+	float		lowerBound;
+	float		upperBound;
+	float *		values;
+} ResponseGridAxis;
+
+/*
+ *	Cartesian grid of raw ADC inputs, and optionally calibration devices, on which the
+ *	response-surface mode evaluates all outputs and streams them to `outputPath`.
+ */
+typedef struct ResponseGrid
+{
+	bool			isEnabled;
+	char			outputPath[kCommonConstantMaxCharsPerFilepath];
+	ResponseGridFormat	format;
+	ResponseGridAxis	axes[kInputDistributionIndexMax];
+	/*
+	 *	Devices of the calibration table to evaluate: all of them, the `numberOfDevices` listed
+	 *	in `deviceIndices`, or just the device of `-n` if `deviceIndices` is `NULL`.
+	 */
+	bool			useAllDevices;
+	size_t			numberOfDevices;
+	size_t *		deviceIndices;
+} ResponseGrid;
+
 typedef struct CommandLineArguments
 {
 	/*
@@ -97,6 +191,108 @@ typedef struct CommandLineArguments
 	 *	Array of flags that track whether an input is set from the command-line.
 	 */
 	bool				isInputSetFromCommandLine[kInputDistributionIndexMax];
+	/*
+	 *	Ux strings of the inputs set from the command-line in native Monte Carlo mode, or `NULL`.
+	 */
+	const char *			inputUxStrings[kInputDistributionIndexMax];
+	/*
+	 *	Method for drawing the raw ADC inputs in native Monte Carlo mode.
+	 */
+	SamplingMethod			samplingMethod;
+	/*
+	 *	Seed of the counter-based random number streams used in native Monte Carlo mode.
+	 */
+	uint64_t			randomSeed;
+	/*
+	 *	Sampling of the calibration parameters in native Monte Carlo mode: fixed to the device
+	 *	of `indexForCalibrationParameters`, or drawn in every iteration from all devices.
+	 */
+	CalibrationSampling		calibrationSampling;
+	/*
+	 *	Analysis that native Monte Carlo mode runs instead of plain Monte Carlo iterations.
+	 */
+	AnalysisMode			analysisMode;
+	/*
+	 *	Event of the selected output whose probability importance-sampling analysis estimates.
+	 */
+	OutputEvent			outputEvent;
+	/*
+	 *	Highest order of the central moments that moment propagation computes.
+	 */
+	size_t				momentOrder;
+	DensityGrid			densityGrid;
+	/*
+	 *	Total degree of the polynomial chaos expansion.
+	 */
+	size_t				polynomialChaosDegree;
+	/*
+	 *	Dependence between the raw ADC inputs drawn from trace files in native Monte Carlo mode.
+	 */
+	InputCorrelation		inputCorrelation;
+	/*
+	 *	Path of the checkpoint file of native Monte Carlo mode, valid if `useCheckpoint` is set.
+	 */
+	char				checkpointPath[kCommonConstantMaxCharsPerFilepath];
+	bool				useCheckpoint;
+	/*
+	 *	Number of iterations between two checkpoints.
+	 */
+	size_t				checkpointInterval;
+	/*
+	 *	Boolean variables controlling whether a run continues from its checkpoint, and whether
+	 *	it may continue to a larger `-M` than the checkpointed run.
+	 */
+	bool				resumeFromCheckpoint;
+	bool				extendCheckpoint;
+	/*
+	 *	Whether native Monte Carlo mode runs one shard of a logical run split across processes,
+	 *	or merges the partial results of all shards.
+	 */
+	ShardMode			shardMode;
+	size_t				shardIndex;
+	size_t				numberOfShards;
+	/*
+	 *	Prefix of the partial-result files of the shards, and whether they include the samples.
+	 */
+	char				partialResultPrefix[kCommonConstantMaxCharsPerFilepath];
+	bool				savePartialSamples;
+	/*
+	 *	Memory that holds the samples of native Monte Carlo mode, and the path of its file
+	 *	for the file backend.
+	 */
+	SampleStoreBackend		sampleStoreBackend;
+	char				sampleStorePath[kCommonConstantMaxCharsPerFilepath];
+	/*
+	 *	Maximum number of Monte Carlo samples to write to "data.out" and print, drawn uniformly
+	 *	from all iterations if there are more. Zero writes and prints all samples.
+	 */
+	size_t				maxOutputSamples;
+	/*
+	 *	Precision at which native Monte Carlo mode stores the samples it writes out.
+	 */
+	SamplePrecision			samplePrecision;
+	/*
+	 *	Boolean variable controlling the use of the temperature output as a control variate
+	 *	for estimating the mean of the selected output in native Monte Carlo mode.
+	 */
+	bool				useControlVariate;
+	/*
+	 *	Boolean variable controlling adaptive Monte Carlo, where `-M` is the largest number of
+	 *	iterations and the run stops early once `adaptiveStoppingCriterion` holds.
+	 */
+	bool				isAdaptiveMode;
+	/*
+	 *	Number of iterations between two convergence checks in adaptive Monte Carlo.
+	 */
+	size_t				adaptiveBatchSize;
+	/*
+	 *	Statistics and tolerance for stopping adaptive Monte Carlo.
+	 */
+	AdaptiveStoppingCriterion	adaptiveStoppingCriterion;
+	/*
+	 *	Grid of the response-surface mode, which runs instead of a single evaluation when enabled.
+	 */
+	ResponseGrid			responseGrid;
 } CommandLineArguments;
 
 /**
@@ -141,6 +337,52 @@ CommonConstantReturnType	loadInputs(
 					float *			pressureRawADCValue,
 					float *			humidityRawADCValue);
 
+/**
+ *	@brief	Load the distributions of the raw ADC inputs for native Monte Carlo mode. Inputs
+ *		from ADC trace files (`-m`) become empirical distributions over all samples of the
+ *		trace, Ux strings from the command line become discrete distributions over their Dirac
+ *		deltas, other inputs set from the command line become constants, and the rest are
+ *		uniform over their ranges in `BME680Constants`.
+ *
+ *	@param	arguments		: Pointer to the command-line arguments struct.
+ *	@param	loadedInputVariables	: The input variables as loaded by `loadInputs()`.
+ *	@param	inputDistributions	: Array of `kInputDistributionIndexMax` distributions to load.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	loadInputDistributions(
+					CommandLineArguments *	arguments,
+					const float *		loadedInputVariables,
+					InputDistribution *	inputDistributions);
+
+/**
+ *	@brief	Load the calibration parameters of all devices into an in-memory table. Every row holds
+ *		the temperature, pressure, and humidity parameters of one device, in this order.
+ *
+ *	@param	arguments		: Pointer to the command-line arguments struct.
+ *	@param	calibrationTable	: Pointer to the calibration table to load.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	loadCalibrationTable(CommandLineArguments *  arguments, CalibrationTable *  calibrationTable);
+
+/**
+ *	@brief	Estimate the correlated sampler of the raw ADC inputs from the ADC trace files (`-m`).
+ *
+ *	@param	arguments		: Pointer to the command-line arguments struct.
+ *	@param	correlatedSampler	: Pointer to the correlated sampler to initialize.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	loadCorrelatedSampler(CommandLineArguments *  arguments, CorrelatedSampler *  correlatedSampler);
+
+/**
+ *	@brief	Load all values of a one-column CSV file. Lines that do not parse as a number (e.g., a header) are skipped.
+ *
+ *	@param	filename		: Path to the CSV file.
+ *	@param	samples			: Pointer to store the newly-allocated array of values.
+ *	@param	numberOfSamples		: Pointer to store the number of values.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	loadFloatSamplesFromPath(const char *  filename, float **  samples, size_t *  numberOfSamples);
+
 /**
  *	@brief	Load a value from a one-column CSV file into the variable pointed by `returnValuePtr`.
  *
@@ -187,13 +429,15 @@ void	determineIndexRangeOfSelectedOutputs(
  *	@param	outputVariables			: The output variables.
  *	@param	outputVariableDescriptions	: Descriptions of output variables from which the array of `JSONVariable` structs will take their descriptions.
  *	@param	monteCarloOutputSamples		: Monte Carlo output samples that will populate `JSONVariable` struct values if in Monte Carlo mode.
+ *	@param	numberOfMonteCarloOutputSamples	: Number of Monte Carlo output samples (1 if not in Monte Carlo mode).
  */
 void	populateAndPrintJSONVariables(
 		JSONVariable *		jsonVariables,
 		CommandLineArguments *	arguments,
 		float *			outputVariables,
 		const char *		outputVariableDescriptions[kOutputDistributionIndexMax],
-		float			monteCarloOutputSamples[]);
+		float			monteCarloOutputSamples[],
+		size_t			numberOfMonteCarloOutputSamples);
 
 /**
  *	@brief	Print human-consumable output.
@@ -203,10 +447,28 @@ void	populateAndPrintJSONVariables(
  *	@param	outputNames			: Names of the output variables to print.
  *	@param	outputVariableDescriptions	: Descriptions of output variables to print.
  *	@param	monteCarloOutputSamples		: Monte Carlo output samples that will populate JSON struct values if in Monte Carlo mode.
+ *	@param	numberOfMonteCarloOutputSamples	: Number of Monte Carlo output samples (1 if not in Monte Carlo mode).
  */
 void	printHumanConsumableOutput(
 		CommandLineArguments *	arguments,
 		float *			outputVariables,
 		const char *		outputVariableNames[kOutputDistributionIndexMax],
 		const char *		outputVariableDescriptions[kOutputDistributionIndexMax],
-		float			monteCarloOutputSamples[]);
+		float			monteCarloOutputSamples[],
+		size_t			numberOfMonteCarloOutputSamples);
+
+/**
+ *	@brief	Save 16-bit Monte Carlo sample codes to a binary "data.out": the elapsed time in
+ *		microseconds as a `uint64_t`, followed by the layout of `sampleQuantizerWriteCodes()`.
+ *
+ *	@param	quantizer		: Quantizer that encoded the codes.
+ *	@param	codes			: Codes of the Monte Carlo output samples.
+ *	@param	microseconds		: Elapsed time in microseconds.
+ *	@param	numberOfSamples		: Number of codes.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	saveMonteCarloCodesToDataDotOutFile(
+		const SampleQuantizer *	quantizer,
+		const uint16_t *	codes,
+		uint64_t		microseconds,
+		size_t			numberOfSamples);
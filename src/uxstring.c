@@ -0,0 +1,171 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "uxstring.h"
+
+static const char	kUxStringPrefix[] = "Ux";
+
+/**
+ *	@brief	Read a big-endian unsigned integer from hexadecimal digits.
+ *
+ *	@param	hexDigits	: Pointer to the first digit.
+ *	@param	numberOfBytes	: Number of bytes (two digits each) to read, at most 8.
+ *	@param	value		: Pointer to store the value.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+readHexUnsigned(const char *  hexDigits, size_t numberOfBytes, uint64_t *  value)
+{
+	uint64_t	result = 0;
+
+	for (size_t i = 0; i < 2 * numberOfBytes; i++)
+	{
+		int	digit = tolower((unsigned char) hexDigits[i]);
+
+		if (!isxdigit(digit))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		result = (result << 4) | (uint64_t)(isdigit(digit) ? (digit - '0') : (digit - 'a' + 10));
+	}
+
+	*value = result;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Read a big-endian IEEE-754 double from hexadecimal digits.
+ *
+ *	@param	hexDigits	: Pointer to the first digit.
+ *	@param	value		: Pointer to store the value.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+readHexDouble(const char *  hexDigits, double *  value)
+{
+	uint64_t	bits;
+
+	if (readHexUnsigned(hexDigits, sizeof(double), &bits) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	memcpy(value, &bits, sizeof(double));
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+bool
+isUxString(const char *  string)
+{
+	return strstr(string, kUxStringPrefix) != NULL;
+}
+
+CommonConstantReturnType
+inputDistributionInitFromUxString(InputDistribution *  distribution, const char *  uxString)
+{
+	const char *			payload = strstr(uxString, kUxStringPrefix);
+	size_t				payloadLength;
+	uint64_t			numberOfDiracDeltas;
+	float *				positions;
+	double *			masses;
+	CommonConstantReturnType	ret = kCommonConstantReturnTypeSuccess;
+
+	if (payload == NULL)
+	{
+		fprintf(stderr, "Error: \"%s\" is not a Ux string.\n", uxString);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	payload += strlen(kUxStringPrefix);
+	payloadLength = strlen(payload);
+
+	/*
+	 *	Ignore trailing whitespace, e.g., from Ux strings copied from a file.
+	 */
+	while ((payloadLength > 0) && isspace((unsigned char) payload[payloadLength - 1]))
+	{
+		payloadLength--;
+	}
+
+	if ((payloadLength < 2 * kUxStringConstantHeaderBytes) ||
+		(readHexUnsigned(
+			&payload[2 * (kUxStringConstantHeaderBytes - kUxStringConstantNumberOfDiracDeltasBytes)],
+			kUxStringConstantNumberOfDiracDeltasBytes,
+			&numberOfDiracDeltas) != kCommonConstantReturnTypeSuccess))
+	{
+		fprintf(stderr, "Error: The header of Ux string \"%s\" is malformed.\n", uxString);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((numberOfDiracDeltas == 0) || (payloadLength != 2 * (kUxStringConstantHeaderBytes + numberOfDiracDeltas * kUxStringConstantDiracDeltaBytes)))
+	{
+		fprintf(stderr, "Error: Ux string \"%s\" should have %" PRIu64 " Dirac deltas, but its length does not match.\n", uxString, numberOfDiracDeltas);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	positions = (float *) checkedMalloc(numberOfDiracDeltas * sizeof(float), __FILE__, __LINE__);
+	masses = (double *) checkedMalloc(numberOfDiracDeltas * sizeof(double), __FILE__, __LINE__);
+
+	for (size_t i = 0; i < numberOfDiracDeltas; i++)
+	{
+		const char *	diracDelta = &payload[2 * (kUxStringConstantHeaderBytes + i * kUxStringConstantDiracDeltaBytes)];
+		double		position;
+		uint64_t	mass;
+
+		if ((readHexDouble(diracDelta, &position) != kCommonConstantReturnTypeSuccess) ||
+			(readHexUnsigned(&diracDelta[2 * kUxStringConstantPositionBytes], kUxStringConstantMassBytes, &mass) != kCommonConstantReturnTypeSuccess) ||
+			!isfinite(position))
+		{
+			fprintf(stderr, "Error: Dirac delta %zu of Ux string \"%s\" is malformed.\n", i, uxString);
+			ret = kCommonConstantReturnTypeError;
+
+			break;
+		}
+
+		positions[i] = (float) position;
+		masses[i] = ldexp((double) mass, -63);
+	}
+
+	/*
+	 *	The alias table normalizes the masses, which may not sum to exactly one after rounding.
+	 */
+	if (ret == kCommonConstantReturnTypeSuccess)
+	{
+		ret = inputDistributionInitDiscrete(distribution, positions, masses, numberOfDiracDeltas);
+	}
+
+	free(positions);
+	free(masses);
+
+	return ret;
+}
@@ -0,0 +1,75 @@
+/*
+ *	Copyright (c) 2021–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "distributions.h"
+
+/*
+ *	Layout of the hexadecimal payload of a Ux string, which follows the characters "Ux" (and
+ *	optionally a human-readable mean before them). All fields are big-endian:
+ *
+ *		representation type	: 1 byte
+ *		number of samples	: 8 bytes (unsigned integer)
+ *		mean			: 8 bytes (IEEE-754 double)
+ *		number of Dirac deltas	: 4 bytes (unsigned integer)
+ *		per Dirac delta		: 8 bytes position (IEEE-754 double),
+ *					  8 bytes probability mass (unsigned fixed-point, 1.0 = 2^63)
+ */
+typedef enum
+{
+	kUxStringConstantRepresentationTypeBytes	= 1,
+	kUxStringConstantNumberOfSamplesBytes		= 8,
+	kUxStringConstantMeanBytes			= 8,
+	kUxStringConstantNumberOfDiracDeltasBytes	= 4,
+	kUxStringConstantPositionBytes			= 8,
+	kUxStringConstantMassBytes			= 8,
+	kUxStringConstantHeaderBytes			= kUxStringConstantRepresentationTypeBytes
+								+ kUxStringConstantNumberOfSamplesBytes
+								+ kUxStringConstantMeanBytes
+								+ kUxStringConstantNumberOfDiracDeltasBytes,
+	kUxStringConstantDiracDeltaBytes		= kUxStringConstantPositionBytes + kUxStringConstantMassBytes,
+} UxStringConstant;
+
+/**
+ *	@brief	Check whether a string is a Ux string.
+ *
+ *	@param	string	: The string.
+ *	@return		: `true` if the string contains a Ux payload, else `false`.
+ */
+bool				isUxString(const char *  string);
+
+/**
+ *	@brief	Initialize an input distribution from a Ux string. The Dirac deltas of the string
+ *		become the weighted outcomes of an alias table, so drawing from the distribution takes
+ *		constant time.
+ *
+ *	@param	distribution	: Pointer to the distribution to initialize.
+ *	@param	uxString	: The Ux string.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	inputDistributionInitFromUxString(InputDistribution *  distribution, const char *  uxString);